@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Config.hpp"
+
+namespace VCDP_NAMESPACE {
+
+/// @brief Fixed-size pool of worker threads consuming a FIFO of tasks.
+class ThreadPool {
+   public:
+    /**
+     * @brief Start the workers.
+     * @param threads Number of workers, 0 for one per hardware thread.
+     */
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    [[nodiscard]] unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+    /// @brief Queue a task. Exceptions thrown by the task are rethrown by wait().
+    void submit(std::function<void()> task);
+
+    /// @brief Block until every submitted task has completed.
+    void wait();
+
+    /// @brief Run fn(0) ... fn(count - 1) on the workers and wait for all of them.
+    template <typename Fn>
+    void parallelFor(const size_t count, Fn&& fn) {
+        for (size_t i = 0; i < count; i++) {
+            submit([&fn, i] { fn(i); });
+        }
+        wait();
+    }
+
+    /// @brief Number of workers used when 0 is requested.
+    static unsigned defaultThreadCount();
+
+   private:
+    void run();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable task_available_;
+    std::condition_variable idle_;
+    size_t busy_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+};
+
+}  // namespace VCDP_NAMESPACE
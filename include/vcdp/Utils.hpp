@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string_view>
+
 #include "Config.hpp"
 #include "VCDTypes.hpp"
 
@@ -11,6 +13,9 @@ std::string vcdVarType2String(VCDVarType type);
 /// @brief Convert a VCDTimeUnit to a string
 std::string vcdTimeUnit2String(VCDTimeUnit unit);
 
+/// @brief Convert a VCDScopeType to the keyword of a $scope declaration
+std::string vcdScopeType2String(VCDScopeType type);
+
 /// @brief Convert a VCDBit to a single char
 char vcdBit2Char(VCDBit bit);
 
@@ -19,6 +24,12 @@ VCDBit char2VCDBit(char bit);
 
 const char* bitColor(VCDBit bit);
 
+/// @brief Identifier code number `index`, written in base 94 with the printable characters from '!' to '~'
+std::string compactIdentifier(uint64_t index);
+
+/// @brief Match a name against a pattern where '*' is any sequence of characters and '?' any single one
+bool matchWildcard(std::string_view pattern, std::string_view name);
+
 }  // namespace VCDP_NAMESPACE::utils
 
 namespace VCDP_NAMESPACE::color {
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "Config.hpp"
 #include "VCDFile.hpp"
+#include "VCDKeywords.hpp"
 #include "VCDLexical.hpp"
 
 namespace VCDP_NAMESPACE {
@@ -19,15 +22,14 @@ struct VCDScopeBuilder {
         type = VCDScopeType::VCD_SCOPE_UNKNOWN;
     }
 
-    std::unique_ptr<VCDScope> Build(VCDScope* parent) {
-        auto scope = std::make_unique<VCDScope>();
-        scope->name = name;
-        scope->type = type;
-        scope->parent = parent;
+    VCDScope Build() {
+        VCDScope scope;
+        scope.name = name;
+        scope.type = type;
 
         Reset();
 
-        return std::move(scope);
+        return scope;
     }
 };
 
@@ -50,22 +52,33 @@ struct VCDSignalBuilder {
         lindex = -1;
     }
 
-    std::unique_ptr<VCDSignal> Build(VCDScope* scope) {
-        auto signal = std::make_unique<VCDSignal>();
-        signal->reference = reference;
-        signal->type = type;
-        signal->scope = scope;
-        signal->hash = hash;
-        signal->rindex = rindex;
-        signal->lindex = lindex;
-        signal->size = size;
+    VCDSignal Build(VCDIndex scope) {
+        VCDSignal signal;
+        signal.reference = reference;
+        signal.type = type;
+        signal.scope = scope;
+        signal.hash = hash;
+        signal.rindex = rindex;
+        signal.lindex = lindex;
+        signal.size = size;
 
         Reset();
 
-        return std::move(signal);
+        return signal;
     }
 };
 
+/**
+ * @brief Destination of $var declarations parsed away from the file, added to it afterwards in
+ * the same order. The actions of a $var take it in place of the VCDFile.
+ */
+struct VCDSignalBatch {
+    VCDIndex current_scope = 0;  //!< Only declarations inside a scope are batched, VCDFile::addSignal sets which one
+    std::vector<VCDSignal> signals;
+
+    void addSignal(VCDSignal signal) { signals.push_back(std::move(signal)); }
+};
+
 struct ActionState {
     VCDScopeBuilder current_scope_builder;
     VCDSignalBuilder current_signal_builder;
@@ -94,21 +107,7 @@ template <>
 struct action<lexical::time_unit> {
     template <typename Input>
     static void apply(const Input& in, VCDFile& file, ActionState& state) {
-        std::string unit = in.string();
-        if (unit == "s")
-            file.time_units = VCDTimeUnit::TIME_S;
-        else if (unit == "ms")
-            file.time_units = VCDTimeUnit::TIME_MS;
-        else if (unit == "us")
-            file.time_units = VCDTimeUnit::TIME_US;
-        else if (unit == "ns")
-            file.time_units = VCDTimeUnit::TIME_NS;
-        else if (unit == "ps")
-            file.time_units = VCDTimeUnit::TIME_PS;
-        else if (unit == "fs")
-            file.time_units = VCDTimeUnit::TIME_FS;
-        else
-            file.time_units = VCDTimeUnit::TIME_UNKNOWN;
+        file.time_units = TIME_UNIT_KEYWORDS.find(std::string_view(in.begin(), in.size()));
     }
 };
 
@@ -124,19 +123,7 @@ template <>
 struct action<lexical::scope_type> {
     template <typename Input>
     static void apply(const Input& in, VCDFile& file, ActionState& state) {
-        std::string type = in.string();
-        if (type == "begin")
-            state.current_scope_builder.type = VCDScopeType::VCD_SCOPE_BEGIN;
-        else if (type == "fork")
-            state.current_scope_builder.type = VCDScopeType::VCD_SCOPE_FORK;
-        else if (type == "function")
-            state.current_scope_builder.type = VCDScopeType::VCD_SCOPE_FUNCTION;
-        else if (type == "module")
-            state.current_scope_builder.type = VCDScopeType::VCD_SCOPE_MODULE;
-        else if (type == "task")
-            state.current_scope_builder.type = VCDScopeType::VCD_SCOPE_TASK;
-        else
-            state.current_scope_builder.type = VCDScopeType::VCD_SCOPE_UNKNOWN;
+        state.current_scope_builder.type = SCOPE_TYPE_KEYWORDS.find(std::string_view(in.begin(), in.size()));
     }
 };
 
@@ -153,8 +140,7 @@ struct action<lexical::scope_end> {
     template <typename Input>
     static void apply(const Input& in, VCDFile& file, ActionState& state) {
         if (state.current_scope_builder.IsComplete()) {
-            auto scope = state.current_scope_builder.Build(file.current_scope);
-            file.addScope(std::move(scope));
+            file.addScope(state.current_scope_builder.Build());
         }
     }
 };
@@ -163,8 +149,8 @@ template <>
 struct action<lexical::command_upscope> {
     template <typename Input>
     static void apply(const Input& in, VCDFile& file, ActionState& state) {
-        if (file.current_scope != nullptr) {
-            file.current_scope = file.current_scope->parent;
+        if (file.current_scope != VCD_NO_INDEX) {
+            file.current_scope = file.getScopes()[file.current_scope].parent;
         } else {
             throw pegtl::parse_error("$scope declaration expected", in);
         }
@@ -173,54 +159,16 @@ struct action<lexical::command_upscope> {
 
 template <>
 struct action<lexical::var_type> {
-    template <typename Input>
-    static void apply(const Input& in, VCDFile& file, ActionState& state) {
-        std::string type = in.string();
-        if (type == "event")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_EVENT;
-        else if (type == "integer")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_INTEGER;
-        else if (type == "parameter")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_PARAMETER;
-        else if (type == "real")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_REAL;
-        else if (type == "realtime")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_REALTIME;
-        else if (type == "reg")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_REG;
-        else if (type == "supply0")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_SUPPLY0;
-        else if (type == "supply1")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_SUPPLY1;
-        else if (type == "time")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_TIME;
-        else if (type == "tri")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_TRI;
-        else if (type == "triand")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_TRIAND;
-        else if (type == "trior")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_TRIOR;
-        else if (type == "trireg")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_TRIREG;
-        else if (type == "tri0")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_TRI0;
-        else if (type == "tri1")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_TRI1;
-        else if (type == "wand")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_WAND;
-        else if (type == "wire")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_WIRE;
-        else if (type == "wor")
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_WOR;
-        else
-            state.current_signal_builder.type = VCDVarType::VCD_VAR_UNKNOWN;
+    template <typename Input, typename File>
+    static void apply(const Input& in, File& file, ActionState& state) {
+        state.current_signal_builder.type = VAR_TYPE_KEYWORDS.find(std::string_view(in.begin(), in.size()));
     }
 };
 
 template <>
 struct action<lexical::var_size> {
-    template <typename Input>
-    static void apply(const Input& in, VCDFile& file, ActionState& state) {
+    template <typename Input, typename File>
+    static void apply(const Input& in, File& file, ActionState& state) {
         const uint32_t size = std::stoi(in.string());
         state.current_signal_builder.size = size;
     }
@@ -228,8 +176,8 @@ struct action<lexical::var_size> {
 
 template <>
 struct action<lexical::var_identifier> {
-    template <typename Input>
-    static void apply(const Input& in, VCDFile& file, ActionState& state) {
+    template <typename Input, typename File>
+    static void apply(const Input& in, File& file, ActionState& state) {
         const std::string hash = in.string();
         state.current_signal_builder.hash = hash;
     }
@@ -237,61 +185,61 @@ struct action<lexical::var_identifier> {
 
 template <>
 struct action<lexical::var_name> {
-    template <typename Input>
-    static void apply(const Input& in, VCDFile& file, ActionState& state) {
+    template <typename Input, typename File>
+    static void apply(const Input& in, File& file, ActionState& state) {
         state.current_signal_builder.reference = in.string();
     }
 };
 
 template <>
 struct action<lexical::lsb_index> {
-    template <typename Input>
-    static void apply(const Input& in, VCDFile& file, ActionState& state) {
+    template <typename Input, typename File>
+    static void apply(const Input& in, File& file, ActionState& state) {
         state.current_signal_builder.rindex = std::stoi(in.string());
     }
 };
 
 template <>
 struct action<lexical::msb_index> {
-    template <typename Input>
-    static void apply(const Input& in, VCDFile& file, ActionState& state) {
+    template <typename Input, typename File>
+    static void apply(const Input& in, File& file, ActionState& state) {
         state.current_signal_builder.lindex = std::stoi(in.string());
     }
 };
 
 template <>
 struct action<lexical::var_end> {
-    template <typename Input>
-    static void apply(const Input& in, VCDFile& file, ActionState& state) {
+    template <typename Input, typename File>
+    static void apply(const Input& in, File& file, ActionState& state) {
         if (state.current_signal_builder.IsComplete()) {
             auto signal = state.current_signal_builder.Build(file.current_scope);
-            if (signal->scope == nullptr) {
+            if (signal.scope == VCD_NO_INDEX) {
                 std::ostringstream msg;
-                msg << "Signal \'" << signal->reference << "\' needs to be part of a scope";
+                msg << "Signal \'" << signal.reference << "\' needs to be part of a scope";
                 throw pegtl::parse_error(msg.str(), in);
             }
 
-            if (signal->rindex != -1) {
-                if (signal->lindex == -1 && signal->size != -1) {
+            if (signal.rindex != -1) {
+                if (signal.lindex == -1 && signal.size != 1) {
                     std::ostringstream msg;
-                    msg << "Size mismatch for signal '" << signal->reference << "': index [" << signal->rindex
-                        << "] implies size 1 but declared size is " << signal->size;
+                    msg << "Size mismatch for signal '" << signal.reference << "': index [" << signal.rindex
+                        << "] implies size 1 but declared size is " << signal.size;
                     throw pegtl::parse_error(msg.str(), in);
                 }
-                if (signal->size > 1) {
+                if (signal.size > 1) {
                     // Range size exception
-                    if (int range_size = std::abs(signal->lindex - signal->rindex) + 1; range_size != signal->size) {
+                    if (int range_size = std::abs(signal.lindex - signal.rindex) + 1; range_size != signal.size) {
                         std::ostringstream msg;
-                        msg << "Range size mismatch for signal '" << signal->reference << "': range [" << signal->lindex << ":" << signal->rindex
-                            << "] implies size " << range_size << " but declared size is " << signal->size;
+                        msg << "Range size mismatch for signal '" << signal.reference << "': range [" << signal.lindex << ":" << signal.rindex
+                            << "] implies size " << range_size << " but declared size is " << signal.size;
                         throw pegtl::parse_error(msg.str(), in);
                     }
                 } else {
                     // Single index exception
-                    if (signal->size != 1) {
+                    if (signal.size != 1) {
                         std::ostringstream msg;
-                        msg << "Size mismatch for signal '" << signal->reference << "': index [" << signal->rindex
-                            << "] implies size 1 but declared size is " << signal->size;
+                        msg << "Size mismatch for signal '" << signal.reference << "': index [" << signal.rindex
+                            << "] implies size 1 but declared size is " << signal.size;
                         throw pegtl::parse_error(msg.str(), in);
                     }
                 }
@@ -305,9 +253,10 @@ template <>
 struct action<lexical::command_enddefinitions> {
     template <typename Input>
     static void apply(const Input& in, VCDFile& file, ActionState& state) {
-        if (file.current_scope != nullptr) {
+        if (file.current_scope != VCD_NO_INDEX) {
             throw pegtl::parse_error("$upscope declaration expected.", in);
         }
+        file.endDefinitions();
     }
 };
 }  // namespace VCDP_NAMESPACE
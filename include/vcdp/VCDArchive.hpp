@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Config.hpp"
+#include "VCDFile.hpp"
+#include "VCDWriter.hpp"
+
+/**
+ * @file VCDArchive.hpp
+ * @brief Block-compressed, time-indexed waveform archive, written from a parsed VCDFile.
+ *
+ * Layout of an archive, integers little endian:
+ *  - "VCDPARCH", uint32 format version, uint32 reserved
+ *  - uint64 compressed size, uint64 raw size and uint32 CRC-32 of the index
+ *  - the index, deflate compressed: timescale, date, version, scopes, signals and
+ *    the list of blocks of the time table and of each signal
+ *  - the data section: the blocks, each deflate compressed on its own
+ *
+ * The value changes of a signal keep the encoding of VCDFile::addValueChange and are
+ * cut at change boundaries into blocks of about ArchiveOptions::block_size bytes.
+ */
+
+namespace VCDP_NAMESPACE {
+
+/// @brief How VCDArchiveWriter compresses.
+struct ArchiveOptions {
+    /// @brief libdeflate compression level, 1 (fastest) to 12 (smallest).
+    int compression_level = 6;
+
+    /// @brief Uncompressed bytes per block. Smaller blocks make time windows cheaper to read, larger ones compress better.
+    uint32_t block_size = 64 * 1024;
+};
+
+/// @brief Compressed run of the value changes of a signal, or of the time table.
+struct VCDArchiveBlock {
+    uint64_t offset = 0;            //!< Position in the data section
+    uint32_t compressed_size = 0;   //!< Bytes in the archive
+    uint32_t raw_size = 0;          //!< Bytes once decompressed
+    uint32_t crc = 0;               //!< CRC-32 of the decompressed bytes
+    uint64_t count = 0;             //!< Value changes, or timestamps
+    uint64_t first_time_index = 0;  //!< Time index of the first change, signal blocks only
+    uint64_t last_time_index = 0;   //!< Time index of the last change, signal blocks only
+};
+
+/// @brief Convert a parsed VCDFile to an archive.
+class VCDArchiveWriter {
+   public:
+    explicit VCDArchiveWriter(const ArchiveOptions options = ArchiveOptions()) : options_(options) {}
+
+    /**
+     * @brief Write every signal of a file.
+     * @param file The file to write, its definitions ended.
+     * @param output_path Destination archive.
+     */
+    VCDWriteResult write(const VCDFile& file, const std::string& output_path);
+
+   private:
+    ArchiveOptions options_;
+};
+
+/**
+ * @brief Read an archive. Opening only reads the index: the time table and the value
+ * changes of a signal are decompressed when first needed.
+ */
+class VCDArchiveReader {
+   public:
+    /**
+     * @brief Read the header and the index of an archive.
+     * @param path The archive.
+     * @return false if the file is not a readable archive, see GetError().
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Scopes and signals of the archive. Signals hold no value change until loaded
+     * with loadSignal(), and timestamps are only there once loadTimestamps() ran.
+     */
+    [[nodiscard]] const VCDFile& getFile() const { return *file_; }
+
+    /// @brief Decompress the time table into getFile(). Done once, loadSignal() calls it.
+    bool loadTimestamps();
+
+    /**
+     * @brief Decompress the value changes of a signal into getFile(), replacing the ones
+     * loaded before. Only the blocks overlapping the time window are read: the loaded changes
+     * cover [begin, end], starting with the last change at or before begin.
+     * @param signal A signal of getFile().
+     * @param begin First time of interest.
+     * @param end Last time of interest.
+     */
+    bool loadSignal(const VCDSignal& signal, uint64_t begin = 0, uint64_t end = UINT64_MAX);
+
+    /// @brief Blocks holding the value changes of a signal of getFile(), in time order.
+    [[nodiscard]] const std::vector<VCDArchiveBlock>& getBlocks(const VCDSignal& signal) const;
+
+    /// @brief Why the last call failed.
+    [[nodiscard]] const std::string& GetError() const { return error_; }
+
+   private:
+    bool readBlock(const VCDArchiveBlock& block, std::vector<uint8_t>& raw);
+    bool fail(std::string error);
+
+    std::ifstream stream_;
+    uint64_t data_offset_ = 0;  //!< Position of the data section in the file
+    std::unique_ptr<VCDFile> file_ = std::make_unique<VCDFile>();  //!< Not movable, replaced by each open()
+    std::vector<VCDArchiveBlock> time_blocks_;
+    uint64_t timestamp_count_ = 0;
+    bool timestamps_loaded_ = false;
+    std::vector<std::vector<VCDArchiveBlock>> signal_blocks_;  //!< By index in getFile().getSignals()
+    std::vector<uint8_t> compressed_;  //!< Read buffer of readBlock()
+    std::string error_;
+};
+
+}  // namespace VCDP_NAMESPACE
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+#include "Config.hpp"
+#include "VCDFile.hpp"
+#include "VCDIdTable.hpp"
+#include "VCDParser.hpp"
+
+namespace VCDP_NAMESPACE {
+
+/// @brief Simulator that wrote a file, see detectSimulator.
+enum class VCDSimulator { UNKNOWN, GHDL, QUESTA, VERILATOR };
+
+/**
+ * @brief Line shapes of the value changes, fixed at compile time so that the decoder drops
+ * the branches a simulator never needs. A line outside its dialect is still decoded, along
+ * the slower generic path.
+ * @tparam Trim Lines may be indented, padded or end with "\r\n" or a lone '\r'. Without it, values
+ * and identifier codes are separated by a single space, and a padded line is trimmed once it
+ * failed to decode.
+ * @tparam IdSize Length of every identifier code, looked up in a VCDIdTable instead of the
+ * hash table of the file. 0 when they differ.
+ */
+template <bool Trim, unsigned IdSize>
+struct VCDDialect {
+    static constexpr bool TRIM = Trim;
+    static constexpr unsigned ID_SIZE = IdSize;
+};
+
+/// @brief Any valid line.
+using VCDGenericDialect = VCDDialect<true, 0>;
+
+/// @brief Simulator named by the $version of a header, UNKNOWN for others.
+inline VCDSimulator detectSimulator(const std::string_view version) {
+    if (version.find("GHDL") != std::string_view::npos) return VCDSimulator::GHDL;
+    if (version.find("Questa") != std::string_view::npos || version.find("ModelSim") != std::string_view::npos) return VCDSimulator::QUESTA;
+    if (version.find("Verilator") != std::string_view::npos) return VCDSimulator::VERILATOR;
+    return VCDSimulator::UNKNOWN;
+}
+
+/**
+ * @brief Call fn with the dialect of a file whose header is parsed. GHDL, Questa and Verilator
+ * write bare "\n" terminated lines, and Verilator short identifier codes: the identifier size
+ * is fixed when every declared code has the same length of 1 or 2 printable characters.
+ * @param fn Generic callable taking a VCDDialect value.
+ */
+template <typename Fn>
+void withDialect(const VCDFile& file, Fn&& fn) {
+    if (detectSimulator(file.version) == VCDSimulator::UNKNOWN) return fn(VCDGenericDialect{});
+
+    size_t id_size = file.getSignals().empty() ? 0 : file.getSignals().front().hash.size();
+    for (const auto& signal : file.getSignals()) {
+        const bool printable = std::all_of(signal.hash.begin(), signal.hash.end(), [](const char c) { return c >= '!' && c <= '~'; });
+        if (signal.hash.size() != id_size || !printable) id_size = 0;
+    }
+    switch (id_size) {
+        case 1:
+            return fn(VCDDialect<false, 1>{});
+        case 2:
+            return fn(VCDDialect<false, 2>{});
+        default:
+            return fn(VCDDialect<false, 0>{});
+    }
+}
+
+/**
+ * @brief Decode the value change section line by line.
+ *
+ * Timestamps and value changes are forwarded to a sink providing:
+ *  - void onTimestamp(uint64_t time);
+ *  - void onValueChange(VCDSignal& signal, std::string_view value);
+ *
+ * Problems are reported to a VCDParseResult, decoding goes on with the next line.
+ *
+ * @tparam Dialect Line shapes to decode fastest, see VCDDialect and withDialect.
+ */
+template <typename Sink, typename Dialect = VCDGenericDialect>
+class VCDBodyDecoder {
+   public:
+    /**
+     * @param file File whose header declares the signals.
+     * @param ids Signals of the file by identifier code of the dialect size, unused by a dialect without one.
+     * @param result Receives the diagnostics.
+     * @param sink Receives the decoded timestamps and value changes.
+     * @param line Number of lines preceding the first decoded one.
+     * @param in_comment The first decoded line is inside a $comment, see inComment().
+     */
+    VCDBodyDecoder(VCDFile& file, const VCDIdTable& ids, VCDParseResult& result, Sink& sink, const uint64_t line = 0, const bool in_comment = false)
+        : file_(file), ids_(&ids), result_(result), sink_(sink), line_(line), in_comment_(in_comment) {}
+
+    /// @brief Decoder of a dialect without identifier size, see the other constructor.
+    VCDBodyDecoder(VCDFile& file, VCDParseResult& result, Sink& sink, const uint64_t line = 0, const bool in_comment = false)
+        : file_(file), result_(result), sink_(sink), line_(line), in_comment_(in_comment) {
+        static_assert(Dialect::ID_SIZE == 0, "The identifier table of the dialect is needed");
+    }
+
+    /**
+     * @brief Decode every complete line of a block of text.
+     * @param text The text to decode.
+     * @param offset Byte offset of the text in the file.
+     * @param last Also decode a final line not terminated by a newline.
+     * @return Number of bytes consumed, the remainder is an incomplete line.
+     */
+    size_t decode(const std::string_view text, const uint64_t offset, const bool last) {
+        size_t line_start = 0;
+        size_t pos = 0;
+        while ((pos = lineEnd(text, line_start)) != std::string_view::npos) {
+            size_t next = pos + 1;
+            if constexpr (Dialect::TRIM) {
+                // "\r\n" ends one line: a '\r' ending the text waits for the next one to tell
+                if (text[pos] == '\r' && next == text.size() && !last) break;
+                if (text[pos] == '\r' && next < text.size() && text[next] == '\n') next++;
+            }
+            line_++;
+            decodeLine(text.substr(line_start, pos - line_start), offset + line_start);
+            line_start = next;
+        }
+
+        if (last && line_start < text.size()) {
+            line_++;
+            decodeLine(text.substr(line_start), offset + line_start);
+            line_start = text.size();
+        }
+        return line_start;
+    }
+
+    /// @brief Decode a single line, without its line terminator.
+    void decodeLine(std::string_view line, const uint64_t offset) {
+        // Trim surrounding blanks, '\r' of CRLF line ends included. Other dialects only trim the lines failing to decode, see decodePadded
+        if constexpr (Dialect::TRIM) line = trim(line);
+        if (line.empty()) return;
+
+        // Skip multi-line comments
+        if (in_comment_) {
+            in_comment_ = line.find("$end") == std::string_view::npos;
+            return;
+        }
+        if (line[0] == '$') {  // Skip dump commands
+            in_comment_ = line.substr(0, 8) == "$comment" && line.find("$end") == std::string_view::npos;
+            return;
+        }
+
+        switch (line[0]) {
+            // Timestamp
+            case '#': {
+                uint64_t time = 0;
+                const char* last = line.data() + line.size();
+                if (const auto [ptr, ec] = std::from_chars(line.data() + 1, last, time); ec != std::errc() || ptr != last) {
+                    if (decodePadded(line, offset)) return;
+                    result_.AddError(VCDDiagCode::INVALID_TIMESTAMP, line, offset, line_);
+                    return;
+                }
+                sink_.onTimestamp(time);
+                return;
+            }
+
+            // Vector value: b<bits> <identifier>, real value: r<number> <identifier>
+            case 'b':
+            case 'B':
+            case 'r':
+            case 'R': {
+                const bool real = line[0] == 'r' || line[0] == 'R';
+
+                // An identifier of the dialect size: no need to look for the space
+                if constexpr (Dialect::ID_SIZE > 0) {
+                    constexpr size_t id_size = Dialect::ID_SIZE;
+                    if (line.size() > id_size + 2 && line[line.size() - id_size - 1] == ' ' && !isBlank(line[line.size() - id_size - 2])) {
+                        emit(line, line.substr(line.size() - id_size), line.substr(1, line.size() - id_size - 2), offset, real);
+                        return;
+                    }
+                }
+
+                // A single space before the identifier code
+                if constexpr (!Dialect::TRIM) {
+                    const void* found = std::memchr(line.data() + 1, ' ', line.size() - 1);
+                    const size_t space = found == nullptr ? line.size() : static_cast<const char*>(found) - line.data();
+                    if (space + 1 < line.size() && !isBlank(line[space + 1]) && !(real && space == 1)) {
+                        emit(line, line.substr(space + 1), line.substr(1, space - 1), offset, real);
+                        return;
+                    }
+                }
+
+                size_t space = 1;
+                while (space < line.size() && !isBlank(line[space])) space++;
+                size_t id_start = space;
+                while (id_start < line.size() && isBlank(line[id_start])) id_start++;
+                if (id_start == line.size() || (real && space == 1)) {
+                    if (decodePadded(line, offset)) return;
+                    result_.AddError(VCDDiagCode::INVALID_VALUE, line, offset, line_);
+                    return;
+                }
+                emit(line, line.substr(id_start), line.substr(1, space - 1), offset, real);
+                return;
+            }
+
+            // Scalar value: <bit><identifier>
+            case '0':
+            case '1':
+            case 'x':
+            case 'X':
+            case 'z':
+            case 'Z':
+            case 'u':
+            case 'U':
+            case 'w':
+            case 'W':
+            case 'l':
+            case 'L':
+            case 'h':
+            case 'H':
+            case '-':
+                if (line.size() < 2) {
+                    result_.AddError(VCDDiagCode::INVALID_VALUE, line, offset, line_);
+                    return;
+                }
+                emit(line, line.substr(1), line.substr(0, 1), offset, false);
+                return;
+
+            default:
+                if (decodePadded(line, offset)) return;
+                result_.AddError(VCDDiagCode::INVALID_VALUE, line, offset, line_);
+                return;
+        }
+    }
+
+    /// @brief Number of lines seen so far, including the ones preceding the decoder.
+    [[nodiscard]] uint64_t line() const { return line_; }
+
+    /// @brief The last decoded line left a $comment open, for the decoder of the following text.
+    [[nodiscard]] bool inComment() const { return in_comment_; }
+
+   private:
+    static bool isBlank(const char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    static std::string_view trim(std::string_view line) {
+        while (!line.empty() && isBlank(line.back())) line.remove_suffix(1);
+        while (!line.empty() && isBlank(line.front())) line.remove_prefix(1);
+        return line;
+    }
+
+    /**
+     * @brief Decode again, trimmed, a line that failed to decode in a dialect without padding.
+     * @return false when the line is not padded or the dialect trims every line: the failure stands.
+     */
+    bool decodePadded(const std::string_view line, const uint64_t offset) {
+        if constexpr (Dialect::TRIM) {
+            return false;
+        } else {
+            const std::string_view trimmed = trim(line);
+            if (trimmed.size() == line.size()) return false;
+            decodeLine(trimmed, offset);
+            return true;
+        }
+    }
+
+    /// @brief Position of the '\n', or of the '\r' too when the dialect trims, ending the line starting at `from`.
+    static size_t lineEnd(const std::string_view text, const size_t from) {
+        if constexpr (Dialect::TRIM) {
+            for (size_t pos = from; pos < text.size(); pos++) {
+                if (text[pos] == '\n' || text[pos] == '\r') return pos;
+            }
+            return std::string_view::npos;
+        } else {
+            const void* newline = std::memchr(text.data() + from, '\n', text.size() - from);
+            return newline == nullptr ? std::string_view::npos : static_cast<const char*>(newline) - text.data();
+        }
+    }
+
+    /**
+     * @brief Forward a change, a real number only to a real signal and a logic value only to a logic one.
+     * @param line The decoded line, ending with the identifier code.
+     */
+    void emit(const std::string_view line, const std::string_view hash, const std::string_view value, const uint64_t offset, const bool real) {
+        VCDSignal* signal = nullptr;
+        if constexpr (Dialect::ID_SIZE > 0) {
+            signal = ids_->template find<Dialect::ID_SIZE>(hash);
+        } else {
+            signal = file_.findSignal(hash);
+        }
+        if (signal == nullptr) {
+            if (decodePadded(line, offset)) return;
+            result_.AddWarning(VCDDiagCode::UNKNOWN_IDENTIFIER, hash, offset, line_);
+            return;
+        }
+        if (signal->isReal() != real) {
+            result_.AddError(VCDDiagCode::INVALID_VALUE, hash, offset, line_);
+            return;
+        }
+        sink_.onValueChange(*signal, value);
+    }
+
+    VCDFile& file_;
+    const VCDIdTable* ids_ = nullptr;  //!< Shared by the decoders of a file, see VCDIdTable
+    VCDParseResult& result_;
+    Sink& sink_;
+    uint64_t line_ = 0;
+    bool in_comment_ = false;
+};
+
+}  // namespace VCDP_NAMESPACE
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Config.hpp"
+
+/**
+ * @file VCDDiagnostics.hpp
+ * @brief Structured errors and warnings reported by the VCD parser.
+ */
+
+namespace VCDP_NAMESPACE {
+
+/// @brief Kind of problem found while parsing a VCD file.
+enum class VCDDiagCode : uint8_t {
+    IO_ERROR,            //!< The file could not be opened or read
+    HEADER_SYNTAX,       //!< The declaration section does not follow the grammar
+    HEADER_INCOMPLETE,   //!< No $end following $enddefinitions
+    INVALID_TIMESTAMP,   //!< '#' not followed by a decimal number
+    UNKNOWN_IDENTIFIER,  //!< Value change on an identifier code never declared by a $var
+    INVALID_VALUE,       //!< Value change line that cannot be decoded
+    COUNT                //!< Number of diagnostic kinds, not a real code
+};
+
+/// @brief Number of distinct diagnostic kinds.
+inline constexpr size_t VCD_DIAG_CODE_COUNT = static_cast<size_t>(VCDDiagCode::COUNT);
+
+enum class VCDSeverity : uint8_t { VCD_ERROR, VCD_WARNING };
+
+/// @brief A single retained diagnostic. The human-readable text is only built by Message().
+struct VCDDiagnostic {
+    VCDDiagCode code = VCDDiagCode::HEADER_SYNTAX;
+    VCDSeverity severity = VCDSeverity::VCD_ERROR;
+    uint64_t offset = 0;  //!< Byte offset of the offending line in the file
+    uint64_t line = 0;    //!< 1-based line number, 0 when unknown
+    std::string detail;   //!< Identifier code for body diagnostics, parser message for header ones
+
+    /// @brief Format the diagnostic as a human-readable message.
+    [[nodiscard]] std::string Message() const;
+};
+
+std::ostream& operator<<(std::ostream& os, const VCDDiagnostic& diagnostic);
+
+/// @brief Default number of errors (and, separately, warnings) kept with their details.
+inline constexpr size_t VCD_DEFAULT_RETAINED_DIAGNOSTICS = 64;
+
+/**
+ * @brief Bounded diagnostic list: every report is counted per kind, but only the first
+ * `limit` ones are stored. Reports past the limit cost a single increment.
+ */
+class VCDDiagnosticList {
+   public:
+    using const_iterator = std::vector<VCDDiagnostic>::const_iterator;
+
+    void Add(VCDDiagCode code, VCDSeverity severity, uint64_t offset, uint64_t line, std::string_view detail) {
+        ++counts_[static_cast<size_t>(code)];
+        ++total_;
+        if (retained_.size() < limit_) {
+            retained_.push_back(VCDDiagnostic{code, severity, offset, line, std::string(detail)});
+        }
+    }
+
+    /**
+     * @brief Append the reports of another list, as if they had been added here.
+     * @param other The list to append.
+     * @param line_base Added to the line numbers of the appended diagnostics.
+     */
+    void Append(const VCDDiagnosticList& other, const uint64_t line_base = 0) {
+        for (size_t i = 0; i < VCD_DIAG_CODE_COUNT; i++) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        for (const auto& diagnostic : other.retained_) {
+            if (retained_.size() >= limit_) break;
+            retained_.push_back(diagnostic);
+            if (retained_.back().line != 0) retained_.back().line += line_base;
+        }
+    }
+
+    /// @brief Number of reports of a given kind, retained or not.
+    [[nodiscard]] uint64_t Count(VCDDiagCode code) const { return counts_[static_cast<size_t>(code)]; }
+
+    /// @brief Number of reports of any kind, retained or not.
+    [[nodiscard]] uint64_t Total() const { return total_; }
+
+    /// @brief Number of reports counted but not retained because the limit was reached.
+    [[nodiscard]] uint64_t Dropped() const { return total_ - retained_.size(); }
+
+    void SetLimit(size_t limit) { limit_ = limit; }
+    [[nodiscard]] size_t Limit() const { return limit_; }
+
+    [[nodiscard]] bool empty() const { return total_ == 0; }
+    [[nodiscard]] size_t size() const { return retained_.size(); }
+    [[nodiscard]] const VCDDiagnostic& operator[](size_t index) const { return retained_[index]; }
+    [[nodiscard]] const_iterator begin() const { return retained_.begin(); }
+    [[nodiscard]] const_iterator end() const { return retained_.end(); }
+
+    void clear() {
+        retained_.clear();
+        counts_.fill(0);
+        total_ = 0;
+    }
+
+   private:
+    std::vector<VCDDiagnostic> retained_;
+    std::array<uint64_t, VCD_DIAG_CODE_COUNT> counts_{};
+    uint64_t total_ = 0;
+    size_t limit_ = VCD_DEFAULT_RETAINED_DIAGNOSTICS;
+};
+
+}  // namespace VCDP_NAMESPACE
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Config.hpp"
+#include "VCDParser.hpp"
+
+/**
+ * @file VCDDiff.hpp
+ * @brief Compare the waveforms of two VCD files signal by signal.
+ */
+
+namespace VCDP_NAMESPACE {
+
+/// @brief What VCDDiff compares, and how.
+struct DiffOptions {
+    /**
+     * @brief Wildcard patterns selecting the compared signals, matched against the dotted
+     * hierarchical name (eg. "tb.uut.*"). Empty for every signal.
+     */
+    std::vector<std::string> signals;
+
+    /// @brief Threads comparing groups of signals, 0 for one per hardware thread.
+    unsigned threads = 1;
+
+    /// @brief Mismatch windows kept per signal, the others are only counted.
+    size_t max_windows = 16;
+
+    /// @brief Bytes of each file decoded at once. Bounds the memory used together with the number of signals.
+    size_t chunk_size = 1024 * 1024;
+};
+
+/// @brief Time interval [begin, end) during which the two values of a signal differ.
+struct VCDDiffWindow {
+    uint64_t begin = 0;
+    uint64_t end = UINT64_MAX;  //!< UINT64_MAX when the values still differ at the end of the traces
+};
+
+/// @brief Comparison of a signal present in both files.
+struct VCDSignalDiff {
+    std::string path;  //!< Dotted hierarchical name
+    uint32_t size_a = 0;
+    uint32_t size_b = 0;
+    uint64_t first_divergence = UINT64_MAX;  //!< Time of the first difference, UINT64_MAX if none
+    uint64_t mismatches = 0;                 //!< Times at which a value changed and the two values differed
+    uint64_t window_count = 0;               //!< Mismatch windows, kept or not
+    std::vector<VCDDiffWindow> windows;      //!< The first DiffOptions::max_windows mismatch windows
+
+    [[nodiscard]] bool Differs() const { return window_count > 0; }
+};
+
+/// @brief Outcome of a comparison.
+struct VCDDiffResult {
+    bool success = true;
+    std::string error;                   //!< Why the comparison could not run
+    std::vector<VCDSignalDiff> signals;  //!< Signals of both files, in the order of the first one
+    std::vector<std::string> only_in_a;  //!< Paths of the signals missing from the second file
+    std::vector<std::string> only_in_b;  //!< Paths of the signals missing from the first file
+    uint64_t end_time = 0;               //!< Last timestamp of either file
+
+    /// @brief Number of signals with at least one mismatch.
+    [[nodiscard]] size_t DifferingSignals() const;
+
+    /// @brief The traces are identical over the compared signals, and have the same signals.
+    [[nodiscard]] bool Identical() const { return success && only_in_a.empty() && only_in_b.empty() && DifferingSignals() == 0; }
+};
+
+/**
+ * @brief Stream two VCD files in lock-step by timestamp and compare the signals
+ * having the same hierarchical name.
+ *
+ * Neither file is stored: both bodies are decoded a chunk at a time, and the value
+ * changes older than the time both decoders reached are handed to groups of signals
+ * compared in parallel. Memory depends on the chunk size and the number of signals,
+ * not on the length of the traces.
+ *
+ * Values are compared after left-extension to the larger declared size, case insensitively.
+ */
+class VCDDiff {
+   public:
+    explicit VCDDiff(DiffOptions options = DiffOptions()) : options_(std::move(options)) {}
+
+    /**
+     * @brief Compare two files.
+     * @param path_a Reference file, eg. the golden trace.
+     * @param path_b File compared to it.
+     */
+    VCDDiffResult compare(const std::string& path_a, const std::string& path_b);
+
+    /// @brief Diagnostics of the first (0) or second (1) file read by the last compare().
+    [[nodiscard]] const VCDParseResult& GetParseResult(const size_t trace) const { return parse_results_.at(trace); }
+
+   private:
+    DiffOptions options_;
+    std::array<VCDParseResult, 2> parse_results_;
+};
+
+}  // namespace VCDP_NAMESPACE
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Config.hpp"
+#include "VCDFile.hpp"
+
+/**
+ * @file VCDExport.hpp
+ * @brief Export signals as a time-aligned table, for dataframe libraries.
+ */
+
+namespace VCDP_NAMESPACE {
+
+/// @brief File format of an exported table.
+enum class ExportFormat {
+    CSV,   //!< Comma separated values, a header line then one line per row
+    ARROW  //!< Arrow IPC file (Feather v2), eg. for pyarrow.ipc.open_file or pandas.read_feather
+};
+
+/// @brief What VCDExporter exports, and how.
+struct ExportOptions {
+    /**
+     * @brief Wildcard patterns selecting the signals, matched against the dotted
+     * hierarchical name (eg. "tb.uut.*") and the identifier code. Empty for every signal.
+     */
+    std::vector<std::string> signals;
+
+    ExportFormat format = ExportFormat::CSV;
+
+    /**
+     * @brief Dotted hierarchical name of a 1-bit clock: one row per rising edge, holding the
+     * values just before it. Empty for one row per time at which a selected signal changes.
+     */
+    std::string clock;
+
+    /// @brief Threads building the columns, 0 for one per hardware thread.
+    unsigned threads = 1;
+
+    /// @brief Bytes of column values built at once, bounds the memory used with many signals. Also the size of an Arrow record batch.
+    size_t batch_bytes = 64 * 1024 * 1024;
+};
+
+/// @brief Summary of an export.
+struct VCDExportResult {
+    bool success = true;
+    std::string error;     //!< Why the export failed
+    uint64_t columns = 0;  //!< Signal columns written, the time column excluded
+    uint64_t rows = 0;
+    uint64_t bytes = 0;  //!< Bytes written to the output file
+};
+
+/**
+ * @brief Write the value changes of a parsed file as a table: a "time" column, then one
+ * column per selected signal named after its dotted hierarchical name.
+ *
+ * Signals up to 64 bits wide are unsigned integers, null while their value holds other
+ * bits than 0 and 1 (an empty CSV field). Wider signals are written as text, as VCDChangeReader returns them.
+ * Real signals are doubles.
+ *
+ * The table is built a batch of timestamps at a time: each column is decoded straight
+ * from the value changes of its signal, columns in parallel, and CSV lines are formatted
+ * in parallel slices of rows.
+ */
+class VCDExporter {
+   public:
+    explicit VCDExporter(ExportOptions options = ExportOptions()) : options_(std::move(options)) {}
+
+    /**
+     * @brief Export a parsed file.
+     * @param file The file to export.
+     * @param output_path Destination file.
+     */
+    VCDExportResult write(const VCDFile& file, const std::string& output_path);
+
+   private:
+    ExportOptions options_;
+};
+
+}  // namespace VCDP_NAMESPACE
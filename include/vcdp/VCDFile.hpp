@@ -2,8 +2,14 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <utility>
 
 #include "Config.hpp"
+#include "VCDProfile.hpp"
 #include "VCDTypes.hpp"
 
 /// @brief Top level object to represent a single VCD file.
@@ -16,16 +22,25 @@ class VCDFile {
     VCDFile() = default;
 
     /**
-     * @brief Add a new scope object to the VCD file.
+     * @brief Add a new scope, child of the current one, and make it the current scope.
      * @param scope The VCDScope object to add to the VCD file.
      */
-    void addScope(std::unique_ptr<VCDScope> scope);
+    void addScope(VCDScope scope);
 
     /**
-     * @brief Add a new signal to the VCD file.
+     * @brief Declare a signal in the current scope. A signal whose identifier code is
+     * already known is only referenced again.
      * @param signal The VCDSignal object to add to the VCD file.
      */
-    void addSignal(std::unique_ptr<VCDSignal> signal);
+    void addSignal(VCDSignal signal);
+
+    /**
+     * @brief Lay the tables out once every declaration is read ($enddefinitions):
+     * scopes in breadth-first order so that children are contiguous, signals ordered
+     * by their first declaring scope and the per-scope signal lists packed in scope order.
+     * Indices obtained before the call are invalidated.
+     */
+    void endDefinitions();
 
     /**
      * @brief Add a new timestamp to the VCD file.
@@ -33,32 +48,215 @@ class VCDFile {
      */
     void addTimestamp(uint64_t timestamp);
 
+    /**
+     * @brief Record a value change of a signal at the last added timestamp.
+     * @param signal The signal whose value changed.
+     * @param value The new value as written in the VCD body (eg. "1", "x" or "1010").
+     */
+    void addValueChange(VCDSignal& signal, std::string_view value);
+
+    /**
+     * @brief Record a value change of a signal at a given time index. Changes of distinct
+     * signals may be recorded concurrently, once their timestamps are added.
+     * @param signal The signal whose value changed.
+     * @param time_index Index in getTimestamps() of the change, not lower than the previous one.
+     * @param value The new value as written in the VCD body.
+     */
+    void addValueChange(VCDSignal& signal, uint64_t time_index, std::string_view value);
+
+    /**
+     * @brief Build the summary pyramid (see VCDSummary) of every signal, declared or to be
+     * declared, from the value changes recorded from now on.
+     * @param resolution Bucket width of the finest level in time units, rounded down to a power of two.
+     */
+    void enableSummaries(uint64_t resolution);
+
+    /**
+     * @brief Summarize the value changes of a signal in `count` buckets of equal width
+     * cutting [begin, end), eg. one per pixel of a waveform view.
+     *
+     * With a summary pyramid (see enableSummaries) this costs O(count + log T) whatever the
+     * number of changes, bucket edges being rounded down to the resolution of the level used.
+     * Otherwise, and for real signals which have no pyramid, every change of the signal is read.
+     */
+    [[nodiscard]] std::vector<VCDSummarySample> summarize(const VCDSignal& signal, uint64_t begin, uint64_t end, size_t count) const;
+
+    /**
+     * @brief Sample signals at the edges of a clock, for cycle-based checks.
+     *
+     * The changes of the clock are read once to list its edges: a change to 1 (RISING) or to 0
+     * (FALLING) from another value, the first value of the clock excluded. Each signal is then
+     * read once alongside the edges, signals in parallel, and holds at each cycle its value just
+     * before the edge, as a flip-flop clocked by it would see it.
+     * @param clock The clock, its least significant bit for a vector.
+     * @param edge Edges starting a cycle.
+     * @param signals Sampled signals, of this file.
+     * @param threads Threads sampling the signals, 0 for one per hardware thread.
+     */
+    [[nodiscard]] VCDSampledSignals sampleOn(const VCDSignal& clock, VCDEdge edge, const std::vector<const VCDSignal*>& signals,
+                                             unsigned threads = 1) const;
+
+    /**
+     * @brief Decode every value change of a signal into arrays, eg. to hand them to NumPy.
+     * Values are packed as sampleOn packs them, real values kept as doubles.
+     */
+    [[nodiscard]] VCDDecodedSignal decode(const VCDSignal& signal) const;
+
+    /**
+     * @brief First change of a signal after a time. Only the changes of this signal near it are
+     * read, with its skip index (see VCDChangeReader::seek): O(log n) whatever the activity of the file.
+     * @param time Timestamp, changes at it excluded.
+     */
+    [[nodiscard]] std::optional<VCDFoundChange> nextChange(const VCDSignal& signal, uint64_t time) const;
+
+    /**
+     * @brief Last change of a signal before a time, with its skip index as nextChange.
+     * @param time Timestamp, changes at it excluded.
+     */
+    [[nodiscard]] std::optional<VCDFoundChange> prevChange(const VCDSignal& signal, uint64_t time) const;
+
+    /**
+     * @brief First edge of a signal after a time, as sampleOn finds them: a change of the least
+     * significant bit to 1 (RISING) or 0 (FALLING) from another value. The changes from the one
+     * holding at the time are read until the edge. Real signals have no edge.
+     * @param time Timestamp, edges at it excluded.
+     */
+    [[nodiscard]] std::optional<VCDFoundChange> nextEdge(const VCDSignal& signal, uint64_t time, VCDEdge edge) const;
+
+    /**
+     * @brief Virtual signal made of bit ranges of vectors, most significant first as in a Verilog
+     * concatenation, eg. {bus[63:32]} or {status[7], data[3:0]}.
+     *
+     * Its changes are derived from those of its signals the first time it is asked for, then kept
+     * in the file: later calls return the same signal, read as any other one (VCDChangeReader,
+     * decode, nextChange...). Each signal is decoded once, its two-state values a 64-bit word at
+     * a time, and the ranges are extracted with shifts and masks. Only the last change at a time
+     * index is kept, and only if it differs from the previous one: a change of the bus outside the
+     * ranges gives none. Before the first change of a signal its bits are X.
+     *
+     * Calls may run concurrently, deriving one signal at a time. A virtual signal is derived
+     * again, as a new signal, once its signals have new changes, eg. while following a file: the
+     * holders of the previous one keep reading it unchanged. On a frozen file no lock is taken:
+     * the signals derived before freeze() are returned, any other one is derived for each call.
+     * @param fields Signals of this file, not real ones, and bit ranges within their declared range.
+     * @return The virtual signal, to be released before the file is destroyed.
+     * @throw std::invalid_argument when a field is not valid.
+     */
+    [[nodiscard]] std::shared_ptr<const VCDSignal> slice(const std::vector<VCDSliceField>& fields) const;
+
+    /**
+     * @brief Virtual signal written as text: a signal with an optional bit range, eg. "tb.bus[63:32]",
+     * or a concatenation of them in braces, eg. "{tb.status[7], tb.data[3:0]}". Signals are named by
+     * their dotted hierarchical name, their identifier code or their reference.
+     * @throw std::invalid_argument for a syntax error, an unknown signal or a field not valid.
+     */
+    [[nodiscard]] std::shared_ptr<const VCDSignal> slice(std::string_view text) const;
+
+    /**
+     * @brief Rebuild the skip index of a signal whose changes were copied in rather than added
+     * with addValueChange, eg. loaded from an archive.
+     */
+    void indexChanges(VCDSignal& signal) const;
+
     /**
      * @brief Return the scope object in the VCD file with this name.
      * @param name The name of the scope to get and return.
      * @return A pointer to the scope, or nullptr if scope not found.
      */
-    [[nodiscard]] VCDScope* getScope(const std::string& name) const;
+    [[nodiscard]] const VCDScope* getScope(const std::string& name) const;
 
     /**
      * @brief Return the signal object in the VCD file with this symbol.
      * @param hash The symbol of the signal to get and return.
      * @return A pointer to the signal, or nullptr if signal not found.
      */
-    [[nodiscard]] VCDSignal* getSignal(const std::string& hash) const;
+    [[nodiscard]] const VCDSignal* getSignal(const std::string& hash) const;
+
+    /// @brief getSignal() of a file being filled, for addValueChange.
+    [[nodiscard]] VCDSignal* getSignal(const std::string& hash);
+
+    /**
+     * @brief Look up a signal by identifier code without building a temporary string.
+     * @param hash The symbol of the signal.
+     * @return A pointer to the signal, or nullptr if signal not found.
+     */
+    [[nodiscard]] const VCDSignal* findSignal(std::string_view hash) const;
+
+    /// @brief findSignal() of a file being filled, for addValueChange.
+    [[nodiscard]] VCDSignal* findSignal(std::string_view hash);
 
     [[nodiscard]] uint64_t getTimestamp(size_t index) const;
     [[nodiscard]] const std::vector<uint64_t>& getTimestamps() const;
 
-    /// @brief Get a vector of all scopes present in the file.
-    [[nodiscard]] const std::vector<std::unique_ptr<VCDScope>>& getScopes() const { return scopes_; }
+    /// @brief Get a vector of all scopes present in the file, top scopes first.
+    [[nodiscard]] const std::vector<VCDScope>& getScopes() const { return scopes_; }
 
     /// @brief Return a flattened vector of all signals in the file.
-    [[nodiscard]] const std::map<std::string, std::unique_ptr<VCDSignal>>& getSignals() const { return signals_; }
+    [[nodiscard]] const std::vector<VCDSignal>& getSignals() const { return signals_; }
+
+    /// @brief Scopes without parent.
+    [[nodiscard]] VCDSpan<const VCDScope> getTopScopes() const { return {scopes_.data(), scopes_.data() + top_scope_count_}; }
+
+    /// @brief Direct child scopes of a scope.
+    [[nodiscard]] VCDSpan<const VCDScope> getScopeChildren(const VCDScope& scope) const {
+        return {scopes_.data() + scope.children_begin, scopes_.data() + scope.children_end};
+    }
+
+    /// @brief Indices in getSignals() of the signals declared in a scope, in declaration order.
+    [[nodiscard]] VCDSpan<const VCDIndex> getScopeSignals(const VCDScope& scope) const {
+        return {scope_signals_.data() + scope.signals_begin, scope_signals_.data() + scope.signals_end};
+    }
+
+    /// @brief Index in getScopes() of a scope of this file.
+    [[nodiscard]] VCDIndex indexOf(const VCDScope& scope) const { return static_cast<VCDIndex>(&scope - scopes_.data()); }
+
+    /// @brief Index in getSignals() of a signal of this file.
+    [[nodiscard]] VCDIndex indexOf(const VCDSignal& signal) const { return static_cast<VCDIndex>(&signal - signals_.data()); }
 
     /// @brief Check if hash exists in value map
     [[nodiscard]] bool exists(const std::string& hash) const;
 
+    /// @brief Bytes currently used by the file, by structure.
+    [[nodiscard]] VCDMemoryStats memoryUsage() const;
+
+    /**
+     * @brief Bound the memory of the value changes by moving their blocks to a temporary file.
+     *
+     * When the value change blocks use more than `limit` bytes, the blocks of the signals
+     * holding the most of them are spilled (see VListManager::spill) until three quarters of
+     * the limit is left. Blocks smaller than VLIST_MIN_SPILL_SIZE stay in memory. Readers page
+     * spilled blocks back in transparently, but a VCDChangeReader created before a spill must
+     * not be used after it.
+     * @param limit Bytes of value change blocks to keep in memory.
+     * @return Bytes released.
+     */
+    uint64_t limitMemory(uint64_t limit);
+
+    /**
+     * @brief Make the file read-only, eg. once parsed and before serving queries from many threads.
+     *
+     * Pending declarations are laid out, nothing is moved. Afterwards every const member
+     * can be called concurrently without locking: readers share nothing but the immutable
+     * tables, each VCDChangeReader being its own cursor. Members that modify the file throw
+     * std::logic_error. A frozen file cannot be followed by VCDParser::poll.
+     */
+    void freeze();
+
+    /// @brief The file is read-only, see freeze().
+    [[nodiscard]] bool frozen() const { return frozen_; }
+
+    /**
+     * @brief Lock to hold while querying a file that a VCDParser is still appending to
+     * (see VCDParser::poll). Timestamps and value changes do not change while it is held.
+     * The lock of a frozen file is not taken, readers do not contend on it.
+     */
+    [[nodiscard]] std::shared_lock<std::shared_mutex> readLock() const {
+        return frozen_ ? std::shared_lock(mutex_, std::defer_lock) : std::shared_lock(mutex_);
+    }
+
+    /// @brief Lock held by the parser while it appends timestamps and value changes.
+    [[nodiscard]] std::unique_lock<std::shared_mutex> writeLock() const { return std::unique_lock(mutex_); }
+
     /// @brief Timescale of the VCD file.
     VCDTimeUnit time_units = VCDTimeUnit::TIME_UNKNOWN;
 
@@ -71,13 +269,316 @@ class VCDFile {
     /// @brief Version string of the simulator which generated the VCD.
     std::string version;
 
-    /// @brief Current scope nodes of the VCD signals -> To manage parents & children
-    VCDScope* current_scope = nullptr;
+    /// @brief Current scope of the declarations, VCD_NO_INDEX outside any scope
+    VCDIndex current_scope = VCD_NO_INDEX;
 
    private:
-    std::map<std::string, std::unique_ptr<VCDSignal>> signals_;
-    std::vector<std::unique_ptr<VCDScope>> scopes_;
+    void reopenDefinitions();
+    void checkWritable() const;
+    void indexSignal(VCDIndex index);
+    void rebuildSignalIndex();
+
+    /// @brief A virtual signal of slice(), and the change counts of its signals when it was derived.
+    struct Slice {
+        std::vector<VCDSliceField> fields;
+        std::vector<uint64_t> change_counts;
+        VCDSignal signal;
+    };
+
+    /// @brief addValueChange without the frozen check, for the virtual signals.
+    void storeValueChange(VCDSignal& signal, uint64_t time_index, std::string_view value) const;
+    /// @brief Some signal of the slice has changes it was derived without.
+    static bool stale(const Slice& slice);
+    /// @brief Derive a virtual signal, not cached.
+    [[nodiscard]] std::shared_ptr<const Slice> newSlice(const std::vector<VCDSliceField>& fields, const std::string& reference, uint32_t width) const;
+    void deriveSlice(Slice& slice) const;
+
+    mutable VListPool pool_;                 //!< Blocks of the value changes, outlives the signals. Mutable for slice()
+    std::unique_ptr<VListSpillFile> spill_;  //!< Created on the first spill, outlives the signals referring to it
+    std::vector<VCDSignal> signals_;
+    std::vector<VCDScope> scopes_;
+    std::vector<VCDIndex> scope_signals_;  //!< Signal indices, packed scope by scope
+    VCDIndex top_scope_count_ = 0;
+
+    /// @brief (scope, signal) pairs declared since the last endDefinitions()
+    std::vector<std::pair<VCDIndex, VCDIndex>> declarations_;
+    bool laid_out_ = false;
+
+    /// @brief Open addressing table of signal indices hashed by identifier code
+    std::vector<VCDIndex> signal_slots_;
+
     std::vector<uint64_t> times_;
+    uint64_t summary_resolution_ = 0;  //!< 0 while summaries are disabled
+    bool frozen_ = false;
+
+    mutable std::shared_mutex mutex_;
+    mutable std::mutex slices_mutex_;
+    mutable std::map<std::string, std::shared_ptr<const Slice>> slices_;  //!< Virtual signals by fields, see slice()
+};
+
+/// @brief Forward decoder of the value changes stored for a signal.
+class VCDChangeReader {
+   public:
+    explicit VCDChangeReader(const VCDSignal& signal) : signal_(signal), reader_(signal.data) {}
+
+    /**
+     * @brief Make the first change at or after a time index the current one, as next() would.
+     * The reader resumes at the last entry of the skip index before it: O(log n), then at most
+     * VCD_SKIP_INTERVAL changes decoded. next() carries on with the following changes.
+     * @return false if the signal does not change from the time index on.
+     */
+    bool seek(uint64_t time_index);
+
+    /**
+     * @brief Make the last change at or before a time index the current one: the value the
+     * signal holds then. Costs as seek().
+     * @return false if the signal does not change until the time index, next() then reads its first change.
+     */
+    bool seekBefore(uint64_t time_index);
+
+    /// @brief Decoder state before the next change, as an entry of the skip index without its time_index.
+    [[nodiscard]] VCDSkipEntry state() const { return {0, time_index_, reader_.position(), real_bits_}; }
+
+    /**
+     * @brief Resume decoding at an entry of the skip index, or at the first change for an empty
+     * entry: its change is the next one. Within the block being read nothing is read again.
+     */
+    void resume(const VCDSkipEntry& entry);
+
+    /// @brief Hint that decoding resumes at an entry soon: the bytes there start being read if spilled to disk.
+    void prefetch(const VCDSkipEntry& entry) const {
+        if (!reader_.holds(entry.position)) VListReader::prefetch(signal_.data, entry.position);
+    }
+
+    /**
+     * @brief Decode the next change.
+     * @return false once all changes have been read.
+     */
+    bool next();
+
+    /**
+     * @brief Decode the next change as an integer, without building its text. value() is not updated.
+     * @param bits Receives the 64 least significant bits of the value, the IEEE 754 bits of a real.
+     * @param known Set to false when a bit of the value is neither 0 nor 1.
+     * @return false once all changes have been read.
+     */
+    bool next(uint64_t& bits, bool& known);
+
+    /**
+     * @brief Decode the next change of a non-real signal into 64-bit words, least significant first.
+     * A value with other bits than 0 and 1 leaves the words at 0, known false, and its text in value().
+     * @param words Receives the count least significant words of the value.
+     * @return false once all changes have been read.
+     */
+    bool next(uint64_t* words, size_t count, bool& known);
+
+    /// @brief Index in VCDFile::getTimestamps() of the current change.
+    [[nodiscard]] uint64_t timeIndex() const { return time_index_; }
+
+    /// @brief Value of the current change, left-extended to the signal size. Reals in their shortest round-trip form.
+    [[nodiscard]] const std::string& value() const { return value_; }
+
+    /// @brief Value of the current change of a real signal.
+    [[nodiscard]] double real() const;
+
+   private:
+    void nextReal();
+
+    /// @brief Decode the bits of a vector value into value().
+    void nextText(size_t bit_count, bool four_state);
+
+    const VCDSignal& signal_;
+    VListReader reader_;
+    uint64_t time_index_ = 0;
+    uint64_t real_bits_ = 0;  //!< IEEE 754 bits of the current value of a real signal
+    std::string value_;
+};
+
+/**
+ * @brief Cursor over the value changes of a signal that moves both ways, eg. to walk back from a
+ * failure.
+ *
+ * Changes are decoded forward a window of VCD_SKIP_INTERVAL at a time, from the entry of the skip
+ * index starting it, and kept until the cursor leaves the window: a step back costs as a step
+ * forward, each window being decoded once per pass. The window left last is kept too, so that
+ * turning around at the edge of a window decodes nothing, and walking back prefetches the bytes of
+ * the previous window when they are spilled to disk.
+ */
+class VCDChangeCursor {
+   public:
+    /// @brief Cursor before the first change of a signal.
+    explicit VCDChangeCursor(const VCDSignal& signal) : signal_(signal), reader_(signal) {}
+
+    /**
+     * @brief Move to the following change.
+     * @return false, after the last change, once all have been read.
+     */
+    bool next();
+
+    /**
+     * @brief Move to the preceding change.
+     * @return false, before the first change, once all have been read.
+     */
+    bool prev();
+
+    /**
+     * @brief Move to the first change at or after a time index, in O(log n) with the skip index.
+     * @return false, after the last change, if there is none.
+     */
+    bool seek(uint64_t time_index);
+
+    /**
+     * @brief Move to the last change at or before a time index: the value the signal holds then.
+     * @return false, before the first change, if there is none.
+     */
+    bool seekBefore(uint64_t time_index);
+
+    /// @brief Move before the first change, for next() to read them from the start.
+    void toStart() { position_ = 0; }
+
+    /// @brief Move after the last change, for prev() to read them backward from the end.
+    void toEnd() { position_ = signal_.change_count + 1; }
+
+    /// @brief The cursor is on a change, neither before the first one nor after the last one.
+    [[nodiscard]] bool valid() const { return position_ > 0 && position_ <= signal_.change_count; }
+
+    /// @brief Number of the current change, 0 for the first one.
+    [[nodiscard]] uint64_t index() const { return position_ - 1; }
+
+    /// @brief Index in VCDFile::getTimestamps() of the current change.
+    [[nodiscard]] uint64_t timeIndex() const { return windows_[current_].time_indices[index() - windows_[current_].first]; }
+
+    /// @brief Value of the current change, as VCDChangeReader::value() returns it.
+    [[nodiscard]] const std::string& value() const { return windows_[current_].values[index() - windows_[current_].first]; }
+
+   private:
+    /// @brief Changes [first, first + VCD_SKIP_INTERVAL) decoded.
+    struct Window {
+        uint64_t first = UINT64_MAX;
+        std::vector<uint64_t> time_indices;
+        std::vector<std::string> values;
+    };
+
+    /// @brief Make the window of a change the current one, decoding it unless kept.
+    void load(uint64_t change, bool backward);
+
+    /// @brief Entry of the skip index starting a window, an empty one for the first window.
+    [[nodiscard]] VCDSkipEntry entry(uint64_t window) const { return window == 0 ? VCDSkipEntry{} : signal_.skip[window - 1]; }
+
+    const VCDSignal& signal_;
+    VCDChangeReader reader_;
+    Window windows_[2];
+    size_t current_ = 0;     //!< Window of the current change
+    uint64_t position_ = 0;  //!< Current change + 1: 0 before the first one, change_count + 1 after the last one
+};
+
+/**
+ * @brief Cursor over the time steps at which any of a set of signals changes, that moves both
+ * ways. At each step every signal holds the value of its last change at or before it.
+ */
+class VCDTimeCursor {
+   public:
+    /// @brief Cursor before the first step.
+    VCDTimeCursor(const VCDFile& file, const std::vector<const VCDSignal*>& signals);
+
+    /**
+     * @brief Move to the following step.
+     * @return false, nothing moved, at the last step.
+     */
+    bool next();
+
+    /**
+     * @brief Move to the preceding step.
+     * @return false, nothing moved, at the first step.
+     */
+    bool prev();
+
+    /**
+     * @brief Move to the first step at or after a time.
+     * @return false, at the last step, if there is none.
+     */
+    bool seek(uint64_t time);
+
+    /**
+     * @brief Move to the last step at or before a time, eg. the time a check failed.
+     * @return false, before the first step, if there is none.
+     */
+    bool seekBefore(uint64_t time);
+
+    /// @brief Index in VCDFile::getTimestamps() of the current step.
+    [[nodiscard]] uint64_t timeIndex() const { return time_index_; }
+
+    /// @brief Timestamp of the current step.
+    [[nodiscard]] uint64_t time() const { return file_.getTimestamp(time_index_); }
+
+    /// @brief Value of a signal, by its position in the constructor list, empty before its first change.
+    [[nodiscard]] std::string_view value(const size_t signal) const {
+        return cursors_[signal].valid() ? std::string_view(cursors_[signal].value()) : std::string_view();
+    }
+
+    /// @brief A signal, by its position in the constructor list, changes at the current step.
+    [[nodiscard]] bool changed(const size_t signal) const {
+        return at_step_ && cursors_[signal].valid() && cursors_[signal].timeIndex() == time_index_;
+    }
+
+   private:
+    const VCDFile& file_;
+    std::vector<VCDChangeCursor> cursors_;  //!< Each one on the last change of its signal at or before the current step
+    uint64_t first_ = UINT64_MAX;           //!< Time index of the first step
+    uint64_t time_index_ = 0;
+    bool at_step_ = false;                  //!< false before the first step
+};
+
+/// @brief A value change, as iterated by VCDChanges.
+struct VCDChange {
+    uint64_t time_index;     //!< Index in VCDFile::getTimestamps()
+    uint64_t time;           //!< Timestamp of the change
+    std::string_view value;  //!< As VCDChangeReader::value() returns it, valid until the iterator moves
+};
+
+/**
+ * @brief Read-only range over the value changes of a signal, for range-based for loops:
+ * `for (const VCDChange& change : VCDChanges(file, signal))`. Each iteration decodes with its
+ * own VCDChangeReader, so that any number of them may run concurrently on a frozen file.
+ */
+class VCDChanges {
+   public:
+    /// @brief Input iterator, moved rather than copied as it owns its cursor.
+    class Iterator {
+       public:
+        Iterator() = default;
+        Iterator(const VCDFile& file, const VCDSignal& signal) : file_(&file), reader_(std::make_unique<VCDChangeReader>(signal)) { ++*this; }
+
+        [[nodiscard]] const VCDChange& operator*() const { return change_; }
+        [[nodiscard]] const VCDChange* operator->() const { return &change_; }
+
+        Iterator& operator++() {
+            if (!reader_->next()) {
+                reader_.reset();
+                return *this;
+            }
+            change_ = {reader_->timeIndex(), file_->getTimestamp(reader_->timeIndex()), reader_->value()};
+            return *this;
+        }
+
+        /// @brief Only tells an iterator at the end from one that is not.
+        [[nodiscard]] bool operator==(const Iterator& other) const { return !reader_ == !other.reader_; }
+        [[nodiscard]] bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+       private:
+        const VCDFile* file_ = nullptr;
+        std::unique_ptr<VCDChangeReader> reader_;  //!< nullptr at the end
+        VCDChange change_{};
+    };
+
+    VCDChanges(const VCDFile& file, const VCDSignal& signal) : file_(file), signal_(signal) {}
+
+    [[nodiscard]] Iterator begin() const { return {file_, signal_}; }
+    [[nodiscard]] static Iterator end() { return {}; }
+
+   private:
+    const VCDFile& file_;
+    const VCDSignal& signal_;
 };
 
 }  // namespace VCDP_NAMESPACE
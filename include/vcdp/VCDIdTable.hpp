@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "Config.hpp"
+#include "VCDFile.hpp"
+
+/**
+ * @file VCDIdTable.hpp
+ * @brief Direct lookup of the signals of a file whose identifier codes all have the same short size.
+ */
+
+namespace VCDP_NAMESPACE {
+
+/**
+ * @brief Signals of a file by identifier code of 1 or 2 printable characters, one slot per possible code.
+ *
+ * Built once per file, after its header, and only read by the body decoders, so that the decoders of
+ * parallel slices share it.
+ */
+class VCDIdTable {
+   public:
+    VCDIdTable() = default;
+
+    /**
+     * @param file File whose header declares the signals, the table points into it.
+     * @param id_size Size of the identifier codes, 1 or 2. Codes of another size are left out.
+     */
+    VCDIdTable(VCDFile& file, const unsigned id_size) : id_size_(id_size), signals_(tableSize(id_size), nullptr) {
+        for (const auto& signal : file.getSignals()) {
+            if (const size_t slot = idSlot(signal.hash, id_size); slot < signals_.size()) signals_[slot] = file.findSignal(signal.hash);
+        }
+    }
+
+    /// @brief Size of the identifier codes of the table, 0 for an empty table.
+    [[nodiscard]] unsigned idSize() const { return id_size_; }
+
+    /**
+     * @brief Signal of an identifier code.
+     * @tparam IdSize Size of the codes of the table, see idSize().
+     * @return nullptr for an unknown code or one of another size.
+     */
+    template <unsigned IdSize>
+    [[nodiscard]] VCDSignal* find(const std::string_view hash) const {
+        const size_t slot = idSlot(hash, IdSize);
+        return slot < signals_.size() ? signals_[slot] : nullptr;
+    }
+
+   private:
+    /// @brief Identifier codes are printable ASCII characters, from '!' to '~'.
+    static constexpr size_t ID_CHARS = 94;
+
+    static constexpr size_t tableSize(const unsigned id_size) { return id_size == 1 ? ID_CHARS : id_size == 2 ? ID_CHARS * ID_CHARS : 0; }
+
+    /// @brief Slot of an identifier code in signals_, tableSize(id_size) for a code of another size.
+    static size_t idSlot(const std::string_view hash, const unsigned id_size) {
+        if (hash.size() != id_size) return tableSize(id_size);
+        size_t slot = 0;
+        for (const char c : hash) {
+            const auto digit = static_cast<size_t>(static_cast<unsigned char>(c) - '!');
+            if (digit >= ID_CHARS) return tableSize(id_size);
+            slot = slot * ID_CHARS + digit;
+        }
+        return slot;
+    }
+
+    unsigned id_size_ = 0;
+    std::vector<VCDSignal*> signals_;  //!< Signals by slot of their identifier code
+};
+
+}  // namespace VCDP_NAMESPACE
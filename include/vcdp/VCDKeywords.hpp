@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "Config.hpp"
+#include "VCDTypes.hpp"
+
+/**
+ * @file VCDKeywords.hpp
+ * @brief Compile-time tables between the keywords of the VCD header and the enums they stand for.
+ */
+
+namespace VCDP_NAMESPACE {
+
+/// @brief A keyword of the VCD header and the enum value it stands for.
+template <typename Enum>
+struct VCDKeyword {
+    std::string_view name;
+    Enum value;
+};
+
+/**
+ * @brief Keyword to enum table with a perfect hash, built at compile time.
+ *
+ * The hash mixes the first, middle and last characters of a word with its length. The constructor searches a seed for
+ * which every keyword lands in its own slot, so a lookup costs one hash and at most one comparison.
+ */
+template <typename Enum, size_t N>
+class VCDKeywordMap {
+   public:
+    constexpr VCDKeywordMap(const std::array<VCDKeyword<Enum>, N>& keywords, const Enum unknown) : keywords_(keywords), unknown_(unknown) {
+        for (uint32_t seed = 1; seed < 4096; seed++) {
+            if (place(seed)) {
+                seed_ = seed;
+                return;
+            }
+        }
+    }
+
+    /// @brief False if no seed separates the keywords, checked by a static_assert next to each table.
+    [[nodiscard]] constexpr bool valid() const { return seed_ != 0; }
+
+    /// @brief Enum value of a keyword, the unknown value for any other word.
+    [[nodiscard]] constexpr Enum find(const std::string_view word) const {
+        if (word.empty()) return unknown_;
+        const uint8_t slot = slots_[hash(word, seed_)];
+        return slot != 0 && keywords_[slot - 1].name == word ? keywords_[slot - 1].value : unknown_;
+    }
+
+    /// @brief Keyword of an enum value, empty if the value has none.
+    [[nodiscard]] constexpr std::string_view name(const Enum value) const {
+        for (const auto& keyword : keywords_) {
+            if (keyword.value == value) return keyword.name;
+        }
+        return {};
+    }
+
+    [[nodiscard]] constexpr const std::array<VCDKeyword<Enum>, N>& keywords() const { return keywords_; }
+
+   private:
+    static constexpr unsigned slotBits() {
+        unsigned bits = 3;
+        while ((size_t{1} << bits) < 2 * N) bits++;
+        return bits;
+    }
+    static constexpr size_t SLOTS = size_t{1} << slotBits();
+
+    static constexpr uint32_t hash(const std::string_view word, const uint32_t seed) {
+        uint32_t h = seed;
+        for (const size_t i : {size_t{0}, word.size() / 2, word.size() - 1}) h = (h ^ static_cast<uint8_t>(word[i])) * 0x01000193u;
+        h = (h ^ static_cast<uint32_t>(word.size())) * 0x9E3779B1u;
+        return h >> (32 - slotBits());
+    }
+
+    constexpr bool place(const uint32_t seed) {
+        slots_ = {};
+        for (size_t i = 0; i < N; i++) {
+            uint8_t& slot = slots_[hash(keywords_[i].name, seed)];
+            if (slot != 0) return false;
+            slot = static_cast<uint8_t>(i + 1);
+        }
+        return true;
+    }
+
+    std::array<VCDKeyword<Enum>, N> keywords_;
+    Enum unknown_;
+    uint32_t seed_ = 0;
+    std::array<uint8_t, SLOTS> slots_{};  //!< Index + 1 of the keyword hashed to each slot, 0 for none
+};
+
+// clang-format off
+/// @brief Variable types of a $var declaration.
+inline constexpr VCDKeywordMap<VCDVarType, 18> VAR_TYPE_KEYWORDS({{
+    {"event",     VCDVarType::VCD_VAR_EVENT},
+    {"integer",   VCDVarType::VCD_VAR_INTEGER},
+    {"parameter", VCDVarType::VCD_VAR_PARAMETER},
+    {"real",      VCDVarType::VCD_VAR_REAL},
+    {"realtime",  VCDVarType::VCD_VAR_REALTIME},
+    {"reg",       VCDVarType::VCD_VAR_REG},
+    {"supply0",   VCDVarType::VCD_VAR_SUPPLY0},
+    {"supply1",   VCDVarType::VCD_VAR_SUPPLY1},
+    {"time",      VCDVarType::VCD_VAR_TIME},
+    {"tri",       VCDVarType::VCD_VAR_TRI},
+    {"triand",    VCDVarType::VCD_VAR_TRIAND},
+    {"trior",     VCDVarType::VCD_VAR_TRIOR},
+    {"trireg",    VCDVarType::VCD_VAR_TRIREG},
+    {"tri0",      VCDVarType::VCD_VAR_TRI0},
+    {"tri1",      VCDVarType::VCD_VAR_TRI1},
+    {"wand",      VCDVarType::VCD_VAR_WAND},
+    {"wire",      VCDVarType::VCD_VAR_WIRE},
+    {"wor",       VCDVarType::VCD_VAR_WOR},
+}}, VCDVarType::VCD_VAR_UNKNOWN);
+
+/// @brief Scope types of a $scope declaration.
+inline constexpr VCDKeywordMap<VCDScopeType, 5> SCOPE_TYPE_KEYWORDS({{
+    {"begin",    VCDScopeType::VCD_SCOPE_BEGIN},
+    {"fork",     VCDScopeType::VCD_SCOPE_FORK},
+    {"function", VCDScopeType::VCD_SCOPE_FUNCTION},
+    {"module",   VCDScopeType::VCD_SCOPE_MODULE},
+    {"task",     VCDScopeType::VCD_SCOPE_TASK},
+}}, VCDScopeType::VCD_SCOPE_UNKNOWN);
+
+/// @brief Units of a $timescale declaration.
+inline constexpr VCDKeywordMap<VCDTimeUnit, 6> TIME_UNIT_KEYWORDS({{
+    {"s",  VCDTimeUnit::TIME_S},
+    {"ms", VCDTimeUnit::TIME_MS},
+    {"us", VCDTimeUnit::TIME_US},
+    {"ns", VCDTimeUnit::TIME_NS},
+    {"ps", VCDTimeUnit::TIME_PS},
+    {"fs", VCDTimeUnit::TIME_FS},
+}}, VCDTimeUnit::TIME_UNKNOWN);
+// clang-format on
+
+static_assert(VAR_TYPE_KEYWORDS.valid() && SCOPE_TYPE_KEYWORDS.valid() && TIME_UNIT_KEYWORDS.valid(), "No perfect hash seed found");
+static_assert(VAR_TYPE_KEYWORDS.find("trireg") == VCDVarType::VCD_VAR_TRIREG && VAR_TYPE_KEYWORDS.find("tri2") == VCDVarType::VCD_VAR_UNKNOWN);
+
+}  // namespace VCDP_NAMESPACE
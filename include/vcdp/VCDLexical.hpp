@@ -213,6 +213,23 @@ struct declaration_section : pegtl::seq<
     whitespaces
 > {};
 
+// Parts of the declaration section parsed apart, see VCDParser::parseHeader
+struct var_line : pegtl::seq<
+    whitespaces,
+    command_var,
+    pegtl::must<mandatory_space>
+> {};
+struct var_run : pegtl::seq<
+    pegtl::star<var_line>,
+    whitespaces,
+    pegtl::must<eof>
+> {};
+struct declaration_run : pegtl::seq<
+    pegtl::star<pegtl::not_at<whitespaces, eof>, declaration_line>,
+    whitespaces,
+    eof
+> {};
+
 // Entry point
 struct grammar : pegtl::must<declaration_section> {};
 
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Config.hpp"
+#include "VCDFile.hpp"
+#include "VCDParser.hpp"
+#include "VCDWriter.hpp"
+
+/**
+ * @file VCDMerge.hpp
+ * @brief Combine VCD files split by time (dump rollover) or by design partition into one timeline.
+ */
+
+namespace VCDP_NAMESPACE {
+
+/// @brief How VCDMerger combines files.
+struct MergeOptions {
+    /**
+     * @brief Name of a scope wrapping the top scopes of every file. Empty to merge the files
+     * at their top level, top scopes of the same name becoming one.
+     */
+    std::string root;
+
+    /// @brief Threads parsing the files, 0 for one per hardware thread.
+    unsigned threads = 1;
+
+    /// @brief Bytes of each file decoded at once by write(). Bounds the memory used together with the number of files.
+    size_t chunk_size = 1024 * 1024;
+};
+
+/// @brief Summary of a merge.
+struct VCDMergeResult {
+    bool success = true;
+    std::string error;        //!< Why the merge failed
+    uint64_t signals = 0;     //!< Signals of the merged file
+    uint64_t shared = 0;      //!< Declarations found in an earlier file under the same path, merged into its signal
+    uint64_t remapped = 0;    //!< Signals given a new identifier code, theirs being used by an earlier file
+    uint64_t timestamps = 0;  //!< Distinct times of the merged timeline, by merge()
+    uint64_t changes = 0;     //!< Value changes stored or written
+    uint64_t bytes = 0;       //!< Bytes written by write()
+};
+
+/**
+ * @brief Merge VCD files into one timeline.
+ *
+ * Scopes are matched by dotted path, and signals by dotted path and bit range: a signal found
+ * in several files (eg. in each part of a rolled over dump) is a single signal of the merged
+ * file, its changes taken from all of them in time order. Changes at the same time are kept
+ * in file order, so that the value of the last file stands.
+ * Identifier codes are kept, except when an earlier file already uses them for another signal:
+ * a new code is then given. The codes of each file are remapped through a table by signal index.
+ *
+ * Files of different timescales are merged at the finest one, their times scaled up.
+ */
+class VCDMerger {
+   public:
+    explicit VCDMerger(MergeOptions options = MergeOptions()) : options_(std::move(options)) {}
+
+    /**
+     * @brief Parse the files in parallel and merge them into a VCDFile. The time tables are
+     * merged k-way, then the changes of the signals, signals in parallel.
+     * @param paths Files to merge.
+     * @param merged Receives the merged file, empty before the call.
+     */
+    VCDMergeResult merge(const std::vector<std::string>& paths, VCDFile* merged);
+
+    /**
+     * @brief Write the merge of the files to a VCD file without storing their value changes:
+     * the bodies are decoded a chunk at a time, in parallel, and the changes older than the
+     * time all of them reached are written in time order.
+     * @param paths Files to merge.
+     * @param output_path Destination file.
+     * @param write_options Selection, time window and compression of the output.
+     */
+    VCDMergeResult write(const std::vector<std::string>& paths, const std::string& output_path, const WriteOptions& write_options = WriteOptions());
+
+    /// @brief Diagnostics of each file read by the last merge() or write().
+    [[nodiscard]] const std::vector<VCDParseResult>& GetParseResults() const { return parse_results_; }
+
+   private:
+    MergeOptions options_;
+    std::vector<VCDParseResult> parse_results_;
+};
+
+}  // namespace VCDP_NAMESPACE
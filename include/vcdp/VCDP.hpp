@@ -2,6 +2,15 @@
 
 #include <memory>
 
+#include "VCDArchive.hpp"
+#include "VCDDiagnostics.hpp"
+#include "VCDDiff.hpp"
+#include "VCDExport.hpp"
 #include "VCDFile.hpp"
+#include "VCDKeywords.hpp"
+#include "VCDMerge.hpp"
 #include "VCDParser.hpp"
+#include "VCDProfile.hpp"
+#include "VCDSearch.hpp"
+#include "VCDWriter.hpp"
 #include "Utils.hpp"
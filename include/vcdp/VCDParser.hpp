@@ -1,53 +1,179 @@
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <string_view>
 
 #include "Config.hpp"
+#include "VCDDiagnostics.hpp"
 #include "VCDFile.hpp"
+#include "VCDIdTable.hpp"
+#include "VCDProfile.hpp"
 
 namespace VCDP_NAMESPACE {
 
 struct VCDParseResult {
     bool success = true;
-    std::vector<std::string> errors;
-    std::vector<std::string> warnings;
+    VCDDiagnosticList errors;
+    VCDDiagnosticList warnings;
+    VCDProfile profile;  //!< Filled when ParseOptions::profile is set
 
     [[nodiscard]] bool HasErrors() const { return !errors.empty(); }
     [[nodiscard]] bool HasWarnings() const { return !warnings.empty(); }
 
+    void AddError(VCDDiagCode code, std::string_view detail, uint64_t offset = 0, uint64_t line = 0) {
+        success = false;
+        errors.Add(code, VCDSeverity::VCD_ERROR, offset, line, detail);
+    }
+
+    void AddWarning(VCDDiagCode code, std::string_view detail, uint64_t offset = 0, uint64_t line = 0) {
+        warnings.Add(code, VCDSeverity::VCD_WARNING, offset, line, detail);
+    }
+
+    /// @brief Limit the number of errors and of warnings kept with their details.
+    void SetRetainLimit(size_t limit) {
+        errors.SetLimit(limit);
+        warnings.SetLimit(limit);
+    }
+
     void PrintErrors(std::ostream& os = std::cerr) const {
         for (const auto& error : errors) {
             os << "Error: " << error << std::endl;
         }
+        if (errors.Dropped() > 0) {
+            os << "Error: " << errors.Dropped() << " more error(s) not shown" << std::endl;
+        }
     }
 
     void PrintWarnings(std::ostream& os = std::cout) const {
         for (const auto& warning : warnings) {
             os << "Warning: " << warning << std::endl;
         }
+        if (warnings.Dropped() > 0) {
+            os << "Warning: " << warnings.Dropped() << " more warning(s) not shown" << std::endl;
+        }
+    }
+
+    /**
+     * @brief Append the diagnostics of another result, eg. one collected by a worker thread.
+     * @param other The result to append.
+     * @param line_base Added to the line numbers of the appended diagnostics.
+     */
+    void Merge(const VCDParseResult& other, const uint64_t line_base = 0) {
+        success = success && other.success;
+        errors.Append(other.errors, line_base);
+        warnings.Append(other.warnings, line_base);
     }
 
     void Clear() {
         success = true;
         errors.clear();
         warnings.clear();
+        profile.Clear();
     }
 };
 
+/// @brief Tuning of VCDParser::parse.
+struct ParseOptions {
+    /// @brief Threads parsing long runs of $var declarations and decoding the value changes, 0 for one per hardware thread.
+    unsigned threads = 1;
+
+    /// @brief Bytes of value changes handed to each thread at once when threads > 1.
+    size_t chunk_size = 4 * 1024 * 1024;
+
+    /// @brief The file is still being written: keep an unterminated last line for VCDParser::poll.
+    bool follow = false;
+
+    /// @brief Measure every phase of the parse into VCDParseResult::profile.
+    bool profile = false;
+
+    /**
+     * @brief Build the summary pyramid of every signal with this finest resolution in time
+     * units (see VCDFile::enableSummaries and VCDFile::summarize), 0 to build none.
+     */
+    uint64_t summary_resolution = 0;
+
+    /**
+     * @brief Decode the value changes with a decoder specialised for the simulator named by
+     * $version (see withDialect), false to always use the generic one.
+     */
+    bool detect_dialect = true;
+
+    /**
+     * @brief Bytes of value changes to keep in memory, 0 for no bound. Beyond, cold blocks are
+     * moved to a temporary file as the body is decoded (see VCDFile::limitMemory) and read back
+     * from it when the changes are read. Blocks of a few kilobytes stay in memory, the bound
+     * is not kept below them.
+     */
+    uint64_t memory_limit = 0;
+
+    /**
+     * @brief Freeze the file once parsed (see VCDFile::freeze), so that it is queried from many
+     * threads without locking. Ignored with follow, a frozen file cannot grow.
+     */
+    bool freeze = false;
+};
+
 class VCDParser {
    public:
     void parseHeader(std::ifstream& stream, VCDFile* file, const std::string& file_path);
     void parseValueChange(std::ifstream& stream, VCDFile* file, const std::string& file_path);
-    void parse(const std::string& file_path, VCDFile* file);
+    void parse(const std::string& file_path, VCDFile* file, const ParseOptions& options = ParseOptions());
+
+    /**
+     * @brief Append what was written to the last parsed file since the previous call.
+     *
+     * Decoding resumes at the line cut at the end of the previous read, the existing
+     * timestamps and value changes are kept. The header is parsed again while it is
+     * incomplete. Hold VCDFile::readLock() to query the file from another thread meanwhile.
+     *
+     * @return Number of new bytes read, 0 if the file did not grow.
+     */
+    size_t poll();
+
+    /**
+     * @brief Poll the last parsed file until told to stop.
+     * @param interval Time to wait after a poll that found nothing new.
+     * @param on_update Called after each poll with its result, return false to stop following.
+     */
+    void follow(std::chrono::milliseconds interval, const std::function<bool(size_t)>& on_update);
 
     [[nodiscard]] const VCDParseResult& GetResult() const { return result_; }
 
+    /// @brief Number of lines decoded so far.
+    [[nodiscard]] uint64_t GetLineCount() const { return line_; }
+
+    /// @brief Byte offset of the first byte not decoded yet, the start of the value changes after parseHeader().
+    [[nodiscard]] uint64_t GetOffset() const { return offset_; }
+
    private:
     VCDParseResult result_;
     VCDFile* file_ = nullptr;
+    ParseOptions options_;
+
+    uint64_t line_ = 0;              //!< Number of lines read so far
+    uint64_t offset_ = 0;            //!< Byte offset of the first byte not decoded yet
+    std::string leftover_;           //!< Bytes read after offset_, an incomplete line
+    bool in_comment_ = false;        //!< The lines decoded so far left a $comment open
+    bool carriage_returns_ = false;  //!< The header has '\r' line ends, only the generic dialect decodes them
+    VCDIdTable ids_;                 //!< Signals of the file by identifier code, for a dialect with an identifier size
+
+    std::string path_;             //!< Last parsed file, followed by poll()
+    VCDFile* followed_ = nullptr;  //!< Destination of the last parse
+    bool header_done_ = false;
+    uint64_t unbounded_bytes_ = 0;  //!< Bytes decoded since the memory was last bounded
 
-    static size_t findNextLine(const std::string& chunk, size_t start);
-    void parseValueChangeLine(const std::string& line) const;
+    /// @brief Where the phases are measured, nullptr when profiling is disabled.
+    [[nodiscard]] VCDProfile* profile() { return options_.profile ? &result_.profile : nullptr; }
+    void parseDeclarations(const std::string& header, const std::string& file_path);
+    void recordMemory();
+    void boundMemory(uint64_t decoded, bool force = false);
+    void decodeBody(std::istream& stream);
+    template <typename Dialect>
+    void decodeSerial(std::istream& stream);
+    template <typename Dialect>
+    void parseValueChangeParallel(std::istream& stream, unsigned threads);
 };
 
 }  // namespace VCDP_NAMESPACE
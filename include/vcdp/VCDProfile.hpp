@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <iosfwd>
+#include <utility>
+
+#include "Config.hpp"
+#include "VListManager.hpp"
+
+/**
+ * @file VCDProfile.hpp
+ * @brief Optional per-phase timings and counters collected by the VCD parser.
+ */
+
+namespace VCDP_NAMESPACE {
+
+/// @brief Step of the parse measured separately.
+enum class VCDPhase : uint8_t {
+    HEADER_READ,   //!< Reading the lines up to $enddefinitions
+    HEADER_PARSE,  //!< Parsing the declarations with the grammar
+    BODY_READ,     //!< Reading the value change section from the file
+    SPLIT,         //!< Cutting the batches into slices, multi-threaded parse only
+    DECODE,        //!< Decoding the lines, and storing them when single-threaded
+    STORE,         //!< Appending the decoded changes to the signals, multi-threaded parse only
+    COUNT          //!< Number of phases, not a real phase
+};
+
+/// @brief Number of distinct phases.
+inline constexpr size_t VCD_PHASE_COUNT = static_cast<size_t>(VCDPhase::COUNT);
+
+/// @brief Name of a phase as written in the JSON output, eg. "header_read".
+const char* vcdPhase2String(VCDPhase phase);
+
+/// @brief What was measured for one phase, summed over every time it ran.
+struct VCDPhaseStats {
+    double wall_seconds = 0;
+    double cpu_seconds = 0;  //!< Process CPU time, worker threads included
+    uint64_t calls = 0;      //!< Number of times the phase ran
+    uint64_t bytes = 0;
+    uint64_t lines = 0;
+    uint64_t changes = 0;      //!< Value changes
+    uint64_t allocations = 0;  //!< VList blocks allocated
+};
+
+/// @brief Bytes used by a VCDFile, by structure.
+struct VCDMemoryStats {
+    uint64_t vlists = 0;  //!< Value change blocks, headers included
+    uint64_t vlist_blocks = 0;
+    uint64_t time_table = 0;  //!< Timestamps
+    uint64_t names = 0;       //!< Characters of the identifier codes, references and scope names
+    uint64_t tables = 0;      //!< Signal, scope and lookup tables
+    uint64_t summaries = 0;   //!< Summary pyramids, see VCDFile::enableSummaries
+    uint64_t spilled = 0;     //!< Value change bytes moved to disk (see VCDFile::limitMemory), not part of Total()
+
+    [[nodiscard]] uint64_t Total() const { return vlists + time_table + names + tables + summaries; }
+};
+
+/// @brief Instrumentation of one parse, filled when ParseOptions::profile is set.
+struct VCDProfile {
+    bool enabled = false;
+    std::array<VCDPhaseStats, VCD_PHASE_COUNT> phases{};
+
+    /**
+     * @brief Memory of the file in use at the end of the parse. Without ParseOptions::memory_limit the file
+     * only grows while parsed, so this is also its peak. With it, blocks spilled during the parse count in
+     * `spilled` only, and the memory used before a spill is not recorded.
+     */
+    VCDMemoryStats memory;
+
+    [[nodiscard]] VCDPhaseStats& operator[](VCDPhase phase) { return phases[static_cast<size_t>(phase)]; }
+    [[nodiscard]] const VCDPhaseStats& operator[](VCDPhase phase) const { return phases[static_cast<size_t>(phase)]; }
+
+    /// @brief Write the profile as a JSON object.
+    void WriteJson(std::ostream& os) const;
+
+    void Clear() { *this = VCDProfile(); }
+};
+
+/**
+ * @brief Measure the lifetime of a scope as one run of a phase. Does nothing without a profile,
+ * so that disabled instrumentation costs a single test per phase.
+ */
+class VCDPhaseTimer {
+   public:
+    VCDPhaseTimer(VCDProfile* profile, const VCDPhase phase) : stats_(profile == nullptr ? nullptr : &(*profile)[phase]) {
+        if (stats_ == nullptr) return;
+        wall_ = std::chrono::steady_clock::now();
+        cpu_ = std::clock();
+        counting_ = std::exchange(vlist_count_allocations, true);
+        allocations_ = vlist_allocations;
+    }
+
+    ~VCDPhaseTimer() {
+        if (stats_ == nullptr) return;
+        stats_->wall_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_).count();
+        stats_->cpu_seconds += static_cast<double>(std::clock() - cpu_) / CLOCKS_PER_SEC;
+        stats_->allocations += vlist_allocations - allocations_;
+        stats_->calls++;
+        vlist_count_allocations = counting_;
+    }
+
+    VCDPhaseTimer(const VCDPhaseTimer&) = delete;
+    VCDPhaseTimer& operator=(const VCDPhaseTimer&) = delete;
+
+    /// @brief Stats of the phase, nullptr when profiling is disabled.
+    [[nodiscard]] VCDPhaseStats* stats() const { return stats_; }
+
+   private:
+    VCDPhaseStats* stats_;
+    std::chrono::steady_clock::time_point wall_;
+    std::clock_t cpu_ = 0;
+    uint64_t allocations_ = 0;
+    bool counting_ = false;  //!< vlist_count_allocations before the phase, as phases nest
+};
+
+}  // namespace VCDP_NAMESPACE
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Config.hpp"
+#include "VCDFile.hpp"
+#include "VCDParser.hpp"
+
+/**
+ * @file VCDSearch.hpp
+ * @brief Find the times at which a condition over signals holds.
+ *
+ * Conditions are C-like expressions over signals named by their dotted hierarchical
+ * name (eg. "tb.uut.valid && !tb.uut.ready", "tb.bus == 0xDEAD", "tb.data[3:0] > 4"):
+ *  - literals: decimal, hexadecimal (0x) or binary (0b), '_' separators allowed
+ *  - bit and part selects: name[3], name[7:4], numbered as declared
+ *  - operators, by increasing precedence: ||, &&, |, ^, &, == !=, < <= > >=, + -, and the unary ! ~ -
+ *
+ * A condition may end with "for <n>" to only match once it has held for n time units,
+ * or "for <n> @ <clock>" for n rising edges of a clock signal.
+ *
+ * Values are the 64 least significant bits of the signals. A value holding x or z bits
+ * is unknown, and so is any comparison involving it: an unknown condition does not match.
+ */
+
+namespace VCDP_NAMESPACE {
+
+/// @brief How VCDSearch searches.
+struct SearchOptions {
+    /// @brief Stop once this many matches are complete, eg. 1 to find the first one.
+    size_t max_matches = SIZE_MAX;
+};
+
+/// @brief Interval during which a condition matched.
+struct VCDMatch {
+    uint64_t begin = 0;         //!< Time the condition became true, or had held for the requested duration
+    uint64_t end = UINT64_MAX;  //!< Time it became false, UINT64_MAX if still true at the end of the trace
+};
+
+/// @brief Outcome of a search.
+struct VCDSearchResult {
+    bool success = true;
+    std::string error;              //!< Why the search could not run, eg. an expression syntax error
+    std::vector<VCDMatch> matches;  //!< In time order
+    uint64_t evaluations = 0;       //!< Times the condition was evaluated, once per time step changing one of its signals
+};
+
+/**
+ * @brief Search a condition in a loaded VCDFile, or straight from a VCD file.
+ *
+ * The expression is compiled against the declarations of the file into a stack
+ * bytecode, and only evaluated at the time steps where one of its signals changes.
+ */
+class VCDSearch {
+   public:
+    explicit VCDSearch(std::string expression, SearchOptions options = SearchOptions())
+        : expression_(std::move(expression)), options_(options) {}
+
+    /// @brief Search the value changes stored in a parsed file.
+    [[nodiscard]] VCDSearchResult find(const VCDFile& file) const;
+
+    /**
+     * @brief Search a VCD file without storing its value changes. Reading stops once
+     * SearchOptions::max_matches matches are complete.
+     * @param path The VCD file.
+     */
+    VCDSearchResult find(const std::string& path);
+
+    /// @brief Diagnostics of the file read by the last find(path).
+    [[nodiscard]] const VCDParseResult& GetParseResult() const { return parse_result_; }
+
+    [[nodiscard]] const std::string& expression() const { return expression_; }
+
+   private:
+    std::string expression_;
+    SearchOptions options_;
+    VCDParseResult parse_result_;
+};
+
+}  // namespace VCDP_NAMESPACE
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Config.hpp"
+
+/**
+ * @file VCDSummary.hpp
+ * @brief Multi-resolution summary of the value changes of a signal, to draw it zoomed out
+ * without reading every change.
+ */
+
+namespace VCDP_NAMESPACE {
+
+/// @brief Value changes of a signal within one time bucket of a summary level.
+struct VCDSummaryBucket {
+    uint64_t index = 0;  //!< Start time of the bucket >> shift of the level
+    uint64_t count = 0;  //!< Value changes in the bucket
+    uint32_t first = 0;  //!< First value of the bucket, in the value pool of the summary
+    uint32_t last = 0;   //!< Last value, VCDSummary::CURRENT for the last bucket of a level
+    bool has_x = false;  //!< A value of the bucket holds x, z or another non 0/1 bit
+};
+
+/// @brief Summary of a signal over one requested bucket, see VCDFile::summarize.
+struct VCDSummarySample {
+    uint64_t begin = 0;
+    uint64_t end = 0;
+    uint64_t changes = 0;  //!< Value changes in [begin, end)
+    bool has_x = false;    //!< The value holds non 0/1 bits at some point of the bucket
+    std::string first;     //!< Value at begin, empty before the first change of the signal
+    std::string last;      //!< Value at end, after the changes of the bucket
+};
+
+/**
+ * @brief Pyramid of per-bucket summaries of the value changes of a signal.
+ *
+ * Level k cuts time in buckets of 2^(shift + 2k) time units, from the finest resolution
+ * up to a single bucket holding the whole trace, and only stores the buckets holding
+ * changes. Levels four times coarser than the previous one take half the memory of
+ * levels twice as coarse, and a requested bucket still spans at most four buckets of
+ * the level read.
+ *
+ * A change updates the last bucket of every level, and the first and last values of
+ * the buckets are pooled: a bucket of a coarse level starts and ends on values of
+ * finer buckets, each value is stored once.
+ *
+ * A change is stored once per level until the buckets get wider than the gaps between
+ * changes: the finest resolution should be the finest zoom summaries are drawn at.
+ */
+class VCDSummary {
+   public:
+    /// @brief Reference to the current value of the signal.
+    static constexpr uint32_t CURRENT = UINT32_MAX;
+
+    /// @brief Each level is 2^LEVEL_BITS times coarser than the previous one.
+    static constexpr unsigned LEVEL_BITS = 2;
+
+    /**
+     * @brief Start summarizing the changes added from now on.
+     * @param resolution Bucket width of the finest level in time units, rounded down to a power of two.
+     * @param size Declared size of the signal, values are left-extended to it.
+     */
+    void enable(uint64_t resolution, uint32_t size);
+
+    [[nodiscard]] bool enabled() const { return enabled_; }
+
+    /**
+     * @brief Account for a value change, times being non-decreasing.
+     * @param time Time of the change.
+     * @param value The new value as written in the VCD body.
+     */
+    void add(uint64_t time, std::string_view value);
+
+    /**
+     * @brief Summarize [begin, end) in `count` buckets of equal width, up to one time unit
+     * apart, from the coarsest level whose buckets are not wider than them. Bucket edges
+     * are rounded down to the resolution of that level.
+     */
+    [[nodiscard]] std::vector<VCDSummarySample> sample(uint64_t begin, uint64_t end, size_t count) const;
+
+    /// @brief Bucket width of level 0 is 2^shift() time units.
+    [[nodiscard]] unsigned shift() const { return shift_; }
+
+    /// @brief Bucket width of a level is 2^levelShift(level) time units.
+    [[nodiscard]] unsigned levelShift(const size_t level) const { return shift_ + LEVEL_BITS * static_cast<unsigned>(level); }
+
+    /// @brief Buckets of each level, finest first.
+    [[nodiscard]] const std::vector<std::vector<VCDSummaryBucket>>& levels() const { return levels_; }
+
+    /// @brief Value of a bucket, left-extended to the size of the signal.
+    [[nodiscard]] std::string value(uint32_t ref) const;
+
+    /// @brief Bytes used by the buckets and the value pool.
+    [[nodiscard]] uint64_t memoryUsage() const;
+
+    /**
+     * @brief Start of the bucket `index` of `count` equal buckets cutting [begin, end).
+     * @return begin for index 0, end for index count.
+     */
+    static uint64_t bucketStart(uint64_t begin, uint64_t end, size_t count, size_t index);
+
+    /// @brief Left-extend a value to a size as VCDChangeReader does: 1 extends with 0, x and z with themselves.
+    static std::string extend(std::string value, uint32_t size);
+
+    /// @brief A value holds bits other than 0 and 1.
+    static bool hasUnknown(const std::string_view value) { return value.find_first_not_of("01") != std::string_view::npos; }
+
+   private:
+    uint32_t commit(std::string_view value);
+
+    bool enabled_ = false;
+    unsigned shift_ = 0;
+    uint32_t size_ = 0;
+    std::vector<std::vector<VCDSummaryBucket>> levels_;
+
+    std::string values_;                   //!< Pooled bucket values, normalized as VCDChangeReader returns them
+    std::vector<uint64_t> value_offsets_;  //!< Start of each pooled value in values_
+    std::string current_;                  //!< Value of the last change
+    std::string next_;                     //!< Value being added, kept to reuse its buffer
+    uint32_t current_ref_ = CURRENT;       //!< current_ in the pool, CURRENT while not pooled
+};
+
+}  // namespace VCDP_NAMESPACE
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "Config.hpp"
+#include "VCDSummary.hpp"
 #include "VListManager.hpp"
 
 /**
@@ -59,28 +62,125 @@ enum class VCDTimeUnit {
 /// @brief Represents the type of SV construct whose scope we are in.
 enum class VCDScopeType { VCD_SCOPE_UNKNOWN, VCD_SCOPE_BEGIN, VCD_SCOPE_FORK, VCD_SCOPE_FUNCTION, VCD_SCOPE_MODULE, VCD_SCOPE_TASK, VCD_SCOPE_ROOT };
 
-// Forward declaration of VCDScope to make it available to VCDSignal struct.
-struct VCDScope;
+/// @brief Clock edges signals are sampled on, see VCDFile::sampleOn.
+enum class VCDEdge { RISING, FALLING, BOTH };
+
+/// @brief Index of an entry of the scope or signal table of a VCDFile.
+using VCDIndex = uint32_t;
+
+/// @brief Index value meaning "no entry", eg. the parent of a top scope.
+inline constexpr VCDIndex VCD_NO_INDEX = UINT32_MAX;
+
+/// @brief View over contiguous entries of a VCDFile table.
+template <typename T>
+class VCDSpan {
+   public:
+    VCDSpan() = default;
+    VCDSpan(T* begin, T* end) : begin_(begin), end_(end) {}
+
+    [[nodiscard]] T* begin() const { return begin_; }
+    [[nodiscard]] T* end() const { return end_; }
+    [[nodiscard]] size_t size() const { return static_cast<size_t>(end_ - begin_); }
+    [[nodiscard]] bool empty() const { return begin_ == end_; }
+    [[nodiscard]] T& operator[](size_t index) const { return begin_[index]; }
+    [[nodiscard]] T& at(size_t index) const {
+        if (index >= size()) throw std::out_of_range("VCDSpan index out of range");
+        return begin_[index];
+    }
+
+   private:
+    T* begin_ = nullptr;
+    T* end_ = nullptr;
+};
+
+/// @brief Changes of a signal between two entries of its skip index.
+inline constexpr uint64_t VCD_SKIP_INTERVAL = 64;
+
+/// @brief Where the decoding of the changes of a signal can resume, see VCDSignal::skip.
+struct VCDSkipEntry {
+    uint64_t time_index;       //!< Time index of the change starting here
+    uint64_t base_time_index;  //!< Time index of the change before it, base of its delta
+    uint64_t position;         //!< Byte of VCDSignal::data where the change starts
+    uint64_t real_bits;        //!< Real signals: IEEE 754 bits of the value before the change, base of its XOR
+};
 
 /// @brief Represents a single signal reference within a VCD file
 struct VCDSignal {
     std::string hash;
     std::string reference;
-    VCDScope* scope = nullptr;
+    VCDIndex scope = VCD_NO_INDEX;  //!< First scope declaring the signal
     uint32_t size = 0;
     VCDVarType type = VCDVarType::VCD_VAR_UNKNOWN;
     int lindex = -1;  // -1 if no brackets, otherwise [lindex] or [lindex:rindex]
     int rindex = -1;  // -1 if not [lindex:rindex]
 
-    VListManager data;
+    VListManager data;               //!< Value changes, see VCDFile::addValueChange for the encoding
+    uint64_t change_count = 0;       //!< Number of value changes stored in data
+    uint64_t last_time_index = 0;    //!< Time index of the last stored change, base of the next delta
+    uint64_t last_real_bits = 0;     //!< Real signals: IEEE 754 bits of the last stored value, base of the next XOR
+    VCDSummary summary;              //!< Zoomed out view of the changes, see VCDFile::enableSummaries
+    std::vector<VCDSkipEntry> skip;  //!< One entry every VCD_SKIP_INTERVAL changes, the first one excluded, see VCDChangeReader::seek
+
+    /// @brief Values are floating point numbers, written "r<number> <id>" in the VCD body.
+    [[nodiscard]] bool isReal() const { return type == VCDVarType::VCD_VAR_REAL || type == VCDVarType::VCD_VAR_REALTIME; }
 };
 
-/// @brief Represents a scope type, scope name pair and all of its child signals.
+/**
+ * @brief Represents a scope type, scope name pair. Children and signals are ranges of
+ * the tables owned by the VCDFile, see VCDFile::getScopeChildren and VCDFile::getScopeSignals.
+ */
 struct VCDScope {
-    std::string name;                 //!< The short name of the scope
-    VCDScopeType type;                //!< Construct type
-    VCDScope* parent;                 //!< Parent scope object
-    std::vector<VCDScope*> children;  //!< Child scope objects.
-    std::vector<VCDSignal*> signals;  //!< Signals in this scope.
+    std::string name;                                     //!< The short name of the scope
+    VCDScopeType type = VCDScopeType::VCD_SCOPE_UNKNOWN;  //!< Construct type
+    VCDIndex parent = VCD_NO_INDEX;                       //!< Parent scope, VCD_NO_INDEX for a top scope
+    VCDIndex children_begin = 0;                          //!< First child scope in VCDFile::getScopes()
+    VCDIndex children_end = 0;                            //!< Past the last child scope
+    VCDIndex signals_begin = 0;                           //!< First entry in VCDFile::getScopeSignals()
+    VCDIndex signals_end = 0;                             //!< Past the last signal entry
+};
+
+/// @brief Bits of a signal taken by a virtual signal, see VCDFile::slice.
+struct VCDSliceField {
+    const VCDSignal* signal = nullptr;
+    int first = -1;  //!< Bit range [first:last] numbered as declared, eg. [63:32] of a [511:0] bus. -1: the whole signal
+    int last = -1;   //!< -1: the single bit first
+};
+
+/// @brief A value change found by VCDFile::nextChange, VCDFile::prevChange or VCDFile::nextEdge.
+struct VCDFoundChange {
+    uint64_t time_index;  //!< Index in VCDFile::getTimestamps()
+    uint64_t time;        //!< Timestamp of the change
+    std::string value;    //!< As VCDChangeReader::value() returns it
+};
+
+/**
+ * @brief Values of signals at each edge of a clock, one entry per cycle, see VCDFile::sampleOn.
+ * A value holds words[signal] 64-bit words per cycle, least significant word first.
+ */
+struct VCDSampledSignals {
+    std::vector<uint64_t> times;                //!< Time of the edge starting each cycle
+    std::vector<uint32_t> words;                //!< Words of a value of each signal, (size + 63) / 64
+    std::vector<std::vector<uint64_t>> values;  //!< Values of each signal, cycle after cycle, 0 when not known
+    std::vector<std::vector<uint8_t>> known;    //!< Per signal and cycle, 0 before the first change or when a bit is not 0 or 1
+
+    [[nodiscard]] size_t cycles() const { return times.size(); }
+
+    /// @brief The 64 least significant bits of a signal at a cycle.
+    [[nodiscard]] uint64_t value(const size_t signal, const size_t cycle) const { return values[signal][cycle * words[signal]]; }
+};
+
+/**
+ * @brief Value changes of a signal decoded into flat arrays, one entry per change, see VCDFile::decode.
+ * A value holds `words` 64-bit words, least significant word first.
+ */
+struct VCDDecodedSignal {
+    std::vector<uint64_t> time_indices;  //!< Index in VCDFile::getTimestamps() of each change
+    std::vector<uint64_t> times;         //!< Timestamp of each change
+    uint32_t words = 1;                  //!< Words of a value, (size + 63) / 64
+    std::vector<uint64_t> values;        //!< Values, change after change, 0 when not known. Empty for a real signal
+    std::vector<uint8_t> known;          //!< Per change, 0 when a bit is not 0 or 1. Empty for a real signal
+    std::vector<double> reals;           //!< Values of a real signal
+
+    [[nodiscard]] size_t changes() const { return time_indices.size(); }
 };
 }  // namespace VCDP_NAMESPACE
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Config.hpp"
+#include "VCDFile.hpp"
+#include "VCDParser.hpp"
+
+/**
+ * @file VCDWriter.hpp
+ * @brief Write a selection of signals and a time window back to VCD.
+ */
+
+namespace VCDP_NAMESPACE {
+
+/// @brief What VCDWriter writes, and how.
+struct WriteOptions {
+    /**
+     * @brief Wildcard patterns selecting the signals, matched against the dotted
+     * hierarchical name (eg. "tb.uut.*") and the identifier code. Empty for every signal.
+     */
+    std::vector<std::string> signals;
+
+    /// @brief First time written. The values at that time are dumped in a $dumpvars block.
+    uint64_t begin = 0;
+
+    /// @brief Last time written, changes after it are dropped.
+    uint64_t end = UINT64_MAX;
+
+    /// @brief Renumber the identifier codes of the written signals from '!', instead of keeping the original ones.
+    bool compact_ids = false;
+
+    /// @brief Compress the output with gzip.
+    bool gzip = false;
+
+    /// @brief libdeflate compression level, 1 (fastest) to 12 (smallest).
+    int compression_level = 6;
+};
+
+/// @brief Summary of a write.
+struct VCDWriteResult {
+    bool success = true;
+    std::string error;     //!< Why the write failed
+    uint64_t signals = 0;  //!< Signals written
+    uint64_t changes = 0;  //!< Value changes written, the initial $dumpvars included
+    uint64_t bytes = 0;    //!< Bytes written to the output file, after compression
+};
+
+/// @brief Serialise VCD files, either from a parsed VCDFile or straight from a source file.
+class VCDWriter {
+   public:
+    explicit VCDWriter(WriteOptions options = WriteOptions()) : options_(std::move(options)) {}
+
+    /**
+     * @brief Write a parsed file.
+     * @param file The file to write.
+     * @param output_path Destination file.
+     */
+    VCDWriteResult write(const VCDFile& file, const std::string& output_path);
+
+    /**
+     * @brief Write the selection of a VCD file without storing its value changes. Reading
+     * stops at the end of the time window, so this is the way to cut a large dump down.
+     * @param input_path Source VCD file.
+     * @param output_path Destination file.
+     */
+    VCDWriteResult extract(const std::string& input_path, const std::string& output_path);
+
+    /// @brief Diagnostics of the source file read by the last extract().
+    [[nodiscard]] const VCDParseResult& GetParseResult() const { return parse_result_; }
+
+   private:
+    WriteOptions options_;
+    VCDParseResult parse_result_;
+};
+
+/**
+ * @brief Write a VCD file from timestamps and value changes produced on the fly, eg. by
+ * VCDMerger::write, instead of stored in a VCDFile. The selection and time window of the
+ * options apply as for VCDWriter.
+ */
+class VCDStreamWriter {
+   public:
+    /**
+     * @brief Open the output and write the header.
+     * @param header File declaring the signals, kept referenced until finish().
+     * @param output_path Destination file.
+     */
+    VCDStreamWriter(const VCDFile& header, const std::string& output_path, const WriteOptions& options = WriteOptions());
+    ~VCDStreamWriter();
+
+    VCDStreamWriter(const VCDStreamWriter&) = delete;
+    VCDStreamWriter& operator=(const VCDStreamWriter&) = delete;
+
+    /// @brief The output could be opened.
+    [[nodiscard]] bool good() const;
+
+    /// @brief Start a new time, not lower than the previous one.
+    void addTimestamp(uint64_t time);
+
+    /// @brief Write a change of a signal of the header at the current time.
+    void addValueChange(const VCDSignal& signal, std::string_view value);
+
+    /// @brief Past the end of the time window: nothing more will be written.
+    [[nodiscard]] bool done() const;
+
+    /// @brief Write the end of the dump and flush the output.
+    VCDWriteResult finish();
+
+   private:
+    struct State;
+    std::unique_ptr<State> state_;
+};
+
+}  // namespace VCDP_NAMESPACE
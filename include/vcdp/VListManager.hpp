@@ -1,99 +1,649 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <cstdio>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "Config.hpp"
 
 namespace VCDP_NAMESPACE {
 
+/// @brief Number of VList blocks allocated by the calling thread while vlist_count_allocations is set, read by the parse profiler.
+inline thread_local uint64_t vlist_allocations = 0;
+
+/// @brief Count the blocks allocated by the calling thread in vlist_allocations, set while a profiled phase runs.
+inline thread_local bool vlist_count_allocations = false;
+
+/// @brief Largest block a list grows by, so that a long list keeps most of its bytes in cold blocks that can be spilled.
+inline constexpr uint32_t VLIST_MAX_BLOCK_SIZE = 1024 * 1024;
+
+/// @brief Smallest block worth moving to a spill file.
+inline constexpr uint32_t VLIST_MIN_SPILL_SIZE = 4096;
+
+/**
+ * @brief Bytes of varints a VListManager keeps in itself before allocating blocks: the few
+ * changes of a quiet signal (reset, configuration bit) need no block at all.
+ */
+inline constexpr uint32_t VLIST_INLINE_SIZE = 15;
+
+/**
+ * @brief Number of block sizes: class 0 holds the 16 bytes of the stub of a spilled block,
+ * the next ones powers of two from 64 bytes to VLIST_MAX_BLOCK_SIZE.
+ */
+inline constexpr unsigned VLIST_SIZE_CLASSES = 16;
+
+/// @brief Bytes of data of a block of a size class.
+constexpr uint32_t vlistClassSize(const unsigned size_class) { return size_class == 0 ? 16 : 64u << (size_class - 1); }
+
+static_assert(vlistClassSize(VLIST_SIZE_CLASSES - 1) == VLIST_MAX_BLOCK_SIZE);
+
+/// @brief Size class of the first block of a list after a spill: growth starts over from there.
+inline constexpr unsigned VLIST_SPILL_RESTART_CLASS = 7;
+
+static_assert(vlistClassSize(VLIST_SPILL_RESTART_CLASS) == VLIST_MIN_SPILL_SIZE);
+
+/// @brief Bytes of the slabs the blocks smaller than VLIST_MIN_SPILL_SIZE are carved from.
+inline constexpr size_t VLIST_SLAB_SIZE = 64 * 1024;
+
+/// @brief Bytes read at once from a spill file when paging contiguous blocks of a list back in.
+inline constexpr size_t VLIST_READ_AHEAD = 4 * 1024 * 1024;
+
+/**
+ * @brief Temporary file receiving the cold blocks of VLists (see VListManager::spill), deleted
+ * when closed. Blocks are appended, and read back from any thread: with positional reads that
+ * share no file position, readers do not lock (but on Windows).
+ */
+class VListSpillFile {
+   public:
+    VListSpillFile() : file_(std::tmpfile(), &std::fclose) {
+        if (!file_) throw std::runtime_error("Error: unable to create a VList spill file");
+    }
+
+    /// @brief Append bytes, return their offset in the file.
+    uint64_t write(const uint8_t* data, const size_t size) {
+        const std::lock_guard lock(mutex_);
+#ifdef _WIN32
+        if (_fseeki64(file_.get(), static_cast<int64_t>(size_), SEEK_SET) != 0 || std::fwrite(data, 1, size, file_.get()) != size ||
+            std::fflush(file_.get()) != 0) {
+            throw std::runtime_error("Error: unable to write the VList spill file");
+        }
+#else
+        for (size_t done = 0; done < size;) {
+            const ssize_t count = ::pwrite(fileno(file_.get()), data + done, size - done, static_cast<off_t>(size_ + done));
+            if (count <= 0) throw std::runtime_error("Error: unable to write the VList spill file");
+            done += static_cast<size_t>(count);
+        }
+#endif
+        size_ += size;
+        return size_ - size;
+    }
+
+    /// @brief Read bytes written before.
+    void read(const uint64_t offset, uint8_t* data, const size_t size) const {
+#ifdef _WIN32
+        const std::lock_guard lock(mutex_);
+        if (_fseeki64(file_.get(), static_cast<int64_t>(offset), SEEK_SET) != 0 || std::fread(data, 1, size, file_.get()) != size) {
+            throw std::runtime_error("Error: unable to read the VList spill file");
+        }
+#else
+        for (size_t done = 0; done < size;) {
+            const ssize_t count = ::pread(fileno(file_.get()), data + done, size - done, static_cast<off_t>(offset + done));
+            if (count <= 0) throw std::runtime_error("Error: unable to read the VList spill file");
+            done += static_cast<size_t>(count);
+        }
+#endif
+    }
+
+    /// @brief Hint that bytes are read soon, for the system to start reading them from disk.
+    void prefetch(const uint64_t offset, const size_t size) const {
+#ifdef POSIX_FADV_WILLNEED
+        ::posix_fadvise(fileno(file_.get()), static_cast<off_t>(offset), static_cast<off_t>(size), POSIX_FADV_WILLNEED);
+#else
+        (void)offset;
+        (void)size;
+#endif
+    }
+
+    /// @brief Bytes written to the file.
+    [[nodiscard]] uint64_t size() const { return size_; }
+
+   private:
+    std::unique_ptr<FILE, int (*)(FILE*)> file_;
+    mutable std::mutex mutex_;
+    uint64_t size_ = 0;
+};
+
+/// @brief Where the data of a spilled block went, stored in place of it.
+struct VListSpillRef {
+    const VListSpillFile* file;
+    uint64_t offset;
+};
+
 /// @brief See https://gtkwave.github.io/gtkwave/internals/vcd-recoding.html
 struct VList {
-    VList* next;
-    uint32_t size;
-    int offset;
-    uint32_t elem_size;
+    VList* next;         //!< Next block in insertion order, nullptr for the last one
+    uint32_t offset;     //!< Bytes of data used
+    uint8_t size_class;  //!< See vlistClassSize
+    uint8_t spilled;     //!< The offset bytes of data are in a spill file, the block holds a VListSpillRef to them
 
+    [[nodiscard]] uint32_t size() const { return vlistClassSize(size_class); }
     uint8_t* getDataAddr() { return reinterpret_cast<uint8_t*>(this + 1); }
+    [[nodiscard]] const uint8_t* getDataAddr() const { return reinterpret_cast<const uint8_t*>(this + 1); }
 };
 
-class VListManager {
+/**
+ * @brief Blocks of the VLists of a file, by size class. Blocks smaller than VLIST_MIN_SPILL_SIZE
+ * are carved from slabs, larger ones allocated one by one. Released blocks go to a free list of
+ * their class and are handed out again, eg. after a spill or when a list is cleared.
+ * Blocks may be allocated and released from several threads.
+ */
+class VListPool {
    public:
-    VListManager() : head_(nullptr) {}
+    VListPool() = default;
+
+    ~VListPool() {
+        trim();
+        for (void* slab : slabs_) free(slab);
+    }
 
-    ~VListManager() {
-        while (head_ != nullptr) {
-            VList* temp = head_;
-            head_ = head_->next;
-            free(temp);
+    VListPool(const VListPool&) = delete;
+    VListPool& operator=(const VListPool&) = delete;
+
+    /// @brief Pool of the lists not given one. Never destroyed, as lists may outlive any other static.
+    static VListPool& global() {
+        static auto* pool = new VListPool();
+        return *pool;
+    }
+
+    VList* allocate(const unsigned size_class) {
+        const size_t total_size = sizeof(VList) + vlistClassSize(size_class);
+        VList* block = nullptr;
+        if (carved(size_class)) {
+            const std::lock_guard lock(mutex_);
+            if ((block = takeFree(size_class)) == nullptr) {
+                if (slab_left_ < total_size) {
+                    slabs_.push_back(malloc(VLIST_SLAB_SIZE));
+                    if (!slabs_.back()) throw std::runtime_error("Error: malloc failed in VListPool::allocate");
+                    slab_next_ = static_cast<uint8_t*>(slabs_.back());
+                    slab_left_ = VLIST_SLAB_SIZE;
+                }
+                block = reinterpret_cast<VList*>(slab_next_);
+                slab_next_ += total_size;
+                slab_left_ -= total_size;
+            }
+        } else {
+            {
+                const std::lock_guard lock(mutex_);
+                block = takeFree(size_class);
+            }
+            if (block == nullptr) {
+                block = static_cast<VList*>(malloc(total_size));
+                if (!block) throw std::runtime_error("Error: malloc failed in VListPool::allocate");
+            }
         }
+
+        block->next = nullptr;
+        block->offset = 0;
+        block->size_class = static_cast<uint8_t>(size_class);
+        block->spilled = 0;
+        if (vlist_count_allocations) vlist_allocations++;
+        return block;
     }
 
-    static VList* allocate(const uint32_t size) {
-        const size_t total_size = sizeof(VList) + size;  // Store the VList header + 'size' bytes
-        const auto new_list = static_cast<VList*>(malloc(total_size));
+    /// @brief Take back a chain of blocks linked by next.
+    void release(VList* blocks) {
+        const std::lock_guard lock(mutex_);
+        while (blocks != nullptr) {
+            VList* block = blocks;
+            blocks = blocks->next;
+            block->next = free_[block->size_class];
+            free_[block->size_class] = block;
+            if (!carved(block->size_class)) cached_ += sizeof(VList) + block->size();
+        }
+    }
 
-        if (!new_list) {
-            throw std::runtime_error("Error: malloc failed in VList::allocate");
+    /**
+     * @brief Give the free blocks allocated one by one back to the system, eg. once spilled.
+     * @return Bytes released.
+     */
+    size_t trim() {
+        const std::lock_guard lock(mutex_);
+        for (unsigned size_class = 0; size_class < VLIST_SIZE_CLASSES; size_class++) {
+            if (carved(size_class)) continue;
+            while (VList* block = free_[size_class]) {
+                free_[size_class] = block->next;
+                free(block);
+            }
         }
+        return std::exchange(cached_, 0);
+    }
 
-        new_list->next = nullptr;
-        new_list->size = size;
-        new_list->offset = 0;
-        new_list->elem_size = 1;
+    /// @brief Bytes of the free blocks allocated one by one, that trim() would release.
+    [[nodiscard]] size_t cachedBytes() const {
+        const std::lock_guard lock(mutex_);
+        return cached_;
+    }
 
-        return new_list;
-    };
+   private:
+    static bool carved(const unsigned size_class) { return vlistClassSize(size_class) < VLIST_MIN_SPILL_SIZE; }
 
-    void addData(uint32_t data) {
+    VList* takeFree(const unsigned size_class) {
+        VList* block = free_[size_class];
+        if (block == nullptr) return nullptr;
+        free_[size_class] = block->next;
+        if (!carved(size_class)) cached_ -= sizeof(VList) + block->size();
+        return block;
+    }
+
+    mutable std::mutex mutex_;
+    std::array<VList*, VLIST_SIZE_CLASSES> free_{};  //!< Free blocks of each class, linked by next
+    std::vector<void*> slabs_;
+    uint8_t* slab_next_ = nullptr;  //!< Start of the unused part of the last slab
+    size_t slab_left_ = 0;
+    size_t cached_ = 0;  //!< Bytes of the free blocks that are not carved from slabs
+};
+
+/**
+ * @brief Append-only list of varints: the first VLIST_INLINE_SIZE bytes are stored inline, the
+ * next ones in blocks of a VListPool linked in insertion order, each one a size class larger than
+ * the previous one up to VLIST_MAX_BLOCK_SIZE.
+ */
+class VListManager {
+   public:
+    explicit VListManager(VListPool& pool = VListPool::global()) : pool_(&pool) {}
+
+    ~VListManager() { release(); }
+
+    VListManager(const VListManager&) = delete;
+    VListManager& operator=(const VListManager&) = delete;
+
+    VListManager(VListManager&& other) noexcept
+        : pool_(other.pool_),
+          head_(std::exchange(other.head_, nullptr)),
+          tail_(std::exchange(other.tail_, nullptr)),
+          tail_base_(std::exchange(other.tail_base_, 0)) {
+        takeInline(other);
+    }
+
+    VListManager& operator=(VListManager&& other) noexcept {
+        if (this != &other) {
+            release();
+            pool_ = other.pool_;
+            head_ = std::exchange(other.head_, nullptr);
+            tail_ = std::exchange(other.tail_, nullptr);
+            tail_base_ = std::exchange(other.tail_base_, 0);
+            takeInline(other);
+        }
+        return *this;
+    }
+
+    /// @brief Allocate the blocks from this pool, eg. the one of the file owning the list. The list has no block yet.
+    void usePool(VListPool& pool) {
+        if (head_ != nullptr) throw std::logic_error("Error: the pool of a VList is changed after its first block");
+        pool_ = &pool;
+    }
+
+    /// @brief Remove every value, the blocks going back to the pool.
+    void clear() {
+        release();
+        inline_size_ = 0;
+    }
+
+    /// @brief Largest size of the varint of a value of type T: 5 bytes for 32 bits, 10 for 64.
+    template <typename T>
+    static constexpr size_t MAX_VARINT_SIZE = (sizeof(T) * 8 + 6) / 7;
+
+    /**
+     * @brief Encode a value as stored in the list.
+     * @param data The value to encode, of 32 or 64 bits.
+     * @param buffer Receives the varint, at least MAX_VARINT_SIZE<T> bytes.
+     * @return Number of bytes written.
+     */
+    template <typename T>
+    static size_t encode(T data, uint8_t* buffer) {
+        static_assert(std::is_same_v<T, uint32_t> || std::is_same_v<T, uint64_t>, "Values of the list are of 32 or 64 bits");
         // Recover only useful bits (varint baby!!!)
-        uint8_t buffer[5];    // Varint for uint32_t is 5 bytes (because MSB show if existing next byte)
         uint8_t* p = buffer;  // Typically buffer[0]
 
-        while (data >= 0x80) {     // 0x80 -> 0b1000_0000
-            *p++ = (data & 0x7F);  // 0x7F -> 0b0111_1111
-            data >>= 7;            // Next byte
+        while (data >= 0x80) {                         // 0x80 -> 0b1000_0000
+            *p++ = static_cast<uint8_t>(data & 0x7F);  // 0x7F -> 0b0111_1111
+            data >>= 7;                                // Next byte
         }
-        *p++ = data | 0x80;  // Mark last byte (because we want to store the last byte also!)
+        *p++ = static_cast<uint8_t>(data | 0x80);  // Mark last byte (because we want to store the last byte also!)
+
+        return p - buffer;  // The real size occupied
+    }
 
-        const size_t size = p - buffer;  // The real size occupied
+    void addData(const uint32_t data) { addValue(data); }
 
-        // Iterate in each byte of the data
-        for (size_t i = 0; i < size; i++) {
-            if (head_ == nullptr || head_->offset >= head_->size) {  // If no remaining space, create a new bloc
-                const auto new_size = (head_ ? head_->size * 2 : 1);
-                const auto new_list = allocate(new_size);
-                new_list->next = head_;
-                head_ = new_list;
-            }
+    /// @brief Append a value of 64 bits, eg. a time index delta. Read back with VListReader::next(uint64_t&).
+    void addData64(const uint64_t data) { addValue(data); }
 
-            uint8_t* dest = head_->getDataAddr();  // Start of the data container of the bloc
-            dest[head_->offset++] = buffer[i];
+    /**
+     * @brief Append values already encoded with encode(), eg. a copy of another list.
+     * @param data The varints, the last one complete.
+     * @param size Number of bytes.
+     */
+    void addBytes(const uint8_t* data, size_t size) {
+        if (head_ == nullptr && inline_size_ < VLIST_INLINE_SIZE) {
+            const size_t count = std::min<size_t>(size, VLIST_INLINE_SIZE - inline_size_);
+            std::copy(data, data + count, inline_ + inline_size_);
+            inline_size_ += static_cast<uint8_t>(count);
+            data += count;
+            size -= count;
+        }
+        while (size > 0) {
+            if (tail_ == nullptr || tail_->offset >= tail_->size()) append(pool_->allocate(nextClass()));
+
+            const size_t count = std::min<size_t>(size, tail_->size() - tail_->offset);
+            std::copy(data, data + count, tail_->getDataAddr() + tail_->offset);
+            tail_->offset += static_cast<uint32_t>(count);
+            data += count;
+            size -= count;
         }
     }
 
-    [[nodiscard]] uint32_t getData(const size_t global_index) const {
-        VList* current = head_;
-        size_t current_base = 0;
+    /// @brief Number of bytes in the list, the position of the next value added (see VListReader).
+    [[nodiscard]] uint64_t size() const { return tail_ == nullptr ? inline_size_ : tail_base_ + tail_->offset; }
 
-        while (current != nullptr) {
-            const size_t last_element_index = std::min(static_cast<size_t>(current->offset), static_cast<size_t>(current->size));
+    /**
+     * @brief Byte of the list at an index, in insertion order.
+     * @throw std::out_of_range past the end of the list, std::logic_error for a byte of a spilled block: read those with a VListReader.
+     */
+    [[nodiscard]] uint32_t getData(const size_t global_index) const {
+        if (global_index < inline_size_) return inline_[global_index];
 
-            if (global_index < current_base + last_element_index) {
-                const size_t local_index = global_index - current_base;
-                const uint8_t* data = current->getDataAddr();
-                return data[local_index];
+        size_t current_base = inline_size_;
+        for (const VList* current = head_; current != nullptr; current = current->next) {
+            if (global_index < current_base + current->offset) {
+                if (current->spilled) {
+                    throw std::logic_error("Error: the byte of the VList is in a block spilled to disk, read it with a VListReader");
+                }
+                return current->getDataAddr()[global_index - current_base];
             }
-
-            current_base += last_element_index;
-            current = current->next;
+            current_base += current->offset;
         }
 
         throw std::out_of_range("Index out of range");
     }
 
+    /**
+     * @brief Bytes allocated for the list, the inline bytes excluded.
+     * @param blocks Incremented by the number of blocks.
+     */
+    [[nodiscard]] size_t memoryUsage(uint64_t& blocks) const {
+        size_t bytes = 0;
+        for (const VList* block = head_; block != nullptr; block = block->next) {
+            bytes += sizeof(VList) + block->size();
+            blocks++;
+        }
+        return bytes;
+    }
+
+    /// @brief Bytes of the blocks that are in a spill file.
+    [[nodiscard]] size_t spilledBytes() const {
+        size_t bytes = 0;
+        for (const VList* block = head_; block != nullptr; block = block->next) bytes += block->spilled ? block->offset : 0;
+        return bytes;
+    }
+
+    /// @brief Bytes of memory spill() would release.
+    [[nodiscard]] size_t spillableBytes() const {
+        size_t bytes = 0;
+        for (const VList* block = head_; block != nullptr; block = block->next) bytes += spillable(block) ? block->size() - vlistClassSize(0) : 0;
+        return bytes;
+    }
+
+    /**
+     * @brief Move the blocks holding at least VLIST_MIN_SPILL_SIZE bytes to a spill file, oldest
+     * first and contiguous, so that a VListReader pages them back in with few sequential reads.
+     * Each one is replaced by a stub and goes back to the pool. Values added afterwards go to a new block.
+     * @return Bytes of memory released.
+     */
+    size_t spill(VListSpillFile& file) {
+        size_t released = 0;
+        VList* previous = nullptr;
+        for (VList* block = head_; block != nullptr; previous = block, block = block->next) {
+            if (!spillable(block)) continue;
+
+            VList* stub = pool_->allocate(0);
+            const VListSpillRef ref{&file, file.write(block->getDataAddr(), block->offset)};
+            std::copy_n(reinterpret_cast<const uint8_t*>(&ref), sizeof(ref), stub->getDataAddr());
+            stub->next = block->next;
+            stub->offset = block->offset;
+            stub->spilled = 1;
+            (previous == nullptr ? head_ : previous->next) = stub;
+            if (tail_ == block) tail_ = stub;
+
+            released += block->size() - vlistClassSize(0);
+            block->next = nullptr;
+            pool_->release(block);
+            block = stub;
+        }
+        return released;
+    }
+
+    /// @brief Oldest block of the list, nullptr while the values fit in the inline bytes.
+    [[nodiscard]] const VList* head() const { return head_; }
+
+    /// @brief The oldest bytes of the list, stored before any block.
+    [[nodiscard]] const uint8_t* inlineData() const { return inline_; }
+    [[nodiscard]] uint32_t inlineSize() const { return inline_size_; }
+
+   private:
+    static bool spillable(const VList* block) { return !block->spilled && block->offset >= VLIST_MIN_SPILL_SIZE; }
+
+    /// @brief Size class of the next block: one larger than the last, up to VLIST_MAX_BLOCK_SIZE. Start over after a spill.
+    [[nodiscard]] unsigned nextClass() const {
+        if (tail_ == nullptr) return 1;
+        if (tail_->spilled) return VLIST_SPILL_RESTART_CLASS;
+        return std::min<unsigned>(tail_->size_class + 1, VLIST_SIZE_CLASSES - 1);
+    }
+
+    template <typename T>
+    void addValue(const T data) {
+        // Most varints are encoded straight into the last block. A stub is never appended to, its offset is beyond its size
+        if (tail_ != nullptr && tail_->offset + MAX_VARINT_SIZE<T> <= tail_->size()) {
+            tail_->offset += static_cast<uint32_t>(encode(data, tail_->getDataAddr() + tail_->offset));
+            return;
+        }
+
+        uint8_t buffer[MAX_VARINT_SIZE<T>];  // MSB of each byte shows if a next byte exists
+        addBytes(buffer, encode(data, buffer));
+    }
+
+    void append(VList* block) {
+        tail_base_ = size();
+        (tail_ == nullptr ? head_ : tail_->next) = block;
+        tail_ = block;
+    }
+
+    void takeInline(VListManager& other) {
+        std::copy_n(other.inline_, other.inline_size_, inline_);
+        inline_size_ = std::exchange(other.inline_size_, 0);
+    }
+
+    void release() {
+        if (head_ != nullptr) pool_->release(head_);
+        head_ = nullptr;
+        tail_ = nullptr;
+        tail_base_ = 0;
+    }
+
+    VListPool* pool_;
+    VList* head_ = nullptr;   //!< Oldest block
+    VList* tail_ = nullptr;   //!< Block being appended to
+    uint64_t tail_base_ = 0;  //!< Bytes of the list before the tail block
+    uint8_t inline_size_ = 0;
+    uint8_t inline_[VLIST_INLINE_SIZE];
+};
+
+/**
+ * @brief Decode the varints of a VListManager in insertion order, its inline bytes first.
+ * Spilled blocks are paged back in to a buffer of the reader, contiguous ones with a single read.
+ */
+class VListReader {
+   public:
+    explicit VListReader(const VListManager& manager) : next_(manager.head()), data_(manager.inlineData()), size_(manager.inlineSize()) {}
+
+    /**
+     * @brief Start decoding at a byte of the list, eg. a position VListManager::size() returned before a value
+     * was added. The blocks before it are skipped without being read, spilled or not.
+     */
+    VListReader(const VListManager& manager, const uint64_t position) : VListReader(manager) {
+        if (position <= size_) {
+            pos_ = static_cast<uint32_t>(position);
+            return;
+        }
+        base_ = size_;
+        while (next_ != nullptr && base_ + next_->offset <= position) {
+            base_ += next_->offset;
+            next_ = next_->next;
+        }
+        size_ = 0;
+        pos_ = 0;
+        if (nextBlock()) pos_ = static_cast<uint32_t>(position - base_);
+    }
+
+    /// @brief Byte of the list where the next varint starts.
+    [[nodiscard]] uint64_t position() const { return base_ + pos_; }
+
+    /// @brief The byte of the list at a position is in the current block, seek() moves there without reading.
+    [[nodiscard]] bool holds(const uint64_t position) const { return position >= base_ && position <= base_ + size_; }
+
+    /**
+     * @brief Move to a byte of the current block, eg. back to where one of its varints started.
+     * @return false, nothing moved, when the byte is in another block.
+     */
+    bool seek(const uint64_t position) {
+        if (!holds(position)) return false;
+        pos_ = static_cast<uint32_t>(position - base_);
+        return true;
+    }
+
+    /**
+     * @brief Hint that a byte of a list is read soon: a spilled block holding it starts being read
+     * from its file, eg. the block before the one a backward walk is in.
+     */
+    static void prefetch(const VListManager& manager, const uint64_t position) {
+        uint64_t base = manager.inlineSize();
+        for (const VList* block = manager.head(); block != nullptr && base <= position; block = block->next) {
+            if (position < base + block->offset) {
+                if (block->spilled) spillRef(block).file->prefetch(spillRef(block).offset, block->offset);
+                return;
+            }
+            base += block->offset;
+        }
+    }
+
+    /**
+     * @brief Decode the next varint.
+     * @param value Receives the decoded value.
+     * @return false once every stored value has been read.
+     */
+    bool next(uint32_t& value) { return decode(value); }
+
+    /// @brief Decode the next varint, one added with VListManager::addData64().
+    bool next(uint64_t& value) { return decode(value); }
+
    private:
-    VList* head_;
+    template <typename T>
+    bool decode(T& value) {
+        if (size_ - pos_ < VListManager::MAX_VARINT_SIZE<T>) return nextAcrossBlocks(value);
+
+        // The whole varint is in the current block. Decoded in a local, that the caller's value does not alias pos_
+        const uint8_t* p = data_ + pos_;
+        T decoded = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            const uint8_t byte = *p++;
+            decoded |= static_cast<T>(byte & 0x7F) << shift;
+            if (byte & 0x80) break;
+        }
+        pos_ = static_cast<uint32_t>(p - data_);
+        value = decoded;
+        return true;
+    }
+
+    /// @brief decode() for a varint that may end in a following block, apart so that the common case inlines well.
+    template <typename T>
+    bool nextAcrossBlocks(T& value) {
+        T decoded = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            if (pos_ >= size_ && !nextBlock()) return false;
+
+            const uint8_t byte = data_[pos_++];
+            decoded |= static_cast<T>(byte & 0x7F) << shift;
+            if (byte & 0x80) {  // Last byte of the varint
+                value = decoded;
+                return true;
+            }
+        }
+    }
+
+    static VListSpillRef spillRef(const VList* block) {
+        VListSpillRef ref{};
+        std::copy_n(block->getDataAddr(), sizeof(ref), reinterpret_cast<uint8_t*>(&ref));
+        return ref;
+    }
+
+    bool nextBlock() {
+        while (next_ != nullptr) {
+            const VList* block = next_;
+            next_ = block->next;
+            base_ += size_;
+            pos_ = 0;
+            size_ = block->offset;
+            if (!block->spilled) {
+                data_ = block->getDataAddr();
+            } else {
+                if (buffered_blocks_ == 0) page(block);
+                data_ = buffer_.data() + buffered_pos_;
+                buffered_pos_ += size_;
+                buffered_blocks_--;
+            }
+            if (size_ > 0) return true;
+        }
+        return false;
+    }
+
+    /// @brief Read a block, and the following ones stored right after it in the same file.
+    void page(const VList* first_block) {
+        const VListSpillRef first = spillRef(first_block);
+        size_t bytes = first_block->offset;
+        buffered_blocks_ = 1;
+        for (const VList* block = first_block->next; block != nullptr && block->spilled; block = block->next) {
+            const VListSpillRef ref = spillRef(block);
+            if (bytes + block->offset > VLIST_READ_AHEAD) break;
+            if (ref.file != first.file || ref.offset != first.offset + bytes) break;
+            bytes += block->offset;
+            buffered_blocks_++;
+        }
+        buffer_.resize(bytes);
+        first.file->read(first.offset, buffer_.data(), bytes);
+        buffered_pos_ = 0;
+    }
+
+    const VList* next_;              //!< Next block
+    const uint8_t* data_ = nullptr;  //!< Data of the current block
+    uint32_t size_ = 0;
+    uint32_t pos_ = 0;
+    uint64_t base_ = 0;  //!< Bytes of the list before the current block
+
+    std::vector<uint8_t> buffer_;  //!< Spilled blocks paged in
+    size_t buffered_blocks_ = 0;   //!< Blocks of buffer_ not read yet
+    size_t buffered_pos_ = 0;      //!< Start of the next block in buffer_
 };
 
 }  // namespace VCDP_NAMESPACE
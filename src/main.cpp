@@ -1,34 +1,123 @@
+#include <algorithm>
 #include <argparse/argparse.hpp>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <csignal>
 #include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "vcdp/ThreadPool.hpp"
 #include "vcdp/VCDP.hpp"
 
 constexpr const char* SECTION_SEPARATOR = "\n\n";
+constexpr uint64_t MIB = 1024 * 1024;
 
-void PrintScope(const vcdp::VCDScope* scope, std::vector<bool> last_flags);
-void PrintSectionBanner(const std::string& title);
+/// @brief Bytes that the files being parsed at the same time are allowed to use.
+class MemoryBudget {
+   public:
+    explicit MemoryBudget(const uint64_t limit) : limit_(limit) {}
+
+    /// @brief Wait until `bytes` fit in the budget. A file larger than the whole budget runs alone.
+    void Acquire(const uint64_t bytes) {
+        std::unique_lock lock(mutex_);
+        released_.wait(lock, [&] { return in_use_ == 0 || in_use_ + bytes <= limit_; });
+        in_use_ += bytes;
+    }
+
+    void Release(const uint64_t bytes) {
+        {
+            std::lock_guard lock(mutex_);
+            in_use_ -= bytes;
+        }
+        released_.notify_all();
+    }
+
+   private:
+    uint64_t limit_;
+    uint64_t in_use_ = 0;
+    std::mutex mutex_;
+    std::condition_variable released_;
+};
+
+std::vector<std::string> ExpandGlobs(const std::vector<std::string>& patterns);
+void WriteProfiles(const std::string& destination, const std::vector<std::string>& files, const std::vector<vcdp::VCDProfile>& profiles);
+int Extract(const argparse::ArgumentParser& program, const std::string& file_path);
+int Convert(int argc, char const* argv[]);
+int Diff(int argc, char const* argv[]);
+int Export(int argc, char const* argv[]);
+int Merge(int argc, char const* argv[]);
+void ReportTrace(const argparse::ArgumentParser& program, const std::string& file_path, const vcdp::VCDParser& parser, const vcdp::VCDFile& trace,
+                 std::ostream& os);
+void PrintScope(const vcdp::VCDFile& trace, const vcdp::VCDScope& scope, std::vector<bool> last_flags, std::ostream& os);
+void PrintSectionBanner(const std::string& title, std::ostream& os);
 
 int main(const int argc, char const* argv[]) {
 #ifdef _WIN32
     system("chcp 65001 > nul");
 #endif
 
-    std::string file_path;
+    // A subcommand cannot follow the variadic positional of the main parser, so it is dispatched first
+    if (argc > 1 && std::string(argv[1]) == "convert") return Convert(argc - 1, argv + 1);
+    if (argc > 1 && std::string(argv[1]) == "diff") return Diff(argc - 1, argv + 1);
+    if (argc > 1 && std::string(argv[1]) == "export") return Export(argc - 1, argv + 1);
+    if (argc > 1 && std::string(argv[1]) == "merge") return Merge(argc - 1, argv + 1);
+
+    std::vector<std::string> file_patterns;
     argparse::ArgumentParser program("vcdp", "0.0.1");
-    program.add_argument("vcd_file").help("VCD file to parse").store_into(file_path);
+    program.add_description(
+        "Parse VCD files. Run 'vcdp convert <vcd_file> <archive>' to write a block-compressed archive, "
+        "'vcdp diff <vcd_a> <vcd_b>' to compare two waveforms, "
+        "'vcdp export <vcd_file> <table>' to write signals as a CSV or Arrow table, "
+        "'vcdp merge <vcd_files> -o <vcd_file>' to merge split dumps into one.");
+    program.add_argument("vcd_files")
+        .help("VCD file(s) to parse, wildcards are expanded")
+        .nargs(argparse::nargs_pattern::at_least_one)
+        .store_into(file_patterns);
     program.add_argument("--verbose").help("Increase output verbosity").default_value(false).implicit_value(true);
     program.add_argument("-t", "--tree").help("Print the scope & var hierarchy").default_value(false).implicit_value(true);
     program.add_argument("--stats")
         .help("Print stats: number of scopes, variables, changes, duration, etc.")
         .default_value(false)
         .implicit_value(true);
-    program.add_argument("--symbol").help("Signal name to observe").nargs(1);
+    program.add_argument("--symbol")
+        .help("Signal name to observe, or bit ranges of vectors, eg. \"tb.bus[63:32]\" or \"{tb.status[7], tb.data[3:0]}\"")
+        .nargs(1);
+    program.add_argument("--find")
+        .help("Print the times at which a condition holds, eg. \"tb.valid && !tb.ready for 3 @ tb.clk\"")
+        .nargs(1);
+    program.add_argument("--extract")
+        .help("Write the selected signals and time window of the VCD file to this file, gzip compressed if it ends with .gz")
+        .nargs(1);
+    program.add_argument("--select").help("Signal kept by --extract: wildcard pattern on the dotted hierarchical name or the identifier code").append();
+    program.add_argument("--from").help("First time written by --extract").default_value(uint64_t{0}).scan<'u', uint64_t>();
+    program.add_argument("--to").help("Last time written by --extract").default_value(UINT64_MAX).scan<'u', uint64_t>();
+    program.add_argument("--compact-ids").help("Renumber the identifier codes written by --extract").default_value(false).implicit_value(true);
+    program.add_argument("--profile").help("Write per-phase timings and memory usage as JSON to a file, '-' for stdout").nargs(1);
+    program.add_argument("--batch")
+        .help("Parse every file without pausing at the end (implied by several files or a wildcard)")
+        .default_value(false)
+        .implicit_value(true);
+    program.add_argument("-j", "--jobs").help("Number of worker threads, 0 for one per core").default_value(0u).scan<'u', unsigned>();
+    program.add_argument("--memory-budget")
+        .help("MiB that the files parsed concurrently may use in batch mode")
+        .default_value(uint64_t{1024})
+        .scan<'u', uint64_t>();
+    program.add_argument("--memory-limit")
+        .help("MiB of value changes each parse keeps in memory, the rest goes to a temporary file. 0 for no limit")
+        .default_value(uint64_t{0})
+        .scan<'u', uint64_t>();
+    program.add_argument("--large-file")
+        .help("Files above this many MiB are parsed one at a time with all threads")
+        .default_value(uint64_t{64})
+        .scan<'u', uint64_t>();
 
     try {
         program.parse_args(argc, argv);
@@ -38,106 +127,560 @@ int main(const int argc, char const* argv[]) {
         return 1;
     }
 
+    const std::vector<std::string> files = ExpandGlobs(file_patterns);
+    if (files.empty()) {
+        std::cerr << vcdp::color::RED << "No VCD file matches the given path(s)" << vcdp::color::RESET << std::endl;
+        return 1;
+    }
+
+    if (program.is_used("--extract")) {
+        if (files.size() != 1) {
+            std::cerr << vcdp::color::RED << "--extract takes a single VCD file" << vcdp::color::RESET << std::endl;
+            return 1;
+        }
+        return Extract(program, files.front());
+    }
+
+    const bool batch = program.get<bool>("--batch") || files.size() > 1 || files.front() != file_patterns.front();
+    const unsigned jobs = program.get<unsigned>("--jobs") == 0 ? vcdp::ThreadPool::defaultThreadCount() : program.get<unsigned>("--jobs");
+    const bool profile = program.is_used("--profile");
+    const uint64_t memory_limit = program.get<uint64_t>("--memory-limit") * MIB;
+    std::vector<vcdp::VCDProfile> profiles(files.size());
+
+    if (!batch) {
+        vcdp::VCDParser parser;
+        vcdp::VCDFile trace;
+        vcdp::ParseOptions options;
+        options.threads = jobs;
+        options.profile = profile;
+        options.memory_limit = memory_limit;
+
+        parser.parse(files.front(), &trace, options);
+        ReportTrace(program, files.front(), parser, trace, std::cout);
+        if (profile) {
+            profiles.front() = parser.GetResult().profile;
+            WriteProfiles(program.get<std::string>("--profile"), files, profiles);
+        }
+
+        std::cout << "\nPress any key to exit...";
+        std::cin.get();
+        return 0;
+    }
+
+    // Small files: one file per thread. Large files: one file at a time, each using every thread.
+    std::vector<size_t> small_files;
+    std::vector<size_t> large_files;
+    for (size_t i = 0; i < files.size(); i++) {
+        std::error_code ec;
+        const uint64_t size = std::filesystem::file_size(files[i], ec);
+        (!ec && size > program.get<uint64_t>("--large-file") * MIB ? large_files : small_files).push_back(i);
+    }
+
+    std::mutex output_mutex;
+    std::atomic<size_t> failures = 0;
+    const auto parse_and_report = [&](const size_t index, const unsigned threads) {
+        const std::string& file = files[index];
+        vcdp::VCDParser parser;
+        vcdp::VCDFile trace;
+        vcdp::ParseOptions options;
+        options.threads = threads;
+        options.profile = profile;
+        options.memory_limit = memory_limit;
+        parser.parse(file, &trace, options);
+        if (!parser.GetResult().success) failures++;
+        profiles[index] = parser.GetResult().profile;
+
+        std::ostringstream report;
+        ReportTrace(program, file, parser, trace, report);
+        std::lock_guard lock(output_mutex);
+        std::cout << report.str() << std::flush;
+    };
+
+    MemoryBudget budget(program.get<uint64_t>("--memory-budget") * MIB);
+    {
+        vcdp::ThreadPool pool(jobs);
+        for (const size_t index : small_files) {
+            pool.submit([&, index] {
+                std::error_code ec;
+                const uint64_t cost = std::filesystem::file_size(files[index], ec);
+                budget.Acquire(cost);
+                parse_and_report(index, 1);
+                budget.Release(cost);
+            });
+        }
+        pool.wait();
+    }
+
+    for (const size_t index : large_files) {
+        parse_and_report(index, jobs);
+    }
+
+    if (profile) WriteProfiles(program.get<std::string>("--profile"), files, profiles);
+
+    std::cout << files.size() - failures << "/" << files.size() << " file(s) parsed successfully" << std::endl;
+    return failures == 0 ? 0 : 2;
+}
+
+std::vector<std::string> ExpandGlobs(const std::vector<std::string>& patterns) {
+    std::vector<std::string> files;
+    for (const auto& pattern : patterns) {
+        if (pattern.find_first_of("*?") == std::string::npos) {
+            files.push_back(pattern);
+            continue;
+        }
+
+        // Wildcards are only supported in the file name
+        const std::filesystem::path path(pattern);
+        const std::filesystem::path directory = path.has_parent_path() ? path.parent_path() : ".";
+        const std::string name_pattern = path.filename().string();
+
+        std::vector<std::string> matches;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+            if (entry.is_regular_file() && vcdp::utils::matchWildcard(name_pattern, entry.path().filename().string())) {
+                matches.push_back(entry.path().string());
+            }
+        }
+        std::sort(matches.begin(), matches.end());
+        files.insert(files.end(), matches.begin(), matches.end());
+    }
+    return files;
+}
+
+int Extract(const argparse::ArgumentParser& program, const std::string& file_path) {
+    const auto output = program.get<std::string>("--extract");
+
+    vcdp::WriteOptions options;
+    if (program.is_used("--select")) options.signals = program.get<std::vector<std::string>>("--select");
+    options.begin = program.get<uint64_t>("--from");
+    options.end = program.get<uint64_t>("--to");
+    options.compact_ids = program.get<bool>("--compact-ids");
+    options.gzip = output.size() > 3 && output.compare(output.size() - 3, 3, ".gz") == 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    vcdp::VCDWriter writer(options);
+    const vcdp::VCDWriteResult result = writer.extract(file_path, output);
+    const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+
+    if (program["--verbose"] == true) writer.GetParseResult().PrintWarnings();
+    if (!result.success) {
+        std::cerr << vcdp::color::RED << result.error << vcdp::color::RESET << std::endl;
+        return 2;
+    }
+
+    std::cout << result.signals << " signal(s), " << result.changes << " value change(s), " << result.bytes << " bytes written to " << output
+              << " in " << duration.count() << " ms" << std::endl;
+    return 0;
+}
+
+int Convert(const int argc, char const* argv[]) {
+    argparse::ArgumentParser command("vcdp convert", "0.0.1");
+    command.add_description("Convert a VCD file to a block-compressed archive whose signals can be read one at a time");
+    command.add_argument("vcd_file").help("VCD file to convert");
+    command.add_argument("archive").help("Archive to write");
+    command.add_argument("-l", "--level").help("Compression level, 1 (fastest) to 12 (smallest)").default_value(6).scan<'i', int>();
+    command.add_argument("--block-size").help("KiB of value changes per compressed block").default_value(64u).scan<'u', unsigned>();
+    command.add_argument("-j", "--jobs").help("Number of worker threads, 0 for one per core").default_value(0u).scan<'u', unsigned>();
+    command.add_argument("--verbose").help("Increase output verbosity").default_value(false).implicit_value(true);
+
+    try {
+        command.parse_args(argc, argv);
+    } catch (const std::exception& err) {
+        std::cerr << vcdp::color::RED << err.what() << vcdp::color::RESET << std::endl;
+        std::cerr << vcdp::color::RED << command << vcdp::color::RESET << std::endl;
+        return 1;
+    }
+
+    const auto input = command.get<std::string>("vcd_file");
+    const auto output = command.get<std::string>("archive");
+    const auto start = std::chrono::steady_clock::now();
+
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    vcdp::ParseOptions parse_options;
+    parse_options.threads = command.get<unsigned>("--jobs") == 0 ? vcdp::ThreadPool::defaultThreadCount() : command.get<unsigned>("--jobs");
+    parser.parse(input, &trace, parse_options);
+    if (command["--verbose"] == true) {
+        parser.GetResult().PrintErrors();
+        parser.GetResult().PrintWarnings();
+    }
+
+    vcdp::ArchiveOptions options;
+    options.compression_level = command.get<int>("--level");
+    options.block_size = command.get<unsigned>("--block-size") * 1024;
+    const vcdp::VCDWriteResult result = vcdp::VCDArchiveWriter(options).write(trace, output);
+    const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    if (!result.success) {
+        std::cerr << vcdp::color::RED << result.error << vcdp::color::RESET << std::endl;
+        return 2;
+    }
+
+    std::error_code ec;
+    const uint64_t input_size = std::filesystem::file_size(input, ec);
+    std::cout << result.signals << " signal(s), " << result.changes << " value change(s), " << result.bytes << " bytes written to " << output;
+    if (!ec && result.bytes > 0) std::cout << " (" << static_cast<double>(input_size) / static_cast<double>(result.bytes) << "x smaller)";
+    std::cout << " in " << duration.count() << " ms" << std::endl;
+
+    // What could be parsed is archived, the lines in error are not
+    if (!parser.GetResult().success) {
+        std::cerr << vcdp::color::RED << parser.GetResult().errors.Total() << " error(s) in " << input << vcdp::color::RESET << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+int Diff(const int argc, char const* argv[]) {
+    argparse::ArgumentParser command("vcdp diff", "0.0.1");
+    command.add_description("Compare the signals of two VCD files by hierarchical name. Exits with 0 if identical, 1 if different, 2 on error");
+    command.add_argument("vcd_a").help("Reference VCD file, eg. the golden trace");
+    command.add_argument("vcd_b").help("VCD file compared to it");
+    command.add_argument("--select").help("Compared signal: wildcard pattern on the dotted hierarchical name").append();
+    command.add_argument("--windows").help("Mismatch windows printed per signal").default_value(size_t{4}).scan<'u', size_t>();
+    command.add_argument("-j", "--jobs").help("Number of worker threads, 0 for one per core").default_value(0u).scan<'u', unsigned>();
+    command.add_argument("--verbose").help("Increase output verbosity").default_value(false).implicit_value(true);
+
+    try {
+        command.parse_args(argc, argv);
+    } catch (const std::exception& err) {
+        std::cerr << vcdp::color::RED << err.what() << vcdp::color::RESET << std::endl;
+        std::cerr << vcdp::color::RED << command << vcdp::color::RESET << std::endl;
+        return 2;
+    }
+
+    const auto path_a = command.get<std::string>("vcd_a");
+    const auto path_b = command.get<std::string>("vcd_b");
+
+    vcdp::DiffOptions options;
+    if (command.is_used("--select")) options.signals = command.get<std::vector<std::string>>("--select");
+    options.threads = command.get<unsigned>("--jobs");
+    options.max_windows = command.get<size_t>("--windows");
+
+    const auto start = std::chrono::steady_clock::now();
+    vcdp::VCDDiff diff(options);
+    const vcdp::VCDDiffResult result = diff.compare(path_a, path_b);
+    const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+
+    if (command["--verbose"] == true) {
+        for (size_t trace = 0; trace < 2; trace++) {
+            diff.GetParseResult(trace).PrintErrors();
+            diff.GetParseResult(trace).PrintWarnings();
+        }
+    }
+    if (!result.success) {
+        std::cerr << vcdp::color::RED << result.error << vcdp::color::RESET << std::endl;
+        return 2;
+    }
+
+    for (const auto& signal : result.signals) {
+        if (!signal.Differs()) continue;
+
+        std::cout << vcdp::color::RED << signal.path << vcdp::color::RESET << ": " << signal.mismatches << " mismatch(es) in " << signal.window_count
+                  << " window(s), first at " << signal.first_divergence;
+        for (const auto& window : signal.windows) {
+            std::cout << " [" << window.begin << ", ";
+            if (window.end == UINT64_MAX) {
+                std::cout << "end]";
+            } else {
+                std::cout << window.end << ")";
+            }
+        }
+        if (signal.windows.size() < signal.window_count) std::cout << " ...";
+        if (signal.size_a != signal.size_b) std::cout << " (sizes " << signal.size_a << " and " << signal.size_b << ")";
+        std::cout << std::endl;
+    }
+    for (const auto& path : result.only_in_a) std::cout << "Only in " << path_a << ": " << path << std::endl;
+    for (const auto& path : result.only_in_b) std::cout << "Only in " << path_b << ": " << path << std::endl;
+
+    std::cout << result.DifferingSignals() << "/" << result.signals.size() << " signal(s) differ up to time " << result.end_time << ", compared in "
+              << duration.count() << " ms" << std::endl;
+    return result.Identical() ? 0 : 1;
+}
+
+int Export(const int argc, char const* argv[]) {
+    argparse::ArgumentParser command("vcdp export", "0.0.1");
+    command.add_description("Export signals as a table, one row per value change or per rising edge of a clock");
+    command.add_argument("vcd_file").help("VCD file to export");
+    command.add_argument("output").help("Table to write, an Arrow IPC file (Feather v2) if it ends with .arrow or .feather, CSV otherwise");
+    command.add_argument("--select").help("Exported signal: wildcard pattern on the dotted hierarchical name or the identifier code").append();
+    command.add_argument("--clock").help("Dotted hierarchical name of a 1-bit clock, to sample the signals on its rising edges");
+    command.add_argument("--format").help("Output format, csv or arrow, instead of guessing it from the output extension");
+    command.add_argument("-j", "--jobs").help("Number of worker threads, 0 for one per core").default_value(0u).scan<'u', unsigned>();
+    command.add_argument("--verbose").help("Increase output verbosity").default_value(false).implicit_value(true);
+
+    try {
+        command.parse_args(argc, argv);
+    } catch (const std::exception& err) {
+        std::cerr << vcdp::color::RED << err.what() << vcdp::color::RESET << std::endl;
+        std::cerr << vcdp::color::RED << command << vcdp::color::RESET << std::endl;
+        return 1;
+    }
+
+    const auto input = command.get<std::string>("vcd_file");
+    const auto output = command.get<std::string>("output");
+    const unsigned jobs = command.get<unsigned>("--jobs") == 0 ? vcdp::ThreadPool::defaultThreadCount() : command.get<unsigned>("--jobs");
+
+    vcdp::ExportOptions options;
+    if (command.is_used("--select")) options.signals = command.get<std::vector<std::string>>("--select");
+    if (command.is_used("--clock")) options.clock = command.get<std::string>("--clock");
+    options.threads = jobs;
+    const std::string extension = std::filesystem::path(output).extension().string();
+    std::string format = extension == ".arrow" || extension == ".feather" ? "arrow" : "csv";
+    if (command.is_used("--format")) format = command.get<std::string>("--format");
+    if (format != "csv" && format != "arrow") {
+        std::cerr << vcdp::color::RED << "Unknown format " << format << ", expected csv or arrow" << vcdp::color::RESET << std::endl;
+        return 1;
+    }
+    options.format = format == "arrow" ? vcdp::ExportFormat::ARROW : vcdp::ExportFormat::CSV;
+
+    const auto start = std::chrono::steady_clock::now();
     vcdp::VCDParser parser;
     vcdp::VCDFile trace;
+    vcdp::ParseOptions parse_options;
+    parse_options.threads = jobs;
+    parser.parse(input, &trace, parse_options);
+    if (command["--verbose"] == true) {
+        parser.GetResult().PrintErrors();
+        parser.GetResult().PrintWarnings();
+    }
 
-    parser.parse(file_path, &trace);
+    const vcdp::VCDExportResult result = vcdp::VCDExporter(options).write(trace, output);
+    const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    if (!result.success) {
+        std::cerr << vcdp::color::RED << result.error << vcdp::color::RESET << std::endl;
+        return 2;
+    }
+    std::cout << result.rows << " row(s) of " << result.columns << " signal(s), " << result.bytes << " bytes written to " << output << " in "
+              << duration.count() << " ms" << std::endl;
+
+    if (!parser.GetResult().success) {
+        std::cerr << vcdp::color::RED << parser.GetResult().errors.Total() << " error(s) in " << input << vcdp::color::RESET << std::endl;
+        return 2;
+    }
+    return 0;
+}
 
+int Merge(const int argc, char const* argv[]) {
+    argparse::ArgumentParser command("vcdp merge", "0.0.1");
+    command.add_description("Merge VCD files split by time or by design partition into one VCD file, without storing their value changes");
+    command.add_argument("vcd_files").help("VCD files to merge, wildcards are expanded").nargs(argparse::nargs_pattern::at_least_one);
+    command.add_argument("-o", "--output").help("VCD file to write").required();
+    command.add_argument("--root").help("Scope wrapping the top scopes of every file");
+    command.add_argument("--select").help("Written signal: wildcard pattern on the dotted hierarchical name or the identifier code").append();
+    command.add_argument("--gzip").help("Compress the output with gzip").default_value(false).implicit_value(true);
+    command.add_argument("-j", "--jobs").help("Number of worker threads, 0 for one per core").default_value(0u).scan<'u', unsigned>();
+    command.add_argument("--verbose").help("Increase output verbosity").default_value(false).implicit_value(true);
+
+    try {
+        command.parse_args(argc, argv);
+    } catch (const std::exception& err) {
+        std::cerr << vcdp::color::RED << err.what() << vcdp::color::RESET << std::endl;
+        std::cerr << vcdp::color::RED << command << vcdp::color::RESET << std::endl;
+        return 1;
+    }
+
+    const std::vector<std::string> files = ExpandGlobs(command.get<std::vector<std::string>>("vcd_files"));
+    const auto output = command.get<std::string>("--output");
+
+    vcdp::MergeOptions options;
+    if (command.is_used("--root")) options.root = command.get<std::string>("--root");
+    options.threads = command.get<unsigned>("--jobs");
+    vcdp::WriteOptions write_options;
+    if (command.is_used("--select")) write_options.signals = command.get<std::vector<std::string>>("--select");
+    write_options.gzip = command.get<bool>("--gzip");
+
+    const auto start = std::chrono::steady_clock::now();
+    vcdp::VCDMerger merger(options);
+    const vcdp::VCDMergeResult result = merger.write(files, output, write_options);
+    const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+
+    if (command["--verbose"] == true) {
+        for (const auto& parse_result : merger.GetParseResults()) {
+            parse_result.PrintErrors();
+            parse_result.PrintWarnings();
+        }
+    }
+    if (!result.success) {
+        std::cerr << vcdp::color::RED << result.error << vcdp::color::RESET << std::endl;
+        return 2;
+    }
+    std::cout << files.size() << " file(s) merged into " << result.signals << " signal(s) (" << result.shared << " shared, " << result.remapped
+              << " identifier code(s) remapped), " << result.changes << " value change(s), " << result.bytes << " bytes written to " << output
+              << " in " << duration.count() << " ms" << std::endl;
+
+    // What could be parsed is merged, the lines in error are not
+    for (size_t i = 0; i < files.size(); i++) {
+        if (merger.GetParseResults()[i].success) continue;
+        std::cerr << vcdp::color::RED << merger.GetParseResults()[i].errors.Total() << " error(s) in " << files[i] << vcdp::color::RESET << std::endl;
+        return 2;
+    }
+    return 0;
+}
+
+void WriteProfiles(const std::string& destination, const std::vector<std::string>& files, const std::vector<vcdp::VCDProfile>& profiles) {
+    std::ofstream file_stream;
+    if (destination != "-") {
+        file_stream.open(destination);
+        if (!file_stream) {
+            std::cerr << vcdp::color::RED << "Unable to write the profile to " << destination << vcdp::color::RESET << std::endl;
+            return;
+        }
+    }
+    std::ostream& os = destination == "-" ? std::cout : file_stream;
+
+    // One object per file, in command line order
+    os << "[\n";
+    for (size_t i = 0; i < files.size(); i++) {
+        std::string path;
+        for (const char c : files[i]) {
+            if (c == '"' || c == '\\') path += '\\';
+            path += c;
+        }
+        os << "  {\"file\": \"" << path << "\", \"profile\": ";
+        profiles[i].WriteJson(os);
+        os << "}" << (i + 1 < files.size() ? "," : "") << "\n";
+    }
+    os << "]" << std::endl;
+}
+
+void ReportTrace(const argparse::ArgumentParser& program, const std::string& file_path, const vcdp::VCDParser& parser, const vcdp::VCDFile& trace,
+                 std::ostream& os) {
+    PrintSectionBanner(file_path, os);
+
+    const auto& result = parser.GetResult();
+    if (!result.success) {
+        os << vcdp::color::RED << "Failed: " << result.errors.Total() << " error(s)" << vcdp::color::RESET << std::endl;
+    }
     if (program["--verbose"] == true) {
-        for (const auto& msg : parser.GetResult().errors) {
-            std::cerr << vcdp::color::RED << msg << vcdp::color::RESET << std::endl;
+        for (const auto& msg : result.errors) {
+            os << vcdp::color::RED << msg << vcdp::color::RESET << std::endl;
         }
     }
 
     if (program.is_used("--tree")) {
-        PrintSectionBanner("VCD SST");
+        PrintSectionBanner("VCD SST", os);
 
-        std::vector<vcdp::VCDScope*> top_scopes;
-        for (auto& scope : trace.getScopes()) {
-            // Top scopes
-            if (scope->parent == nullptr) top_scopes.push_back(scope.get());
+        for (const auto& scope : trace.getTopScopes()) {
+            PrintScope(trace, scope, {}, os);
         }
 
-        for (const auto& scope : top_scopes) {
-            PrintScope(scope, {});
+        os << SECTION_SEPARATOR;
+    }
+
+    if (program.is_used("--stats")) {
+        PrintSectionBanner("VCD Stats", os);
+
+        uint64_t changes = 0;
+        for (const auto& signal : trace.getSignals()) {
+            changes += signal.change_count;
         }
 
-        std::cout << SECTION_SEPARATOR;
+        os << "Scopes: " << trace.getScopes().size() << std::endl;
+        os << "Signals: " << trace.getSignals().size() << std::endl;
+        os << "Timestamps: " << trace.getTimestamps().size() << std::endl;
+        os << "Value changes: " << changes << std::endl;
+        os << "Timescale: " << static_cast<int>(trace.time_resolution) << vcdp::utils::vcdTimeUnit2String(trace.time_units) << std::endl;
+        os << "Date: " << trace.date << std::endl;
+        os << "Version: " << trace.version << std::endl;
+        os << "Errors: " << result.errors.Total() << std::endl;
+        os << "Warnings: " << result.warnings.Total() << std::endl;
+        os << SECTION_SEPARATOR;
     }
 
-    if (program.is_used("--stats")) {
-        PrintSectionBanner("VCD Stats");
+    if (program.is_used("--find")) {
+        PrintSectionBanner("VCD Find", os);
 
-        if (program["--verbose"] == true) {
-            for (const auto& msg : parser.GetResult().errors) {
-                std::cerr << vcdp::color::RED << msg << vcdp::color::RESET << std::endl;
+        const vcdp::VCDSearchResult found = vcdp::VCDSearch(program.get<std::string>("--find")).find(trace);
+        if (!found.success) {
+            os << vcdp::color::RED << found.error << vcdp::color::RESET << std::endl;
+        } else {
+            os << "Matches: " << found.matches.size() << std::endl;
+            for (const auto& match : found.matches) {
+                os << match.begin << " - ";
+                if (match.end == UINT64_MAX) {
+                    os << "end";
+                } else {
+                    os << match.end;
+                }
+                os << std::endl;
             }
         }
-
-        std::cout << "Scopes: " << trace.getScopes().size() << std::endl;
-        std::cout << "Signals: " << trace.getSignals().size() << std::endl;
-        std::cout << "Timescale: " << trace.time_resolution << vcdp::utils::vcdTimeUnit2String(trace.time_units) << std::endl;
-        std::cout << "Date: " << trace.date << std::endl;
-        std::cout << "Version: " << trace.version << std::endl;
-        std::cout << SECTION_SEPARATOR;
+        os << SECTION_SEPARATOR;
     }
 
     if (program.is_used("--symbol")) {
         const auto symbol = program.get<std::string>("--symbol");
 
-        for (const auto& timestamp : trace.getTimestamps()) {
-            std::cout << timestamp << std::endl;
+        const vcdp::VCDSignal* found = trace.findSignal(symbol);
+        for (const auto& signal : trace.getSignals()) {
+            if (found == nullptr && signal.reference == symbol) found = &signal;
+        }
+        std::shared_ptr<const vcdp::VCDSignal> sliced;
+        if (found == nullptr && symbol.find_first_of("[{") != std::string::npos) {
+            try {
+                sliced = trace.slice(symbol);
+                found = sliced.get();
+            } catch (const std::invalid_argument& err) {
+                os << vcdp::color::RED << err.what() << vcdp::color::RESET << std::endl;
+                return;
+            }
         }
-    }
 
-    std::cout << "\nPress any key to exit...";
-    std::cin.get();
+        if (found == nullptr) {
+            os << vcdp::color::RED << "Unknown signal '" << symbol << "'" << vcdp::color::RESET << std::endl;
+            return;
+        }
 
-    return 0;
+        vcdp::VCDChangeReader reader(*found);
+        while (reader.next()) {
+            os << trace.getTimestamp(reader.timeIndex()) << " " << reader.value() << std::endl;
+        }
+    }
 }
 
-void PrintScope(const vcdp::VCDScope* scope, std::vector<bool> last_flags) {
+void PrintScope(const vcdp::VCDFile& trace, const vcdp::VCDScope& scope, std::vector<bool> last_flags, std::ostream& os) {
     // Print scope
     for (size_t i = 0; i + 1 < last_flags.size(); ++i) {
-        std::cout << (last_flags[i] ? "    " : "│   ");
+        os << (last_flags[i] ? "    " : "│   ");
     }
     if (!last_flags.empty()) {
-        std::cout << (last_flags.back() ? "└── " : "├── ");
+        os << (last_flags.back() ? "└── " : "├── ");
     }
-    std::cout << vcdp::color::MAGENTA << scope->name << vcdp::color::RESET << std::endl;
+    os << vcdp::color::MAGENTA << scope.name << vcdp::color::RESET << std::endl;
 
     // Print signals
-    for (size_t i = 0; i < scope->signals.size(); i++) {
+    const auto signals = trace.getScopeSignals(scope);
+    const auto children = trace.getScopeChildren(scope);
+    for (size_t i = 0; i < signals.size(); i++) {
         for (auto&& last_flag : last_flags) {
-            std::cout << (last_flag ? "    " : "│   ");
+            os << (last_flag ? "    " : "│   ");
         }
-        const bool last_signal = (i == scope->signals.size() - 1) && scope->children.empty();
-        std::cout << (last_signal ? "└── " : "├── ");
-        auto& signal = scope->signals.at(i);
+        const bool last_signal = (i == signals.size() - 1) && children.empty();
+        os << (last_signal ? "└── " : "├── ");
+        const auto& signal = trace.getSignals()[signals[i]];
         std::stringstream bit_index;
-        if (signal->lindex > -1)
-            bit_index << "[" << signal->lindex << ":" << signal->rindex << "] ";
-        else if (signal->rindex > -1)
-            bit_index << "[" << signal->rindex << "] ";
+        if (signal.lindex > -1)
+            bit_index << "[" << signal.lindex << ":" << signal.rindex << "] ";
+        else if (signal.rindex > -1)
+            bit_index << "[" << signal.rindex << "] ";
         else
             bit_index << "";
 
-        std::cout << vcdp::color::GREEN << signal->reference << vcdp::color::RESET << " : " << vcdp::color::BLUE
-                  << vcdp::utils::vcdVarType2String(signal->type) << " " << vcdp::color::RED << bit_index.str() << vcdp::color::RESET << "("
-                  << vcdp::color::YELLOW << "id" << vcdp::color::RESET << ": " << signal->hash << ")" << std::endl;
+        os << vcdp::color::GREEN << signal.reference << vcdp::color::RESET << " : " << vcdp::color::BLUE
+           << vcdp::utils::vcdVarType2String(signal.type) << " " << vcdp::color::RED << bit_index.str() << vcdp::color::RESET << "("
+           << vcdp::color::YELLOW << "id" << vcdp::color::RESET << ": " << signal.hash << ")" << std::endl;
     }
 
     // Recursive for children
-    for (size_t i = 0; i < scope->children.size(); ++i) {
-        const bool is_last = (i == scope->children.size() - 1);
+    for (size_t i = 0; i < children.size(); ++i) {
+        const bool is_last = (i == children.size() - 1);
         auto new_flags = last_flags;
         new_flags.push_back(is_last);
-        PrintScope(scope->children[i], new_flags);
+        PrintScope(trace, children[i], new_flags, os);
     }
 }
 
-void PrintSectionBanner(const std::string& title) {
-    std::cout << "==========================================\n";
-    std::cout << "[ " << title << " ]\n";
-    std::cout << "------------------------------------------\n";
+void PrintSectionBanner(const std::string& title, std::ostream& os) {
+    os << "==========================================\n";
+    os << "[ " << title << " ]\n";
+    os << "------------------------------------------\n";
 }
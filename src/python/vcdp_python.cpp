@@ -0,0 +1,300 @@
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "vcdp/VCDBodyDecoder.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace py = pybind11;
+
+namespace {
+
+/// @brief Parser of the module: a VCDParser and the diagnostics of its last parse or stream.
+struct Parser {
+    vcdp::VCDParser parser;
+    vcdp::VCDParseResult result;
+};
+
+/**
+ * @brief NumPy array over a vector, without copy: the array keeps the Python object owning
+ * the vector alive, and is read-only as the vector belongs to C++.
+ */
+template <typename T>
+py::array View(const std::vector<T>& data, const py::handle owner, const std::vector<py::ssize_t>& shape) {
+    py::array array(py::dtype::of<T>(), shape, data.data(), owner);
+    array.attr("flags").attr("writeable") = false;
+    return array;
+}
+
+/// @brief Dotted hierarchical name of a signal, eg. "tb.uut.count".
+std::string SignalPath(const vcdp::VCDFile& file, const vcdp::VCDSignal& signal) {
+    std::string path = signal.reference;
+    for (vcdp::VCDIndex scope = signal.scope; scope != vcdp::VCD_NO_INDEX; scope = file.getScopes()[scope].parent) {
+        path.insert(0, file.getScopes()[scope].name + ".");
+    }
+    return path;
+}
+
+/// @brief Signals of a file as Python objects referring to it, keeping it alive.
+py::list Signals(const py::object& file, const vcdp::VCDSpan<const vcdp::VCDIndex> indices) {
+    const auto& signals = file.cast<const vcdp::VCDFile&>().getSignals();
+    py::list list;
+    for (const vcdp::VCDIndex index : indices) list.append(py::cast(&signals[index], py::return_value_policy::reference_internal, file));
+    return list;
+}
+
+/// @brief Scopes of a file as Python objects referring to it, keeping it alive.
+py::list Scopes(const py::object& file, const vcdp::VCDSpan<const vcdp::VCDScope> scopes) {
+    py::list list;
+    for (const vcdp::VCDScope& scope : scopes) list.append(py::cast(&scope, py::return_value_policy::reference_internal, file));
+    return list;
+}
+
+/**
+ * @brief Sink of VCDBodyDecoder calling the on_timestamp(time) and on_value_change(signal, value)
+ * methods of a Python visitor, those it defines.
+ */
+class PythonVisitor {
+   public:
+    PythonVisitor(const py::object& visitor, const py::object& file) {
+        if (py::hasattr(visitor, "on_timestamp")) on_timestamp_ = visitor.attr("on_timestamp");
+        if (py::hasattr(visitor, "on_value_change")) on_value_change_ = visitor.attr("on_value_change");
+        for (const auto& signal : file.cast<const vcdp::VCDFile&>().getSignals()) {
+            signals_.push_back(py::cast(&signal, py::return_value_policy::reference_internal, file));
+        }
+        file_ = &file.cast<const vcdp::VCDFile&>();
+    }
+
+    void onTimestamp(const uint64_t time) {
+        if (on_timestamp_) on_timestamp_(time);
+    }
+
+    void onValueChange(const vcdp::VCDSignal& signal, const std::string_view value) {
+        if (on_value_change_) on_value_change_(signals_[file_->indexOf(signal)], py::str(value.data(), value.size()));
+    }
+
+   private:
+    const vcdp::VCDFile* file_ = nullptr;
+    py::object on_timestamp_;
+    py::object on_value_change_;
+    std::vector<py::object> signals_;  //!< Python object of each signal, built once
+};
+
+/**
+ * @brief Parse the header of a file, then hand its value changes to a visitor as they are
+ * decoded, a chunk at a time, without storing them. The GIL is released while reading.
+ */
+py::object Stream(Parser& self, const std::string& path, const py::object& visitor, const size_t chunk_size) {
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) throw std::runtime_error("Unable to open " + path);
+
+    py::object file = py::cast(std::make_unique<vcdp::VCDFile>());
+    auto* header = file.cast<vcdp::VCDFile*>();
+    {
+        py::gil_scoped_release release;
+        self.parser.parseHeader(stream, header, path);
+    }
+    self.result = self.parser.GetResult();
+    if (!self.result.success) return file;
+
+    PythonVisitor sink(visitor, file);
+    vcdp::VCDBodyDecoder<PythonVisitor> decoder(*header, self.result, sink, self.parser.GetLineCount());
+    std::vector<char> buffer(chunk_size);
+    std::string text;  // Starts with the line cut at the end of the previous chunk
+    uint64_t offset = self.parser.GetOffset();
+    while (true) {
+        size_t count = 0;
+        {
+            py::gil_scoped_release release;
+            stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            count = static_cast<size_t>(stream.gcount());
+        }
+        text.append(buffer.data(), count);
+        if (!stream) break;
+        const size_t consumed = decoder.decode(text, offset, false);
+        text.erase(0, consumed);
+        offset += consumed;
+    }
+    decoder.decode(text, offset, true);
+    return file;
+}
+
+}  // namespace
+
+PYBIND11_MODULE(vcdp, m) {
+    m.doc() = "Parse VCD files, their time table and value changes exposed as NumPy arrays";
+
+    py::class_<vcdp::VCDScope>(m, "Scope")
+        .def_readonly("name", &vcdp::VCDScope::name)
+        .def_property_readonly("type", [](const vcdp::VCDScope& scope) { return vcdp::utils::vcdScopeType2String(scope.type); })
+        .def_property_readonly("parent", [](const vcdp::VCDScope& scope) -> py::object {
+            return scope.parent == vcdp::VCD_NO_INDEX ? py::none() : py::cast(scope.parent);
+        });
+
+    py::class_<vcdp::VCDSignal>(m, "Signal")
+        .def_readonly("code", &vcdp::VCDSignal::hash)
+        .def_readonly("reference", &vcdp::VCDSignal::reference)
+        .def_readonly("size", &vcdp::VCDSignal::size)
+        .def_readonly("change_count", &vcdp::VCDSignal::change_count)
+        .def_property_readonly("type", [](const vcdp::VCDSignal& signal) { return vcdp::utils::vcdVarType2String(signal.type); })
+        .def_property_readonly("is_real", &vcdp::VCDSignal::isReal);
+
+    py::class_<vcdp::VCDDecodedSignal>(m, "DecodedSignal", "Value changes of a signal, see File.decode")
+        .def_readonly("words", &vcdp::VCDDecodedSignal::words, "64-bit words of a value, least significant first")
+        .def("__len__", &vcdp::VCDDecodedSignal::changes)
+        .def_property_readonly(
+            "times",
+            [](const py::object& self) {
+                const auto& decoded = self.cast<const vcdp::VCDDecodedSignal&>();
+                return View(decoded.times, self, {static_cast<py::ssize_t>(decoded.changes())});
+            },
+            "Timestamp of each change, uint64")
+        .def_property_readonly(
+            "time_indices",
+            [](const py::object& self) {
+                const auto& decoded = self.cast<const vcdp::VCDDecodedSignal&>();
+                return View(decoded.time_indices, self, {static_cast<py::ssize_t>(decoded.changes())});
+            },
+            "Index in File.timestamps of each change, uint64")
+        .def_property_readonly(
+            "values",
+            [](const py::object& self) {
+                const auto& decoded = self.cast<const vcdp::VCDDecodedSignal&>();
+                const auto changes = static_cast<py::ssize_t>(decoded.values.size() / decoded.words);
+                if (decoded.words == 1) return View(decoded.values, self, {changes});
+                return View(decoded.values, self, {changes, static_cast<py::ssize_t>(decoded.words)});
+            },
+            "Value of each change, uint64 of shape (changes,) or (changes, words), 0 when not known")
+        .def_property_readonly(
+            "known",
+            [](const py::object& self) {
+                const auto& decoded = self.cast<const vcdp::VCDDecodedSignal&>();
+                return View(decoded.known, self, {static_cast<py::ssize_t>(decoded.known.size())});
+            },
+            "1 for each change whose bits are all 0 or 1, uint8")
+        .def_property_readonly(
+            "reals",
+            [](const py::object& self) {
+                const auto& decoded = self.cast<const vcdp::VCDDecodedSignal&>();
+                return View(decoded.reals, self, {static_cast<py::ssize_t>(decoded.reals.size())});
+            },
+            "Value of each change of a real signal, float64");
+
+    py::class_<vcdp::VCDFile>(m, "File")
+        .def_readonly("version", &vcdp::VCDFile::version)
+        .def_readonly("date", &vcdp::VCDFile::date)
+        .def_readonly("time_resolution", &vcdp::VCDFile::time_resolution)
+        .def_property_readonly("time_unit", [](const vcdp::VCDFile& file) { return vcdp::utils::vcdTimeUnit2String(file.time_units); })
+        .def_property_readonly("frozen", &vcdp::VCDFile::frozen)
+        .def_property_readonly(
+            "timestamps",
+            [](const py::object& self) {
+                const auto& times = self.cast<const vcdp::VCDFile&>().getTimestamps();
+                return View(times, self, {static_cast<py::ssize_t>(times.size())});
+            },
+            "Time table, uint64, aliasing the memory of the file")
+        .def_property_readonly("signals",
+                               [](const py::object& self) {
+                                   const auto& file = self.cast<const vcdp::VCDFile&>();
+                                   std::vector<vcdp::VCDIndex> indices(file.getSignals().size());
+                                   for (size_t i = 0; i < indices.size(); i++) indices[i] = static_cast<vcdp::VCDIndex>(i);
+                                   return Signals(self, {indices.data(), indices.data() + indices.size()});
+                               })
+        .def_property_readonly("scopes",
+                               [](const py::object& self) {
+                                   const auto& scopes = self.cast<const vcdp::VCDFile&>().getScopes();
+                                   return Scopes(self, {scopes.data(), scopes.data() + scopes.size()});
+                               })
+        .def_property_readonly("top_scopes", [](const py::object& self) { return Scopes(self, self.cast<const vcdp::VCDFile&>().getTopScopes()); })
+        .def(
+            "children",
+            [](const py::object& self, const vcdp::VCDScope& scope) {
+                return Scopes(self, self.cast<const vcdp::VCDFile&>().getScopeChildren(scope));
+            },
+            py::arg("scope"))
+        .def(
+            "scope_signals",
+            [](const py::object& self, const vcdp::VCDScope& scope) {
+                return Signals(self, self.cast<const vcdp::VCDFile&>().getScopeSignals(scope));
+            },
+            py::arg("scope"))
+        .def(
+            "find_signal",
+            [](const py::object& self, const std::string& code) -> py::object {
+                const vcdp::VCDSignal* signal = self.cast<const vcdp::VCDFile&>().findSignal(code);
+                return signal == nullptr ? py::none() : py::cast(signal, py::return_value_policy::reference_internal, self);
+            },
+            py::arg("code"), "Signal of an identifier code, None if not declared")
+        .def("path", &SignalPath, py::arg("signal"), "Dotted hierarchical name of a signal")
+        .def("decode", &vcdp::VCDFile::decode, py::arg("signal"), py::call_guard<py::gil_scoped_release>(),
+             "Decode the value changes of a signal into NumPy arrays. Releases the GIL");
+
+    py::class_<vcdp::VCDParseResult>(m, "ParseResult")
+        .def_readonly("success", &vcdp::VCDParseResult::success)
+        .def_property_readonly("error_count", [](const vcdp::VCDParseResult& result) { return result.errors.Total(); })
+        .def_property_readonly("warning_count", [](const vcdp::VCDParseResult& result) { return result.warnings.Total(); })
+        .def_property_readonly("errors",
+                               [](const vcdp::VCDParseResult& result) {
+                                   std::vector<std::string> messages;
+                                   for (const auto& error : result.errors) messages.push_back(error.Message());
+                                   return messages;
+                               })
+        .def_property_readonly("warnings", [](const vcdp::VCDParseResult& result) {
+            std::vector<std::string> messages;
+            for (const auto& warning : result.warnings) messages.push_back(warning.Message());
+            return messages;
+        });
+
+    py::class_<Parser>(m, "Parser", "Parse VCD files. Use one parser per thread, parses release the GIL")
+        .def(py::init<>())
+        .def(
+            "parse",
+            [](Parser& self, const std::string& path, const unsigned threads, const uint64_t memory_limit, const uint64_t summary_resolution,
+               const bool freeze) {
+                vcdp::ParseOptions options;
+                options.threads = threads;
+                options.memory_limit = memory_limit;
+                options.summary_resolution = summary_resolution;
+                options.freeze = freeze;
+                auto file = std::make_unique<vcdp::VCDFile>();
+                {
+                    py::gil_scoped_release release;
+                    self.parser.parse(path, file.get(), options);
+                }
+                self.result = self.parser.GetResult();
+                return file;
+            },
+            py::arg("path"), py::arg("threads") = 1, py::arg("memory_limit") = 0, py::arg("summary_resolution") = 0, py::arg("freeze") = true,
+            "Parse a file and store its value changes. Frozen by default, for queries from many threads")
+        .def("stream", &Stream, py::arg("path"), py::arg("visitor"), py::arg("chunk_size") = 1024 * 1024,
+             "Parse the header of a file, then call visitor.on_timestamp(time) and visitor.on_value_change(signal, value) "
+             "for each decoded line, storing nothing. Returns the file, holding the declarations only")
+        .def_property_readonly(
+            "result", [](const Parser& self) -> const vcdp::VCDParseResult& { return self.result; }, py::return_value_policy::reference_internal);
+
+    m.def(
+        "parse",
+        [](const std::string& path, const unsigned threads) {
+            vcdp::VCDParser parser;
+            vcdp::ParseOptions options;
+            options.threads = threads;
+            options.freeze = true;
+            auto file = std::make_unique<vcdp::VCDFile>();
+            {
+                py::gil_scoped_release release;
+                parser.parse(path, file.get(), options);
+            }
+            const vcdp::VCDDiagnosticList& errors = parser.GetResult().errors;
+            if (errors.Count(vcdp::VCDDiagCode::IO_ERROR) > 0 || errors.Count(vcdp::VCDDiagCode::HEADER_SYNTAX) > 0) {
+                throw std::runtime_error(errors.begin()->Message());
+            }
+            return file;
+        },
+        py::arg("path"), py::arg("threads") = 1, "Parse a file into a frozen File, raise RuntimeError if it cannot be read");
+}
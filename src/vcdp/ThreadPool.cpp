@@ -0,0 +1,76 @@
+#include "vcdp/ThreadPool.hpp"
+
+namespace VCDP_NAMESPACE {
+
+ThreadPool::ThreadPool(const unsigned threads) {
+    const unsigned count = threads == 0 ? defaultThreadCount() : threads;
+    workers_.reserve(count);
+    for (unsigned i = 0; i < count; i++) {
+        workers_.emplace_back([this] { run(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    task_available_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    task_available_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock lock(mutex_);
+    idle_.wait(lock, [this] { return tasks_.empty() && busy_ == 0; });
+
+    if (error_) {
+        const std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+unsigned ThreadPool::defaultThreadCount() {
+    const unsigned count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+void ThreadPool::run() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(mutex_);
+            task_available_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;  // Stopping and nothing left to do
+
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+            busy_++;
+        }
+
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard lock(mutex_);
+            if (!error_) error_ = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock(mutex_);
+            busy_--;
+            if (tasks_.empty() && busy_ == 0) idle_.notify_all();
+        }
+    }
+}
+
+}  // namespace VCDP_NAMESPACE
@@ -1,45 +1,28 @@
 #include "vcdp/Utils.hpp"
 
+#include "vcdp/VCDKeywords.hpp"
+
 namespace VCDP_NAMESPACE::utils {
 
-// clang-format off
-std::string vcdVarType2String(const VCDVarType type)  {
-    switch (type) {
-        case VCDVarType::VCD_VAR_UNKNOWN:   return "unknown";
-        case VCDVarType::VCD_VAR_EVENT:     return "event";
-        case VCDVarType::VCD_VAR_INTEGER:   return "integer";
-        case VCDVarType::VCD_VAR_PARAMETER: return "parameter";
-        case VCDVarType::VCD_VAR_REAL:      return "real";
-        case VCDVarType::VCD_VAR_REALTIME:  return "realtime";
-        case VCDVarType::VCD_VAR_REG:       return "reg";
-        case VCDVarType::VCD_VAR_SUPPLY0:   return "supply0";
-        case VCDVarType::VCD_VAR_SUPPLY1:   return "supply1";
-        case VCDVarType::VCD_VAR_TIME:      return "time";
-        case VCDVarType::VCD_VAR_TRI:       return "tri";
-        case VCDVarType::VCD_VAR_TRIAND:    return "triand";
-        case VCDVarType::VCD_VAR_TRIOR:     return "trior";
-        case VCDVarType::VCD_VAR_TRIREG:    return "trireg";
-        case VCDVarType::VCD_VAR_TRI0:      return "tri0";
-        case VCDVarType::VCD_VAR_TRI1:      return "tri1";
-        case VCDVarType::VCD_VAR_WAND:      return "wand";
-        case VCDVarType::VCD_VAR_WIRE:      return "wire";
-        case VCDVarType::VCD_VAR_WOR:       return "wor";
-        default:                            return "invalid";
-    }
+std::string vcdVarType2String(const VCDVarType type) {
+    if (type == VCDVarType::VCD_VAR_UNKNOWN) return "unknown";
+    const std::string_view name = VAR_TYPE_KEYWORDS.name(type);
+    return name.empty() ? "invalid" : std::string(name);
 }
+
 std::string vcdTimeUnit2String(const VCDTimeUnit unit) {
-    switch (unit) {
-    case VCDTimeUnit::TIME_UNKNOWN: return "unknown";
-    case VCDTimeUnit::TIME_S:       return "s";
-    case VCDTimeUnit::TIME_MS:      return "ms";
-    case VCDTimeUnit::TIME_US:      return "us";
-    case VCDTimeUnit::TIME_NS:      return "ns";
-    case VCDTimeUnit::TIME_PS:      return "ps";
-    case VCDTimeUnit::TIME_FS:      return "fs";
-    default:                        return "invalid";
-    }
+    if (unit == VCDTimeUnit::TIME_UNKNOWN) return "unknown";
+    const std::string_view name = TIME_UNIT_KEYWORDS.name(unit);
+    return name.empty() ? "invalid" : std::string(name);
+}
+
+std::string vcdScopeType2String(const VCDScopeType type) {
+    if (type == VCDScopeType::VCD_SCOPE_ROOT) return "root";
+    const std::string_view name = SCOPE_TYPE_KEYWORDS.name(type);
+    return name.empty() ? "unknown" : std::string(name);
 }
 
+// clang-format off
 char vcdBit2Char(const VCDBit bit) {
     switch (bit) {
         case VCDBit::VCD_0      :   return '0';
@@ -94,4 +77,34 @@ const char* bitColor(const VCDBit bit) {
 }
 // clang-format on
 
+std::string compactIdentifier(uint64_t index) {
+    std::string id;
+    do {
+        id += static_cast<char>('!' + index % 94);
+        index /= 94;
+    } while (index != 0);
+    return id;
+}
+
+bool matchWildcard(const std::string_view pattern, const std::string_view name) {
+    size_t p = 0, n = 0;
+    size_t star = std::string_view::npos, star_n = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+            p++;
+            n++;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_n = n;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            n = ++star_n;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') p++;
+    return p == pattern.size();
+}
+
 }  // namespace VCDP_NAMESPACE::utils
\ No newline at end of file
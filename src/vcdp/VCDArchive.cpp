@@ -0,0 +1,571 @@
+#include "vcdp/VCDArchive.hpp"
+
+#include <libdeflate.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <memory>
+
+namespace VCDP_NAMESPACE {
+
+namespace {
+
+constexpr char ARCHIVE_MAGIC[8] = {'V', 'C', 'D', 'P', 'A', 'R', 'C', 'H'};
+constexpr uint32_t ARCHIVE_VERSION = 1;
+constexpr size_t ARCHIVE_HEADER_SIZE = 8 + 4 + 4 + 8 + 8 + 4;
+
+/// @brief Little endian integers and LEB128 varints appended to a byte string.
+class ByteWriter {
+   public:
+    void putFixed(uint64_t value, const unsigned size) {
+        for (unsigned i = 0; i < size; i++, value >>= 8) bytes_ += static_cast<char>(value & 0xFF);
+    }
+
+    void putVarint(uint64_t value) {
+        while (value >= 0x80) {
+            bytes_ += static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        bytes_ += static_cast<char>(value);
+    }
+
+    /// @brief Zigzag encoding, small negative values stay short.
+    void putSigned(const int64_t value) { putVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63)); }
+
+    void putString(const std::string& text) {
+        putVarint(text.size());
+        bytes_ += text;
+    }
+
+    /// @brief Bytes of a block, in the VList encoding.
+    template <typename T>
+    void putWord(const T word) {
+        uint8_t buffer[VListManager::MAX_VARINT_SIZE<T>];
+        bytes_.append(reinterpret_cast<const char*>(buffer), VListManager::encode(word, buffer));
+    }
+
+    [[nodiscard]] std::string& bytes() { return bytes_; }
+
+   private:
+    std::string bytes_;
+};
+
+/// @brief Reads what ByteWriter wrote, turning any overrun into failed().
+class ByteReader {
+   public:
+    ByteReader(const uint8_t* begin, const uint8_t* end) : pos_(begin), end_(end) {}
+
+    uint64_t getFixed(const unsigned size) {
+        if (static_cast<size_t>(end_ - pos_) < size) return overrun();
+        uint64_t value = 0;
+        for (unsigned i = 0; i < size; i++) value |= static_cast<uint64_t>(*pos_++) << (8 * i);
+        return value;
+    }
+
+    uint64_t getVarint() {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (pos_ == end_) return overrun();
+            const uint8_t byte = *pos_++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        return overrun();
+    }
+
+    int64_t getSigned() {
+        const uint64_t value = getVarint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    std::string getString() {
+        const uint64_t size = getVarint();
+        if (static_cast<uint64_t>(end_ - pos_) < size) {
+            overrun();
+            return {};
+        }
+        std::string text(reinterpret_cast<const char*>(pos_), size);
+        pos_ += size;
+        return text;
+    }
+
+    [[nodiscard]] bool failed() const { return failed_; }
+    [[nodiscard]] uint64_t remaining() const { return static_cast<uint64_t>(end_ - pos_); }
+
+   private:
+    uint64_t overrun() {
+        failed_ = true;
+        pos_ = end_;
+        return 0;
+    }
+
+    const uint8_t* pos_;
+    const uint8_t* end_;
+    bool failed_ = false;
+};
+
+using Compressor = std::unique_ptr<libdeflate_compressor, decltype(&libdeflate_free_compressor)>;
+using Decompressor = std::unique_ptr<libdeflate_decompressor, decltype(&libdeflate_free_decompressor)>;
+
+/// @brief The data section being written, one independently compressed block after the other.
+class DataSection {
+   public:
+    explicit DataSection(const int level) : compressor_(libdeflate_alloc_compressor(level), &libdeflate_free_compressor) {}
+
+    [[nodiscard]] bool good() const { return compressor_ != nullptr; }
+
+    /// @brief Compress a block and fill its location, sizes and checksum.
+    void add(const std::string& raw, VCDArchiveBlock& block) {
+        const size_t offset = bytes_.size();
+        bytes_.resize(offset + libdeflate_deflate_compress_bound(compressor_.get(), raw.size()));
+        const size_t size = libdeflate_deflate_compress(compressor_.get(), raw.data(), raw.size(), bytes_.data() + offset, bytes_.size() - offset);
+        bytes_.resize(offset + size);
+
+        block.offset = offset;
+        block.compressed_size = static_cast<uint32_t>(size);
+        block.raw_size = static_cast<uint32_t>(raw.size());
+        block.crc = libdeflate_crc32(0, raw.data(), raw.size());
+    }
+
+    [[nodiscard]] const std::string& bytes() const { return bytes_; }
+
+   private:
+    Compressor compressor_;
+    std::string bytes_;
+};
+
+void writeBlockList(ByteWriter& index, const std::vector<VCDArchiveBlock>& blocks) {
+    // Offsets are implied by the order of the blocks in the data section
+    index.putVarint(blocks.size());
+    uint64_t previous = 0;
+    for (const auto& block : blocks) {
+        index.putVarint(block.compressed_size);
+        index.putVarint(block.raw_size);
+        index.putFixed(block.crc, 4);
+        index.putVarint(block.count);
+        index.putVarint(block.first_time_index - previous);
+        index.putVarint(block.last_time_index - block.first_time_index);
+        previous = block.last_time_index;
+    }
+}
+
+std::vector<VCDArchiveBlock> readBlockList(ByteReader& index, uint64_t& offset) {
+    // Every block takes a few bytes of the index, a larger count is corrupted
+    std::vector<VCDArchiveBlock> blocks(std::min(index.getVarint(), index.remaining()));
+    uint64_t previous = 0;
+    for (auto& block : blocks) {
+        block.offset = offset;
+        block.compressed_size = static_cast<uint32_t>(index.getVarint());
+        block.raw_size = static_cast<uint32_t>(index.getVarint());
+        block.crc = static_cast<uint32_t>(index.getFixed(4));
+        block.count = index.getVarint();
+        block.first_time_index = previous + index.getVarint();
+        block.last_time_index = block.first_time_index + index.getVarint();
+        previous = block.last_time_index;
+        offset += block.compressed_size;
+    }
+    return blocks;
+}
+
+/// @brief Cut the value changes of a signal into blocks.
+std::vector<VCDArchiveBlock> writeSignal(const VCDSignal& signal, DataSection& data, const uint32_t block_size) {
+    std::vector<VCDArchiveBlock> blocks;
+    ByteWriter raw;
+    VCDArchiveBlock block;
+
+    VListReader reader(signal.data);
+    uint64_t time_index = 0;
+    uint64_t real_bits = 0;
+    uint64_t delta = 0;
+    while (reader.next(delta)) {
+        time_index += delta;
+        const bool block_start = block.count == 0;
+        if (block_start) block.first_time_index = time_index;
+        block.last_time_index = time_index;
+        block.count++;
+        raw.putWord(delta);
+
+        uint32_t word = 0;
+        reader.next(word);
+        if (signal.isReal()) {
+            // XORed with the previous value (see VCDFile::addValueChange): the first one of a block is made absolute
+            std::array<uint32_t, 3> words = {word, 0, 0};
+            size_t count = 1;
+            if (word != 0) {
+                reader.next(words[count++]);
+                if (((word - 1) & 1) != 0) reader.next(words[count++]);
+                const uint64_t bits = (static_cast<uint64_t>(words[2]) << 32 | words[1]) << ((word - 1) >> 2);
+                real_bits = ((word - 1) & 2) != 0 ? bits : real_bits ^ bits;
+            }
+            if (block_start) {
+                const int trailing = real_bits == 0 ? 0 : std::countr_zero(real_bits);
+                const uint64_t meaningful = real_bits >> trailing;
+                const bool wide = (meaningful >> 32) != 0;
+                words = {1 + (static_cast<uint32_t>(trailing) << 2 | 2 | (wide ? 1 : 0)), static_cast<uint32_t>(meaningful),
+                         static_cast<uint32_t>(meaningful >> 32)};
+                count = wide ? 3 : 2;
+            }
+            for (size_t i = 0; i < count; i++) raw.putWord(words[i]);
+        } else {
+            raw.putWord(word);
+        }
+        if (signal.size != 1 && !signal.isReal()) {
+            // Vector: the header word gives the number of value words
+            const size_t bits_per_word = (word & 1) ? 8 : 32;
+            for (size_t words = ((word >> 1) + bits_per_word - 1) / bits_per_word; words > 0; words--) {
+                reader.next(word);
+                raw.putWord(word);
+            }
+        }
+
+        if (raw.bytes().size() >= block_size) {
+            data.add(raw.bytes(), block);
+            blocks.push_back(block);
+            block = VCDArchiveBlock();
+            raw.bytes().clear();
+        }
+    }
+    if (block.count > 0) {
+        data.add(raw.bytes(), block);
+        blocks.push_back(block);
+    }
+    return blocks;
+}
+
+}  // namespace
+
+VCDWriteResult VCDArchiveWriter::write(const VCDFile& file, const std::string& output_path) {
+    VCDWriteResult result;
+    DataSection data(options_.compression_level);
+    if (!data.good()) {
+        result.success = false;
+        result.error = "Invalid compression level " + std::to_string(options_.compression_level);
+        return result;
+    }
+    const uint32_t block_size = std::max<uint32_t>(options_.block_size, 1);
+
+    const auto& scopes = file.getScopes();
+    const auto& signals = file.getSignals();
+    const auto& times = file.getTimestamps();
+
+    // Time table: deltas between consecutive timestamps
+    std::vector<VCDArchiveBlock> time_blocks;
+    {
+        ByteWriter raw;
+        VCDArchiveBlock block;
+        uint64_t previous = 0;
+        for (const uint64_t time : times) {
+            raw.putVarint(time - previous);
+            previous = time;
+            block.count++;
+            if (raw.bytes().size() >= block_size) {
+                data.add(raw.bytes(), block);
+                time_blocks.push_back(block);
+                block = VCDArchiveBlock();
+                raw.bytes().clear();
+            }
+        }
+        if (block.count > 0) {
+            data.add(raw.bytes(), block);
+            time_blocks.push_back(block);
+        }
+    }
+
+    std::vector<std::vector<VCDArchiveBlock>> signal_blocks;
+    signal_blocks.reserve(signals.size());
+    for (const auto& signal : signals) {
+        signal_blocks.push_back(writeSignal(signal, data, block_size));
+        result.changes += signal.change_count;
+    }
+    result.signals = signals.size();
+
+    ByteWriter index;
+    index.putVarint(static_cast<uint64_t>(file.time_units));
+    index.putVarint(file.time_resolution);
+    index.putString(file.date);
+    index.putString(file.version);
+
+    index.putVarint(scopes.size());
+    for (const auto& scope : scopes) {
+        index.putString(scope.name);
+        index.putVarint(static_cast<uint64_t>(scope.type));
+        index.putVarint(scope.parent == VCD_NO_INDEX ? 0 : scope.parent + uint64_t{1});
+        const auto declared = file.getScopeSignals(scope);
+        index.putVarint(declared.size());
+        for (const VCDIndex signal : declared) index.putVarint(signal);
+    }
+
+    index.putVarint(times.size());
+    writeBlockList(index, time_blocks);
+
+    index.putVarint(signals.size());
+    for (size_t i = 0; i < signals.size(); i++) {
+        const VCDSignal& signal = signals[i];
+        index.putString(signal.hash);
+        index.putString(signal.reference);
+        index.putVarint(signal.scope == VCD_NO_INDEX ? 0 : signal.scope + uint64_t{1});
+        index.putVarint(signal.size);
+        index.putVarint(static_cast<uint64_t>(signal.type));
+        index.putSigned(signal.lindex);
+        index.putSigned(signal.rindex);
+        writeBlockList(index, signal_blocks[i]);
+    }
+
+    VCDArchiveBlock index_block;
+    DataSection index_section(options_.compression_level);
+    index_section.add(index.bytes(), index_block);
+
+    ByteWriter header;
+    header.bytes().append(ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    header.putFixed(ARCHIVE_VERSION, 4);
+    header.putFixed(0, 4);
+    header.putFixed(index_block.compressed_size, 8);
+    header.putFixed(index_block.raw_size, 8);
+    header.putFixed(index_block.crc, 4);
+
+    std::ofstream stream(output_path, std::ios::binary);
+    stream.write(header.bytes().data(), static_cast<std::streamsize>(header.bytes().size()));
+    stream.write(index_section.bytes().data(), static_cast<std::streamsize>(index_section.bytes().size()));
+    stream.write(data.bytes().data(), static_cast<std::streamsize>(data.bytes().size()));
+    if (!stream) {
+        result.success = false;
+        result.error = "Unable to write " + output_path;
+        return result;
+    }
+
+    result.bytes = header.bytes().size() + index_section.bytes().size() + data.bytes().size();
+    return result;
+}
+
+bool VCDArchiveReader::open(const std::string& path) {
+    file_ = std::make_unique<VCDFile>();
+    time_blocks_.clear();
+    signal_blocks_.clear();
+    timestamps_loaded_ = false;
+    error_.clear();
+
+    stream_.close();
+    stream_.clear();
+    stream_.open(path, std::ios::binary);
+    if (!stream_) return fail("Unable to open " + path);
+
+    uint8_t fixed[ARCHIVE_HEADER_SIZE];
+    if (!stream_.read(reinterpret_cast<char*>(fixed), sizeof(fixed)) || !std::equal(ARCHIVE_MAGIC, ARCHIVE_MAGIC + 8, fixed)) {
+        return fail(path + " is not a VCD archive");
+    }
+
+    ByteReader header(fixed + 8, fixed + sizeof(fixed));
+    if (const uint64_t version = header.getFixed(4); version != ARCHIVE_VERSION) {
+        return fail("Unsupported archive version " + std::to_string(version));
+    }
+    header.getFixed(4);
+
+    // The index is read as a block placed right before the data section
+    VCDArchiveBlock index_block;
+    index_block.offset = ARCHIVE_HEADER_SIZE;
+    index_block.compressed_size = static_cast<uint32_t>(header.getFixed(8));
+    index_block.raw_size = static_cast<uint32_t>(header.getFixed(8));
+    index_block.crc = static_cast<uint32_t>(header.getFixed(4));
+    data_offset_ = 0;
+
+    std::vector<uint8_t> raw;
+    if (!readBlock(index_block, raw)) return false;
+    data_offset_ = ARCHIVE_HEADER_SIZE + index_block.compressed_size;
+
+    ByteReader index(raw.data(), raw.data() + raw.size());
+    file_->time_units = static_cast<VCDTimeUnit>(index.getVarint());
+    file_->time_resolution = static_cast<uint8_t>(index.getVarint());
+    file_->date = index.getString();
+    file_->version = index.getString();
+
+    // Scopes are stored parents first, each followed by the signals it declares
+    const uint64_t scope_count = index.getVarint();
+    std::vector<VCDScope> scopes;
+    std::vector<std::vector<VCDIndex>> declared;
+    std::vector<std::vector<VCDIndex>> children(1);  // Entry 0 for the top scopes
+    for (uint64_t i = 0; i < scope_count && !index.failed(); i++) {
+        VCDScope scope;
+        scope.name = index.getString();
+        scope.type = static_cast<VCDScopeType>(index.getVarint());
+        const uint64_t parent = index.getVarint();
+        if (parent > i) return fail("Corrupted archive index: scope " + scope.name + " declared before its parent");
+        children[parent].push_back(static_cast<VCDIndex>(i));
+        children.emplace_back();
+
+        declared.emplace_back(std::min(index.getVarint(), index.remaining()));
+        for (VCDIndex& signal : declared.back()) signal = static_cast<VCDIndex>(index.getVarint());
+        scopes.push_back(std::move(scope));
+    }
+
+    uint64_t offset = 0;
+    timestamp_count_ = index.getVarint();
+    time_blocks_ = readBlockList(index, offset);
+
+    const uint64_t signal_count = index.getVarint();
+    std::vector<VCDSignal> signals;
+    std::vector<VCDIndex> signal_scopes;
+    std::vector<std::vector<VCDArchiveBlock>> blocks;
+    for (uint64_t i = 0; i < signal_count && !index.failed(); i++) {
+        VCDSignal signal;
+        signal.hash = index.getString();
+        signal.reference = index.getString();
+        signal_scopes.push_back(static_cast<VCDIndex>(index.getVarint()));
+        signal.size = static_cast<uint32_t>(index.getVarint());
+        signal.type = static_cast<VCDVarType>(index.getVarint());
+        signal.lindex = static_cast<int>(index.getSigned());
+        signal.rindex = static_cast<int>(index.getSigned());
+        blocks.push_back(readBlockList(index, offset));
+        signals.push_back(std::move(signal));
+    }
+    if (index.failed()) return fail("Corrupted archive index");
+
+    // Declare everything again, depth first as in a VCD header
+    const auto declare = [&](const VCDIndex signal) {
+        if (signal >= signals.size()) return false;
+        VCDSignal copy;
+        copy.hash = signals[signal].hash;
+        copy.reference = signals[signal].reference;
+        copy.size = signals[signal].size;
+        copy.type = signals[signal].type;
+        copy.lindex = signals[signal].lindex;
+        copy.rindex = signals[signal].rindex;
+        file_->addSignal(std::move(copy));
+        return true;
+    };
+    struct Open {
+        VCDIndex scope;     //!< In the archive
+        size_t next_child;  //!< Next entry of its children to declare
+        VCDIndex upscope;   //!< Current scope of file_ to restore once done
+    };
+    std::vector<Open> stack{{VCD_NO_INDEX, 0, VCD_NO_INDEX}};
+    while (!stack.empty()) {
+        Open& open = stack.back();
+        const std::vector<VCDIndex>& siblings = children[open.scope + 1];  // VCD_NO_INDEX + 1 is 0, the top scopes
+        if (open.next_child == siblings.size()) {
+            file_->current_scope = open.upscope;
+            stack.pop_back();
+            continue;
+        }
+
+        const VCDIndex child = siblings[open.next_child++];
+        stack.push_back({child, 0, file_->current_scope});
+        file_->addScope(scopes[child]);
+        for (const VCDIndex signal : declared[child]) {
+            if (!declare(signal)) return fail("Corrupted archive index: unknown signal");
+        }
+    }
+    for (VCDIndex signal = 0; signal < signals.size(); signal++) {
+        if (signal_scopes[signal] == 0) declare(signal);
+    }
+    file_->endDefinitions();
+
+    // Match the blocks with the signals as laid out again
+    signal_blocks_.resize(file_->getSignals().size());
+    for (size_t i = 0; i < signals.size(); i++) {
+        if (const VCDSignal* signal = file_->findSignal(signals[i].hash); signal != nullptr) {
+            signal_blocks_[file_->indexOf(*signal)] = std::move(blocks[i]);
+        }
+    }
+    return true;
+}
+
+bool VCDArchiveReader::loadTimestamps() {
+    if (timestamps_loaded_) return true;
+
+    std::vector<uint8_t> raw;
+    uint64_t time = 0;
+    for (const auto& block : time_blocks_) {
+        if (!readBlock(block, raw)) return false;
+        ByteReader reader(raw.data(), raw.data() + raw.size());
+        for (uint64_t i = 0; i < block.count; i++) {
+            time += reader.getVarint();
+            file_->addTimestamp(time);
+        }
+        if (reader.failed()) return fail("Corrupted time table");
+    }
+    if (file_->getTimestamps().size() != timestamp_count_) return fail("Corrupted time table");
+
+    timestamps_loaded_ = true;
+    return true;
+}
+
+bool VCDArchiveReader::loadSignal(const VCDSignal& signal, const uint64_t begin, const uint64_t end) {
+    if (!loadTimestamps()) return false;
+
+    VCDSignal* target = file_->findSignal(signal.hash);
+    if (target == nullptr) return fail("Unknown signal " + signal.hash);
+    const std::vector<VCDArchiveBlock>& blocks = signal_blocks_[file_->indexOf(*target)];
+    const std::vector<uint64_t>& times = file_->getTimestamps();
+    for (const auto& block : blocks) {
+        if (block.last_time_index >= times.size()) return fail("Corrupted block index of signal " + signal.hash);
+    }
+
+    // From the last block starting at or before begin, to the last block starting at or before end
+    const auto starts_before = [&](const uint64_t time) {
+        return static_cast<size_t>(std::partition_point(blocks.begin(), blocks.end(),
+                                                        [&](const VCDArchiveBlock& block) { return times[block.first_time_index] <= time; }) -
+                                   blocks.begin());
+    };
+    const size_t first = std::max<size_t>(starts_before(begin), 1) - 1;
+    const size_t last = std::max(starts_before(end), first + 1);
+
+    target->data.clear();
+    target->change_count = 0;
+    target->last_time_index = 0;
+
+    std::vector<uint8_t> raw;
+    for (size_t i = first; i < last && i < blocks.size(); i++) {
+        if (!readBlock(blocks[i], raw)) return false;
+
+        size_t skip = 0;
+        if (i == first && i > 0) {
+            // The first delta is relative to the previous block, which is not loaded
+            uint64_t delta = 0;
+            for (unsigned shift = 0; skip < raw.size(); shift += 7) {
+                delta |= static_cast<uint64_t>(raw[skip] & 0x7F) << shift;
+                if (raw[skip++] & 0x80) break;
+            }
+            target->data.addData64(blocks[i - 1].last_time_index + delta);
+        }
+        target->data.addBytes(raw.data() + skip, raw.size() - skip);
+        target->change_count += blocks[i].count;
+        target->last_time_index = blocks[i].last_time_index;
+    }
+    file_->indexChanges(*target);
+    return true;
+}
+
+const std::vector<VCDArchiveBlock>& VCDArchiveReader::getBlocks(const VCDSignal& signal) const {
+    static const std::vector<VCDArchiveBlock> none;
+    const VCDSignal* found = file_->findSignal(signal.hash);
+    return found == nullptr ? none : signal_blocks_[file_->indexOf(*found)];
+}
+
+bool VCDArchiveReader::readBlock(const VCDArchiveBlock& block, std::vector<uint8_t>& raw) {
+    thread_local Decompressor decompressor(libdeflate_alloc_decompressor(), &libdeflate_free_decompressor);
+
+    // Deflate cannot expand data more than about 1032 times
+    if (block.raw_size > uint64_t{block.compressed_size} * 1032 + 64) return fail("Corrupted archive block");
+
+    std::vector<uint8_t>& compressed = compressed_;
+    compressed.resize(block.compressed_size);
+    stream_.clear();
+    stream_.seekg(static_cast<std::streamoff>(data_offset_ + block.offset));
+    if (!stream_.read(reinterpret_cast<char*>(compressed.data()), block.compressed_size)) return fail("Truncated archive");
+
+    raw.resize(block.raw_size);
+    size_t size = 0;
+    if (libdeflate_deflate_decompress(decompressor.get(), compressed.data(), compressed.size(), raw.data(), raw.size(), &size) != LIBDEFLATE_SUCCESS ||
+        size != raw.size() || libdeflate_crc32(0, raw.data(), raw.size()) != block.crc) {
+        return fail("Corrupted archive block");
+    }
+    return true;
+}
+
+bool VCDArchiveReader::fail(std::string error) {
+    error_ = std::move(error);
+    return false;
+}
+
+}  // namespace VCDP_NAMESPACE
@@ -0,0 +1,40 @@
+#include "vcdp/VCDDiagnostics.hpp"
+
+#include <ostream>
+#include <sstream>
+
+namespace VCDP_NAMESPACE {
+
+std::string VCDDiagnostic::Message() const {
+    std::ostringstream msg;
+    switch (code) {
+        case VCDDiagCode::IO_ERROR:
+            msg << "I/O error: " << detail;
+            break;
+        case VCDDiagCode::HEADER_SYNTAX:
+        case VCDDiagCode::HEADER_INCOMPLETE:
+            msg << "Parse error: " << detail;
+            break;
+        case VCDDiagCode::INVALID_TIMESTAMP:
+            msg << "Invalid timestamp '" << detail << "'";
+            break;
+        case VCDDiagCode::UNKNOWN_IDENTIFIER:
+            msg << "Unable to find the signal hash '" << detail << "'";
+            break;
+        case VCDDiagCode::INVALID_VALUE:
+            msg << "Invalid value change '" << detail << "'";
+            break;
+        default:
+            msg << detail;
+            break;
+    }
+
+    if (line != 0) {
+        msg << " (line " << line << ", byte " << offset << ")";
+    }
+    return msg.str();
+}
+
+std::ostream& operator<<(std::ostream& os, const VCDDiagnostic& diagnostic) { return os << diagnostic.Message(); }
+
+}  // namespace VCDP_NAMESPACE
@@ -0,0 +1,345 @@
+#include "vcdp/VCDDiff.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "vcdp/ThreadPool.hpp"
+#include "vcdp/Utils.hpp"
+#include "vcdp/VCDBodyDecoder.hpp"
+
+namespace VCDP_NAMESPACE {
+
+namespace {
+
+/// @brief Value change decoded from a file, its value kept in the arena of the file.
+struct Change {
+    uint64_t time;
+    VCDIndex signal;
+    uint32_t value_offset;
+    uint32_t value_size;
+};
+
+/// @brief One of the compared files, decoded a chunk at a time.
+class Trace {
+   public:
+    explicit Trace(VCDParseResult& result) : result_(result) {}
+
+    /// @brief Parse the header, the body is left for readChunk().
+    bool open(const std::string& path) {
+        stream_.open(path, std::ios::binary);
+        if (!stream_) {
+            result_.AddError(VCDDiagCode::IO_ERROR, "Unable to open " + path);
+            return false;
+        }
+
+        VCDParser parser;
+        parser.parseHeader(stream_, &file, path);
+        result_ = parser.GetResult();
+        if (!result_.success) return false;
+
+        decoder_ = std::make_unique<VCDBodyDecoder<Trace>>(file, result_, *this, parser.GetLineCount());
+        offset_ = parser.GetOffset();
+        return true;
+    }
+
+    /// @brief Decode the next chunk of the body, and the last line once the end of the file is reached.
+    void readChunk(const size_t chunk_size) {
+        buffer_.resize(chunk_size);
+        if (stream_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size())) || stream_.gcount() > 0) {
+            text_.append(buffer_.data(), stream_.gcount());
+            const size_t consumed = decoder_->decode(text_, offset_, false);
+            text_.erase(0, consumed);
+            offset_ += consumed;
+        }
+        if (!stream_) {
+            decoder_->decode(text_, offset_, true);
+            text_.clear();
+            done_ = true;
+        }
+    }
+
+    /// @brief Forget the first changes, once compared.
+    void drop(const size_t count) {
+        changes_.erase(changes_.begin(), changes_.begin() + static_cast<std::ptrdiff_t>(count));
+
+        // Compact the arena around the values left
+        std::string arena;
+        for (Change& change : changes_) {
+            const uint32_t offset = static_cast<uint32_t>(arena.size());
+            arena.append(arena_, change.value_offset, change.value_size);
+            change.value_offset = offset;
+        }
+        arena_.swap(arena);
+    }
+
+    [[nodiscard]] bool done() const { return done_; }
+
+    /// @brief Last timestamp decoded. No change older than it is still to come.
+    [[nodiscard]] uint64_t time() const { return time_; }
+
+    [[nodiscard]] const std::vector<Change>& changes() const { return changes_; }
+    [[nodiscard]] std::string_view value(const Change& change) const { return {arena_.data() + change.value_offset, change.value_size}; }
+
+    void onTimestamp(const uint64_t time) { time_ = time; }
+
+    void onValueChange(const VCDSignal& signal, const std::string_view value) {
+        changes_.push_back({time_, file.indexOf(signal), static_cast<uint32_t>(arena_.size()), static_cast<uint32_t>(value.size())});
+        arena_ += value;
+    }
+
+    VCDFile file;
+
+   private:
+    VCDParseResult& result_;
+    std::ifstream stream_;
+    std::unique_ptr<VCDBodyDecoder<Trace>> decoder_;
+    std::vector<char> buffer_;
+    std::string text_;  //!< Starts with the line cut at the end of the previous chunk
+    uint64_t offset_ = 0;
+    bool done_ = false;
+    uint64_t time_ = 0;
+    std::vector<Change> changes_;  //!< Decoded, not compared yet
+    std::string arena_;            //!< Values of the changes
+};
+
+/// @brief Signal declared under the same path in both files.
+struct Pair {
+    VCDIndex signal[2];
+    uint32_t width;  //!< Values are compared at this size
+};
+
+/// @brief Current values of a pair, and its mismatch window if open.
+struct PairState {
+    std::string value[2];
+    bool differs = false;
+    bool touched = false;  //!< Changed at the time being compared
+};
+
+/// @brief Change of a pair handed to the group comparing it.
+struct GroupChange {
+    uint64_t time;
+    uint32_t pair;
+    std::string_view value;
+};
+
+/// @brief Signals of a file by dotted hierarchical name, in declaration order.
+std::vector<std::pair<std::string, VCDIndex>> signalPaths(const VCDFile& file, const std::vector<std::string>& patterns) {
+    const auto& scopes = file.getScopes();
+
+    // Scopes are stored parents first
+    std::vector<std::string> scope_paths(scopes.size());
+    for (size_t i = 0; i < scopes.size(); i++) {
+        scope_paths[i] = scopes[i].parent == VCD_NO_INDEX ? scopes[i].name : scope_paths[scopes[i].parent] + "." + scopes[i].name;
+    }
+
+    std::vector<std::pair<std::string, VCDIndex>> paths;
+    for (VCDIndex scope = 0; scope < scopes.size(); scope++) {
+        for (const VCDIndex signal : file.getScopeSignals(scopes[scope])) {
+            std::string path = scope_paths[scope] + "." + file.getSignals()[signal].reference;
+            const bool selected = patterns.empty() || std::any_of(patterns.begin(), patterns.end(), [&](const std::string& pattern) {
+                                      return utils::matchWildcard(pattern, path);
+                                  });
+            if (selected) paths.emplace_back(std::move(path), signal);
+        }
+    }
+    return paths;
+}
+
+/// @brief Lower case value left-extended to the compared width, as VCDChangeReader extends.
+void normalizeValue(const std::string_view value, const uint32_t width, std::string& out) {
+    out.clear();
+    if (value.size() < width) {
+        const char first = value.empty() ? 'x' : static_cast<char>(std::tolower(static_cast<unsigned char>(value[0])));
+        out.assign(width - value.size(), first == '1' ? '0' : first);
+    }
+    for (const char c : value) out += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+/// @brief Compares the pairs of one group, a round of changes at a time.
+class GroupComparator {
+   public:
+    GroupComparator(const std::vector<Pair>& pairs, std::vector<PairState>& states, std::vector<VCDSignalDiff>& diffs, const size_t max_windows)
+        : pairs_(pairs), states_(states), diffs_(diffs), max_windows_(max_windows) {}
+
+    /// @brief Merge the changes of both files by time, comparing after each time step.
+    void compare(const std::array<std::vector<GroupChange>, 2>& changes) {
+        size_t next[2] = {0, 0};
+        while (next[0] < changes[0].size() || next[1] < changes[1].size()) {
+            uint64_t time = UINT64_MAX;
+            for (size_t side = 0; side < 2; side++) {
+                if (next[side] < changes[side].size()) time = std::min(time, changes[side][next[side]].time);
+            }
+
+            touched_.clear();
+            for (size_t side = 0; side < 2; side++) {
+                for (; next[side] < changes[side].size() && changes[side][next[side]].time == time; next[side]++) {
+                    const GroupChange& change = changes[side][next[side]];
+                    PairState& state = states_[change.pair];
+                    normalizeValue(change.value, pairs_[change.pair].width, state.value[side]);
+                    if (!state.touched) {
+                        state.touched = true;
+                        touched_.push_back(change.pair);
+                    }
+                }
+            }
+
+            for (const uint32_t pair : touched_) {
+                states_[pair].touched = false;
+                evaluate(pair, time);
+            }
+        }
+    }
+
+   private:
+    void evaluate(const uint32_t pair, const uint64_t time) {
+        PairState& state = states_[pair];
+        VCDSignalDiff& diff = diffs_[pair];
+
+        if (state.value[0] != state.value[1]) {
+            diff.mismatches++;
+            if (state.differs) return;
+
+            state.differs = true;
+            diff.first_divergence = std::min(diff.first_divergence, time);
+            diff.window_count++;
+            if (diff.windows.size() < max_windows_) diff.windows.push_back({time, UINT64_MAX});
+        } else if (state.differs) {
+            state.differs = false;
+            if (diff.windows.size() == diff.window_count) diff.windows.back().end = time;
+        }
+    }
+
+    const std::vector<Pair>& pairs_;
+    std::vector<PairState>& states_;
+    std::vector<VCDSignalDiff>& diffs_;
+    size_t max_windows_;
+    std::vector<uint32_t> touched_;
+};
+
+}  // namespace
+
+size_t VCDDiffResult::DifferingSignals() const {
+    return static_cast<size_t>(std::count_if(signals.begin(), signals.end(), [](const VCDSignalDiff& diff) { return diff.Differs(); }));
+}
+
+VCDDiffResult VCDDiff::compare(const std::string& path_a, const std::string& path_b) {
+    VCDDiffResult result;
+    for (auto& parse_result : parse_results_) parse_result.Clear();
+
+    Trace traces[2] = {Trace(parse_results_[0]), Trace(parse_results_[1])};
+    const std::string* paths[2] = {&path_a, &path_b};
+    for (size_t side = 0; side < 2; side++) {
+        if (!traces[side].open(*paths[side])) {
+            result.success = false;
+            result.error = parse_results_[side].errors.empty() ? "Unable to read " + *paths[side] : parse_results_[side].errors[0].Message();
+            return result;
+        }
+    }
+
+    // Match the declarations by path
+    const auto declared_a = signalPaths(traces[0].file, options_.signals);
+    const auto declared_b = signalPaths(traces[1].file, options_.signals);
+    std::unordered_map<std::string, VCDIndex> by_path_a(declared_a.begin(), declared_a.end());
+    std::unordered_map<std::string, VCDIndex> by_path_b(declared_b.begin(), declared_b.end());
+
+    std::vector<Pair> pairs;
+    std::unordered_set<uint64_t> paired;
+    std::vector<std::vector<uint32_t>> pairs_of[2] = {std::vector<std::vector<uint32_t>>(traces[0].file.getSignals().size()),
+                                                      std::vector<std::vector<uint32_t>>(traces[1].file.getSignals().size())};
+    for (const auto& [path, a] : declared_a) {
+        const auto found = by_path_b.find(path);
+        if (found == by_path_b.end()) {
+            result.only_in_a.push_back(path);
+            continue;
+        }
+
+        // A signal declared under several names is compared once
+        const VCDIndex b = found->second;
+        if (!paired.insert(static_cast<uint64_t>(a) << 32 | b).second) continue;
+
+        const uint32_t size_a = traces[0].file.getSignals()[a].size;
+        const uint32_t size_b = traces[1].file.getSignals()[b].size;
+        const auto pair = static_cast<uint32_t>(pairs.size());
+        pairs.push_back({{a, b}, std::max(size_a, size_b)});
+        pairs_of[0][a].push_back(pair);
+        pairs_of[1][b].push_back(pair);
+
+        VCDSignalDiff diff;
+        diff.path = path;
+        diff.size_a = size_a;
+        diff.size_b = size_b;
+        result.signals.push_back(std::move(diff));
+    }
+    for (const auto& [path, b] : declared_b) {
+        if (by_path_a.find(path) == by_path_a.end()) result.only_in_b.push_back(path);
+    }
+
+    // Values are unknown until first dumped
+    std::vector<PairState> states(pairs.size());
+    for (size_t i = 0; i < pairs.size(); i++) {
+        states[i].value[0].assign(pairs[i].width, 'x');
+        states[i].value[1].assign(pairs[i].width, 'x');
+    }
+
+    // Pair i is compared by group i % group_count, always on the same thread
+    const unsigned threads = options_.threads == 0 ? ThreadPool::defaultThreadCount() : options_.threads;
+    const size_t group_count = std::max<size_t>(1, std::min<size_t>(threads, pairs.size()));
+    std::vector<GroupComparator> groups(group_count, GroupComparator(pairs, states, result.signals, options_.max_windows));
+    std::vector<std::array<std::vector<GroupChange>, 2>> buckets(group_count);
+    std::unique_ptr<ThreadPool> pool;
+    if (group_count > 1) pool = std::make_unique<ThreadPool>(static_cast<unsigned>(group_count));
+
+    // Compare the changes older than the horizon, no file can add any before it
+    const auto compare_until = [&](const uint64_t horizon, const bool all) {
+        size_t cut[2];
+        for (size_t side = 0; side < 2; side++) {
+            const auto& changes = traces[side].changes();
+            cut[side] = all ? changes.size()
+                            : static_cast<size_t>(std::partition_point(changes.begin(), changes.end(), [&](const Change& c) { return c.time < horizon; }) -
+                                                  changes.begin());
+            for (size_t i = 0; i < cut[side]; i++) {
+                const Change& change = changes[i];
+                for (const uint32_t pair : pairs_of[side][change.signal]) {
+                    buckets[pair % group_count][side].push_back({change.time, pair, traces[side].value(change)});
+                }
+            }
+        }
+
+        const auto compare_group = [&](const size_t group) {
+            groups[group].compare(buckets[group]);
+            buckets[group][0].clear();
+            buckets[group][1].clear();
+        };
+        if (pool) {
+            pool->parallelFor(group_count, compare_group);
+        } else {
+            compare_group(0);
+        }
+
+        for (size_t side = 0; side < 2; side++) traces[side].drop(cut[side]);
+    };
+
+    const size_t chunk_size = std::max<size_t>(options_.chunk_size, 1);
+    while (!traces[0].done() || !traces[1].done()) {
+        // Read from the file lagging behind, the first one on a tie
+        const size_t side = traces[1].done() || (!traces[0].done() && traces[0].time() <= traces[1].time()) ? 0 : 1;
+        traces[side].readChunk(chunk_size);
+
+        uint64_t horizon = UINT64_MAX;
+        for (const Trace& trace : traces) {
+            if (!trace.done()) horizon = std::min(horizon, trace.time());
+        }
+        compare_until(horizon, false);
+    }
+    compare_until(UINT64_MAX, true);
+
+    result.end_time = std::max(traces[0].time(), traces[1].time());
+    return result;
+}
+
+}  // namespace VCDP_NAMESPACE
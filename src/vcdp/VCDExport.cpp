@@ -0,0 +1,613 @@
+#include "vcdp/VCDExport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "vcdp/ThreadPool.hpp"
+#include "vcdp/Utils.hpp"
+
+namespace VCDP_NAMESPACE {
+
+namespace {
+
+/*
+ * Arrow IPC file layout (https://arrow.apache.org/docs/format/Columnar.html#ipc-file-format):
+ *  - "ARROW1" padded to 8 bytes
+ *  - messages: 0xFFFFFFFF, int32 metadata size, Message flatbuffer padded to 8 bytes, body
+ *    (a Schema message, then one RecordBatch message per batch of rows)
+ *  - end of stream: 0xFFFFFFFF, 0
+ *  - Footer flatbuffer, int32 footer size, "ARROW1"
+ */
+
+/// @brief A FlatBuffers object: a table, a string, a vector of tables or a vector of structs.
+struct FlatNode {
+    enum class Kind { TABLE, STRING, TABLES, STRUCTS };
+
+    struct Scalar {
+        uint16_t slot;
+        uint8_t size;  //!< 1, 2, 4 or 8 bytes
+        uint64_t value;
+    };
+
+    Kind kind = Kind::TABLE;
+    std::vector<Scalar> scalars;         //!< TABLE fields holding a value
+    std::vector<uint16_t> child_slots;   //!< TABLE fields pointing to another object
+    std::vector<FlatNode> children;      //!< Objects of child_slots, or elements of TABLES
+    std::string bytes;                   //!< STRING characters, or STRUCTS elements of 8-byte aligned structs
+    uint32_t count = 0;                  //!< STRUCTS elements
+
+    FlatNode& add(const uint16_t slot, const uint8_t size, const uint64_t value) {
+        scalars.push_back({slot, size, value});
+        return *this;
+    }
+
+    FlatNode& add(const uint16_t slot, FlatNode child) {
+        child_slots.push_back(slot);
+        children.push_back(std::move(child));
+        return *this;
+    }
+
+    static FlatNode string(std::string text) {
+        FlatNode node;
+        node.kind = Kind::STRING;
+        node.bytes = std::move(text);
+        return node;
+    }
+
+    static FlatNode tables(std::vector<FlatNode> elements) {
+        FlatNode node;
+        node.kind = Kind::TABLES;
+        node.children = std::move(elements);
+        return node;
+    }
+
+    static FlatNode structs(std::string elements, const uint32_t count) {
+        FlatNode node;
+        node.kind = Kind::STRUCTS;
+        node.bytes = std::move(elements);
+        node.count = count;
+        return node;
+    }
+};
+
+/**
+ * @brief Serialise FlatBuffers front to back: an object is written before the objects it
+ * points to, its offsets being patched once they are written, so that they all point forward.
+ */
+class FlatBuilder {
+   public:
+    static std::string finish(const FlatNode& root) {
+        FlatBuilder builder;
+        builder.buffer_.resize(4);  // Offset of the root table
+        builder.patch(0, builder.write(root));
+        return std::move(builder.buffer_);
+    }
+
+   private:
+    void pad(const size_t alignment) { buffer_.resize((buffer_.size() + alignment - 1) / alignment * alignment, '\0'); }
+
+    void put(const size_t position, const uint64_t value, const size_t size) { std::memcpy(&buffer_[position], &value, size); }
+
+    void patch(const size_t field, const size_t target) { put(field, target - field, 4); }
+
+    size_t write(const FlatNode& node) {
+        switch (node.kind) {
+            case FlatNode::Kind::STRING: {
+                pad(4);
+                const size_t position = buffer_.size();
+                buffer_.resize(position + 4);
+                put(position, node.bytes.size(), 4);
+                buffer_ += node.bytes;
+                buffer_ += '\0';
+                return position;
+            }
+            case FlatNode::Kind::TABLES: {
+                pad(4);
+                const size_t position = buffer_.size();
+                buffer_.resize(position + 4 + 4 * node.children.size());
+                put(position, node.children.size(), 4);
+                for (size_t i = 0; i < node.children.size(); i++) patch(position + 4 + 4 * i, write(node.children[i]));
+                return position;
+            }
+            case FlatNode::Kind::STRUCTS: {
+                pad(4);
+                if ((buffer_.size() + 4) % 8 != 0) buffer_.resize(buffer_.size() + 4);
+                const size_t position = buffer_.size();
+                buffer_.resize(position + 4);
+                put(position, node.count, 4);
+                buffer_ += node.bytes;
+                return position;
+            }
+            case FlatNode::Kind::TABLE:
+                break;
+        }
+
+        // Inline fields, largest first so that they are naturally aligned
+        struct Field {
+            uint16_t slot;
+            uint8_t size;
+            uint64_t value;
+            size_t child;  //!< Index in children, SIZE_MAX for a value
+        };
+        std::vector<Field> fields;
+        for (const auto& scalar : node.scalars) fields.push_back({scalar.slot, scalar.size, scalar.value, SIZE_MAX});
+        for (size_t i = 0; i < node.child_slots.size(); i++) fields.push_back({node.child_slots[i], 4, 0, i});
+        std::stable_sort(fields.begin(), fields.end(), [](const Field& a, const Field& b) { return a.size > b.size; });
+
+        std::vector<size_t> offsets(fields.size());
+        size_t table_size = 4;  // Offset to the vtable
+        size_t alignment = 4;
+        size_t slot_count = 0;
+        for (size_t i = 0; i < fields.size(); i++) {
+            table_size = (table_size + fields[i].size - 1) / fields[i].size * fields[i].size;
+            offsets[i] = table_size;
+            table_size += fields[i].size;
+            alignment = std::max<size_t>(alignment, fields[i].size);
+            slot_count = std::max<size_t>(slot_count, fields[i].slot + 1);
+        }
+
+        pad(2);
+        const size_t vtable = buffer_.size();
+        buffer_.resize(vtable + 4 + 2 * slot_count);
+        put(vtable, 4 + 2 * slot_count, 2);
+        put(vtable + 2, table_size, 2);
+        for (size_t i = 0; i < fields.size(); i++) put(vtable + 4 + 2 * fields[i].slot, offsets[i], 2);
+
+        pad(alignment);
+        const size_t table = buffer_.size();
+        buffer_.resize(table + table_size);
+        put(table, table - vtable, 4);  // The vtable is that many bytes before the table
+        for (size_t i = 0; i < fields.size(); i++) {
+            if (fields[i].child == SIZE_MAX) put(table + offsets[i], fields[i].value, fields[i].size);
+        }
+        for (size_t i = 0; i < fields.size(); i++) {
+            if (fields[i].child != SIZE_MAX) patch(table + offsets[i], write(node.children[fields[i].child]));
+        }
+        return table;
+    }
+
+    std::string buffer_;
+};
+
+constexpr uint16_t ARROW_METADATA_V5 = 4;
+constexpr uint8_t ARROW_HEADER_SCHEMA = 1;
+constexpr uint8_t ARROW_HEADER_RECORD_BATCH = 3;
+constexpr uint8_t ARROW_TYPE_INT = 2;
+constexpr uint8_t ARROW_TYPE_FLOATING_POINT = 3;
+constexpr uint8_t ARROW_TYPE_UTF8 = 5;
+constexpr uint16_t ARROW_PRECISION_DOUBLE = 2;
+
+/// @brief Append 64-bit little-endian fields of a struct.
+void appendInt64(std::string& bytes, const uint64_t value) { bytes.append(reinterpret_cast<const char*>(&value), 8); }
+
+/// @brief Change of a column within the current batch.
+struct Change {
+    uint64_t time_index;
+    uint64_t bits;
+    bool known;
+};
+
+/// @brief A column of the table, decoded a batch at a time.
+struct Column {
+    Column(std::string column_name, const VCDSignal& column_signal)
+        : name(std::move(column_name)),
+          signal(&column_signal),
+          real(column_signal.isReal()),
+          wide(!real && column_signal.size > 64),
+          reader(column_signal) {
+        width = real || column_signal.size > 32 ? 8 : column_signal.size <= 8 ? 1 : column_signal.size <= 16 ? 2 : 4;
+    }
+
+    std::string name;
+    const VCDSignal* signal;
+    bool real;          //!< Doubles, values holding their IEEE 754 bits
+    bool wide;          //!< Over 64 bits, written as text
+    unsigned width;     //!< Bytes of an Arrow integer
+    VCDChangeReader reader;
+
+    // Change read past the end of the previous batch
+    bool has_next = false;
+    Change next{};
+    std::string next_text;
+
+    // Value before the current batch
+    bool has_value = false;
+    Change value{};
+    std::string text;
+
+    // Changes of the current batch
+    std::vector<Change> changes;
+    std::vector<std::string> texts;
+
+    // Values of the rows of the current batch
+    std::vector<uint64_t> values;
+    std::vector<uint8_t> valid;
+    std::vector<int32_t> offsets;  //!< Wide columns: start of each value in chars
+    std::string chars;
+    uint64_t null_count = 0;
+
+    std::string body;  //!< Arrow buffers of the batch
+    std::vector<std::pair<uint64_t, uint64_t>> buffers;  //!< (offset in body, length)
+
+    /// @brief Read the changes of the time indices before `end`.
+    void decode(const uint64_t end) {
+        changes.clear();
+        texts.clear();
+        while (true) {
+            if (!has_next) {
+                if (wide) {
+                    if (!reader.next()) return;
+                    next_text = reader.value();
+                    next = {reader.timeIndex(), 0, false};
+                } else if (!reader.next(next.bits, next.known)) {
+                    return;
+                }
+                next.time_index = reader.timeIndex();
+                has_next = true;
+            }
+            if (next.time_index >= end) return;
+            changes.push_back(next);
+            if (wide) texts.push_back(std::move(next_text));
+            has_next = false;
+        }
+    }
+
+    /**
+     * @brief Values of the rows of the batch.
+     * @param rows Time index of each row.
+     * @param before Rows hold the values before the changes of their time index.
+     */
+    void fill(const std::vector<uint64_t>& rows, const bool before) {
+        values.clear();
+        valid.clear();
+        offsets.assign(1, 0);
+        chars.clear();
+        null_count = 0;
+
+        size_t change = 0;
+        const auto apply = [&] {
+            value = changes[change];
+            if (wide) text = std::move(texts[change]);
+            has_value = true;
+            change++;
+        };
+
+        for (const uint64_t row : rows) {
+            while (change < changes.size() && (changes[change].time_index < row || (!before && changes[change].time_index == row))) apply();
+            if (wide) {
+                if (has_value) chars += text;
+                offsets.push_back(static_cast<int32_t>(chars.size()));
+                valid.push_back(has_value);
+            } else {
+                values.push_back(value.known ? value.bits : 0);
+                valid.push_back(has_value && value.known);
+            }
+            null_count += valid.back() == 0;
+        }
+        while (change < changes.size()) apply();
+    }
+
+    /// @brief Lay the Arrow buffers of the batch out: validity, then values or offsets and characters.
+    void serialize() {
+        body.clear();
+        buffers.clear();
+        const auto add = [&](const void* data, const size_t size) {
+            buffers.emplace_back(body.size(), size);
+            body.append(static_cast<const char*>(data), size);
+            body.resize((body.size() + 7) / 8 * 8, '\0');
+        };
+
+        if (null_count == 0) {
+            add(nullptr, 0);
+        } else {
+            std::string bitmap((valid.size() + 7) / 8, '\0');
+            for (size_t i = 0; i < valid.size(); i++) bitmap[i / 8] = static_cast<char>(bitmap[i / 8] | (valid[i] << (i % 8)));
+            add(bitmap.data(), bitmap.size());
+        }
+
+        if (wide) {
+            add(offsets.data(), offsets.size() * sizeof(int32_t));
+            add(chars.data(), chars.size());
+            return;
+        }
+        std::string narrow(values.size() * width, '\0');
+        for (size_t i = 0; i < values.size(); i++) std::memcpy(&narrow[i * width], &values[i], width);  // Little-endian
+        add(narrow.data(), narrow.size());
+    }
+};
+
+/// @brief Quote a CSV field holding a separator or a quote.
+std::string csvField(const std::string& text) {
+    if (text.find_first_of(",\"\n") == std::string::npos) return text;
+    std::string quoted = "\"";
+    for (const char c : text) {
+        quoted += c;
+        if (c == '"') quoted += '"';
+    }
+    return quoted + "\"";
+}
+
+/// @brief Destination of the table, in one of the formats.
+class TableOutput {
+   public:
+    TableOutput(const std::string& path, const ExportFormat format, const VCDFile& file, const std::vector<Column>& columns)
+        : stream_(path, std::ios::binary), format_(format) {
+        if (format_ == ExportFormat::CSV) {
+            std::string header = "time";
+            for (const auto& column : columns) header += "," + csvField(column.name);
+            write(header + "\n");
+            return;
+        }
+
+        std::vector<FlatNode> fields;
+        fields.push_back(field("time", false, ARROW_TYPE_INT, 8));
+        for (const auto& column : columns) {
+            const uint8_t type = column.real ? ARROW_TYPE_FLOATING_POINT : column.wide ? ARROW_TYPE_UTF8 : ARROW_TYPE_INT;
+            fields.push_back(field(column.name, true, type, column.width));
+        }
+
+        FlatNode timescale;
+        timescale.add(0, FlatNode::string("timescale"));
+        timescale.add(1, FlatNode::string(std::to_string(file.time_resolution) + utils::vcdTimeUnit2String(file.time_units)));
+
+        schema_.add(0, 2, 0);  // Little-endian
+        schema_.add(1, FlatNode::tables(std::move(fields)));
+        schema_.add(2, FlatNode::tables({timescale}));
+
+        write(std::string("ARROW1\0\0", 8));
+        message(ARROW_HEADER_SCHEMA, schema_, {});
+    }
+
+    [[nodiscard]] bool good() const { return stream_.good(); }
+    [[nodiscard]] uint64_t bytes() const { return bytes_; }
+
+    /// @brief Write CSV lines.
+    void write(const std::string& text) {
+        stream_.write(text.data(), static_cast<std::streamsize>(text.size()));
+        bytes_ += text.size();
+    }
+
+    /// @brief Write an Arrow record batch of the serialized columns.
+    void batch(const std::vector<uint64_t>& times, const std::vector<Column>& columns) {
+        std::string nodes;
+        std::string buffers;
+        std::string body;
+        const auto add = [&](const uint64_t length, const uint64_t null_count, const Column* column) {
+            appendInt64(nodes, length);
+            appendInt64(nodes, null_count);
+            if (column == nullptr) return;
+            for (const auto& [offset, size] : column->buffers) {
+                appendInt64(buffers, body.size() + offset);
+                appendInt64(buffers, size);
+            }
+            body += column->body;
+        };
+
+        // The time column has no null: an empty validity buffer
+        appendInt64(buffers, 0);
+        appendInt64(buffers, 0);
+        appendInt64(buffers, 0);
+        appendInt64(buffers, times.size() * 8);
+        body.append(reinterpret_cast<const char*>(times.data()), times.size() * 8);
+        add(times.size(), 0, nullptr);
+        for (const auto& column : columns) add(times.size(), column.null_count, &column);
+
+        FlatNode record_batch;
+        record_batch.add(0, 8, times.size());
+        record_batch.add(1, FlatNode::structs(std::move(nodes), static_cast<uint32_t>(columns.size() + 1)));
+        record_batch.add(2, FlatNode::structs(std::move(buffers), static_cast<uint32_t>(buffers.size() / 16)));
+        message(ARROW_HEADER_RECORD_BATCH, std::move(record_batch), body);
+    }
+
+    void finish() {
+        if (format_ == ExportFormat::CSV) {
+            stream_.flush();
+            return;
+        }
+
+        write(std::string("\xFF\xFF\xFF\xFF\0\0\0\0", 8));  // End of stream
+
+        FlatNode footer;
+        footer.add(0, 2, ARROW_METADATA_V5);
+        footer.add(1, std::move(schema_));
+        footer.add(2, FlatNode::structs({}, 0));
+        footer.add(3, FlatNode::structs(std::move(blocks_), block_count_));
+        const std::string metadata = FlatBuilder::finish(footer);
+        write(metadata);
+        const auto size = static_cast<int32_t>(metadata.size());
+        write(std::string(reinterpret_cast<const char*>(&size), 4) + "ARROW1");
+        stream_.flush();
+    }
+
+   private:
+    /// @brief Field of a text column, a double column or an unsigned integer column of `width` bytes.
+    static FlatNode field(const std::string& name, const bool nullable, const uint8_t type_type, const unsigned width) {
+        FlatNode type;
+        if (type_type == ARROW_TYPE_INT) {
+            type.add(0, 4, width * 8);  // bitWidth
+            type.add(1, 1, 0);          // is_signed
+        } else if (type_type == ARROW_TYPE_FLOATING_POINT) {
+            type.add(0, 2, ARROW_PRECISION_DOUBLE);
+        }
+
+        FlatNode node;
+        node.add(0, FlatNode::string(name));
+        node.add(1, 1, nullable);
+        node.add(2, 1, type_type);
+        node.add(3, std::move(type));
+        node.add(5, FlatNode::tables({}));  // children
+        return node;
+    }
+
+    void message(const uint8_t header_type, FlatNode header, const std::string& body) {
+        FlatNode node;
+        node.add(0, 2, ARROW_METADATA_V5);
+        node.add(1, 1, header_type);
+        node.add(2, std::move(header));
+        node.add(3, 8, body.size());
+        std::string metadata = FlatBuilder::finish(node);
+        metadata.resize((metadata.size() + 7) / 8 * 8, '\0');
+
+        // Block of the footer: offset, metadata length (int32 and 4 bytes of padding), body length
+        if (header_type == ARROW_HEADER_RECORD_BATCH) {
+            appendInt64(blocks_, bytes_);
+            appendInt64(blocks_, 8 + metadata.size());
+            appendInt64(blocks_, body.size());
+            block_count_++;
+        }
+
+        const auto size = static_cast<int32_t>(metadata.size());
+        write(std::string("\xFF\xFF\xFF\xFF", 4) + std::string(reinterpret_cast<const char*>(&size), 4));
+        write(metadata);
+        write(body);
+    }
+
+    std::ofstream stream_;
+    ExportFormat format_;
+    uint64_t bytes_ = 0;
+    FlatNode schema_;
+    std::string blocks_;
+    uint32_t block_count_ = 0;
+};
+
+/// @brief Format rows [begin, end) of a batch as CSV lines.
+std::string formatRows(const std::vector<uint64_t>& times, const std::vector<Column>& columns, const size_t begin, const size_t end) {
+    std::string text;
+    char number[32];
+    for (size_t row = begin; row < end; row++) {
+        text.append(number, std::to_chars(number, number + sizeof(number), times[row]).ptr);
+        for (const auto& column : columns) {
+            text += ',';
+            if (column.wide) {
+                text.append(column.chars, column.offsets[row], column.offsets[row + 1] - column.offsets[row]);
+            } else if (column.valid[row] && column.real) {
+                double real = 0;
+                std::memcpy(&real, &column.values[row], sizeof(real));
+                text.append(number, std::to_chars(number, number + sizeof(number), real).ptr);
+            } else if (column.valid[row]) {
+                text.append(number, std::to_chars(number, number + sizeof(number), column.values[row]).ptr);
+            }
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+VCDExportResult failure(std::string error) {
+    VCDExportResult result;
+    result.success = false;
+    result.error = std::move(error);
+    return result;
+}
+
+}  // namespace
+
+VCDExportResult VCDExporter::write(const VCDFile& file, const std::string& output_path) {
+    // Columns in declaration order, a signal declared in several scopes once
+    const auto& scopes = file.getScopes();
+    const auto& signals = file.getSignals();
+    std::vector<std::string> scope_paths(scopes.size());
+    std::vector<Column> columns;
+    std::unordered_set<VCDIndex> selected;
+    const VCDSignal* clock = nullptr;
+    for (VCDIndex scope = 0; scope < scopes.size(); scope++) {
+        // Scopes are stored parents first
+        scope_paths[scope] = scopes[scope].parent == VCD_NO_INDEX ? scopes[scope].name : scope_paths[scopes[scope].parent] + "." + scopes[scope].name;
+        for (const VCDIndex signal : file.getScopeSignals(scopes[scope])) {
+            const std::string path = scope_paths[scope] + "." + signals[signal].reference;
+            if (path == options_.clock) clock = &signals[signal];
+
+            bool match = options_.signals.empty();
+            for (const auto& pattern : options_.signals) {
+                match = match || utils::matchWildcard(pattern, path) || utils::matchWildcard(pattern, signals[signal].hash);
+            }
+            if (match && selected.insert(signal).second) columns.emplace_back(path, signals[signal]);
+        }
+    }
+
+    if (columns.empty()) return failure("No signal matches the selection");
+    if (!options_.clock.empty() && clock == nullptr) return failure("Unknown clock " + options_.clock);
+    if (clock != nullptr && clock->size != 1) return failure("The clock " + options_.clock + " is not a 1-bit signal");
+
+    TableOutput out(output_path, options_.format, file, columns);
+    if (!out.good()) return failure("Unable to open " + output_path);
+
+    ThreadPool pool(options_.threads);
+    std::unique_ptr<Column> clock_column = clock == nullptr ? nullptr : std::make_unique<Column>(options_.clock, *clock);
+    bool clock_high = false;  // Known 1
+
+    // Time indices per batch, so that a batch of rows stays within batch_bytes
+    const uint64_t batch_size = std::max<uint64_t>(options_.batch_bytes / (8 * (columns.size() + 1)), 1024);
+    const uint64_t time_count = file.getTimestamps().size();
+    std::unique_ptr<std::atomic<uint8_t>[]> changed(new std::atomic<uint8_t>[batch_size]);
+    std::vector<uint64_t> rows;
+    std::vector<uint64_t> times;
+
+    VCDExportResult result;
+    result.columns = columns.size();
+    for (uint64_t begin = 0; begin < time_count; begin += batch_size) {
+        const uint64_t end = std::min(begin + batch_size, time_count);
+
+        // Changes of the batch, and the time indices changing a column
+        for (uint64_t i = 0; i < end - begin; i++) changed[i].store(0, std::memory_order_relaxed);
+        pool.parallelFor(columns.size(), [&](const size_t i) {
+            columns[i].decode(end);
+            if (clock_column != nullptr) return;
+            for (const Change& change : columns[i].changes) changed[change.time_index - begin].store(1, std::memory_order_relaxed);
+        });
+
+        // Rows: rising edges of the clock, or times changing a column
+        rows.clear();
+        if (clock_column != nullptr) {
+            clock_column->decode(end);
+            for (const Change& change : clock_column->changes) {
+                const bool high = change.known && change.bits == 1;
+                if (high && !clock_high) rows.push_back(change.time_index);
+                clock_high = high;
+            }
+        } else {
+            for (uint64_t i = 0; i < end - begin; i++) {
+                if (changed[i].load(std::memory_order_relaxed) != 0) rows.push_back(begin + i);
+            }
+        }
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+        if (rows.empty()) {
+            pool.parallelFor(columns.size(), [&](const size_t i) { columns[i].fill(rows, clock_column != nullptr); });
+            continue;
+        }
+
+        times.resize(rows.size());
+        for (size_t i = 0; i < rows.size(); i++) times[i] = file.getTimestamp(rows[i]);
+
+        pool.parallelFor(columns.size(), [&](const size_t i) {
+            columns[i].fill(rows, clock_column != nullptr);
+            if (options_.format == ExportFormat::ARROW) columns[i].serialize();
+        });
+
+        if (options_.format == ExportFormat::ARROW) {
+            out.batch(times, columns);
+        } else {
+            // Lines formatted in parallel slices of rows, written in order
+            const size_t slice_count = std::min<size_t>(pool.size() * 4, rows.size());
+            std::vector<std::string> slices(slice_count);
+            pool.parallelFor(slice_count, [&](const size_t i) {
+                slices[i] = formatRows(times, columns, rows.size() * i / slice_count, rows.size() * (i + 1) / slice_count);
+            });
+            for (const auto& slice : slices) out.write(slice);
+        }
+        result.rows += rows.size();
+    }
+
+    out.finish();
+    if (!out.good()) return failure("Unable to write " + output_path);
+    result.bytes = out.bytes();
+    return result;
+}
+
+}  // namespace VCDP_NAMESPACE
@@ -1,50 +1,524 @@
 #include "vcdp/VCDFile.hpp"
 
-#include <iostream>
-#include <ranges>
-#include <sstream>
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
 
+#include "vcdp/ThreadPool.hpp"
+#include "vcdp/Utils.hpp"
 #include "vcdp/VCDTypes.hpp"
 
 namespace VCDP_NAMESPACE {
 
-void VCDFile::addScope(std::unique_ptr<VCDScope> scope) {
+namespace {
+
+/// @brief FNV-1a, identifier codes are only a few characters long.
+size_t hashIdentifier(const std::string_view hash) {
+    uint64_t h = 14695981039346656037ULL;
+    for (const char c : hash) {
+        h ^= static_cast<uint8_t>(c);
+        h *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(h);
+}
+
+/**
+ * @brief Pack the text of a vector value, most significant bit first, into words.
+ * @return false, words left at 0, when a bit is not 0 or 1.
+ */
+bool packBits(const std::string& text, uint64_t* words, const size_t count) {
+    std::fill(words, words + count, 0);
+    if (VCDSummary::hasUnknown(text)) return false;
+    for (size_t bit = 0; bit < text.size() && bit / 64 < count; bit++) {
+        words[bit / 64] |= static_cast<uint64_t>(text[text.size() - 1 - bit] == '1') << (bit % 64);
+    }
+    return true;
+}
+
+/// @brief Text of the width least significant bits of words, most significant bit first.
+void unpackBits(const uint64_t* words, const size_t width, std::string& text) {
+    text.resize(width);
+    for (size_t bit = 0; bit < width; bit++) text[width - 1 - bit] = (words[bit / 64] >> (bit % 64)) & 1 ? '1' : '0';
+}
+
+/// @brief Copy width bits of `from`, from bit low on, into `to` from bit offset on, up to 64 bits at a time.
+void copyBits(const uint64_t* from, size_t low, size_t width, uint64_t* to, size_t offset) {
+    while (width > 0) {
+        const size_t count = std::min({width, 64 - low % 64, 64 - offset % 64});
+        const uint64_t mask = count == 64 ? ~uint64_t{0} : (uint64_t{1} << count) - 1;
+        const uint64_t bits = (from[low / 64] >> (low % 64)) & mask;
+        to[offset / 64] = (to[offset / 64] & ~(mask << (offset % 64))) | bits << (offset % 64);
+        low += count;
+        offset += count;
+        width -= count;
+    }
+}
+
+/// @brief Positions from the least significant bit of the first and last bits of a field, following the declared range.
+std::pair<uint32_t, uint32_t> fieldBits(const VCDSliceField& field) {
+    const VCDSignal& signal = *field.signal;
+    const int64_t size = std::max<int64_t>(signal.size, 1);
+    if (field.first < 0) return {0, static_cast<uint32_t>(size - 1)};
+
+    const int64_t lsb = signal.rindex >= 0 ? signal.rindex : std::max(signal.lindex, 0);
+    const bool descending = signal.rindex < 0 || signal.lindex >= signal.rindex;
+    const auto position = [&](const int64_t index) { return descending ? index - lsb : lsb - index; };
+    const int64_t first = position(field.first);
+    const int64_t last = field.last < 0 ? first : position(field.last);
+    if (std::min(first, last) < 0 || std::max(first, last) >= size) throw std::invalid_argument("Bit range out of the range of " + signal.reference);
+    return {static_cast<uint32_t>(std::min(first, last)), static_cast<uint32_t>(std::max(first, last))};
+}
+
+/// @brief Signal named by its identifier code, dotted hierarchical name or reference, nullptr if none.
+const VCDSignal* findNamed(const VCDFile& file, const std::string_view name) {
+    if (const VCDSignal* signal = file.findSignal(name); signal != nullptr) return signal;
+
+    // Scopes are stored parents first
+    const auto& scopes = file.getScopes();
+    std::vector<std::string> scope_paths(scopes.size());
+    for (VCDIndex scope = 0; scope < scopes.size(); scope++) {
+        scope_paths[scope] = scopes[scope].parent == VCD_NO_INDEX ? scopes[scope].name : scope_paths[scopes[scope].parent] + "." + scopes[scope].name;
+        const std::string& path = scope_paths[scope];
+        if (name.size() <= path.size() || name[path.size()] != '.' || name.compare(0, path.size(), path) != 0) continue;
+        for (const VCDIndex signal : file.getScopeSignals(scopes[scope])) {
+            if (name.substr(path.size() + 1) == file.getSignals()[signal].reference) return &file.getSignals()[signal];
+        }
+    }
+    for (const auto& signal : file.getSignals()) {
+        if (signal.reference == name) return &signal;
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+void VCDFile::addScope(VCDScope scope) {
+    checkWritable();
+    reopenDefinitions();
+
+    scope.parent = current_scope;
     scopes_.push_back(std::move(scope));
-    VCDScope* p_scope = scopes_.back().get();
+    current_scope = static_cast<VCDIndex>(scopes_.size() - 1);
+}
+
+void VCDFile::addSignal(VCDSignal signal) {
+    checkWritable();
+    reopenDefinitions();
+
+    VCDIndex index;
+    if (const VCDSignal* existing = findSignal(signal.hash); existing != nullptr) {
+        index = indexOf(*existing);
+    } else {
+        index = static_cast<VCDIndex>(signals_.size());
+        signal.scope = current_scope;
+        if (summary_resolution_ > 0 && !signal.isReal()) signal.summary.enable(summary_resolution_, signal.size);
+        signals_.push_back(std::move(signal));
+        signals_.back().data.usePool(pool_);
+        indexSignal(index);
+    }
+
+    declarations_.emplace_back(current_scope, index);
+}
+
+void VCDFile::endDefinitions() {
+    checkWritable();
+    reopenDefinitions();
+    const auto scope_count = static_cast<VCDIndex>(scopes_.size());
+
+    // Children of each scope, in declaration order
+    std::vector<std::vector<VCDIndex>> children(scope_count);
+    std::vector<VCDIndex> order;  // New position -> old index
+    order.reserve(scope_count);
+    for (VCDIndex i = 0; i < scope_count; i++) {
+        if (scopes_[i].parent == VCD_NO_INDEX) {
+            order.push_back(i);
+        } else {
+            children[scopes_[i].parent].push_back(i);
+        }
+    }
+    top_scope_count_ = static_cast<VCDIndex>(order.size());
+
+    // Breadth-first walk: the children of a scope are appended next to each other
+    std::vector<VCDIndex> new_scope_index(scope_count);
+    for (size_t position = 0; position < order.size(); position++) {
+        const VCDIndex old = order[position];
+        new_scope_index[old] = static_cast<VCDIndex>(position);
+        scopes_[old].children_begin = static_cast<VCDIndex>(order.size());
+        order.insert(order.end(), children[old].begin(), children[old].end());
+        scopes_[old].children_end = static_cast<VCDIndex>(order.size());
+    }
+
+    std::vector<VCDScope> scopes;
+    scopes.reserve(scope_count);
+    for (const VCDIndex old : order) {
+        scopes.push_back(std::move(scopes_[old]));
+        if (scopes.back().parent != VCD_NO_INDEX) scopes.back().parent = new_scope_index[scopes.back().parent];
+    }
+
+    // Declarations grouped by scope in the new order, declaration order kept inside a scope
+    const auto scope_key = [&](const VCDIndex scope) { return scope == VCD_NO_INDEX ? scope_count : new_scope_index[scope]; };
+    std::stable_sort(declarations_.begin(), declarations_.end(),
+                     [&](const auto& a, const auto& b) { return scope_key(a.first) < scope_key(b.first); });
+
+    // Signals are numbered in the order they are first met
+    std::vector<VCDIndex> new_signal_index(signals_.size(), VCD_NO_INDEX);
+    std::vector<VCDIndex> signal_order;  // New position -> old index
+    signal_order.reserve(signals_.size());
+    scope_signals_.clear();
+    scope_signals_.reserve(declarations_.size());
+
+    size_t declaration = 0;
+    for (VCDIndex scope = 0; scope < scope_count; scope++) {
+        scopes[scope].signals_begin = static_cast<VCDIndex>(scope_signals_.size());
+        for (; declaration < declarations_.size() && scope_key(declarations_[declaration].first) == scope; declaration++) {
+            const VCDIndex old = declarations_[declaration].second;
+            if (new_signal_index[old] == VCD_NO_INDEX) {
+                new_signal_index[old] = static_cast<VCDIndex>(signal_order.size());
+                signal_order.push_back(old);
+            }
+            scope_signals_.push_back(new_signal_index[old]);
+        }
+        scopes[scope].signals_end = static_cast<VCDIndex>(scope_signals_.size());
+    }
+
+    // Signals declared outside of any scope go last
+    for (VCDIndex old = 0; old < signals_.size(); old++) {
+        if (new_signal_index[old] == VCD_NO_INDEX) signal_order.push_back(old);
+    }
+
+    std::vector<VCDSignal> signals;
+    signals.reserve(signals_.size());
+    for (const VCDIndex old : signal_order) {
+        signals.push_back(std::move(signals_[old]));
+        if (signals.back().scope != VCD_NO_INDEX) signals.back().scope = new_scope_index[signals.back().scope];
+    }
+
+    scopes_ = std::move(scopes);
+    signals_ = std::move(signals);
+    declarations_.clear();
+    declarations_.shrink_to_fit();
+    laid_out_ = true;
+    current_scope = VCD_NO_INDEX;
+    rebuildSignalIndex();
+}
+
+void VCDFile::freeze() {
+    if (frozen_) return;
+    if (!declarations_.empty()) endDefinitions();
+    current_scope = VCD_NO_INDEX;
+
+    // Slices are brought up to date once, readers of the frozen file then find them without locking
+    {
+        const std::lock_guard lock(slices_mutex_);
+        for (auto& [key, slice] : slices_) {
+            if (stale(*slice)) slice = newSlice(slice->fields, slice->signal.reference, slice->signal.size);
+        }
+    }
+    frozen_ = true;
+}
+
+void VCDFile::checkWritable() const {
+    if (frozen_) throw std::logic_error("Error: the VCD file is frozen, it cannot be modified");
+}
+
+void VCDFile::reopenDefinitions() {
+    if (!laid_out_) return;
+
+    // Turn the packed layout back into declarations, to be laid out again with the new ones
+    for (VCDIndex scope = 0; scope < scopes_.size(); scope++) {
+        for (const VCDIndex signal : getScopeSignals(scopes_[scope])) {
+            declarations_.emplace_back(scope, signal);
+        }
+    }
+    laid_out_ = false;
+}
+
+void VCDFile::indexSignal(const VCDIndex index) {
+    if (signal_slots_.size() < 2 * signals_.size()) {
+        rebuildSignalIndex();
+        return;
+    }
+
+    const size_t mask = signal_slots_.size() - 1;
+    size_t slot = hashIdentifier(signals_[index].hash) & mask;
+    while (signal_slots_[slot] != VCD_NO_INDEX) slot = (slot + 1) & mask;
+    signal_slots_[slot] = index;
+}
+
+void VCDFile::rebuildSignalIndex() {
+    // Keep the table at most half full
+    size_t capacity = 16;
+    while (capacity < 4 * signals_.size()) capacity <<= 1;
+    signal_slots_.assign(capacity, VCD_NO_INDEX);
 
-    if (current_scope != nullptr) current_scope->children.push_back(p_scope);
-    current_scope = p_scope;
+    const size_t mask = capacity - 1;
+    for (VCDIndex index = 0; index < signals_.size(); index++) {
+        size_t slot = hashIdentifier(signals_[index].hash) & mask;
+        while (signal_slots_[slot] != VCD_NO_INDEX) slot = (slot + 1) & mask;
+        signal_slots_[slot] = index;
+    }
+}
+
+void VCDFile::addTimestamp(const uint64_t timestamp) {
+    checkWritable();
+    times_.push_back(timestamp);
+}
+
+/*
+ * Each change is appended to the signal VList as:
+ *  - varint: time index delta since the previous change of this signal, of 64 bits
+ *  - 1-bit signals: varint VCDBit
+ *  - vectors: varint (bit_count << 1 | four_state), then the bits MSB first, packed
+ *    32 per word when only 0/1 are present, 8 VCDBit nibbles per word otherwise.
+ *  - reals: the IEEE 754 bits XORed with the previous value, as in Gorilla time series:
+ *    varint 0 for an unchanged value, otherwise varint 1 + (trailing_zeros << 2 | absolute << 1 | wide)
+ *    then the XOR shifted right by its trailing zeros, in one word or two (wide, low
+ *    word first). Leading zeros are dropped by the varints. An absolute value is XORed
+ *    with 0 instead, so that an archive block can be decoded on its own.
+ * Every VCD_SKIP_INTERVAL changes, the decoder state before the change is recorded in the
+ * skip index of the signal, for VCDChangeReader::seek to resume there.
+ */
+void VCDFile::addValueChange(VCDSignal& signal, const std::string_view value) {
+    addValueChange(signal, times_.empty() ? 0 : times_.size() - 1, value);
+}
+
+void VCDFile::addValueChange(VCDSignal& signal, const uint64_t time_index, const std::string_view value) {
+    checkWritable();
+    storeValueChange(signal, time_index, value);
+}
+
+void VCDFile::storeValueChange(VCDSignal& signal, const uint64_t time_index, const std::string_view value) const {
+    if (signal.change_count > 0 && signal.change_count % VCD_SKIP_INTERVAL == 0) {
+        signal.skip.push_back({time_index, signal.last_time_index, signal.data.size(), signal.last_real_bits});
+    }
+    signal.data.addData64(time_index - signal.last_time_index);
+    signal.last_time_index = time_index;
+    signal.change_count++;
+    if (signal.summary.enabled()) signal.summary.add(getTimestamp(time_index), value);
+
+    if (signal.isReal()) {
+        // Parsed in place, a number that does not parse is stored as NaN
+        double real = std::numeric_limits<double>::quiet_NaN();
+        const std::string_view number = !value.empty() && value[0] == '+' ? value.substr(1) : value;
+        std::from_chars(number.data(), number.data() + number.size(), real);
+        uint64_t bits = 0;
+        std::memcpy(&bits, &real, sizeof(bits));
+
+        const uint64_t delta = bits ^ signal.last_real_bits;
+        signal.last_real_bits = bits;
+        if (delta == 0) {
+            signal.data.addData(0);
+            return;
+        }
+        const int trailing = std::countr_zero(delta);
+        const uint64_t meaningful = delta >> trailing;
+        const bool wide = (meaningful >> 32) != 0;
+        signal.data.addData(1 + (static_cast<uint32_t>(trailing) << 2 | (wide ? 1 : 0)));
+        signal.data.addData(static_cast<uint32_t>(meaningful));
+        if (wide) signal.data.addData(static_cast<uint32_t>(meaningful >> 32));
+        return;
+    }
+
+    if (signal.size == 1) {
+        signal.data.addData(static_cast<uint32_t>(utils::char2VCDBit(value.empty() ? 'x' : value.back())));
+        return;
+    }
+
+    const bool four_state = value.find_first_not_of("01") != std::string_view::npos;
+    signal.data.addData(static_cast<uint32_t>(value.size() << 1) | (four_state ? 1 : 0));
+
+    const size_t bits_per_word = four_state ? 8 : 32;
+    uint32_t word = 0;
+    size_t count = 0;
+    for (const char c : value) {
+        word = four_state ? (word << 4) | static_cast<uint32_t>(utils::char2VCDBit(c)) : (word << 1) | (c == '1' ? 1 : 0);
+        if (++count == bits_per_word) {
+            signal.data.addData(word);
+            word = 0;
+            count = 0;
+        }
+    }
+    if (count > 0) signal.data.addData(word);
 }
 
-void VCDFile::addSignal(std::unique_ptr<VCDSignal> signal) {
-    const std::string hash = signal->hash;
+void VCDFile::enableSummaries(const uint64_t resolution) {
+    checkWritable();
+    summary_resolution_ = std::max<uint64_t>(resolution, 1);
+    for (auto& signal : signals_) {
+        if (!signal.isReal()) signal.summary.enable(summary_resolution_, signal.size);
+    }
+}
 
-    if (!signals_.contains(signal->hash)) {
-        signals_[hash] = std::move(signal);
+std::vector<VCDSummarySample> VCDFile::summarize(const VCDSignal& signal, const uint64_t begin, const uint64_t end, const size_t count) const {
+    if (signal.summary.enabled()) return signal.summary.sample(begin, end, count);
+
+    std::vector<VCDSummarySample> samples(count == 0 || end <= begin ? 0 : count);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i].begin = VCDSummary::bucketStart(begin, end, count, i);
+        samples[i].end = VCDSummary::bucketStart(begin, end, count, i + 1);
     }
+    if (samples.empty()) return samples;
+
+    // Every change of the signal, the last one before the window giving its first value
+    std::string value;
+    size_t sample = 0;
+    const auto unknown = [&] { return !signal.isReal() && VCDSummary::hasUnknown(value); };
+    const auto enter = [&] {
+        samples[sample].first = value;
+        samples[sample].has_x = unknown();
+    };
+    enter();
+
+    VCDChangeReader reader(signal);
+    while (reader.next()) {
+        const uint64_t time = getTimestamp(reader.timeIndex());
+        while (sample < samples.size() && time >= samples[sample].end) {
+            samples[sample].last = value;
+            if (++sample < samples.size()) enter();
+        }
+        if (sample == samples.size()) return samples;
 
-    VCDSignal* p_signal = signals_[hash].get();
-    current_scope->signals.push_back(p_signal);
+        value = reader.value();
+        if (time < samples[sample].begin) {
+            enter();
+            continue;
+        }
+        samples[sample].changes++;
+        samples[sample].has_x |= unknown();
+    }
+    while (sample < samples.size()) {
+        samples[sample].last = value;
+        if (++sample < samples.size()) enter();
+    }
+    return samples;
 }
 
-void VCDFile::addTimestamp(const uint64_t timestamp) { times_.push_back(timestamp); }
+VCDSampledSignals VCDFile::sampleOn(const VCDSignal& clock, const VCDEdge edge, const std::vector<const VCDSignal*>& signals,
+                                    const unsigned threads) const {
+    // Time indices of the edges
+    std::vector<uint64_t> edges;
+    VCDChangeReader clock_reader(clock);
+    uint64_t bits = 0;
+    bool known = false;
+    int level = -1;  // 0, 1, 2 for another value, -1 before the first change
+    while (clock_reader.next(bits, known)) {
+        const int next_level = !known ? 2 : static_cast<int>(bits & 1);
+        const bool rising = next_level == 1 && edge != VCDEdge::FALLING;
+        const bool falling = next_level == 0 && edge != VCDEdge::RISING;
+        if (level >= 0 && level != next_level && (rising || falling) && (edges.empty() || edges.back() != clock_reader.timeIndex())) {
+            edges.push_back(clock_reader.timeIndex());
+        }
+        level = next_level;
+    }
+
+    VCDSampledSignals sampled;
+    sampled.times.reserve(edges.size());
+    for (const uint64_t index : edges) sampled.times.push_back(getTimestamp(index));
+    sampled.words.resize(signals.size());
+    sampled.values.resize(signals.size());
+    sampled.known.resize(signals.size());
+
+    // Each signal merged with the edges in one pass
+    ThreadPool pool(threads);
+    pool.parallelFor(signals.size(), [&](const size_t i) {
+        const VCDSignal& signal = *signals[i];
+        const uint32_t words = std::max<uint32_t>((signal.size + 63) / 64, 1);
+        auto& values = sampled.values[i];
+        auto& valid = sampled.known[i];
+        sampled.words[i] = words;
+        values.assign(edges.size() * words, 0);
+        valid.assign(edges.size(), 0);
+
+        VCDChangeReader reader(signal);
+        std::vector<uint64_t> current(words, 0);  // Value before the next change
+        bool current_known = false;
+        uint64_t next_bits = 0;
+        bool next_known = false;
+        const bool wide = words > 1;
+        bool more = wide ? reader.next() : reader.next(next_bits, next_known);
 
-VCDScope* VCDFile::getScope(const std::string& name) const {
+        for (size_t cycle = 0; cycle < edges.size(); cycle++) {
+            while (more && reader.timeIndex() < edges[cycle]) {
+                if (wide) {
+                    current_known = packBits(reader.value(), current.data(), words);
+                    more = reader.next();
+                } else {
+                    current[0] = next_known ? next_bits : 0;
+                    current_known = next_known;
+                    more = reader.next(next_bits, next_known);
+                }
+            }
+            if (!current_known) continue;
+            std::copy(current.begin(), current.end(), values.begin() + static_cast<std::ptrdiff_t>(cycle * words));
+            valid[cycle] = 1;
+        }
+    });
+    return sampled;
+}
+
+VCDDecodedSignal VCDFile::decode(const VCDSignal& signal) const {
+    VCDDecodedSignal decoded;
+    decoded.words = std::max<uint32_t>((signal.size + 63) / 64, 1);
+    decoded.time_indices.reserve(signal.change_count);
+    decoded.times.reserve(signal.change_count);
+
+    VCDChangeReader reader(signal);
+    uint64_t bits = 0;
+    bool known = false;
+    if (signal.isReal()) {
+        decoded.reals.reserve(signal.change_count);
+        while (reader.next(bits, known)) {
+            decoded.time_indices.push_back(reader.timeIndex());
+            decoded.reals.push_back(reader.real());
+        }
+    } else {
+        decoded.values.reserve(signal.change_count * decoded.words);
+        decoded.known.reserve(signal.change_count);
+        while (decoded.words == 1 ? reader.next(bits, known) : reader.next()) {
+            decoded.time_indices.push_back(reader.timeIndex());
+            decoded.values.resize(decoded.values.size() + decoded.words);
+            if (decoded.words == 1) {
+                decoded.values.back() = known ? bits : 0;
+            } else {
+                known = packBits(reader.value(), decoded.values.data() + decoded.values.size() - decoded.words, decoded.words);
+            }
+            decoded.known.push_back(known ? 1 : 0);
+        }
+    }
+    for (const uint64_t index : decoded.time_indices) decoded.times.push_back(times_[index]);
+    return decoded;
+}
+
+const VCDScope* VCDFile::getScope(const std::string& name) const {
     for (const auto& scope : scopes_) {
-        if (scope->name == name) return scope.get();
+        if (scope.name == name) return &scope;
     }
     return nullptr;
 }
 
-VCDSignal* VCDFile::getSignal(const std::string& hash) const {
-    for (const auto& signal : signals_ | std::views::values) {
-        if (signal->hash == hash) {
-            return signal.get();
-        }
+const VCDSignal* VCDFile::findSignal(const std::string_view hash) const {
+    if (signal_slots_.empty()) return nullptr;
+
+    const size_t mask = signal_slots_.size() - 1;
+    for (size_t slot = hashIdentifier(hash) & mask; signal_slots_[slot] != VCD_NO_INDEX; slot = (slot + 1) & mask) {
+        if (const VCDIndex index = signal_slots_[slot]; signals_[index].hash == hash) return &signals_[index];
     }
     return nullptr;
 }
 
+VCDSignal* VCDFile::findSignal(const std::string_view hash) {
+    const VCDSignal* signal = std::as_const(*this).findSignal(hash);
+    return signal == nullptr ? nullptr : &signals_[indexOf(*signal)];
+}
+
+const VCDSignal* VCDFile::getSignal(const std::string& hash) const { return findSignal(hash); }
+
+VCDSignal* VCDFile::getSignal(const std::string& hash) { return findSignal(hash); }
+
 uint64_t VCDFile::getTimestamp(const size_t index) const {
     if (index >= times_.size()) return 0;
     return times_[index];
@@ -52,14 +526,620 @@ uint64_t VCDFile::getTimestamp(const size_t index) const {
 
 const std::vector<uint64_t>& VCDFile::getTimestamps() const { return times_; }
 
-bool VCDFile::exists(const std::string& hash) const {
-    if (const auto it = signals_.find(hash); it == signals_.end()) {
-        std::ostringstream msg;
-        msg << "Unable to find the signal hash \'" << hash << "\'";
-        std::cerr << msg.str() << std::endl;
+bool VCDFile::exists(const std::string& hash) const { return findSignal(hash) != nullptr; }
+
+std::optional<VCDFoundChange> VCDFile::nextChange(const VCDSignal& signal, const uint64_t time) const {
+    const auto index = static_cast<uint64_t>(std::upper_bound(times_.begin(), times_.end(), time) - times_.begin());
+    VCDChangeReader reader(signal);
+    if (!reader.seek(index)) return std::nullopt;
+    return VCDFoundChange{reader.timeIndex(), getTimestamp(reader.timeIndex()), reader.value()};
+}
+
+std::optional<VCDFoundChange> VCDFile::prevChange(const VCDSignal& signal, const uint64_t time) const {
+    const auto index = static_cast<uint64_t>(std::lower_bound(times_.begin(), times_.end(), time) - times_.begin());
+    VCDChangeReader reader(signal);
+    if (index == 0 || !reader.seekBefore(index - 1)) return std::nullopt;
+    return VCDFoundChange{reader.timeIndex(), getTimestamp(reader.timeIndex()), reader.value()};
+}
+
+std::optional<VCDFoundChange> VCDFile::nextEdge(const VCDSignal& signal, const uint64_t time, const VCDEdge edge) const {
+    if (signal.isReal()) return std::nullopt;
+
+    // Levels as sampleOn sees them: 0, 1, 2 for a value with a bit neither 0 nor 1, -1 before the first change
+    const auto level = [](const std::string& value) {
+        return value.empty() || value.find_first_not_of("01") != std::string::npos ? 2 : value.back() - '0';
+    };
+    const auto index = static_cast<uint64_t>(std::upper_bound(times_.begin(), times_.end(), time) - times_.begin());
+    VCDChangeReader reader(signal);
+    int current = -1;
+    if (index > 0 && reader.seekBefore(index - 1)) current = level(reader.value());
+
+    while (reader.next()) {
+        const int next_level = level(reader.value());
+        const bool rising = next_level == 1 && edge != VCDEdge::FALLING;
+        const bool falling = next_level == 0 && edge != VCDEdge::RISING;
+        if (current >= 0 && current != next_level && (rising || falling)) {
+            return VCDFoundChange{reader.timeIndex(), getTimestamp(reader.timeIndex()), reader.value()};
+        }
+        current = next_level;
+    }
+    return std::nullopt;
+}
+
+std::shared_ptr<const VCDSignal> VCDFile::slice(const std::vector<VCDSliceField>& fields) const {
+    if (fields.empty()) throw std::invalid_argument("A slice needs at least one field");
+
+    // Keyed by bit positions, the same bits named otherwise give the same signal
+    std::string key;
+    std::string reference;
+    uint32_t width = 0;
+    for (const VCDSliceField& field : fields) {
+        if (field.signal == nullptr || field.signal->isReal()) throw std::invalid_argument("A slice takes bits of vectors, not of real signals");
+        const auto [low, high] = fieldBits(field);
+        width += high - low + 1;
+        key += std::to_string(indexOf(*field.signal)) + ':' + std::to_string(low) + ':' + std::to_string(high) + ' ';
+        if (!reference.empty()) reference += ", ";
+        reference += field.signal->reference;
+        if (field.first >= 0) reference += '[' + std::to_string(field.first) + (field.last >= 0 ? ':' + std::to_string(field.last) : "") + ']';
+    }
+
+    const std::string name = fields.size() > 1 ? '{' + reference + '}' : reference;
+
+    // The cache of a frozen file no longer changes, see freeze(): it is read without the lock, and
+    // a virtual signal it does not hold is derived for the caller alone
+    if (frozen_) {
+        const auto found = slices_.find(key);
+        const std::shared_ptr<const Slice> cached = found != slices_.end() ? found->second : newSlice(fields, name, width);
+        return {cached, &cached->signal};
+    }
+
+    // A new signal replaces a stale one, which its holders keep reading
+    const std::lock_guard lock(slices_mutex_);
+    std::shared_ptr<const Slice>& cached = slices_[key];
+    if (cached == nullptr || stale(*cached)) cached = newSlice(fields, name, width);
+    return {cached, &cached->signal};
+}
+
+std::shared_ptr<const VCDSignal> VCDFile::slice(const std::string_view text) const {
+    const auto trim = [](std::string_view part) {
+        while (!part.empty() && std::isspace(static_cast<unsigned char>(part.front()))) part.remove_prefix(1);
+        while (!part.empty() && std::isspace(static_cast<unsigned char>(part.back()))) part.remove_suffix(1);
+        return part;
+    };
+    const auto error = [&](const std::string& what) { return std::invalid_argument(what + " in slice '" + std::string(text) + "'"); };
+
+    std::string_view body = trim(text);
+    if (!body.empty() && body.front() == '{') {
+        if (body.size() < 2 || body.back() != '}') throw error("Unclosed brace");
+        body = body.substr(1, body.size() - 2);
+    }
+
+    std::vector<VCDSliceField> fields;
+    for (;;) {
+        const size_t comma = body.find(',');
+        std::string_view part = trim(body.substr(0, comma));
+        VCDSliceField field;
+        if (!part.empty() && part.back() == ']') {
+            const size_t open = part.rfind('[');
+            if (open == std::string_view::npos) throw error("Unopened bracket");
+            const std::string_view range = part.substr(open + 1, part.size() - open - 2);
+            const auto number = [&](const std::string_view digits_text) {
+                const std::string_view digits = trim(digits_text);
+                int index = -1;
+                const auto parsed = std::from_chars(digits.data(), digits.data() + digits.size(), index);
+                if (parsed.ec != std::errc() || parsed.ptr != digits.data() + digits.size() || index < 0) throw error("Invalid bit index");
+                return index;
+            };
+            const size_t colon = range.find(':');
+            field.first = number(range.substr(0, colon));
+            if (colon != std::string_view::npos) field.last = number(range.substr(colon + 1));
+            part = trim(part.substr(0, open));
+        }
+        field.signal = findNamed(*this, part);
+        if (field.signal == nullptr) throw error("Unknown signal '" + std::string(part) + "'");
+        fields.push_back(field);
+
+        if (comma == std::string_view::npos) break;
+        body.remove_prefix(comma + 1);
+    }
+    return slice(fields);
+}
+
+bool VCDFile::stale(const Slice& slice) {
+    for (size_t i = 0; i < slice.fields.size(); i++) {
+        if (slice.change_counts[i] != slice.fields[i].signal->change_count) return true;
+    }
+    return false;
+}
+
+std::shared_ptr<const VCDFile::Slice> VCDFile::newSlice(const std::vector<VCDSliceField>& fields, const std::string& reference,
+                                                        const uint32_t width) const {
+    auto slice = std::make_shared<Slice>();
+    slice->fields = fields;
+    slice->signal.data.usePool(pool_);
+    slice->signal.reference = reference;
+    slice->signal.type = VCDVarType::VCD_VAR_WIRE;
+    slice->signal.size = width;
+    slice->signal.lindex = width > 1 ? static_cast<int>(width - 1) : -1;
+    slice->signal.rindex = width > 1 ? 0 : -1;
+    deriveSlice(*slice);
+    return slice;
+}
+
+void VCDFile::deriveSlice(Slice& slice) const {
+    VCDSignal& signal = slice.signal;
+    for (const VCDSliceField& field : slice.fields) slice.change_counts.push_back(field.signal->change_count);
+
+    // Each signal decoded once whatever the number of its fields: its current value and the next one
+    struct Source {
+        const VCDSignal* signal;
+        VCDChangeReader reader;
+        std::vector<uint64_t> current;
+        std::vector<uint64_t> next;
+        bool current_known;
+        bool next_known;
+        std::string text;  //!< Current value when not known, X before the first change
+        bool more;
+    };
+    struct Field {
+        size_t source;
+        uint32_t low;     //!< Of the signal
+        uint32_t width;
+        uint32_t offset;  //!< In the slice
+    };
+    std::vector<Source> sources;
+    sources.reserve(slice.fields.size());
+    std::vector<Field> layout;
+    uint32_t offset = 0;
+    for (auto field = slice.fields.rbegin(); field != slice.fields.rend(); ++field) {  // Least significant first
+        auto source = std::find_if(sources.begin(), sources.end(), [&](const Source& s) { return s.signal == field->signal; });
+        if (source == sources.end()) {
+            const uint32_t size = std::max<uint32_t>(field->signal->size, 1);
+            const std::vector<uint64_t> words((size + 63) / 64, 0);
+            sources.push_back(Source{field->signal, VCDChangeReader(*field->signal), words, words, false, false, std::string(size, 'X'), false});
+            source = std::prev(sources.end());
+            source->more = source->reader.next(source->next.data(), source->next.size(), source->next_known);
+        }
+        const auto [low, high] = fieldBits(*field);
+        layout.push_back({static_cast<size_t>(source - sources.begin()), low, high - low + 1, offset});
+        offset += high - low + 1;
+    }
+
+    const uint32_t width = signal.size;
+    std::vector<uint64_t> value((width + 63) / 64, 0);
+    std::vector<uint64_t> last_value;
+    std::string text;
+    std::string last_text;
+    bool last_known = false;
+    for (;;) {
+        uint64_t index = UINT64_MAX;
+        for (const Source& source : sources) {
+            if (source.more) index = std::min(index, source.reader.timeIndex());
+        }
+        if (index == UINT64_MAX) break;
+
+        // The last change of each signal at this time index
+        bool known = true;
+        for (Source& source : sources) {
+            while (source.more && source.reader.timeIndex() == index) {
+                std::swap(source.current, source.next);
+                source.current_known = source.next_known;
+                if (!source.current_known) source.text = source.reader.value();
+                source.more = source.reader.next(source.next.data(), source.next.size(), source.next_known);
+            }
+            known = known && source.current_known;
+        }
+
+        if (known) {
+            for (const Field& field : layout) copyBits(sources[field.source].current.data(), field.low, field.width, value.data(), field.offset);
+        } else {
+            // Bit by bit, the bits taken from an unknown value may still all be 0 or 1
+            text.assign(width, '0');
+            for (const Field& field : layout) {
+                const Source& source = sources[field.source];
+                for (uint32_t bit = 0; bit < field.width; bit++) {
+                    const uint32_t position = field.low + bit;
+                    text[width - 1 - field.offset - bit] = source.current_known ? ((source.current[position / 64] >> (position % 64)) & 1 ? '1' : '0')
+                                                                                : source.text[source.text.size() - 1 - position];
+                }
+            }
+            known = packBits(text, value.data(), value.size());
+        }
+
+        if (signal.change_count > 0 && known == last_known && (known ? value == last_value : text == last_text)) continue;
+        last_known = known;
+        if (known) {
+            last_value = value;
+            unpackBits(value.data(), width, text);
+        } else {
+            last_text = text;
+        }
+        storeValueChange(signal, index, text);
+    }
+}
+
+void VCDFile::indexChanges(VCDSignal& signal) const {
+    checkWritable();
+    signal.skip.clear();
+    VCDChangeReader reader(signal);
+    uint64_t bits = 0;
+    bool known = false;
+    for (uint64_t change = 0;; change++) {
+        VCDSkipEntry entry = reader.state();
+        if (!reader.next(bits, known)) break;
+        if (change > 0 && change % VCD_SKIP_INTERVAL == 0) {
+            entry.time_index = reader.timeIndex();
+            signal.skip.push_back(entry);
+        }
+    }
+}
+
+VCDMemoryStats VCDFile::memoryUsage() const {
+    VCDMemoryStats stats;
+    for (const auto& signal : signals_) {
+        stats.vlists += signal.data.memoryUsage(stats.vlist_blocks);
+        stats.spilled += signal.data.spilledBytes();
+        stats.summaries += signal.summary.memoryUsage();
+        stats.names += signal.hash.size() + signal.reference.size();
+        stats.tables += signal.skip.capacity() * sizeof(VCDSkipEntry);
+    }
+    {
+        const std::lock_guard lock(slices_mutex_);
+        for (const auto& [key, slice] : slices_) {
+            stats.vlists += slice->signal.data.memoryUsage(stats.vlist_blocks);
+            stats.tables += slice->signal.skip.capacity() * sizeof(VCDSkipEntry);
+        }
+    }
+    for (const auto& scope : scopes_) {
+        stats.names += scope.name.size();
+    }
+    stats.time_table = times_.capacity() * sizeof(uint64_t);
+    stats.tables += signals_.capacity() * sizeof(VCDSignal) + scopes_.capacity() * sizeof(VCDScope) +
+                   (scope_signals_.capacity() + signal_slots_.capacity()) * sizeof(VCDIndex) +
+                   declarations_.capacity() * sizeof(declarations_[0]);
+    return stats;
+}
+
+uint64_t VCDFile::limitMemory(const uint64_t limit) {
+    checkWritable();
+    // Memory of the blocks, and what spilling each signal would release
+    uint64_t usage = 0;
+    std::vector<std::pair<uint64_t, VCDSignal*>> cold;
+    for (auto& signal : signals_) {
+        uint64_t blocks = 0;
+        usage += signal.data.memoryUsage(blocks);
+        if (const uint64_t bytes = signal.data.spillableBytes(); bytes > 0) cold.emplace_back(bytes, &signal);
+    }
+    if (usage <= limit) return 0;
+
+    if (!spill_) spill_ = std::make_unique<VListSpillFile>();
+    std::sort(cold.begin(), cold.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    uint64_t released = 0;
+    const uint64_t target = limit / 4 * 3;
+    for (const auto& [bytes, signal] : cold) {
+        if (usage - released <= target) break;
+        released += signal->data.spill(*spill_);
+    }
+    pool_.trim();  // The spilled blocks back to the system, rather than kept for the lists to grow into
+    return released;
+}
+
+bool VCDChangeReader::next() {
+    uint64_t delta = 0;
+    if (!reader_.next(delta)) return false;
+    time_index_ += delta;
+    uint32_t word = 0;
+
+    if (signal_.isReal()) {
+        nextReal();
+        char number[32];
+        value_.assign(number, std::to_chars(number, number + sizeof(number), real()).ptr);
+        return true;
+    }
+
+    if (signal_.size == 1) {
+        reader_.next(word);
+        value_.assign(1, utils::vcdBit2Char(static_cast<VCDBit>(word)));
+        return true;
+    }
+
+    reader_.next(word);
+    nextText(word >> 1, word & 1);
+    return true;
+}
+
+void VCDChangeReader::nextText(const size_t bit_count, const bool four_state) {
+    const size_t bits_per_word = four_state ? 8 : 32;
+    uint32_t word = 0;
+    value_.clear();
+    for (size_t done = 0; done < bit_count; done += bits_per_word) {
+        reader_.next(word);
+        const size_t count = std::min(bits_per_word, bit_count - done);
+        for (size_t i = count; i-- > 0;) {
+            value_ += four_state ? utils::vcdBit2Char(static_cast<VCDBit>((word >> (4 * i)) & 0xF)) : ((word >> i) & 1 ? '1' : '0');
+        }
+    }
+
+    // Left-extend to the declared size: 1 extends with 0, X and Z extend with themselves
+    if (value_.size() < signal_.size) {
+        const char fill = (value_.empty() || value_[0] == '1') ? '0' : value_[0];
+        value_.insert(0, signal_.size - value_.size(), fill);
+    }
+}
+
+bool VCDChangeReader::next(uint64_t& bits, bool& known) {
+    uint64_t delta = 0;
+    if (!reader_.next(delta)) return false;
+    time_index_ += delta;
+    uint32_t word = 0;
+
+    if (signal_.isReal()) {
+        nextReal();
+        bits = real_bits_;
+        known = true;
+        return true;
+    }
+
+    if (signal_.size == 1) {
+        reader_.next(word);
+        bits = static_cast<VCDBit>(word) == VCDBit::VCD_1 ? 1 : 0;
+        known = static_cast<VCDBit>(word) == VCDBit::VCD_0 || static_cast<VCDBit>(word) == VCDBit::VCD_1;
+        return true;
+    }
+
+    reader_.next(word);
+    const size_t bit_count = word >> 1;
+    const bool four_state = word & 1;
+    const size_t bits_per_word = four_state ? 8 : 32;
+
+    // Values with other bits than 0 and 1 are stored four-state: their bits are skipped
+    bits = 0;
+    known = !four_state;
+    for (size_t done = 0; done < bit_count; done += bits_per_word) {
+        reader_.next(word);
+        if (!four_state) bits = (bits << std::min(bits_per_word, bit_count - done)) | word;  // Only the last 64 bits remain
+    }
+    return true;
+}
+
+bool VCDChangeReader::next(uint64_t* words, const size_t count, bool& known) {
+    uint64_t delta = 0;
+    if (!reader_.next(delta)) return false;
+    time_index_ += delta;
+    uint32_t word = 0;
+    std::fill(words, words + count, 0);
+
+    reader_.next(word);
+    if (signal_.size == 1) {
+        const auto bit = static_cast<VCDBit>(word);
+        known = bit == VCDBit::VCD_0 || bit == VCDBit::VCD_1;
+        if (count > 0) words[0] = bit == VCDBit::VCD_1 ? 1 : 0;
+        if (!known) value_.assign(1, utils::vcdBit2Char(bit));
+        return true;
+    }
+
+    const size_t bit_count = word >> 1;
+    known = !(word & 1);
+    if (!known) {
+        nextText(bit_count, true);
+        return true;
+    }
+
+    // Stored 32 bits per word from the most significant one: each word lands at its bit position
+    for (size_t done = 0; done < bit_count; done += 32) {
+        reader_.next(word);
+        const size_t low = bit_count - done - std::min<size_t>(32, bit_count - done);
+        if (low / 64 < count) words[low / 64] |= static_cast<uint64_t>(word) << (low % 64);
+        if (low % 64 > 32 && low / 64 + 1 < count) words[low / 64 + 1] |= static_cast<uint64_t>(word) >> (64 - low % 64);
+    }
+    return true;
+}
+
+bool VCDChangeReader::seek(const uint64_t time_index) {
+    // From the last entry before the time index, the changes up to it are skipped without building their value
+    const auto& skip = signal_.skip;
+    const auto after = std::partition_point(skip.begin(), skip.end(), [&](const VCDSkipEntry& entry) { return entry.time_index < time_index; });
+    resume(after == skip.begin() ? VCDSkipEntry{} : *std::prev(after));
+
+    VCDSkipEntry before = state();
+    uint64_t bits = 0;
+    bool known = false;
+    while (next(bits, known)) {
+        if (time_index_ >= time_index) {
+            resume(before);
+            return next();
+        }
+        before = state();
+    }
+    return false;
+}
+
+bool VCDChangeReader::seekBefore(const uint64_t time_index) {
+    const auto& skip = signal_.skip;
+    const auto after = std::partition_point(skip.begin(), skip.end(), [&](const VCDSkipEntry& entry) { return entry.time_index <= time_index; });
+    resume(after == skip.begin() ? VCDSkipEntry{} : *std::prev(after));
+
+    // The state before the last change up to the time index, found by reading one change past it
+    std::optional<VCDSkipEntry> last;
+    VCDSkipEntry before = state();
+    uint64_t bits = 0;
+    bool known = false;
+    while (next(bits, known) && time_index_ <= time_index) {
+        last = before;
+        before = state();
+    }
+    resume(last.value_or(VCDSkipEntry{}));
+    return last.has_value() && next();
+}
+
+void VCDChangeReader::resume(const VCDSkipEntry& entry) {
+    if (!reader_.seek(entry.position)) reader_ = VListReader(signal_.data, entry.position);
+    time_index_ = entry.base_time_index;
+    real_bits_ = entry.real_bits;
+}
+
+double VCDChangeReader::real() const {
+    double value = 0;
+    std::memcpy(&value, &real_bits_, sizeof(value));
+    return value;
+}
+
+void VCDChangeReader::nextReal() {
+    uint32_t header = 0;
+    reader_.next(header);
+    if (header == 0) return;  // Unchanged
+
+    uint32_t low = 0;
+    uint32_t high = 0;
+    reader_.next(low);
+    if (((header - 1) & 1) != 0) reader_.next(high);
+    const uint64_t bits = (static_cast<uint64_t>(high) << 32 | low) << ((header - 1) >> 2);
+    real_bits_ = ((header - 1) & 2) != 0 ? bits : real_bits_ ^ bits;
+}
+
+bool VCDChangeCursor::next() {
+    if (position_ > signal_.change_count) return false;
+    if (++position_ > signal_.change_count) return false;
+    load(position_ - 1, false);
+    return true;
+}
+
+bool VCDChangeCursor::prev() {
+    if (position_ == 0) return false;
+    if (--position_ == 0) return false;
+    load(position_ - 1, true);
+    return true;
+}
+
+bool VCDChangeCursor::seek(const uint64_t time_index) {
+    // The window of the last entry before the time index holds the change, or the next window starts with it
+    const auto& skip = signal_.skip;
+    const auto before = [&](const VCDSkipEntry& e) { return e.time_index < time_index; };
+    const auto window = static_cast<uint64_t>(std::partition_point(skip.begin(), skip.end(), before) - skip.begin());
+    if (signal_.change_count == 0) {
+        toEnd();
         return false;
     }
+    load(window * VCD_SKIP_INTERVAL, false);
+    const auto& indices = windows_[current_].time_indices;
+    const uint64_t change = window * VCD_SKIP_INTERVAL + (std::lower_bound(indices.begin(), indices.end(), time_index) - indices.begin());
+    if (change >= signal_.change_count) {
+        toEnd();
+        return false;
+    }
+    position_ = change + 1;
+    load(change, false);
     return true;
 }
 
-}  // namespace VCDP_NAMESPACE
\ No newline at end of file
+bool VCDChangeCursor::seekBefore(const uint64_t time_index) {
+    const auto& skip = signal_.skip;
+    const auto until = [&](const VCDSkipEntry& e) { return e.time_index <= time_index; };
+    const auto window = static_cast<uint64_t>(std::partition_point(skip.begin(), skip.end(), until) - skip.begin());
+    if (signal_.change_count == 0) {
+        toStart();
+        return false;
+    }
+    load(window * VCD_SKIP_INTERVAL, true);
+    const auto& indices = windows_[current_].time_indices;
+    position_ = window * VCD_SKIP_INTERVAL + (std::upper_bound(indices.begin(), indices.end(), time_index) - indices.begin());
+    return position_ > 0;
+}
+
+void VCDChangeCursor::load(const uint64_t change, const bool backward) {
+    const uint64_t window = change / VCD_SKIP_INTERVAL;
+    const uint64_t first = window * VCD_SKIP_INTERVAL;
+    const size_t size = static_cast<size_t>(std::min<uint64_t>(VCD_SKIP_INTERVAL, signal_.change_count - first));
+    for (size_t slot = 0; slot < 2; slot++) {
+        if (windows_[slot].first == first && windows_[slot].time_indices.size() == size) {
+            current_ = slot;
+            return;
+        }
+    }
+
+    // In place of the other window, the current one is kept for a turn around
+    if (windows_[current_].first != UINT64_MAX) current_ ^= 1;
+    Window& decoded = windows_[current_];
+    decoded.first = first;
+    decoded.time_indices.resize(size);
+    decoded.values.resize(size);
+    reader_.resume(entry(window));
+    for (size_t i = 0; i < size && reader_.next(); i++) {
+        decoded.time_indices[i] = reader_.timeIndex();
+        decoded.values[i] = reader_.value();
+    }
+    if (backward && window > 0) reader_.prefetch(entry(window - 1));
+}
+
+VCDTimeCursor::VCDTimeCursor(const VCDFile& file, const std::vector<const VCDSignal*>& signals) : file_(file) {
+    cursors_.reserve(signals.size());
+    for (const VCDSignal* signal : signals) {
+        cursors_.emplace_back(*signal);
+        if (cursors_.back().next()) first_ = std::min(first_, cursors_.back().timeIndex());
+        cursors_.back().toStart();
+    }
+}
+
+bool VCDTimeCursor::next() {
+    // The earliest of the following changes, each cursor moved back once looked at
+    uint64_t next_index = UINT64_MAX;
+    for (VCDChangeCursor& cursor : cursors_) {
+        if (cursor.next()) next_index = std::min(next_index, cursor.timeIndex());
+        cursor.prev();
+    }
+    if (next_index == UINT64_MAX) return false;
+
+    // Every change at the step, the last one giving the value
+    for (VCDChangeCursor& cursor : cursors_) {
+        while (cursor.next()) {
+            if (cursor.timeIndex() > next_index) break;
+        }
+        if (!cursor.valid() || cursor.timeIndex() > next_index) cursor.prev();
+    }
+    time_index_ = next_index;
+    at_step_ = true;
+    return true;
+}
+
+bool VCDTimeCursor::prev() {
+    if (!at_step_ || time_index_ == first_) return false;
+
+    // Each cursor back before its changes at the step: the latest change left is the previous step
+    uint64_t prev_index = 0;
+    for (VCDChangeCursor& cursor : cursors_) {
+        while (cursor.valid() && cursor.timeIndex() == time_index_) cursor.prev();
+        if (cursor.valid()) prev_index = std::max(prev_index, cursor.timeIndex());
+    }
+    time_index_ = prev_index;
+    return true;
+}
+
+bool VCDTimeCursor::seek(const uint64_t time) {
+    const auto& times = file_.getTimestamps();
+    const auto index = static_cast<uint64_t>(std::lower_bound(times.begin(), times.end(), time) - times.begin());
+    for (VCDChangeCursor& cursor : cursors_) {
+        if (index == 0 || !cursor.seekBefore(index - 1)) cursor.toStart();
+    }
+    at_step_ = false;
+    if (next()) return true;
+    seekBefore(UINT64_MAX);
+    return false;
+}
+
+bool VCDTimeCursor::seekBefore(const uint64_t time) {
+    const auto& times = file_.getTimestamps();
+    const auto index = static_cast<uint64_t>(std::upper_bound(times.begin(), times.end(), time) - times.begin());
+    at_step_ = false;
+    for (VCDChangeCursor& cursor : cursors_) {
+        if (index == 0 || !cursor.seekBefore(index - 1)) {
+            cursor.toStart();
+            continue;
+        }
+        time_index_ = at_step_ ? std::max(time_index_, cursor.timeIndex()) : cursor.timeIndex();
+        at_step_ = true;
+    }
+    return at_step_;
+}
+
+}  // namespace VCDP_NAMESPACE
@@ -0,0 +1,500 @@
+#include "vcdp/VCDMerge.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+
+#include "vcdp/ThreadPool.hpp"
+#include "vcdp/Utils.hpp"
+#include "vcdp/VCDBodyDecoder.hpp"
+
+namespace VCDP_NAMESPACE {
+
+namespace {
+
+/// @brief Timescale of a file in femtoseconds, 0 when unknown.
+uint64_t timescaleFs(const VCDFile& file) {
+    uint64_t scale = file.time_resolution == 0 ? 1 : file.time_resolution;
+    switch (file.time_units) {
+        case VCDTimeUnit::TIME_S:
+            return scale * 1000000000000000ULL;
+        case VCDTimeUnit::TIME_MS:
+            return scale * 1000000000000ULL;
+        case VCDTimeUnit::TIME_US:
+            return scale * 1000000000ULL;
+        case VCDTimeUnit::TIME_NS:
+            return scale * 1000000ULL;
+        case VCDTimeUnit::TIME_PS:
+            return scale * 1000ULL;
+        case VCDTimeUnit::TIME_FS:
+            return scale;
+        default:
+            return 0;
+    }
+}
+
+/// @brief Declarations of the merged file, and where the signals of each file went.
+class MergedHeader {
+   public:
+    /**
+     * @brief Declare the scopes and signals of every file in the merged one, and lay it out.
+     * @return Empty on success, why the files cannot be merged otherwise.
+     */
+    std::string build(const std::vector<const VCDFile*>& files, const std::string& root, VCDFile& merged) {
+        if (files.empty()) return "No file to merge";
+        merged.date = files.front()->date;
+        merged.version = files.front()->version;
+
+        // The finest timescale, when every file has one
+        uint64_t finest = 0;
+        for (const VCDFile* file : files) {
+            const uint64_t scale = timescaleFs(*file);
+            if (scale == 0) {
+                finest = 0;
+                break;
+            }
+            if (finest == 0 || scale < finest) {
+                finest = scale;
+                merged.time_units = file->time_units;
+                merged.time_resolution = file->time_resolution;
+            }
+        }
+        if (finest == 0) {
+            merged.time_units = files.front()->time_units;
+            merged.time_resolution = files.front()->time_resolution;
+        }
+
+        VCDIndex root_scope = VCD_NO_INDEX;
+        if (!root.empty()) {
+            VCDScope scope;
+            scope.name = root;
+            scope.type = VCDScopeType::VCD_SCOPE_MODULE;
+            merged.current_scope = VCD_NO_INDEX;
+            merged.addScope(std::move(scope));
+            root_scope = merged.current_scope;
+        }
+
+        std::vector<std::vector<std::string>> hashes(files.size());  // Merged identifier code of the signals of each file
+        time_factors.assign(files.size(), 1);
+        for (size_t f = 0; f < files.size(); f++) {
+            const VCDFile& file = *files[f];
+            if (finest != 0) time_factors[f] = timescaleFs(file) / finest;
+            hashes[f].resize(file.getSignals().size());
+
+            // Scopes are stored parents first
+            const auto& scopes = file.getScopes();
+            std::vector<std::string> paths(scopes.size());
+            std::vector<VCDIndex> merged_scopes(scopes.size());
+            for (size_t i = 0; i < scopes.size(); i++) {
+                const bool top = scopes[i].parent == VCD_NO_INDEX;
+                paths[i] = (top ? root : paths[scopes[i].parent]) + "." + scopes[i].name;
+                const auto [found, added] = scopes_.try_emplace(paths[i], VCD_NO_INDEX);
+                if (added) {
+                    VCDScope scope;
+                    scope.name = scopes[i].name;
+                    scope.type = scopes[i].type;
+                    merged.current_scope = top ? root_scope : merged_scopes[scopes[i].parent];
+                    merged.addScope(std::move(scope));
+                    found->second = merged.current_scope;
+                }
+                merged_scopes[i] = found->second;
+            }
+
+            for (VCDIndex scope = 0; scope < scopes.size(); scope++) {
+                for (const VCDIndex signal : file.getScopeSignals(scopes[scope])) {
+                    if (std::string error = declare(merged, merged_scopes[scope], paths[scope], file.getSignals()[signal], hashes[f][signal]);
+                        !error.empty()) {
+                        return error;
+                    }
+                }
+            }
+
+            // Signals declared outside of any scope
+            for (VCDIndex signal = 0; signal < file.getSignals().size(); signal++) {
+                if (!hashes[f][signal].empty()) continue;
+                if (std::string error = declare(merged, root_scope, root, file.getSignals()[signal], hashes[f][signal]); !error.empty()) return error;
+            }
+        }
+
+        merged.current_scope = VCD_NO_INDEX;
+        merged.endDefinitions();
+
+        signals.resize(files.size());
+        for (size_t f = 0; f < files.size(); f++) {
+            for (const std::string& hash : hashes[f]) signals[f].push_back(merged.findSignal(hash));
+        }
+        return {};
+    }
+
+    std::vector<std::vector<VCDSignal*>> signals;  //!< Merged signal of each signal of each file, by index
+    std::vector<uint64_t> time_factors;            //!< Times of each file are scaled by this to the merged timescale
+    uint64_t shared = 0;
+    uint64_t remapped = 0;
+
+   private:
+    /// @brief Declare a signal of a file in a merged scope, unless a file declared it there already.
+    std::string declare(VCDFile& merged, const VCDIndex scope, const std::string& scope_path, const VCDSignal& signal, std::string& hash) {
+        std::string key = scope_path + "." + signal.reference;
+        if (signal.lindex > -1) key += "[" + std::to_string(signal.lindex) + ":" + std::to_string(signal.rindex) + "]";
+        if (signal.lindex <= -1 && signal.rindex > -1) key += "[" + std::to_string(signal.rindex) + "]";
+
+        if (const auto found = signals_.find(key); found != signals_.end()) {
+            const VCDSignal* existing = merged.findSignal(found->second);
+            if (existing->size != signal.size || existing->isReal() != signal.isReal()) {
+                return "Signal " + key.substr(1) + " is declared with different sizes or types";
+            }
+            if (hash.empty()) hash = found->second;
+            shared++;
+            return {};
+        }
+
+        VCDSignal declared;
+        if (!hash.empty()) {
+            declared.hash = hash;  // Declared again by the same file, under another path
+        } else {
+            declared.hash = signal.hash;
+            if (merged.findSignal(declared.hash) != nullptr) {
+                do {
+                    declared.hash = utils::compactIdentifier(next_id_++);
+                } while (merged.findSignal(declared.hash) != nullptr);
+                remapped++;
+            }
+            declared.reference = signal.reference;
+            declared.size = signal.size;
+            declared.type = signal.type;
+            declared.lindex = signal.lindex;
+            declared.rindex = signal.rindex;
+            hash = declared.hash;
+        }
+        signals_.emplace(std::move(key), hash);
+        merged.current_scope = scope;
+        merged.addSignal(std::move(declared));
+        return {};
+    }
+
+    std::unordered_map<std::string, VCDIndex> scopes_;       //!< Merged scope by dotted path
+    std::unordered_map<std::string, std::string> signals_;  //!< Merged identifier code by dotted path and range
+    uint64_t next_id_ = 0;
+};
+
+/// @brief Value change decoded from a file by write(), its value kept in the arena of the file.
+struct Change {
+    uint64_t time;
+    const VCDSignal* signal;  //!< In the merged file
+    uint32_t value_offset;
+    uint32_t value_size;
+};
+
+/// @brief One of the files merged by write(), decoded a chunk at a time.
+class Source {
+   public:
+    explicit Source(VCDParseResult& result) : result_(result) {}
+
+    /// @brief Parse the header, the body is left for readChunk().
+    bool open(const std::string& path) {
+        stream_.open(path, std::ios::binary);
+        if (!stream_) {
+            result_.AddError(VCDDiagCode::IO_ERROR, "Unable to open " + path);
+            return false;
+        }
+
+        VCDParser parser;
+        parser.parseHeader(stream_, &file, path);
+        result_ = parser.GetResult();
+        line_ = parser.GetLineCount();
+        offset_ = parser.GetOffset();
+        return result_.success;
+    }
+
+    /// @brief Start decoding, once the merged header is built.
+    void start(const std::vector<VCDSignal*>& signals, const uint64_t time_factor) {
+        signals_ = &signals;
+        time_factor_ = time_factor;
+        decoder_ = std::make_unique<VCDBodyDecoder<Source>>(file, result_, *this, line_);
+    }
+
+    /// @brief Decode the next chunk of the body, and the last line once the end of the file is reached.
+    void readChunk(const size_t chunk_size) {
+        buffer_.resize(chunk_size);
+        if (stream_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size())) || stream_.gcount() > 0) {
+            text_.append(buffer_.data(), stream_.gcount());
+            const size_t consumed = decoder_->decode(text_, offset_, false);
+            text_.erase(0, consumed);
+            offset_ += consumed;
+        }
+        if (!stream_) {
+            decoder_->decode(text_, offset_, true);
+            text_.clear();
+            done_ = true;
+        }
+    }
+
+    /// @brief Forget the first changes, once written.
+    void drop(const size_t count) {
+        changes_.erase(changes_.begin(), changes_.begin() + static_cast<std::ptrdiff_t>(count));
+
+        // Compact the arena around the values left
+        std::string arena;
+        for (Change& change : changes_) {
+            const auto offset = static_cast<uint32_t>(arena.size());
+            arena.append(arena_, change.value_offset, change.value_size);
+            change.value_offset = offset;
+        }
+        arena_.swap(arena);
+    }
+
+    [[nodiscard]] bool done() const { return done_; }
+
+    /// @brief Last timestamp decoded, in the merged timescale. No change older than it is still to come.
+    [[nodiscard]] uint64_t time() const { return time_; }
+
+    /// @brief Bytes of values decoded and not written yet.
+    [[nodiscard]] size_t pending() const { return arena_.size(); }
+
+    [[nodiscard]] const std::deque<Change>& changes() const { return changes_; }
+    [[nodiscard]] std::string_view value(const Change& change) const { return {arena_.data() + change.value_offset, change.value_size}; }
+
+    void onTimestamp(const uint64_t time) { time_ = time * time_factor_; }
+
+    void onValueChange(const VCDSignal& signal, const std::string_view value) {
+        changes_.push_back({time_, (*signals_)[file.indexOf(signal)], static_cast<uint32_t>(arena_.size()), static_cast<uint32_t>(value.size())});
+        arena_ += value;
+    }
+
+    VCDFile file;
+
+   private:
+    VCDParseResult& result_;
+    std::ifstream stream_;
+    std::unique_ptr<VCDBodyDecoder<Source>> decoder_;
+    const std::vector<VCDSignal*>* signals_ = nullptr;
+    uint64_t time_factor_ = 1;
+    uint64_t line_ = 0;
+    std::vector<char> buffer_;
+    std::string text_;  //!< Starts with the line cut at the end of the previous chunk
+    uint64_t offset_ = 0;
+    bool done_ = false;
+    uint64_t time_ = 0;
+    std::deque<Change> changes_;  //!< Decoded, not written yet
+    std::string arena_;           //!< Values of the changes
+};
+
+VCDMergeResult failure(const std::string& error) {
+    VCDMergeResult result;
+    result.success = false;
+    result.error = error;
+    return result;
+}
+
+/// @brief First error of a file whose header could not be read, empty if it could.
+std::string headerError(const VCDParseResult& result, const std::string& path) {
+    if (result.errors.Count(VCDDiagCode::IO_ERROR) == 0 && result.errors.Count(VCDDiagCode::HEADER_SYNTAX) == 0) return {};
+    return result.errors.empty() ? "Unable to read " + path : result.errors[0].Message();
+}
+
+}  // namespace
+
+VCDMergeResult VCDMerger::merge(const std::vector<std::string>& paths, VCDFile* merged) {
+    parse_results_.assign(paths.size(), VCDParseResult());
+    if (paths.empty()) return failure("No file to merge");
+
+    // Files in parallel, the threads left over decode the bodies
+    const unsigned threads = options_.threads == 0 ? ThreadPool::defaultThreadCount() : options_.threads;
+    const auto workers = static_cast<unsigned>(std::min<size_t>(threads, paths.size()));
+    std::vector<VCDFile> files(paths.size());
+    {
+        ThreadPool pool(workers);
+        pool.parallelFor(paths.size(), [&](const size_t i) {
+            VCDParser parser;
+            ParseOptions options;
+            options.threads = std::max(1u, threads / workers);
+            parser.parse(paths[i], &files[i], options);
+            parse_results_[i] = parser.GetResult();
+        });
+    }
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (std::string error = headerError(parse_results_[i], paths[i]); !error.empty()) return failure(error);
+    }
+
+    MergedHeader header;
+    std::vector<const VCDFile*> file_pointers;
+    for (const VCDFile& file : files) file_pointers.push_back(&file);
+    if (std::string error = header.build(file_pointers, options_.root, *merged); !error.empty()) return failure(error);
+
+    // Time tables, k-way merged: each time of each file to its index in the merged table
+    std::vector<std::vector<uint64_t>> time_indices(files.size());
+    using Next = std::pair<uint64_t, size_t>;  // (time, file)
+    std::priority_queue<Next, std::vector<Next>, std::greater<>> next;
+    std::vector<size_t> positions(files.size(), 0);
+    for (size_t f = 0; f < files.size(); f++) {
+        time_indices[f].resize(files[f].getTimestamps().size());
+        if (!files[f].getTimestamps().empty()) next.emplace(files[f].getTimestamps().front() * header.time_factors[f], f);
+    }
+    while (!next.empty()) {
+        const auto [time, f] = next.top();
+        next.pop();
+        if (merged->getTimestamps().empty() || merged->getTimestamps().back() != time) merged->addTimestamp(time);
+        time_indices[f][positions[f]++] = merged->getTimestamps().size() - 1;
+        if (positions[f] < time_indices[f].size()) next.emplace(files[f].getTimestamps()[positions[f]] * header.time_factors[f], f);
+    }
+
+    // Signals of the files merged into each signal
+    std::vector<VCDSignal*> targets(merged->getSignals().size());
+    std::vector<std::vector<std::pair<size_t, const VCDSignal*>>> sources(targets.size());
+    for (size_t f = 0; f < files.size(); f++) {
+        for (VCDIndex signal = 0; signal < files[f].getSignals().size(); signal++) {
+            VCDSignal* target = header.signals[f][signal];
+            targets[merged->indexOf(*target)] = target;
+            sources[merged->indexOf(*target)].emplace_back(f, &files[f].getSignals()[signal]);
+        }
+    }
+
+    // Changes, signals in parallel: each signal is written by one thread
+    std::atomic<uint64_t> changes = 0;
+    {
+        ThreadPool pool(threads);
+        const size_t partitions = std::min<size_t>(targets.size(), pool.size() * 4);
+        pool.parallelFor(partitions, [&](const size_t partition) {
+            uint64_t count = 0;
+            std::vector<VCDChangeReader> readers;
+            std::vector<bool> pending;
+            for (size_t signal = partition; signal < targets.size(); signal += partitions) {
+                readers.clear();
+                pending.clear();
+                for (const auto& [f, source] : sources[signal]) {
+                    readers.emplace_back(*source);
+                    pending.push_back(readers.back().next());
+                }
+
+                // The earliest change, the earlier file first on a tie
+                const auto time_index = [&](const size_t reader) {
+                    const auto& indices = time_indices[sources[signal][reader].first];
+                    return readers[reader].timeIndex() < indices.size() ? indices[readers[reader].timeIndex()] : 0;
+                };
+                while (true) {
+                    size_t first = readers.size();
+                    for (size_t reader = 0; reader < readers.size(); reader++) {
+                        if (pending[reader] && (first == readers.size() || time_index(reader) < time_index(first))) first = reader;
+                    }
+                    if (first == readers.size()) break;
+
+                    merged->addValueChange(*targets[signal], time_index(first), readers[first].value());
+                    count++;
+                    pending[first] = readers[first].next();
+                }
+            }
+            changes += count;
+        });
+    }
+
+    VCDMergeResult result;
+    result.signals = targets.size();
+    result.shared = header.shared;
+    result.remapped = header.remapped;
+    result.timestamps = merged->getTimestamps().size();
+    result.changes = changes;
+    return result;
+}
+
+VCDMergeResult VCDMerger::write(const std::vector<std::string>& paths, const std::string& output_path, const WriteOptions& write_options) {
+    parse_results_.assign(paths.size(), VCDParseResult());
+    if (paths.empty()) return failure("No file to merge");
+
+    const unsigned threads = options_.threads == 0 ? ThreadPool::defaultThreadCount() : options_.threads;
+    ThreadPool pool(static_cast<unsigned>(std::min<size_t>(threads, paths.size())));
+
+    std::vector<std::unique_ptr<Source>> sources;
+    for (auto& parse_result : parse_results_) sources.push_back(std::make_unique<Source>(parse_result));
+    std::vector<char> opened(paths.size());
+    pool.parallelFor(paths.size(), [&](const size_t i) { opened[i] = sources[i]->open(paths[i]); });
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (!opened[i]) return failure(parse_results_[i].errors.empty() ? "Unable to read " + paths[i] : parse_results_[i].errors[0].Message());
+    }
+
+    // Only the declarations of the merged file are stored
+    VCDFile merged;
+    MergedHeader header;
+    std::vector<const VCDFile*> files;
+    for (const auto& source : sources) files.push_back(&source->file);
+    if (std::string error = header.build(files, options_.root, merged); !error.empty()) return failure(error);
+    for (size_t i = 0; i < sources.size(); i++) sources[i]->start(header.signals[i], header.time_factors[i]);
+
+    VCDStreamWriter writer(merged, output_path, write_options);
+    if (!writer.good()) return failure("Unable to open " + output_path);
+
+    // Write the changes older than the horizon, no file can add any before it
+    uint64_t written_time = 0;
+    bool time_written = false;
+    const auto write_until = [&](const uint64_t horizon, const bool all) {
+        using Next = std::pair<uint64_t, size_t>;  // (time, source)
+        std::priority_queue<Next, std::vector<Next>, std::greater<>> next;
+        std::vector<size_t> cut(sources.size(), 0);
+        for (size_t i = 0; i < sources.size(); i++) {
+            const auto& changes = sources[i]->changes();
+            if (!changes.empty() && (all || changes.front().time < horizon)) next.emplace(changes.front().time, i);
+        }
+        while (!next.empty()) {
+            const auto [time, i] = next.top();
+            next.pop();
+            if (!time_written || time != written_time) {
+                writer.addTimestamp(time);
+                written_time = time;
+                time_written = true;
+            }
+
+            // The changes of a source at that time, in file order
+            const auto& changes = sources[i]->changes();
+            for (; cut[i] < changes.size() && changes[cut[i]].time == time; cut[i]++) {
+                writer.addValueChange(*changes[cut[i]].signal, sources[i]->value(changes[cut[i]]));
+            }
+            if (cut[i] < changes.size() && (all || changes[cut[i]].time < horizon)) next.emplace(changes[cut[i]].time, i);
+        }
+        for (size_t i = 0; i < sources.size(); i++) sources[i]->drop(cut[i]);
+    };
+
+    const size_t chunk_size = std::max<size_t>(options_.chunk_size, 1);
+    std::vector<size_t> reading;
+    while (!writer.done()) {
+        uint64_t horizon = UINT64_MAX;
+        for (const auto& source : sources) {
+            if (!source->done()) horizon = std::min(horizon, source->time());
+        }
+        if (horizon == UINT64_MAX) break;
+
+        // The files lagging behind, and the others while they hold little undecided
+        reading.clear();
+        for (size_t i = 0; i < sources.size(); i++) {
+            if (!sources[i]->done() && (sources[i]->time() == horizon || sources[i]->pending() < chunk_size)) reading.push_back(i);
+        }
+        pool.parallelFor(reading.size(), [&](const size_t i) { sources[reading[i]]->readChunk(chunk_size); });
+
+        horizon = UINT64_MAX;
+        for (const auto& source : sources) {
+            if (!source->done()) horizon = std::min(horizon, source->time());
+        }
+        write_until(horizon, false);
+    }
+    if (!writer.done()) write_until(UINT64_MAX, true);
+
+    // End of the timeline
+    uint64_t end = 0;
+    for (const auto& source : sources) end = std::max(end, source->time());
+    if (!time_written || end > written_time) writer.addTimestamp(end);
+
+    const VCDWriteResult written = writer.finish();
+    if (!written.success) return failure(written.error);
+
+    VCDMergeResult result;
+    result.signals = merged.getSignals().size();
+    result.shared = header.shared;
+    result.remapped = header.remapped;
+    result.changes = written.changes;
+    result.bytes = written.bytes;
+    return result;
+}
+
+}  // namespace VCDP_NAMESPACE
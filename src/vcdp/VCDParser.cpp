@@ -1,14 +1,218 @@
 #include "vcdp/VCDParser.hpp"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <charconv>
 #include <fstream>
+#include <thread>
 #include <tao/pegtl/contrib/trace.hpp>
 
+#include "vcdp/ThreadPool.hpp"
 #include "vcdp/VCDActions.hpp"
+#include "vcdp/VCDBodyDecoder.hpp"
 #include "vcdp/VCDLexical.hpp"
 
 namespace VCDP_NAMESPACE {
 
+namespace {
+
+constexpr size_t BUFFER_SIZE = 64 * 1024;  // 64 Ko chunks
+
+/// @brief Stores the decoded changes straight into the file.
+struct FileSink {
+    VCDFile& file;
+    uint64_t changes = 0;
+
+    void onTimestamp(const uint64_t time) const { file.addTimestamp(time); }
+    void onValueChange(VCDSignal& signal, const std::string_view value) {
+        file.addValueChange(signal, value);
+        changes++;
+    }
+};
+
+/// @brief Value change decoded by a worker, pointing into the batch text.
+struct PendingChange {
+    VCDSignal* signal;
+    const char* value;
+    uint32_t value_size;
+    uint32_t time_slot;  //!< Number of timestamps of the slice preceding the change
+};
+
+/// @brief What a worker decoded from one slice of a batch.
+struct DecodedChunk {
+    std::vector<uint64_t> times;
+    std::vector<std::vector<PendingChange>> changes;  //!< Bucketed by signal partition
+    VCDParseResult result;
+    uint64_t lines = 0;
+    bool in_comment = false;  //!< The slice ends inside a $comment
+
+    void Reset(const size_t partitions) {
+        times.clear();
+        changes.resize(partitions);
+        for (auto& bucket : changes) bucket.clear();
+        result.Clear();
+        lines = 0;
+        in_comment = false;
+    }
+};
+
+struct ChunkSink {
+    const VCDFile& file;
+    DecodedChunk& chunk;
+    size_t partitions;
+
+    void onTimestamp(const uint64_t time) const { chunk.times.push_back(time); }
+    void onValueChange(VCDSignal& signal, const std::string_view value) const {
+        const size_t partition = file.indexOf(signal) % partitions;
+        chunk.changes[partition].push_back(
+            PendingChange{&signal, value.data(), static_cast<uint32_t>(value.size()), static_cast<uint32_t>(chunk.times.size())});
+    }
+};
+
+/// @brief Position of the first line of a block starting with '#' at or after `from`.
+size_t findTimestampLine(const std::string_view text, size_t from, const bool carriage_returns) {
+    while ((from = text.find('#', from)) != std::string_view::npos) {
+        if (from == 0 || text[from - 1] == '\n' || (carriage_returns && text[from - 1] == '\r')) return from;
+        from++;
+    }
+    return std::string_view::npos;
+}
+
+/// @brief End of the line holding the first $end at or after `from`: where a $comment open at `from` is closed.
+size_t commentEnd(const std::string_view text, const size_t from) {
+    const size_t end = text.find("$end", from);
+    if (end == std::string_view::npos) return std::string_view::npos;
+    return std::min(text.find_first_of("\r\n", end), text.size());
+}
+
+/// @brief Position of the first line of a block opening a $comment at or after `from`, as VCDBodyDecoder tells them.
+size_t findCommentLine(const std::string_view text, size_t from) {
+    while ((from = text.find("$comment", from)) != std::string_view::npos) {
+        size_t line_start = from;
+        while (line_start > 0 && (text[line_start - 1] == ' ' || text[line_start - 1] == '\t')) line_start--;
+        if (line_start == 0 || text[line_start - 1] == '\n' || text[line_start - 1] == '\r') return from;
+        from++;
+    }
+    return std::string_view::npos;
+}
+
+/**
+ * @brief Split a block of complete lines into at most `count` slices, each starting on a timestamp line out of any
+ * $comment: the decoders of the slices but the first one start out of a comment.
+ * @param in_comment The block starts inside a $comment.
+ * @param carriage_returns A lone '\r' ends a line too.
+ */
+std::vector<std::string_view> splitAtTimestamps(const std::string_view text, const size_t count, const bool in_comment,
+                                                const bool carriage_returns) {
+    constexpr size_t npos = std::string_view::npos;
+    size_t comment_start = 0;  // Comment, the next one ending after the last cut: [comment_start, comment_end)
+    size_t comment_end = in_comment ? commentEnd(text, 0) : 0;
+
+    std::vector<std::string_view> slices;
+    size_t start = 0;
+    for (size_t i = 1; i < count && start < text.size(); i++) {
+        size_t cut = findTimestampLine(text, std::max(start + 1, text.size() * i / count), carriage_returns);
+        while (cut != npos) {
+            while (comment_end <= cut && comment_start != npos) {
+                comment_start = findCommentLine(text, comment_end);
+                comment_end = comment_start == npos ? npos : commentEnd(text, comment_start + 8);
+            }
+            if (comment_start == npos || cut < comment_start || cut >= comment_end) break;
+            cut = comment_end == npos ? npos : findTimestampLine(text, comment_end, carriage_returns);  // Past the comment
+        }
+        if (cut == npos) break;
+        slices.push_back(text.substr(start, cut - start));
+        start = cut;
+    }
+    slices.push_back(text.substr(start));
+    return slices;
+}
+
+/// @brief Bytes of $var declarations below which a run is not worth a worker.
+constexpr size_t HEADER_RUN_MIN = 64 * 1024;
+
+/// @brief Part of the declaration section, as cut by scanHeader().
+struct HeaderSegment {
+    std::string_view text;
+    size_t byte;    //!< Position of the first character in the section
+    size_t line;    //!< From 1
+    size_t column;  //!< From 1
+    bool vars;      //!< Only $var declarations inside a scope, parsed on a worker
+};
+
+/**
+ * @brief Cut the declaration section into runs of $var declarations of about `run_size` bytes and the declarations
+ * between them, looking at the keywords only. Text that is not a sequence of known declarations closed by $end is
+ * left in one segment, for the grammar to report the error.
+ */
+std::vector<HeaderSegment> scanHeader(const std::string_view header, const size_t run_size) {
+    static constexpr std::array<std::string_view, 8> KEYWORDS = {"$comment", "$date", "$enddefinitions", "$scope",
+                                                                 "$timescale", "$upscope", "$var", "$version"};
+    const auto is_space = [](const char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; };
+    const std::vector<HeaderSegment> whole = {{header, 0, 1, 1, false}};
+
+    std::vector<HeaderSegment> segments;
+    size_t pos = 0, line = 1, line_start = 0;
+    const auto advance = [&](const size_t to) {
+        for (; pos < to; pos++) {
+            if (header[pos] == '\n') {
+                line++;
+                line_start = pos + 1;
+            }
+        }
+    };
+    HeaderSegment between{{}, 0, 1, 1, false};  // Declarations since the last run handed to a worker
+    HeaderSegment run{{}, std::string_view::npos, 0, 0, true};
+    size_t depth = 0;
+
+    while (true) {
+        size_t next = pos;
+        while (next < header.size() && is_space(header[next])) next++;
+        advance(next);
+        size_t keyword_end = pos;
+        while (keyword_end < header.size() && !is_space(header[keyword_end])) keyword_end++;
+        const std::string_view keyword = header.substr(pos, keyword_end - pos);
+        if (std::find(KEYWORDS.begin(), KEYWORDS.end(), keyword) == KEYWORDS.end()) return whole;
+
+        // The $end closing the declaration follows a space, as the grammar wants it
+        size_t end = keyword_end;
+        do {
+            end = header.find("$end", end + 1);
+        } while (end != std::string_view::npos && !is_space(header[end - 1]));
+        if (end == std::string_view::npos || (end + 4 < header.size() && !is_space(header[end + 4]))) return whole;
+
+        const bool var = keyword == "$var" && depth > 0;
+        if (run.byte != std::string_view::npos && (!var || pos - run.byte >= run_size)) {
+            if (pos - run.byte >= HEADER_RUN_MIN) {
+                between.text = header.substr(between.byte, run.byte - between.byte);
+                if (!between.text.empty()) segments.push_back(between);
+                run.text = header.substr(run.byte, pos - run.byte);
+                segments.push_back(run);
+                between = {{}, pos, line, pos - line_start + 1, false};
+            }
+            run.byte = std::string_view::npos;
+        }
+        if (var && run.byte == std::string_view::npos) run = {{}, pos, line, pos - line_start + 1, true};
+
+        if (keyword == "$scope") {
+            depth++;
+        } else if (keyword == "$upscope") {
+            if (depth == 0) return whole;
+            depth--;
+        } else if (keyword == "$enddefinitions") {
+            break;
+        }
+        advance(end + 4);
+    }
+
+    between.text = header.substr(between.byte);
+    segments.push_back(between);
+    return segments;
+}
+
+}  // namespace
+
 void VCDParser::parseHeader(std::ifstream& stream, VCDFile* file, const std::string& file_path) {
     file_ = file;
     result_.Clear();
@@ -18,114 +222,408 @@ void VCDParser::parseHeader(std::ifstream& stream, VCDFile* file, const std::str
     std::string line;
     bool found_enddefinitions = false;
     bool found_end = false;
+    bool read_past = false;  // The last line read runs past the header
+    line_ = 0;
 
-    while (std::getline(stream, line)) {
-        header += line + '\n';
+    {
+        const VCDPhaseTimer timer(profile(), VCDPhase::HEADER_READ);
+        while (std::getline(stream, line)) {
+            header += line + '\n';
+            line_++;
+
+            // Find $enddefinitions
+            if (!found_enddefinitions) {
+                if (line.find("$enddefinitions") != std::string::npos) {
+                    found_enddefinitions = true;
+                }
+            }
 
-        // Find $enddefinitions
-        if (!found_enddefinitions) {
-            if (line.find("$enddefinitions") != std::string::npos) {
-                found_enddefinitions = true;
+            // Find end following $enddefinitions
+            if (found_enddefinitions && line.find("$end") != std::string::npos) {
+                found_end = true;
+                break;
             }
         }
 
-        // Find end following $enddefinitions
-        if (found_enddefinitions && line.find("$end") != std::string::npos) {
-            found_end = true;
-            break;
+        // With lines ended by a lone '\r', the body follows on the same line: cut after the line of the closing $end
+        if (found_end) {
+            const size_t definitions = line.find("$enddefinitions");
+            const size_t end = line.find("$end", definitions == std::string::npos ? 0 : definitions + 15);
+            const size_t cr = end == std::string::npos ? std::string::npos : line.find('\r', end);
+            if (cr != std::string::npos && cr + 1 < line.size()) {
+                header.resize(header.size() - (line.size() - cr));
+                line_ += std::count(line.begin(), line.begin() + static_cast<std::ptrdiff_t>(cr), '\r');
+                read_past = true;
+            }
+        }
+
+        if (timer.stats() != nullptr) {
+            timer.stats()->bytes += header.size();
+            timer.stats()->lines += line_;
         }
     }
 
-    if (!found_end) {
-        result_.errors.emplace_back("Parse error: Missing $end after $enddefinitions");
+    // When following, an unterminated last line may still be growing
+    if (!found_end || (options_.follow && stream.eof() && !read_past)) {
+        result_.AddError(VCDDiagCode::HEADER_INCOMPLETE, "Missing $end after $enddefinitions");
+        file_ = nullptr;
         return;
     }
+    if (read_past) {
+        offset_ = header.size();
+        stream.clear();
+        stream.seekg(static_cast<std::streamoff>(offset_));
+    } else {
+        offset_ = header.size() - (stream.eof() ? 1 : 0);  // No '\n' after the last line
+    }
+    carriage_returns_ = header.find('\r') != std::string::npos;
 
     try {
-        pegtl::memory_input<> in(header, file_path);
-        if (ActionState state; !pegtl::parse<lexical::declaration_section, action>(in, *file_, state)) {
-            result_.success = false;
-            result_.errors.emplace_back("Internal parse error...");
+        const VCDPhaseTimer timer(profile(), VCDPhase::HEADER_PARSE);
+        if (timer.stats() != nullptr) {
+            timer.stats()->bytes += header.size();
+            timer.stats()->lines += line_;
         }
+
+        parseDeclarations(header, file_path);
     } catch (const pegtl::parse_error& e) {
-        result_.success = false;
-        result_.errors.emplace_back("Parse error: " + std::string(e.what()));
+        result_.AddError(VCDDiagCode::HEADER_SYNTAX, e.what());
     }
 
     file_ = nullptr;
 }
 
+void VCDParser::parseDeclarations(const std::string& header, const std::string& file_path) {
+    // Long runs of $var, as in flattened netlists, are parsed on the workers
+    const unsigned threads = options_.threads == 0 ? ThreadPool::defaultThreadCount() : options_.threads;
+    const std::vector<HeaderSegment> segments = threads > 1 ? scanHeader(header, std::max(header.size() / (4 * threads), HEADER_RUN_MIN))
+                                                            : std::vector<HeaderSegment>{{header, 0, 1, 1, false}};
+    const auto input = [&](const HeaderSegment& segment) {
+        return pegtl::memory_input<>(segment.text.data(), segment.text.data() + segment.text.size(), file_path, segment.byte, segment.line,
+                                     segment.column);
+    };
+
+    std::vector<VCDSignalBatch> batches(segments.size());
+    std::vector<std::string> errors(segments.size());  // First error of each run, the declarations before it are kept
+    if (segments.size() > 1) {
+        ThreadPool pool(threads);
+        pool.parallelFor(segments.size(), [&](const size_t i) {
+            if (!segments[i].vars) return;
+            try {
+                auto in = input(segments[i]);
+                ActionState state;
+                if (!pegtl::parse<lexical::var_run, action>(in, batches[i], state)) errors[i] = "Internal parse error...";
+            } catch (const pegtl::parse_error& e) {
+                errors[i] = e.what();
+            }
+        });
+    }
+
+    // Spliced in order with the declarations around them, which move the current scope
+    ActionState state;
+    for (size_t i = 0; i < segments.size(); i++) {
+        if (segments[i].vars) {
+            for (auto& signal : batches[i].signals) file_->addSignal(std::move(signal));
+            batches[i] = VCDSignalBatch();
+            if (!errors[i].empty()) {
+                result_.AddError(VCDDiagCode::HEADER_SYNTAX, errors[i]);
+                return;
+            }
+        } else if (auto in = input(segments[i]); i + 1 < segments.size()) {
+            if (!pegtl::parse<lexical::declaration_run, action>(in, *file_, state)) {
+                result_.AddError(VCDDiagCode::HEADER_SYNTAX, "Internal parse error...");
+                return;
+            }
+        } else if (!pegtl::parse<lexical::declaration_section, action>(in, *file_, state)) {
+            result_.AddError(VCDDiagCode::HEADER_SYNTAX, "Internal parse error...");
+        }
+    }
+}
+
 void VCDParser::parseValueChange(std::ifstream& stream, VCDFile* file, const std::string& file_path) {
     file_ = file;
-    result_.Clear();
-    constexpr size_t BUFFER_SIZE = 64 * 1024;  // 64 Ko chunks
+    decodeBody(stream);
+    file_ = nullptr;
+}
+
+void VCDParser::decodeBody(std::istream& stream) {
+    const unsigned threads = options_.threads == 0 ? ThreadPool::defaultThreadCount() : options_.threads;
+    const auto decode = [&](auto dialect) {
+        using Dialect = decltype(dialect);
+        if constexpr (Dialect::ID_SIZE > 0) {
+            if (ids_.idSize() != Dialect::ID_SIZE) ids_ = VCDIdTable(*file_, Dialect::ID_SIZE);  // Once per file, polls included
+        }
+        if (threads > 1) {
+            parseValueChangeParallel<Dialect>(stream, threads);
+        } else {
+            decodeSerial<Dialect>(stream);
+        }
+    };
+
+    if (options_.detect_dialect && !carriage_returns_) {
+        withDialect(*file_, decode);
+    } else {
+        decode(VCDGenericDialect{});
+    }
+
+    // Bound the tail of the body too
+    if (options_.memory_limit > 0) {
+        const auto lock = file_->writeLock();
+        boundMemory(0, true);
+    }
+}
+
+template <typename Dialect>
+void VCDParser::decodeSerial(std::istream& stream) {
     std::array<char, BUFFER_SIZE> buffer{};
-    std::string leftover;  // For cutted lines, caused by chunking
+    std::string chunk = std::move(leftover_);  // Starts with the line cut at the end of the previous read
+    uint64_t chunk_offset = offset_;
+    FileSink sink{*file_};
+    VCDBodyDecoder<FileSink, Dialect> decoder(*file_, ids_, result_, sink, line_, in_comment_);
 
-    while (stream.read(buffer.data(), BUFFER_SIZE) || stream.gcount() > 0) {
-        const size_t byte_read = stream.gcount();
+    while (true) {
+        {
+            const VCDPhaseTimer timer(profile(), VCDPhase::BODY_READ);
+            if (!stream.read(buffer.data(), BUFFER_SIZE) && stream.gcount() == 0) break;
+            if (timer.stats() != nullptr) timer.stats()->bytes += stream.gcount();
+        }
+        chunk.append(buffer.data(), stream.gcount());
+
+        // Parse line by line in the chunk, keep the incomplete line for the next one
+        const VCDPhaseTimer timer(profile(), VCDPhase::DECODE);
+        const auto lock = file_->writeLock();
+        const size_t consumed = decoder.decode(chunk, chunk_offset, false);
+        chunk.erase(0, consumed);
+        chunk_offset += consumed;
+        if (timer.stats() != nullptr) timer.stats()->bytes += consumed;
+        boundMemory(consumed);
+    }
 
-        // Combine leftover + the new chunk
-        std::string chunk = leftover + std::string(buffer.data(), byte_read);
-        leftover.clear();
+    // Parse the last line of the file (no '\n'), unless the rest of it is still to be written
+    if (!options_.follow) {
+        const VCDPhaseTimer timer(profile(), VCDPhase::DECODE);
+        const auto lock = file_->writeLock();
+        chunk_offset += decoder.decode(chunk, chunk_offset, true);
+        if (timer.stats() != nullptr) timer.stats()->bytes += chunk.size();
+        chunk.clear();
+    }
 
-        // Parse line by line in the chunk
-        size_t pos = 0;
-        size_t line_start = 0;
+    if (VCDProfile* stats = profile(); stats != nullptr) {
+        (*stats)[VCDPhase::DECODE].lines += decoder.line() - line_;
+        (*stats)[VCDPhase::DECODE].changes += sink.changes;
+    }
+    line_ = decoder.line();
+    in_comment_ = decoder.inComment();
+    offset_ = chunk_offset;
+    leftover_ = std::move(chunk);
+}
 
-        while ((pos = findNextLine(chunk, line_start)) != std::string::npos) {
-            std::string line = chunk.substr(line_start, pos - line_start);
+/*
+ * The body is read in batches of threads * chunk_size bytes. Each batch is:
+ *  1. split into slices starting on a timestamp line,
+ *  2. decoded slice by slice in parallel, changes being bucketed by signal partition,
+ *  3. timestamps appended in order,
+ *  4. stored partition by partition in parallel, so that each signal is written by one thread.
+ */
+template <typename Dialect>
+void VCDParser::parseValueChangeParallel(std::istream& stream, const unsigned threads) {
+    ThreadPool pool(threads);
+    std::vector<DecodedChunk> chunks(threads);
+    std::vector<uint64_t> time_bases(threads);
+    const size_t batch_size = threads * options_.chunk_size;
 
-            // Parse the line
-            parseValueChangeLine(line);
+    std::string batch = std::move(leftover_);  // Starts with the line cut at the end of the previous batch
+    uint64_t batch_offset = offset_;
+    bool last = false;
 
-            line_start = pos + 1;
+    while (!last) {
+        {
+            const VCDPhaseTimer timer(profile(), VCDPhase::BODY_READ);
+            const size_t kept = batch.size();
+            batch.resize(kept + batch_size);
+            stream.read(batch.data() + kept, static_cast<std::streamsize>(batch_size));
+            batch.resize(kept + stream.gcount());
+            last = !stream;
+            if (timer.stats() != nullptr) timer.stats()->bytes += stream.gcount();
         }
 
-        // Keep the incomplete line for the next chunk
-        if (line_start < chunk.size()) {
-            leftover = chunk.substr(line_start);
+        const std::string_view text(batch);
+        const bool whole = last && !options_.follow;  // Also decode an unterminated last line
+        size_t end = text.size();
+        if (!whole) {
+            // Up to the last line end the decoder knows, a '\r' ending the batch may be the first half of "\r\n"
+            const char* line_ends = Dialect::TRIM ? "\r\n" : "\n";
+            end = text.find_last_of(line_ends);
+            if (end != std::string_view::npos && end + 1 == text.size() && text[end] == '\r') {
+                end = end == 0 ? std::string_view::npos : text.find_last_of(line_ends, end - 1);
+            }
+            end++;  // npos + 1 == 0
         }
-    }
+        std::vector<std::string_view> slices;
+        {
+            const VCDPhaseTimer timer(profile(), VCDPhase::SPLIT);
+            slices = splitAtTimestamps(text.substr(0, end), threads, in_comment_, Dialect::TRIM);
+            if (timer.stats() != nullptr) timer.stats()->bytes += end;
+        }
+
+        // Decode
+        {
+            const VCDPhaseTimer timer(profile(), VCDPhase::DECODE);
+            pool.parallelFor(slices.size(), [&](const size_t i) {
+                DecodedChunk& chunk = chunks[i];
+                chunk.Reset(threads);
+                ChunkSink sink{*file_, chunk, threads};
+                VCDBodyDecoder<ChunkSink, Dialect> decoder(*file_, ids_, chunk.result, sink, 0, i == 0 && in_comment_);
+                decoder.decode(slices[i], batch_offset + (slices[i].data() - text.data()), true);  // Slices end with a line
+                chunk.lines = decoder.line();
+                chunk.in_comment = decoder.inComment();
+            });
 
-    // Parse the last line of the file (no '\n')
-    if (!leftover.empty()) {
-        // Parse the line
-        parseValueChangeLine(leftover);
+            if (timer.stats() != nullptr) {
+                timer.stats()->bytes += end;
+                for (size_t i = 0; i < slices.size(); i++) {
+                    timer.stats()->lines += chunks[i].lines;
+                    for (const auto& bucket : chunks[i].changes) timer.stats()->changes += bucket.size();
+                }
+            }
+        }
+
+        {
+            const auto lock = file_->writeLock();
+            const VCDPhaseTimer timer(profile(), VCDPhase::STORE);
+
+            // Timestamps, in file order
+            for (size_t i = 0; i < slices.size(); i++) {
+                time_bases[i] = file_->getTimestamps().size();
+                for (const uint64_t time : chunks[i].times) {
+                    file_->addTimestamp(time);
+                }
+            }
+
+            // Store
+            std::atomic<uint64_t> allocations = 0;  // Made by the workers, invisible to this thread's counter
+            pool.parallelFor(threads, [&](const size_t partition) {
+                const bool counting = std::exchange(vlist_count_allocations, timer.stats() != nullptr);
+                const uint64_t allocated = vlist_allocations;
+                for (size_t i = 0; i < slices.size(); i++) {
+                    for (const PendingChange& change : chunks[i].changes[partition]) {
+                        // A change preceding the first timestamp of the slice belongs to the previous one
+                        const uint64_t slot = time_bases[i] + change.time_slot;
+                        file_->addValueChange(*change.signal, slot == 0 ? 0 : slot - 1, std::string_view(change.value, change.value_size));
+                    }
+                }
+                if (timer.stats() != nullptr) allocations += vlist_allocations - allocated;
+                vlist_count_allocations = counting;
+            });
+
+            if (timer.stats() != nullptr) {
+                timer.stats()->allocations += allocations;
+                for (size_t i = 0; i < slices.size(); i++) {
+                    for (const auto& bucket : chunks[i].changes) timer.stats()->changes += bucket.size();
+                }
+            }
+            boundMemory(end);
+        }
+
+        for (size_t i = 0; i < slices.size(); i++) {
+            result_.Merge(chunks[i].result, line_);
+            line_ += chunks[i].lines;
+        }
+        in_comment_ = chunks[slices.size() - 1].in_comment;
+
+        batch.erase(0, end);
+        batch_offset += end;
     }
 
-    file_ = nullptr;
+    offset_ = batch_offset;
+    leftover_ = std::move(batch);
 }
 
-void VCDParser::parse(const std::string& file_path, VCDFile* file) {
+void VCDParser::parse(const std::string& file_path, VCDFile* file, const ParseOptions& options) {
     result_.Clear();
+    options_ = options;
+    path_ = file_path;
+    followed_ = file;
+    header_done_ = false;
+    unbounded_bytes_ = 0;
+    leftover_.clear();
+    in_comment_ = false;
+    ids_ = {};
 
     std::ifstream stream(file_path, std::ios::binary);
+    if (!stream) {
+        result_.AddError(VCDDiagCode::IO_ERROR, "Unable to open " + file_path);
+        return;
+    }
 
     parseHeader(stream, file, file_path);
-    parseValueChange(stream, file, file_path);
+    if (result_.success) {
+        header_done_ = true;
+        if (options_.summary_resolution > 0) file->enableSummaries(options_.summary_resolution);
+        parseValueChange(stream, file, file_path);
+        if (options_.freeze && !options_.follow) file->freeze();
+    }
+    recordMemory();
 }
 
-size_t VCDParser::findNextLine(const std::string& chunk, size_t start) {
-    const size_t lf_pos = chunk.find('\n', start);
-    const size_t cr_pos = chunk.find('\r', start);
-    if (lf_pos == std::string::npos && cr_pos == std::string::npos) {
-        return std::string::npos;
-    }
+/// @brief Spill cold value changes once the decoded bytes may have grown them past the limit. Called under the write lock.
+void VCDParser::boundMemory(const uint64_t decoded, const bool force) {
+    if (options_.memory_limit == 0) return;
 
-    if (lf_pos == std::string::npos) return cr_pos;
-    if (cr_pos == std::string::npos) return lf_pos;
+    // Walking every signal costs, check about 8 times per limit worth of text
+    unbounded_bytes_ += decoded;
+    if (!force && unbounded_bytes_ < std::max<uint64_t>(options_.memory_limit / 8, 1024 * 1024)) return;
+    unbounded_bytes_ = 0;
+    try {
+        file_->limitMemory(options_.memory_limit);
+    } catch (const std::runtime_error& e) {
+        result_.AddError(VCDDiagCode::IO_ERROR, e.what());
+        options_.memory_limit = 0;  // Keep decoding, unbounded
+    }
+}
 
-    return std::min(lf_pos, cr_pos);
+void VCDParser::recordMemory() {
+    if (!options_.profile) return;
+    result_.profile.enabled = true;
+    if (followed_ != nullptr) result_.profile.memory = followed_->memoryUsage();
 }
 
-void VCDParser::parseValueChangeLine(const std::string& line) const {
-    if (line.empty() || line[0] == '$') return;  // Skip comments/dump commands
+size_t VCDParser::poll() {
+    if (followed_ == nullptr || followed_->frozen()) return 0;
+
+    if (!header_done_) {
+        // A file not created yet or a header still being written are worth another try, a syntax error is not
+        if (result_.errors.Count(VCDDiagCode::HEADER_SYNTAX) > 0) return 0;
+        parse(path_, followed_, options_);
+        return header_done_ ? offset_ + leftover_.size() : 0;
+    }
+
+    std::ifstream stream(path_, std::ios::binary);
+    if (!stream) return 0;  // Eg. being replaced, try again later
+
+    const uint64_t position = offset_ + leftover_.size();
+    stream.seekg(0, std::ios::end);
+    const auto size = static_cast<uint64_t>(stream.tellg());
+    if (size < position) {
+        result_.AddError(VCDDiagCode::IO_ERROR, path_ + " shrank while being followed");
+        followed_ = nullptr;
+        return 0;
+    }
+    if (size == position) return 0;
+
+    stream.seekg(static_cast<std::streamoff>(position));
+    file_ = followed_;
+    decodeBody(stream);
+    file_ = nullptr;
+    recordMemory();
+    return offset_ + leftover_.size() - position;
+}
 
-    // Timestamp
-    if (line[0] == '#') {
-        const uint64_t current_time = std::stoull(line.substr(1));
-        file_->addTimestamp(current_time);
+void VCDParser::follow(const std::chrono::milliseconds interval, const std::function<bool(size_t)>& on_update) {
+    while (true) {
+        const size_t bytes = poll();
+        if (!on_update(bytes)) return;
+        if (bytes == 0) std::this_thread::sleep_for(interval);
     }
 }
 
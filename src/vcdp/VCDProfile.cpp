@@ -0,0 +1,43 @@
+#include "vcdp/VCDProfile.hpp"
+
+#include <ostream>
+
+namespace VCDP_NAMESPACE {
+
+const char* vcdPhase2String(const VCDPhase phase) {
+    switch (phase) {
+        case VCDPhase::HEADER_READ:
+            return "header_read";
+        case VCDPhase::HEADER_PARSE:
+            return "header_parse";
+        case VCDPhase::BODY_READ:
+            return "body_read";
+        case VCDPhase::SPLIT:
+            return "split";
+        case VCDPhase::DECODE:
+            return "decode";
+        case VCDPhase::STORE:
+            return "store";
+        default:
+            return "unknown";
+    }
+}
+
+void VCDProfile::WriteJson(std::ostream& os) const {
+    os << "{\"phases\": {";
+    for (size_t i = 0; i < VCD_PHASE_COUNT; i++) {
+        const VCDPhaseStats& stats = phases[i];
+        const double throughput = stats.wall_seconds > 0 ? static_cast<double>(stats.bytes) / stats.wall_seconds : 0;
+
+        os << (i == 0 ? "" : ", ") << "\"" << vcdPhase2String(static_cast<VCDPhase>(i)) << "\": {"
+           << "\"wall_seconds\": " << stats.wall_seconds << ", \"cpu_seconds\": " << stats.cpu_seconds << ", \"calls\": " << stats.calls
+           << ", \"bytes\": " << stats.bytes << ", \"lines\": " << stats.lines << ", \"changes\": " << stats.changes
+           << ", \"allocations\": " << stats.allocations << ", \"bytes_per_second\": " << throughput << "}";
+    }
+    os << "}, \"memory\": {"
+       << "\"vlists\": " << memory.vlists << ", \"vlist_blocks\": " << memory.vlist_blocks << ", \"time_table\": " << memory.time_table
+       << ", \"names\": " << memory.names << ", \"tables\": " << memory.tables << ", \"summaries\": " << memory.summaries
+       << ", \"spilled\": " << memory.spilled << ", \"total\": " << memory.Total() << "}}";
+}
+
+}  // namespace VCDP_NAMESPACE
@@ -0,0 +1,603 @@
+#include "vcdp/VCDSearch.hpp"
+
+#include <tao/pegtl.hpp>
+
+#include <fstream>
+#include <queue>
+#include <unordered_map>
+
+#include "vcdp/VCDBodyDecoder.hpp"
+
+namespace pegtl = TAO_PEGTL_NAMESPACE;
+
+namespace VCDP_NAMESPACE {
+
+namespace {
+
+enum class OpCode : uint8_t {
+    LOAD,   //!< Push the value of a signal slot
+    CONST,  //!< Push a literal
+    SLICE,  //!< Keep `width` bits from bit `shift` of the top value
+    NOT,
+    INV,
+    NEG,
+    ADD,
+    SUB,
+    LT,
+    LE,
+    GT,
+    GE,
+    EQ,
+    NE,
+    BAND,
+    BXOR,
+    BOR,
+    LAND,
+    LOR
+};
+
+struct Instruction {
+    OpCode op;
+    uint32_t slot_or_shift = 0;
+    uint32_t width = 0;
+    uint64_t constant = 0;
+};
+
+/// @brief Value on the evaluation stack.
+struct Value {
+    uint64_t bits = 0;
+    uint32_t width = 64;
+    bool unknown = true;  //!< Has x or z bits
+};
+
+uint64_t mask(const uint32_t width) { return width >= 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1; }
+
+/// @brief A compiled condition.
+struct Program {
+    std::vector<Instruction> code;
+    std::vector<VCDIndex> signals;  //!< Signal of each slot
+    size_t stack_size = 0;
+    uint64_t duration = 0;             //!< Time units, or clock edges when clock is set
+    uint32_t clock = UINT32_MAX;       //!< Slot of the clock of the duration
+    std::vector<uint32_t> slot_of;     //!< Slot of each signal of the file, UINT32_MAX if not referenced
+
+    uint32_t slot(const VCDIndex signal) {
+        if (slot_of[signal] == UINT32_MAX) {
+            slot_of[signal] = static_cast<uint32_t>(signals.size());
+            signals.push_back(signal);
+        }
+        return slot_of[signal];
+    }
+};
+
+/// @brief What the grammar actions need to compile.
+struct Compiler {
+    const VCDFile& file;
+    Program& program;
+    std::unordered_map<std::string, VCDIndex> paths;  //!< Signals by dotted hierarchical name
+    VCDIndex last_signal = VCD_NO_INDEX;              //!< Operand of a following bit select
+
+    void emit(const OpCode op) { program.code.push_back({op}); }
+};
+
+}  // namespace
+
+namespace expression {
+
+// clang-format off
+
+struct ws : pegtl::star<pegtl::one<' ', '\t'>> {};
+struct name_first : pegtl::ranges<'a', 'z', 'A', 'Z', '_'> {};
+struct name_char : pegtl::sor<pegtl::ranges<'a', 'z', 'A', 'Z', '0', '9', '_'>, pegtl::one<'.'>> {};
+struct digits : pegtl::plus<pegtl::ranges<'0', '9', '_'>> {};
+
+// Operands
+struct signal_name : pegtl::seq<name_first, pegtl::star<name_char>> {};
+struct bit_select : pegtl::seq<
+    pegtl::one<'['>, ws, pegtl::must<digits>, ws,
+    pegtl::opt<pegtl::one<':'>, ws, pegtl::must<digits>, ws>,
+    pegtl::must<pegtl::one<']'>>
+> {};
+struct signal_ref : pegtl::seq<signal_name, pegtl::opt<bit_select>> {};
+struct hex_literal : pegtl::seq<pegtl::one<'0'>, pegtl::one<'x', 'X'>, pegtl::must<pegtl::plus<pegtl::ranges<'0', '9', 'a', 'f', 'A', 'F', '_'>>>> {};
+struct bin_literal : pegtl::seq<pegtl::one<'0'>, pegtl::one<'b', 'B'>, pegtl::must<pegtl::plus<pegtl::ranges<'0', '1', '_'>>>> {};
+struct dec_literal : digits {};
+struct literal : pegtl::sor<hex_literal, bin_literal, dec_literal> {};
+
+struct expr;
+struct paren : pegtl::seq<pegtl::one<'('>, ws, pegtl::must<expr>, ws, pegtl::must<pegtl::one<')'>>> {};
+struct primary : pegtl::sor<paren, literal, signal_ref> {};
+
+// Operators: the action of each one runs once its operands are compiled
+struct unary;
+struct op_not : pegtl::seq<pegtl::one<'!'>, pegtl::not_at<pegtl::one<'='>>, ws, pegtl::must<unary>> {};
+struct op_inv : pegtl::seq<pegtl::one<'~'>, ws, pegtl::must<unary>> {};
+struct op_neg : pegtl::seq<pegtl::one<'-'>, ws, pegtl::must<unary>> {};
+struct unary : pegtl::sor<op_not, op_inv, op_neg, primary> {};
+
+struct op_add : pegtl::seq<ws, pegtl::one<'+'>, ws, pegtl::must<unary>> {};
+struct op_sub : pegtl::seq<ws, pegtl::one<'-'>, ws, pegtl::must<unary>> {};
+struct additive : pegtl::seq<unary, pegtl::star<pegtl::sor<op_add, op_sub>>> {};
+
+struct op_le : pegtl::seq<ws, TAO_PEGTL_STRING("<="), ws, pegtl::must<additive>> {};
+struct op_lt : pegtl::seq<ws, pegtl::one<'<'>, ws, pegtl::must<additive>> {};
+struct op_ge : pegtl::seq<ws, TAO_PEGTL_STRING(">="), ws, pegtl::must<additive>> {};
+struct op_gt : pegtl::seq<ws, pegtl::one<'>'>, ws, pegtl::must<additive>> {};
+struct relational : pegtl::seq<additive, pegtl::star<pegtl::sor<op_le, op_lt, op_ge, op_gt>>> {};
+
+struct op_eq : pegtl::seq<ws, TAO_PEGTL_STRING("=="), ws, pegtl::must<relational>> {};
+struct op_ne : pegtl::seq<ws, TAO_PEGTL_STRING("!="), ws, pegtl::must<relational>> {};
+struct equality : pegtl::seq<relational, pegtl::star<pegtl::sor<op_eq, op_ne>>> {};
+
+struct op_band : pegtl::seq<ws, pegtl::one<'&'>, pegtl::not_at<pegtl::one<'&'>>, ws, pegtl::must<equality>> {};
+struct bit_and : pegtl::seq<equality, pegtl::star<op_band>> {};
+struct op_bxor : pegtl::seq<ws, pegtl::one<'^'>, ws, pegtl::must<bit_and>> {};
+struct bit_xor : pegtl::seq<bit_and, pegtl::star<op_bxor>> {};
+struct op_bor : pegtl::seq<ws, pegtl::one<'|'>, pegtl::not_at<pegtl::one<'|'>>, ws, pegtl::must<bit_xor>> {};
+struct bit_or : pegtl::seq<bit_xor, pegtl::star<op_bor>> {};
+struct op_land : pegtl::seq<ws, TAO_PEGTL_STRING("&&"), ws, pegtl::must<bit_or>> {};
+struct logical_and : pegtl::seq<bit_or, pegtl::star<op_land>> {};
+struct op_lor : pegtl::seq<ws, TAO_PEGTL_STRING("||"), ws, pegtl::must<logical_and>> {};
+struct expr : pegtl::seq<logical_and, pegtl::star<op_lor>> {};
+
+// Duration
+struct kw_for : pegtl::seq<TAO_PEGTL_STRING("for"), pegtl::not_at<name_char>> {};
+struct duration_count : digits {};
+struct clock_name : signal_name {};
+struct duration : pegtl::seq<kw_for, ws, pegtl::must<duration_count>, ws, pegtl::opt<pegtl::one<'@'>, ws, pegtl::must<clock_name>>> {};
+
+struct condition : pegtl::seq<ws, pegtl::must<expr>, ws, pegtl::opt<duration>, ws, pegtl::must<pegtl::eof>> {};
+
+// clang-format on
+
+uint64_t parseNumber(const std::string_view text, const unsigned base) {
+    uint64_t value = 0;
+    for (const char c : text) {
+        if (c == '_') continue;
+        const unsigned digit = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+        value = value * base + digit;
+    }
+    return value;
+}
+
+template <typename Rule>
+struct action : pegtl::nothing<Rule> {};
+
+template <>
+struct action<signal_name> {
+    template <typename Input>
+    static void apply(const Input& in, Compiler& compiler) {
+        const auto found = compiler.paths.find(in.string());
+        if (found == compiler.paths.end()) throw pegtl::parse_error("Unknown signal " + in.string(), in);
+        compiler.last_signal = found->second;
+        compiler.program.code.push_back({OpCode::LOAD, compiler.program.slot(found->second)});
+    }
+};
+
+template <>
+struct action<clock_name> {
+    template <typename Input>
+    static void apply(const Input& in, Compiler& compiler) {
+        const auto found = compiler.paths.find(in.string());
+        if (found == compiler.paths.end()) throw pegtl::parse_error("Unknown signal " + in.string(), in);
+        compiler.program.clock = compiler.program.slot(found->second);
+    }
+};
+
+template <>
+struct action<bit_select> {
+    template <typename Input>
+    static void apply(const Input& in, Compiler& compiler) {
+        const std::string text = in.string();
+        const size_t colon = text.find(':');
+        const auto number = [&](const size_t begin, const size_t end) {
+            std::string digits_only;
+            for (size_t i = begin; i < end; i++) {
+                if (text[i] >= '0' && text[i] <= '9') digits_only += text[i];
+            }
+            return static_cast<int64_t>(parseNumber(digits_only, 10));
+        };
+        const int64_t first = number(1, colon == std::string::npos ? text.size() : colon);
+        const int64_t last = colon == std::string::npos ? first : number(colon + 1, text.size());
+
+        // Bit positions from the least significant bit, following the declared range
+        const VCDSignal& signal = compiler.file.getSignals()[compiler.last_signal];
+        const int64_t lsb = signal.rindex >= 0 ? signal.rindex : std::max(signal.lindex, 0);
+        const bool descending = signal.rindex < 0 || signal.lindex >= signal.rindex;
+        const auto position = [&](const int64_t index) { return descending ? index - lsb : lsb - index; };
+        const int64_t low = std::min(position(first), position(last));
+        const int64_t high = std::max(position(first), position(last));
+        if (low < 0 || high >= std::max<int64_t>(signal.size, 1) || low >= 64) {
+            throw pegtl::parse_error("Bit select out of the range of " + signal.reference, in);
+        }
+        compiler.program.code.push_back({OpCode::SLICE, static_cast<uint32_t>(low), static_cast<uint32_t>(std::min<int64_t>(high - low + 1, 64))});
+    }
+};
+
+template <>
+struct action<hex_literal> {
+    template <typename Input>
+    static void apply(const Input& in, Compiler& compiler) {
+        if (in.size() > 2 + 16 + 15) throw pegtl::parse_error("Literal wider than 64 bits", in);
+        compiler.program.code.push_back({OpCode::CONST, 0, 0, parseNumber(in.string_view().substr(2), 16)});
+    }
+};
+
+template <>
+struct action<bin_literal> {
+    template <typename Input>
+    static void apply(const Input& in, Compiler& compiler) {
+        compiler.program.code.push_back({OpCode::CONST, 0, 0, parseNumber(in.string_view().substr(2), 2)});
+    }
+};
+
+template <>
+struct action<dec_literal> {
+    template <typename Input>
+    static void apply(const Input& in, Compiler& compiler) {
+        compiler.program.code.push_back({OpCode::CONST, 0, 0, parseNumber(in.string_view(), 10)});
+    }
+};
+
+template <>
+struct action<duration_count> {
+    template <typename Input>
+    static void apply(const Input& in, Compiler& compiler) {
+        compiler.program.duration = parseNumber(in.string_view(), 10);
+    }
+};
+
+/// @brief Operators only emit their opcode.
+template <OpCode Op>
+struct emit_action {
+    template <typename Input>
+    static void apply(const Input&, Compiler& compiler) {
+        compiler.emit(Op);
+    }
+};
+
+template <> struct action<op_not> : emit_action<OpCode::NOT> {};
+template <> struct action<op_inv> : emit_action<OpCode::INV> {};
+template <> struct action<op_neg> : emit_action<OpCode::NEG> {};
+template <> struct action<op_add> : emit_action<OpCode::ADD> {};
+template <> struct action<op_sub> : emit_action<OpCode::SUB> {};
+template <> struct action<op_lt> : emit_action<OpCode::LT> {};
+template <> struct action<op_le> : emit_action<OpCode::LE> {};
+template <> struct action<op_gt> : emit_action<OpCode::GT> {};
+template <> struct action<op_ge> : emit_action<OpCode::GE> {};
+template <> struct action<op_eq> : emit_action<OpCode::EQ> {};
+template <> struct action<op_ne> : emit_action<OpCode::NE> {};
+template <> struct action<op_band> : emit_action<OpCode::BAND> {};
+template <> struct action<op_bxor> : emit_action<OpCode::BXOR> {};
+template <> struct action<op_bor> : emit_action<OpCode::BOR> {};
+template <> struct action<op_land> : emit_action<OpCode::LAND> {};
+template <> struct action<op_lor> : emit_action<OpCode::LOR> {};
+
+}  // namespace expression
+
+namespace {
+
+/**
+ * @brief Compile a condition against the declarations of a file.
+ * @return An empty string, or the syntax error.
+ */
+std::string compile(const std::string& text, const VCDFile& file, Program& program) {
+    program.slot_of.assign(file.getSignals().size(), UINT32_MAX);
+    Compiler compiler{file, program, {}};
+
+    // Scopes are stored parents first
+    const auto& scopes = file.getScopes();
+    std::vector<std::string> scope_paths(scopes.size());
+    for (VCDIndex scope = 0; scope < scopes.size(); scope++) {
+        scope_paths[scope] = scopes[scope].parent == VCD_NO_INDEX ? scopes[scope].name : scope_paths[scopes[scope].parent] + "." + scopes[scope].name;
+        for (const VCDIndex signal : file.getScopeSignals(scopes[scope])) {
+            compiler.paths.emplace(scope_paths[scope] + "." + file.getSignals()[signal].reference, signal);
+        }
+    }
+
+    try {
+        pegtl::memory_input<> in(text, "expression");
+        if (!pegtl::parse<expression::condition, expression::action>(in, compiler)) return "Invalid expression";
+    } catch (const pegtl::parse_error& e) {
+        return e.what();
+    }
+
+    // Stack depth, every instruction but the loads pops its operands
+    size_t depth = 0;
+    for (const Instruction& instruction : program.code) {
+        switch (instruction.op) {
+            case OpCode::LOAD:
+            case OpCode::CONST:
+                depth++;
+                break;
+            case OpCode::SLICE:
+            case OpCode::NOT:
+            case OpCode::INV:
+            case OpCode::NEG:
+                break;
+            default:
+                depth--;
+                break;
+        }
+        program.stack_size = std::max(program.stack_size, depth);
+    }
+    return {};
+}
+
+/// @brief Decode a VCD value, its 64 least significant bits.
+Value decodeValue(const std::string_view text, const uint32_t width) {
+    Value value{0, std::min<uint32_t>(std::max<uint32_t>(width, 1), 64), false};
+    const size_t first = text.size() > 64 ? text.size() - 64 : 0;
+    for (size_t i = first; i < text.size(); i++) {
+        value.bits = (value.bits << 1) | (text[i] == '1' ? 1 : 0);
+        value.unknown |= text[i] != '0' && text[i] != '1';
+    }
+    return value;
+}
+
+/// @brief Run the bytecode on the current values of the slots.
+bool run(const Program& program, const std::vector<Value>& slots, std::vector<Value>& stack) {
+    size_t top = 0;  // Number of values on the stack
+    for (const Instruction& instruction : program.code) {
+        switch (instruction.op) {
+            case OpCode::LOAD:
+                stack[top++] = slots[instruction.slot_or_shift];
+                continue;
+            case OpCode::CONST:
+                stack[top++] = {instruction.constant, 64, false};
+                continue;
+            case OpCode::SLICE: {
+                Value& value = stack[top - 1];
+                value.bits = (value.bits >> instruction.slot_or_shift) & mask(instruction.width);
+                value.width = instruction.width;
+                continue;
+            }
+            case OpCode::NOT:
+                stack[top - 1] = {stack[top - 1].bits == 0, 1, stack[top - 1].unknown};
+                continue;
+            case OpCode::INV:
+                stack[top - 1].bits = ~stack[top - 1].bits & mask(stack[top - 1].width);
+                continue;
+            case OpCode::NEG:
+                stack[top - 1].bits = (0 - stack[top - 1].bits) & mask(stack[top - 1].width);
+                continue;
+            default:
+                break;
+        }
+
+        // Binary operators
+        const Value right = stack[--top];
+        Value& left = stack[top - 1];
+        const bool unknown = left.unknown || right.unknown;
+        const uint32_t width = std::max(left.width, right.width);
+        switch (instruction.op) {
+            case OpCode::LAND: {
+                // A known false operand decides, even if the other one is unknown
+                const bool is_false = (!left.unknown && left.bits == 0) || (!right.unknown && right.bits == 0);
+                left = {static_cast<uint64_t>(!is_false && !unknown), 1, !is_false && unknown};
+                break;
+            }
+            case OpCode::LOR: {
+                const bool is_true = (!left.unknown && left.bits != 0) || (!right.unknown && right.bits != 0);
+                left = {static_cast<uint64_t>(is_true), 1, !is_true && unknown};
+                break;
+            }
+            case OpCode::ADD:
+                left = {(left.bits + right.bits) & mask(width), width, unknown};
+                break;
+            case OpCode::SUB:
+                left = {(left.bits - right.bits) & mask(width), width, unknown};
+                break;
+            case OpCode::LT:
+                left = {left.bits < right.bits, 1, unknown};
+                break;
+            case OpCode::LE:
+                left = {left.bits <= right.bits, 1, unknown};
+                break;
+            case OpCode::GT:
+                left = {left.bits > right.bits, 1, unknown};
+                break;
+            case OpCode::GE:
+                left = {left.bits >= right.bits, 1, unknown};
+                break;
+            case OpCode::EQ:
+                left = {left.bits == right.bits, 1, unknown};
+                break;
+            case OpCode::NE:
+                left = {left.bits != right.bits, 1, unknown};
+                break;
+            case OpCode::BAND:
+                left = {left.bits & right.bits, width, unknown};
+                break;
+            case OpCode::BXOR:
+                left = {left.bits ^ right.bits, width, unknown};
+                break;
+            case OpCode::BOR:
+                left = {left.bits | right.bits, width, unknown};
+                break;
+            default:
+                break;
+        }
+    }
+    return !stack[0].unknown && stack[0].bits != 0;
+}
+
+/// @brief Evaluate a program at the time steps changing its signals, and track its matches.
+class Matcher {
+   public:
+    Matcher(const Program& program, const VCDFile& file, const SearchOptions& options, VCDSearchResult& result)
+        : program_(program), options_(options), result_(result), slots_(program.signals.size()), stack_(std::max<size_t>(program.stack_size, 1)) {
+        widths_.reserve(program.signals.size());
+        for (const VCDIndex signal : program.signals) widths_.push_back(file.getSignals()[signal].size);
+    }
+
+    /// @brief A signal changed at the current time.
+    void change(const uint32_t slot, const std::string_view text) {
+        const Value value = decodeValue(text, widths_[slot]);
+        if (slot == program_.clock) {
+            rose_ |= !slots_[slot].unknown && !(slots_[slot].bits & 1) && !value.unknown && (value.bits & 1);
+        }
+        slots_[slot] = value;
+        dirty_ = true;
+    }
+
+    /// @brief Move to a new time, the changes at the previous one are complete.
+    void advance(const uint64_t time) {
+        if (time == time_) return;
+        evaluate();
+        time_ = time;
+    }
+
+    /// @brief End of the trace.
+    void finish() {
+        evaluate();
+        if (held_ && !reached_ && program_.clock == UINT32_MAX && time_ - start_ >= program_.duration) {
+            record(start_ + program_.duration);
+        }
+    }
+
+    /// @brief Enough matches are complete.
+    [[nodiscard]] bool done() const { return result_.matches.size() >= options_.max_matches && !(held_ && reached_); }
+
+   private:
+    void evaluate() {
+        if (!dirty_) return;
+        dirty_ = false;
+        result_.evaluations++;
+        const bool value = run(program_, slots_, stack_);
+        const bool rose = std::exchange(rose_, false);
+
+        if (value && !held_) {
+            held_ = true;
+            reached_ = false;
+            start_ = time_;
+            edges_ = 0;
+            if (program_.duration == 0) record(time_);
+            return;
+        }
+        if (!held_) return;
+
+        if (program_.clock != UINT32_MAX) {
+            // Clock edges after the condition became true
+            if (rose && ++edges_ == program_.duration && !reached_) record(time_);
+        } else if (!reached_ && time_ - start_ >= program_.duration) {
+            record(start_ + program_.duration);
+        }
+
+        if (!value) {
+            held_ = false;
+            if (reached_) result_.matches.back().end = time_;
+        }
+    }
+
+    void record(const uint64_t begin) {
+        if (result_.matches.size() >= options_.max_matches) return;
+        reached_ = true;
+        result_.matches.push_back({begin, UINT64_MAX});
+    }
+
+    const Program& program_;
+    const SearchOptions& options_;
+    VCDSearchResult& result_;
+    std::vector<uint32_t> widths_;
+    std::vector<Value> slots_;
+    std::vector<Value> stack_;
+    uint64_t time_ = 0;
+    bool dirty_ = false;
+    bool rose_ = false;     //!< The clock rose at the current time
+    bool held_ = false;     //!< The condition is true
+    bool reached_ = false;  //!< The current true interval was recorded as a match
+    uint64_t start_ = 0;    //!< Time the condition became true
+    uint64_t edges_ = 0;    //!< Clock edges since then
+};
+
+/// @brief Forwards the changes of the referenced signals of a streamed file.
+struct MatcherSink {
+    const VCDFile& file;
+    const Program& program;
+    Matcher& matcher;
+
+    void onTimestamp(const uint64_t time) { matcher.advance(time); }
+
+    void onValueChange(const VCDSignal& signal, const std::string_view value) {
+        if (const uint32_t slot = program.slot_of[file.indexOf(signal)]; slot != UINT32_MAX) matcher.change(slot, value);
+    }
+};
+
+VCDSearchResult failure(std::string error) {
+    VCDSearchResult result;
+    result.success = false;
+    result.error = std::move(error);
+    return result;
+}
+
+}  // namespace
+
+VCDSearchResult VCDSearch::find(const VCDFile& file) const {
+    Program program;
+    if (std::string error = compile(expression_, file, program); !error.empty()) return failure(std::move(error));
+
+    VCDSearchResult result;
+    Matcher matcher(program, file, options_, result);
+
+    // Merge the changes of the referenced signals by time
+    std::vector<VCDChangeReader> readers;
+    readers.reserve(program.signals.size());
+    using Entry = std::pair<uint64_t, uint32_t>;  // Time index, slot
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> next;
+    for (uint32_t slot = 0; slot < program.signals.size(); slot++) {
+        readers.emplace_back(file.getSignals()[program.signals[slot]]);
+        if (readers.back().next()) next.emplace(readers.back().timeIndex(), slot);
+    }
+
+    while (!next.empty() && !matcher.done()) {
+        const auto [time_index, slot] = next.top();
+        next.pop();
+        matcher.advance(file.getTimestamp(time_index));
+        matcher.change(slot, readers[slot].value());
+        if (readers[slot].next()) next.emplace(readers[slot].timeIndex(), slot);
+    }
+    if (!file.getTimestamps().empty()) matcher.advance(file.getTimestamps().back());
+    matcher.finish();
+    return result;
+}
+
+VCDSearchResult VCDSearch::find(const std::string& path) {
+    parse_result_.Clear();
+
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        parse_result_.AddError(VCDDiagCode::IO_ERROR, "Unable to open " + path);
+        return failure(parse_result_.errors[0].Message());
+    }
+
+    // Only the declarations are stored
+    VCDFile file;
+    VCDParser parser;
+    parser.parseHeader(stream, &file, path);
+    parse_result_ = parser.GetResult();
+    if (!parse_result_.success) return failure(parse_result_.errors[0].Message());
+
+    Program program;
+    if (std::string error = compile(expression_, file, program); !error.empty()) return failure(std::move(error));
+
+    VCDSearchResult result;
+    Matcher matcher(program, file, options_, result);
+    MatcherSink sink{file, program, matcher};
+    VCDBodyDecoder decoder(file, parse_result_, sink, parser.GetLineCount());
+
+    std::vector<char> buffer(1024 * 1024);
+    std::string chunk;  // Starts with the line cut at the end of the previous read
+    uint64_t offset = parser.GetOffset();
+    while (!matcher.done() && (stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || stream.gcount() > 0)) {
+        chunk.append(buffer.data(), stream.gcount());
+        const size_t consumed = decoder.decode(chunk, offset, false);
+        chunk.erase(0, consumed);
+        offset += consumed;
+    }
+    if (!matcher.done()) decoder.decode(chunk, offset, true);
+    matcher.finish();
+    return result;
+}
+
+}  // namespace VCDP_NAMESPACE
@@ -0,0 +1,126 @@
+#include "vcdp/VCDSummary.hpp"
+
+#include <algorithm>
+
+#include "vcdp/Utils.hpp"
+
+namespace VCDP_NAMESPACE {
+
+void VCDSummary::enable(const uint64_t resolution, const uint32_t size) {
+    *this = VCDSummary();
+    enabled_ = true;
+    size_ = size;
+    while ((resolution >> (shift_ + 1)) != 0) shift_++;
+}
+
+void VCDSummary::add(const uint64_t time, const std::string_view value) {
+    // Normalized as VCDChangeReader decodes it
+    if (size_ == 1) {
+        next_.assign(1, utils::vcdBit2Char(utils::char2VCDBit(value.empty() ? 'x' : value.back())));
+    } else {
+        next_.clear();
+        for (const char c : value) next_ += utils::vcdBit2Char(utils::char2VCDBit(c));
+    }
+    const bool has_x = hasUnknown(next_);
+
+    // Add coarser levels until the last one holds every change in its bucket 0
+    const size_t max_levels = (63 - shift_) / LEVEL_BITS + 1;
+    while (levels_.size() < max_levels && (levels_.empty() || (time >> levelShift(levels_.size() - 1)) != 0)) {
+        levels_.emplace_back();
+        if (levels_.size() > 1 && !levels_[levels_.size() - 2].empty()) levels_.back().push_back(levels_[levels_.size() - 2].back());
+    }
+
+    uint32_t ref = CURRENT;  // The new value in the pool, once a bucket starts with it
+    for (size_t level = 0; level < levels_.size(); level++) {
+        auto& buckets = levels_[level];
+        const uint64_t index = time >> levelShift(level);
+        if (!buckets.empty() && buckets.back().index >= index) {
+            buckets.back().count++;
+            buckets.back().has_x |= has_x;
+            continue;
+        }
+
+        // The previous bucket ends on the value before this change
+        if (!buckets.empty()) {
+            if (current_ref_ == CURRENT) current_ref_ = commit(current_);
+            buckets.back().last = current_ref_;
+        }
+        if (ref == CURRENT) ref = commit(next_);
+        buckets.push_back({index, 1, ref, CURRENT, has_x});
+    }
+
+    std::swap(current_, next_);
+    current_ref_ = ref;
+}
+
+std::vector<VCDSummarySample> VCDSummary::sample(const uint64_t begin, const uint64_t end, const size_t count) const {
+    std::vector<VCDSummarySample> samples(count == 0 || end <= begin ? 0 : count);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i].begin = bucketStart(begin, end, count, i);
+        samples[i].end = bucketStart(begin, end, count, i + 1);
+    }
+    if (samples.empty() || levels_.empty()) return samples;
+
+    // Coarsest level whose buckets are not wider than the requested ones
+    const uint64_t width = std::max<uint64_t>((end - begin) / count, 1);
+    unsigned width_shift = 0;
+    while ((width >> (width_shift + 1)) != 0) width_shift++;
+    const size_t level = width_shift <= shift_ ? 0 : std::min<size_t>((width_shift - shift_) / LEVEL_BITS, levels_.size() - 1);
+    const unsigned level_shift = levelShift(level);
+    const auto& buckets = levels_[level];
+
+    auto bucket = std::lower_bound(buckets.begin(), buckets.end(), begin >> level_shift,
+                                   [](const VCDSummaryBucket& entry, const uint64_t index) { return entry.index < index; });
+    bool has_value = bucket != buckets.begin();
+    uint32_t last = has_value ? std::prev(bucket)->last : CURRENT;
+
+    for (auto& sample : samples) {
+        if (has_value) {
+            sample.first = value(last);
+            sample.has_x = hasUnknown(sample.first);
+        }
+        for (const uint64_t stop = sample.end >> level_shift; bucket != buckets.end() && bucket->index < stop; ++bucket) {
+            sample.changes += bucket->count;
+            sample.has_x |= bucket->has_x;
+            last = bucket->last;
+            has_value = true;
+        }
+        if (has_value) sample.last = value(last);
+    }
+    return samples;
+}
+
+std::string VCDSummary::value(const uint32_t ref) const {
+    if (ref == CURRENT) return extend(current_, size_);
+    const uint64_t begin = value_offsets_[ref];
+    const uint64_t end = ref + 1 < value_offsets_.size() ? value_offsets_[ref + 1] : values_.size();
+    return extend(values_.substr(begin, end - begin), size_);
+}
+
+uint64_t VCDSummary::memoryUsage() const {
+    if (!enabled_) return 0;
+    uint64_t bytes = levels_.capacity() * sizeof(levels_[0]) + values_.capacity() + value_offsets_.capacity() * sizeof(uint64_t);
+    for (const auto& buckets : levels_) bytes += buckets.capacity() * sizeof(VCDSummaryBucket);
+    return bytes;
+}
+
+uint64_t VCDSummary::bucketStart(const uint64_t begin, const uint64_t end, const size_t count, const size_t index) {
+    const uint64_t span = end - begin;
+    return begin + span / count * index + span % count * index / count;
+}
+
+std::string VCDSummary::extend(std::string value, const uint32_t size) {
+    if (value.size() < size) {
+        const char fill = (value.empty() || value[0] == '1') ? '0' : value[0];
+        value.insert(0, size - value.size(), fill);
+    }
+    return value;
+}
+
+uint32_t VCDSummary::commit(const std::string_view value) {
+    value_offsets_.push_back(values_.size());
+    values_.append(value);
+    return static_cast<uint32_t>(value_offsets_.size() - 1);
+}
+
+}  // namespace VCDP_NAMESPACE
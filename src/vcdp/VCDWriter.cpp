@@ -0,0 +1,469 @@
+#include "vcdp/VCDWriter.hpp"
+
+#include <libdeflate.h>
+
+#include <fstream>
+#include <queue>
+
+#include "vcdp/Utils.hpp"
+#include "vcdp/VCDBodyDecoder.hpp"
+
+namespace VCDP_NAMESPACE {
+
+namespace {
+
+constexpr size_t INPUT_BUFFER_SIZE = 1024 * 1024;
+constexpr size_t OUTPUT_BUFFER_SIZE = 1024 * 1024;  // Also the size of each gzip member
+
+/// @brief Buffered output file, optionally written as a series of gzip members.
+class OutputBuffer {
+   public:
+    OutputBuffer(const std::string& path, const bool gzip, const int level) : stream_(path, std::ios::binary) {
+        buffer_.reserve(OUTPUT_BUFFER_SIZE + 64);
+        if (gzip) compressor_ = libdeflate_alloc_compressor(level);
+    }
+
+    ~OutputBuffer() {
+        if (compressor_ != nullptr) libdeflate_free_compressor(compressor_);
+    }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    [[nodiscard]] bool good() const { return stream_.good(); }
+    [[nodiscard]] uint64_t bytes() const { return bytes_; }
+
+    void put(const char c) {
+        buffer_ += c;
+        if (buffer_.size() >= OUTPUT_BUFFER_SIZE) flush();
+    }
+
+    void put(const std::string_view text) {
+        buffer_ += text;
+        if (buffer_.size() >= OUTPUT_BUFFER_SIZE) flush();
+    }
+
+    /// @brief Decimal formatting without locale nor stream state.
+    void putNumber(uint64_t value) {
+        char digits[20];
+        char* first = digits + sizeof(digits);
+        do {
+            *--first = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        put(std::string_view(first, digits + sizeof(digits) - first));
+    }
+
+    void flush() {
+        if (buffer_.empty()) return;
+
+        if (compressor_ == nullptr) {
+            stream_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+            bytes_ += buffer_.size();
+        } else {
+            // gzip readers (gunzip, zlib) read concatenated members as a single stream
+            compressed_.resize(libdeflate_gzip_compress_bound(compressor_, buffer_.size()));
+            const size_t size = libdeflate_gzip_compress(compressor_, buffer_.data(), buffer_.size(), compressed_.data(), compressed_.size());
+            stream_.write(compressed_.data(), static_cast<std::streamsize>(size));
+            bytes_ += size;
+        }
+        buffer_.clear();
+    }
+
+   private:
+    std::ofstream stream_;
+    std::string buffer_;
+    std::vector<char> compressed_;
+    libdeflate_compressor* compressor_ = nullptr;
+    uint64_t bytes_ = 0;
+};
+
+/// @brief Signals and declarations kept by the options, with their output identifier codes.
+class Selection {
+   public:
+    Selection(const VCDFile& file, const WriteOptions& options) : file_(file) {
+        const auto& scopes = file.getScopes();
+        const auto& signals = file.getSignals();
+        ids_.resize(signals.size());
+        kept_.resize(scopes.size());
+        needed_.assign(scopes.size(), false);
+
+        // Scopes are stored parents first
+        std::vector<std::string> paths(scopes.size());
+        for (size_t i = 0; i < scopes.size(); i++) {
+            paths[i] = scopes[i].parent == VCD_NO_INDEX ? scopes[i].name : paths[scopes[i].parent] + "." + scopes[i].name;
+        }
+
+        for (VCDIndex scope = 0; scope < scopes.size(); scope++) {
+            for (const VCDIndex signal : file.getScopeSignals(scopes[scope])) {
+                if (!matches(options, paths[scope] + "." + signals[signal].reference, signals[signal].hash)) continue;
+
+                kept_[scope].push_back(signal);
+                if (ids_[signal].empty()) {
+                    ids_[signal] = options.compact_ids ? utils::compactIdentifier(count_) : signals[signal].hash;
+                    count_++;
+                }
+            }
+        }
+
+        // A scope is written when it declares a kept signal or has such a descendant
+        for (size_t i = scopes.size(); i-- > 0;) {
+            needed_[i] = needed_[i] || !kept_[i].empty();
+            if (needed_[i] && scopes[i].parent != VCD_NO_INDEX) needed_[scopes[i].parent] = true;
+        }
+    }
+
+    [[nodiscard]] bool selected(const VCDIndex signal) const { return !ids_[signal].empty(); }
+    [[nodiscard]] const std::string& id(const VCDIndex signal) const { return ids_[signal]; }
+    [[nodiscard]] uint64_t count() const { return count_; }
+
+    void writeHeader(OutputBuffer& out) const {
+        writeSection(out, "$date", file_.date);
+        writeSection(out, "$version", file_.version);
+        if (file_.time_units != VCDTimeUnit::TIME_UNKNOWN) {
+            out.put("$timescale ");
+            out.putNumber(file_.time_resolution);
+            out.put(utils::vcdTimeUnit2String(file_.time_units));
+            out.put(" $end\n");
+        }
+
+        for (const auto& scope : file_.getTopScopes()) {
+            writeScope(out, scope);
+        }
+        out.put("$enddefinitions $end\n");
+    }
+
+   private:
+    static bool matches(const WriteOptions& options, const std::string& path, const std::string& hash) {
+        if (options.signals.empty()) return true;
+        for (const auto& pattern : options.signals) {
+            if (utils::matchWildcard(pattern, path) || utils::matchWildcard(pattern, hash)) return true;
+        }
+        return false;
+    }
+
+    static void writeSection(OutputBuffer& out, const std::string_view keyword, const std::string& text) {
+        const size_t first = text.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) return;
+        out.put(keyword);
+        out.put("\n\t");
+        out.put(std::string_view(text).substr(first, text.find_last_not_of(" \t\r\n") - first + 1));
+        out.put("\n$end\n");
+    }
+
+    void writeScope(OutputBuffer& out, const VCDScope& scope) const {
+        const VCDIndex index = file_.indexOf(scope);
+        if (!needed_[index]) return;
+
+        out.put("$scope ");
+        out.put(scope.type == VCDScopeType::VCD_SCOPE_UNKNOWN ? "module" : utils::vcdScopeType2String(scope.type));
+        out.put(' ');
+        out.put(scope.name);
+        out.put(" $end\n");
+
+        for (const VCDIndex signal_index : kept_[index]) {
+            const VCDSignal& signal = file_.getSignals()[signal_index];
+            out.put("$var ");
+            out.put(utils::vcdVarType2String(signal.type));
+            out.put(' ');
+            out.putNumber(signal.size);
+            out.put(' ');
+            out.put(ids_[signal_index]);
+            out.put(' ');
+            out.put(signal.reference);
+            if (signal.lindex > -1) {
+                out.put(" [");
+                out.putNumber(static_cast<uint64_t>(signal.lindex));
+                out.put(':');
+                out.putNumber(static_cast<uint64_t>(signal.rindex));
+                out.put(']');
+            } else if (signal.rindex > -1) {
+                out.put(" [");
+                out.putNumber(static_cast<uint64_t>(signal.rindex));
+                out.put(']');
+            }
+            out.put(" $end\n");
+        }
+
+        for (const auto& child : file_.getScopeChildren(scope)) {
+            writeScope(out, child);
+        }
+        out.put("$upscope $end\n");
+    }
+
+    const VCDFile& file_;
+    std::vector<std::string> ids_;  //!< Output identifier code of each signal, empty when not selected
+    std::vector<std::vector<VCDIndex>> kept_;
+    std::vector<bool> needed_;
+    uint64_t count_ = 0;
+};
+
+/**
+ * @brief Write the value changes of the selection within the time window.
+ *
+ * Changes up to the beginning of the window only update the last known values, which are
+ * dumped at the first time of the window. Timestamps without a selected change are skipped.
+ */
+class Emitter {
+   public:
+    Emitter(const VCDFile& file, const Selection& selection, const WriteOptions& options, OutputBuffer& out)
+        : file_(file), selection_(selection), options_(options), out_(out), values_(file.getSignals().size()), known_(values_.size(), false) {}
+
+    void onTimestamp(const uint64_t time) {
+        last_time_ = time;
+        if (state_ == State::DONE) return;
+
+        if (state_ != State::INSIDE) {
+            if (time <= options_.begin) return;
+            dumpInitialValues();
+        }
+
+        if (time > options_.end) {
+            state_ = State::DONE;
+            return;
+        }
+        time_ = time;
+        time_written_ = false;
+    }
+
+    void onValueChange(const VCDIndex signal, const std::string_view value) {
+        if (state_ == State::DONE || !selection_.selected(signal)) return;
+
+        if (state_ == State::BEFORE) {
+            values_[signal].assign(value);
+            known_[signal] = true;
+            return;
+        }
+
+        if (!time_written_) {
+            writeTime(time_);
+            time_written_ = true;
+        }
+        writeValue(signal, value);
+    }
+
+    /// @brief Dump the initial values if not done yet, and mark the end of the written time range.
+    void finish() {
+        if (state_ == State::BEFORE) dumpInitialValues();
+        const uint64_t end = std::min(last_time_, options_.end);
+        if (end > written_time_) writeTime(end);
+    }
+
+    [[nodiscard]] bool done() const { return state_ == State::DONE; }
+    [[nodiscard]] uint64_t changes() const { return changes_; }
+
+   private:
+    enum class State { BEFORE, INSIDE, DONE };
+
+    void dumpInitialValues() {
+        writeTime(options_.begin);
+        out_.put("$dumpvars\n");
+        for (VCDIndex signal = 0; signal < values_.size(); signal++) {
+            if (known_[signal]) writeValue(signal, values_[signal]);
+        }
+        out_.put("$end\n");
+
+        values_.clear();
+        values_.shrink_to_fit();
+        state_ = State::INSIDE;
+        time_written_ = true;
+    }
+
+    void writeTime(const uint64_t time) {
+        out_.put('#');
+        out_.putNumber(time);
+        out_.put('\n');
+        written_time_ = time;
+    }
+
+    void writeValue(const VCDIndex signal, const std::string_view value) {
+        if (file_.getSignals()[signal].isReal()) {
+            out_.put('r');
+            out_.put(value);
+            out_.put(' ');
+        } else if (file_.getSignals()[signal].size == 1) {
+            out_.put(value.empty() ? 'x' : value.back());
+        } else {
+            out_.put('b');
+            out_.put(value);
+            out_.put(' ');
+        }
+        out_.put(selection_.id(signal));
+        out_.put('\n');
+        changes_++;
+    }
+
+    const VCDFile& file_;
+    const Selection& selection_;
+    const WriteOptions& options_;
+    OutputBuffer& out_;
+
+    State state_ = State::BEFORE;
+    std::vector<std::string> values_;  //!< Last value of each signal before the window
+    std::vector<bool> known_;
+    uint64_t time_ = 0;
+    bool time_written_ = false;
+    uint64_t last_time_ = 0;
+    uint64_t written_time_ = 0;
+    uint64_t changes_ = 0;
+};
+
+/// @brief Forwards what the body decoder reads to the emitter.
+struct EmitterSink {
+    const VCDFile& file;
+    Emitter& emitter;
+
+    void onTimestamp(const uint64_t time) const { emitter.onTimestamp(time); }
+    void onValueChange(const VCDSignal& signal, const std::string_view value) const { emitter.onValueChange(file.indexOf(signal), value); }
+};
+
+VCDWriteResult failure(const std::string& error) {
+    VCDWriteResult result;
+    result.success = false;
+    result.error = error;
+    return result;
+}
+
+}  // namespace
+
+VCDWriteResult VCDWriter::write(const VCDFile& file, const std::string& output_path) {
+    OutputBuffer out(output_path, options_.gzip, options_.compression_level);
+    if (!out.good()) return failure("Unable to open " + output_path);
+
+    const Selection selection(file, options_);
+    selection.writeHeader(out);
+    Emitter emitter(file, selection, options_, out);
+
+    // Merge the changes of the selected signals by time index
+    const auto& signals = file.getSignals();
+    std::vector<VCDChangeReader> readers;
+    std::vector<VCDIndex> reader_signals;
+    readers.reserve(selection.count());
+    using Next = std::pair<uint64_t, size_t>;  // (time index, reader)
+    std::priority_queue<Next, std::vector<Next>, std::greater<>> next;
+    for (VCDIndex signal = 0; signal < signals.size(); signal++) {
+        if (!selection.selected(signal)) continue;
+        readers.emplace_back(signals[signal]);
+        reader_signals.push_back(signal);
+        if (readers.back().next()) next.emplace(readers.back().timeIndex(), readers.size() - 1);
+    }
+
+    uint64_t time_index = UINT64_MAX;
+    while (!next.empty() && !emitter.done()) {
+        const auto [index, reader] = next.top();
+        next.pop();
+        if (index != time_index) {
+            time_index = index;
+            emitter.onTimestamp(file.getTimestamp(index));
+        }
+        emitter.onValueChange(reader_signals[reader], readers[reader].value());
+        if (readers[reader].next()) next.emplace(readers[reader].timeIndex(), reader);
+    }
+
+    if (!file.getTimestamps().empty()) emitter.onTimestamp(file.getTimestamps().back());
+    emitter.finish();
+    out.flush();
+    if (!out.good()) return failure("Unable to write " + output_path);
+
+    VCDWriteResult result;
+    result.signals = selection.count();
+    result.changes = emitter.changes();
+    result.bytes = out.bytes();
+    return result;
+}
+
+struct VCDStreamWriter::State {
+    State(const VCDFile& header, const std::string& output_path, const WriteOptions& write_options)
+        : options(write_options),
+          out(output_path, options.gzip, options.compression_level),
+          selection(header, options),
+          emitter(header, selection, options, out),
+          file(header),
+          path(output_path) {}
+
+    WriteOptions options;
+    OutputBuffer out;
+    Selection selection;
+    Emitter emitter;
+    const VCDFile& file;
+    std::string path;
+};
+
+VCDStreamWriter::VCDStreamWriter(const VCDFile& header, const std::string& output_path, const WriteOptions& options)
+    : state_(std::make_unique<State>(header, output_path, options)) {
+    if (state_->out.good()) state_->selection.writeHeader(state_->out);
+}
+
+VCDStreamWriter::~VCDStreamWriter() = default;
+
+bool VCDStreamWriter::good() const { return state_->out.good(); }
+
+void VCDStreamWriter::addTimestamp(const uint64_t time) { state_->emitter.onTimestamp(time); }
+
+void VCDStreamWriter::addValueChange(const VCDSignal& signal, const std::string_view value) {
+    state_->emitter.onValueChange(state_->file.indexOf(signal), value);
+}
+
+bool VCDStreamWriter::done() const { return state_->emitter.done(); }
+
+VCDWriteResult VCDStreamWriter::finish() {
+    if (!state_->out.good()) return failure("Unable to open " + state_->path);
+    state_->emitter.finish();
+    state_->out.flush();
+    if (!state_->out.good()) return failure("Unable to write " + state_->path);
+
+    VCDWriteResult result;
+    result.signals = state_->selection.count();
+    result.changes = state_->emitter.changes();
+    result.bytes = state_->out.bytes();
+    return result;
+}
+
+VCDWriteResult VCDWriter::extract(const std::string& input_path, const std::string& output_path) {
+    parse_result_.Clear();
+
+    std::ifstream stream(input_path, std::ios::binary);
+    if (!stream) {
+        parse_result_.AddError(VCDDiagCode::IO_ERROR, "Unable to open " + input_path);
+        return failure(parse_result_.errors[0].Message());
+    }
+
+    // Only the declarations are stored
+    VCDFile file;
+    VCDParser parser;
+    parser.parseHeader(stream, &file, input_path);
+    parse_result_ = parser.GetResult();
+    if (!parse_result_.success) return failure(parse_result_.errors[0].Message());
+
+    OutputBuffer out(output_path, options_.gzip, options_.compression_level);
+    if (!out.good()) return failure("Unable to open " + output_path);
+
+    const Selection selection(file, options_);
+    selection.writeHeader(out);
+    Emitter emitter(file, selection, options_, out);
+    EmitterSink sink{file, emitter};
+    VCDBodyDecoder decoder(file, parse_result_, sink, parser.GetLineCount());
+
+    std::vector<char> buffer(INPUT_BUFFER_SIZE);
+    std::string chunk;  // Starts with the line cut at the end of the previous read
+    uint64_t offset = parser.GetOffset();
+    while (!emitter.done() && (stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || stream.gcount() > 0)) {
+        chunk.append(buffer.data(), stream.gcount());
+        const size_t consumed = decoder.decode(chunk, offset, false);
+        chunk.erase(0, consumed);
+        offset += consumed;
+    }
+    if (!emitter.done()) decoder.decode(chunk, offset, true);
+
+    emitter.finish();
+    out.flush();
+    if (!out.good()) return failure("Unable to write " + output_path);
+
+    VCDWriteResult result;
+    result.signals = selection.count();
+    result.changes = emitter.changes();
+    result.bytes = out.bytes();
+    return result;
+}
+
+}  // namespace VCDP_NAMESPACE
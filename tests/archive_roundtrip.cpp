@@ -0,0 +1,145 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+/// @brief Changes of every signal, by hierarchical name.
+std::map<std::string, Changes> Waveforms(const vcdp::VCDFile& trace) {
+    std::map<std::string, Changes> waveforms;
+    for (const auto& scope : trace.getScopes()) {
+        for (const vcdp::VCDIndex index : trace.getScopeSignals(scope)) {
+            waveforms[scope.name + "." + trace.getSignals()[index].reference] = ReadChanges(trace, trace.getSignals()[index]);
+        }
+    }
+    return waveforms;
+}
+
+}  // namespace
+
+TEST_CASE("Convert a VCD file to an archive and read it back") {
+    const std::string archive = TempPath("vcdp_archive_roundtrip.vcda");
+
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "ghdl_counter.vcd", &trace);
+    REQUIRE(parser.GetResult().success);
+
+    vcdp::ArchiveOptions options;
+    options.block_size = 16;  // Several blocks per signal
+    const vcdp::VCDWriteResult result = vcdp::VCDArchiveWriter(options).write(trace, archive);
+    REQUIRE(result.success);
+    CHECK(result.signals == trace.getSignals().size());
+    CHECK(result.bytes == std::filesystem::file_size(archive));
+
+    vcdp::VCDArchiveReader reader;
+    REQUIRE(reader.open(archive));
+    const vcdp::VCDFile& copy = reader.getFile();
+    CHECK(copy.time_units == trace.time_units);
+    CHECK(copy.time_resolution == trace.time_resolution);
+    CHECK(copy.version == trace.version);
+    REQUIRE(copy.getScopes().size() == trace.getScopes().size());
+    REQUIRE(copy.getSignals().size() == trace.getSignals().size());
+    for (size_t i = 0; i < trace.getScopes().size(); i++) {
+        CHECK(copy.getScopes()[i].name == trace.getScopes()[i].name);
+        CHECK(copy.getScopes()[i].parent == trace.getScopes()[i].parent);
+    }
+
+    // Opening reads nothing but the index
+    CHECK(copy.getTimestamps().empty());
+    for (const auto& signal : copy.getSignals()) CHECK(signal.change_count == 0);
+
+    for (const auto& signal : copy.getSignals()) REQUIRE(reader.loadSignal(signal));
+    CHECK(copy.getTimestamps() == trace.getTimestamps());
+    CHECK(Waveforms(copy) == Waveforms(trace));
+    for (const auto& signal : copy.getSignals()) {
+        CHECK(signal.change_count == trace.findSignal(signal.hash)->change_count);
+    }
+
+    std::filesystem::remove(archive);
+}
+
+TEST_CASE("Read a time window of a signal") {
+    const std::string archive = TempPath("vcdp_archive_window.vcda");
+
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "ghdl_counter.vcd", &trace);
+    REQUIRE(parser.GetResult().success);
+
+    vcdp::ArchiveOptions options;
+    options.block_size = 16;
+    REQUIRE(vcdp::VCDArchiveWriter(options).write(trace, archive).success);
+
+    vcdp::VCDArchiveReader reader;
+    REQUIRE(reader.open(archive));
+
+    // The signal cut into the most blocks
+    const vcdp::VCDSignal* busiest = &reader.getFile().getSignals().front();
+    for (const auto& signal : reader.getFile().getSignals()) {
+        if (reader.getBlocks(signal).size() > reader.getBlocks(*busiest).size()) busiest = &signal;
+    }
+    REQUIRE(reader.getBlocks(*busiest).size() > 4);
+
+    const auto full = ReadChanges(trace, *trace.findSignal(busiest->hash));
+    const uint64_t begin = full[full.size() / 3].first + 1;
+    const uint64_t end = full[full.size() / 2].first;
+    REQUIRE(reader.loadSignal(*busiest, begin, end));
+    const auto window = ReadChanges(reader.getFile(), *busiest);
+    CHECK(window.size() < full.size());
+
+    // Every change of the window is there, after the value at its start
+    std::vector<std::pair<uint64_t, std::string>> expected;
+    for (size_t i = 0; i < full.size(); i++) {
+        const bool last_before = full[i].first < begin && (i + 1 == full.size() || full[i + 1].first >= begin);
+        if (last_before || (full[i].first >= begin && full[i].first <= end)) expected.push_back(full[i]);
+    }
+    CHECK(std::search(window.begin(), window.end(), expected.begin(), expected.end()) != window.end());
+
+    std::filesystem::remove(archive);
+}
+
+TEST_CASE("Reject files that are not archives and detect corrupted blocks") {
+    const std::string archive = TempPath("vcdp_archive_corrupted.vcda");
+
+    vcdp::VCDArchiveReader reader;
+    CHECK_FALSE(reader.open(TEST_DATA_DIR "ghdl_counter.vcd"));
+    CHECK_FALSE(reader.GetError().empty());
+
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "ghdl_counter.vcd", &trace);
+    REQUIRE(vcdp::VCDArchiveWriter().write(trace, archive).success);
+
+    // Damage the last byte, in the blocks of the last signal
+    {
+        std::fstream stream(archive, std::ios::in | std::ios::out | std::ios::binary);
+        stream.seekg(-1, std::ios::end);
+        const char last = static_cast<char>(stream.get());
+        stream.seekp(-1, std::ios::end);
+        stream.put(static_cast<char>(~last));
+    }
+
+    REQUIRE(reader.open(archive));
+    const auto& signals = reader.getFile().getSignals();
+    const vcdp::VCDSignal* damaged = nullptr;
+    for (const auto& signal : signals) {
+        if (!reader.getBlocks(signal).empty()) damaged = &signal;
+    }
+    REQUIRE(damaged != nullptr);
+    CHECK_FALSE(reader.loadSignal(*damaged));
+
+    // The other signals are still readable
+    for (const auto& signal : signals) {
+        if (&signal != damaged) CHECK(reader.loadSignal(signal));
+    }
+
+    std::filesystem::remove(archive);
+}
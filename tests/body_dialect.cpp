@@ -0,0 +1,94 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDBodyDecoder.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+/// @brief Parse a file with the decoder of its dialect and with the generic one, and compare their changes.
+void CheckSameAsGeneric(const std::string& path) {
+    vcdp::VCDParser generic_parser;
+    vcdp::VCDFile generic;
+    vcdp::ParseOptions options;
+    options.detect_dialect = false;
+    generic_parser.parse(path, &generic, options);
+
+    vcdp::VCDParser parser;
+    vcdp::VCDFile file;
+    parser.parse(path, &file);
+
+    CHECK(parser.GetResult().errors.Total() == generic_parser.GetResult().errors.Total());
+    CHECK(parser.GetResult().warnings.Total() == generic_parser.GetResult().warnings.Total());
+    CHECK(file.getTimestamps() == generic.getTimestamps());
+    REQUIRE(file.getSignals().size() == generic.getSignals().size());
+    for (const auto& signal : generic.getSignals()) {
+        const vcdp::VCDSignal* other = file.getSignal(signal.hash);
+        REQUIRE(other != nullptr);
+        CHECK(other->change_count == signal.change_count);
+
+        vcdp::VCDChangeReader expected(signal);
+        vcdp::VCDChangeReader actual(*other);
+        while (expected.next()) {
+            REQUIRE(actual.next());
+            CHECK(actual.timeIndex() == expected.timeIndex());
+            CHECK(actual.value() == expected.value());
+        }
+        CHECK_FALSE(actual.next());
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Detect the simulator from $version") {
+    CHECK(vcdp::detectSimulator("GHDL v0") == vcdp::VCDSimulator::GHDL);
+    CHECK(vcdp::detectSimulator("QuestaSim Version 2024.2") == vcdp::VCDSimulator::QUESTA);
+    CHECK(vcdp::detectSimulator("ModelSim Version 10.5b") == vcdp::VCDSimulator::QUESTA);
+    CHECK(vcdp::detectSimulator("Generated by VerilatedVcd / Verilator 5.020") == vcdp::VCDSimulator::VERILATOR);
+    CHECK(vcdp::detectSimulator("Icarus Verilog") == vcdp::VCDSimulator::UNKNOWN);
+}
+
+TEST_CASE("Dialect decoders match the generic one") {
+    CheckSameAsGeneric(TEST_DATA_DIR "ghdl_counter.vcd");
+    CheckSameAsGeneric(TEST_DATA_DIR "body_unknown_identifier.vcd");  // Questa, one character identifiers
+
+    // Lines a Verilator dump does not hold are still decoded
+    const std::string path = WriteTemp("vcdp_dialect.vcd", [](std::ofstream& stream) {
+        stream << "$version Verilator 5.020 $end\n"
+                  "$scope module top $end\n"
+                  "$var wire 1 ! clk $end\n"
+                  "$var wire 4 \" data [3:0] $end\n"
+                  "$var wire 8 # bus [7:0] $end\n"
+                  "$upscope $end\n"
+                  "$enddefinitions $end\n"
+                  "#0\r\n"
+                  "0!\r\n"
+                  "b0101 \"\r\n"
+                  "  b1x #\n"
+                  "#10\n"
+                  "1!\n"
+                  "b11  \"\n"
+                  "b1\t#\n"
+                  "b0 ##\n"
+                  "1$\n"
+                  "#20 \n"
+                  "0! \n"
+                  "b10 \"\t\n"
+                  "\tb0 #\n";
+    });
+    CheckSameAsGeneric(path);
+
+    vcdp::VCDParser parser;
+    vcdp::VCDFile file;
+    parser.parse(path, &file);
+    CHECK(file.getTimestamps() == std::vector<uint64_t>{0, 10, 20});
+    CHECK(file.getSignal("!")->change_count == 3);
+    CHECK(file.getSignal("\"")->change_count == 3);
+    CHECK(file.getSignal("#")->change_count == 3);
+    CHECK(parser.GetResult().warnings.Total() == 2);  // "##" and "$"
+    std::filesystem::remove(path);
+}
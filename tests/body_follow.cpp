@@ -0,0 +1,95 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+void Append(const std::string& path, const std::string& text) {
+    std::ofstream stream(path, std::ios::binary | std::ios::app);
+    stream << text;
+}
+
+std::string Values(const vcdp::VCDFile& trace, const std::string& hash) {
+    std::string values;
+    vcdp::VCDChangeReader reader(*trace.getSignal(hash));
+    while (reader.next()) {
+        values += std::to_string(trace.getTimestamp(reader.timeIndex())) + "=" + reader.value() + " ";
+    }
+    return values;
+}
+
+}  // namespace
+
+TEST_CASE("Follow a VCD file while it is being written") {
+    const std::string path = TempPath("vcdp_body_follow.vcd");
+    std::filesystem::remove(path);
+
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    vcdp::ParseOptions options;
+    options.follow = true;
+
+    // Not created yet, then header still being written
+    parser.parse(path, &trace, options);
+    CHECK_FALSE(parser.GetResult().success);
+    Append(path, "$timescale 1 ns $end\n$scope module top $end\n$var wire 1 ! clk $end\n");
+    CHECK(parser.poll() == 0);
+    Append(path, "$var wire 4 \" data [3:0] $end\n$upscope $end\n$enddefinitions $end");
+    CHECK(parser.poll() == 0);  // The $enddefinitions line is not terminated yet
+
+    Append(path, "\n#0\n0!\nb0000 \"\n#5\n1");
+    CHECK(parser.poll() > 0);
+    REQUIRE(parser.GetResult().success);
+    CHECK(trace.getSignals().size() == 2);
+    CHECK(trace.getTimestamps() == std::vector<uint64_t>{0, 5});
+    CHECK(Values(trace, "!") == "0=0 ");  // "1" is cut before its identifier
+
+    // The cut line is completed
+    Append(path, "!\nb1010 \"\n#10\n0!\n");
+    CHECK(parser.poll() > 0);
+    CHECK(parser.poll() == 0);
+    CHECK(trace.getTimestamps() == std::vector<uint64_t>{0, 5, 10});
+    CHECK(Values(trace, "!") == "0=0 5=1 10=0 ");
+    CHECK(Values(trace, "\"") == "0=0000 5=1010 ");
+    CHECK(parser.GetResult().success);
+    CHECK(parser.GetResult().warnings.empty());
+
+    // A comment written across polls
+    Append(path, "$comment\n#99\n");
+    CHECK(parser.poll() > 0);
+    Append(path, "1!\n$end\n");
+    CHECK(parser.poll() > 0);
+    CHECK(trace.getTimestamps().size() == 3);
+    CHECK(parser.GetResult().errors.empty());
+
+    // Readers take a snapshot while a writer thread appends
+    std::thread writer([&] {
+        for (int time = 15; time <= 100; time += 5) {
+            Append(path, "#" + std::to_string(time) + "\n" + (time % 10 == 0 ? "0!\n" : "1!\n"));
+        }
+    });
+    size_t polls = 0;
+    parser.follow(std::chrono::milliseconds(1), [&](size_t) {
+        const auto lock = trace.readLock();
+        CHECK(trace.getSignal("!")->change_count <= trace.getTimestamps().size());
+        return ++polls < 10000 && trace.getTimestamps().back() < 100;
+    });
+    writer.join();
+
+    CHECK(trace.getTimestamps().size() == 21);
+    CHECK(trace.getSignal("!")->change_count == 21);
+    CHECK(parser.GetResult().success);
+
+    // Truncation is reported
+    std::filesystem::resize_file(path, 10);
+    CHECK(parser.poll() == 0);
+    CHECK_FALSE(parser.GetResult().success);
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,103 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+/// @brief Write a trace of a few megabytes: a clock, a counter and a real signal.
+std::string WriteTrace() {
+    return WriteTemp("vcdp_memory_limit.vcd", [](std::ofstream& stream) {
+        stream << "$version GHDL v0 $end\n$timescale 1 ns $end\n$scope module tb $end\n"
+               << "$var reg 1 ! clk $end\n$var reg 16 \" count [15:0] $end\n$var real 64 # level $end\n"
+               << "$upscope $end\n$enddefinitions $end\n";
+        for (uint32_t cycle = 0; cycle < 100000; cycle++) {
+            stream << '#' << cycle * 10 << '\n' << (cycle % 2) << "!\nb";
+            for (int bit = 15; bit >= 0; bit--) stream << ((cycle >> bit) & 1);
+            stream << " \"\nr" << cycle * 0.25 << " #\n";
+        }
+    });
+}
+
+}  // namespace
+
+TEST_CASE("Spilled VList blocks read back in order") {
+    vcdp::VListSpillFile file;
+    vcdp::VListManager list;
+    uint32_t value = 0;
+    const auto append = [&](const uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) list.addData(value++ * 2654435761u);
+    };
+
+    append(300000);
+    CHECK(list.spill(file) > 0);
+    append(1000);  // Interleaved with another list, the next spill is not contiguous with the first one
+    vcdp::VListManager other;
+    other.addData(42);
+    other.addData(43);
+    other.spill(file);
+    append(3000000);
+    list.spill(file);
+    CHECK(list.spill(file) == 0);  // Nothing left but the block being appended to
+    CHECK(list.spilledBytes() > 0);
+    CHECK(list.spilledBytes() == file.size() - other.spilledBytes());
+
+    uint64_t blocks = 0;
+    CHECK(list.memoryUsage(blocks) < 2 * vcdp::VLIST_MAX_BLOCK_SIZE);
+
+    vcdp::VListReader reader(list);
+    uint32_t read = 0;
+    uint32_t index = 0;
+    bool ordered = true;
+    while (reader.next(read)) ordered = ordered && read == index++ * 2654435761u;
+    CHECK(ordered);
+    CHECK(index == value);
+
+    // Byte by byte, only the bytes still in memory
+    uint64_t spilled = list.inlineSize();
+    for (const vcdp::VList* block = list.head(); !block->spilled; block = block->next) spilled += block->offset;
+    CHECK_THROWS_AS((void)list.getData(spilled), std::logic_error);
+    CHECK(list.getData(spilled - 1) <= 0xFF);  // Still in memory
+    CHECK_THROWS_AS((void)list.getData(list.size()), std::out_of_range);
+}
+
+TEST_CASE("A parse bounded in memory matches an unbounded one") {
+    const std::string path = WriteTrace();
+    vcdp::VCDParser parser;
+    vcdp::VCDFile unbounded;
+    parser.parse(path, &unbounded);
+    REQUIRE(parser.GetResult().success);
+    CHECK(unbounded.memoryUsage().spilled == 0);
+
+    for (const unsigned threads : {1u, 4u}) {
+        vcdp::ParseOptions options;
+        options.threads = threads;
+        options.chunk_size = 64 * 1024;
+        options.memory_limit = 512 * 1024;
+
+        vcdp::VCDFile bounded;
+        parser.parse(path, &bounded, options);
+        REQUIRE(parser.GetResult().success);
+        const vcdp::VCDMemoryStats stats = bounded.memoryUsage();
+        CHECK(stats.spilled > 0);
+        CHECK(stats.vlists <= options.memory_limit);
+        CHECK(stats.vlists + stats.spilled > unbounded.memoryUsage().vlists / 2);
+
+        for (const auto& signal : unbounded.getSignals()) {
+            vcdp::VCDChangeReader expected(signal);
+            vcdp::VCDChangeReader actual(*bounded.getSignal(signal.hash));
+            bool same = true;
+            while (expected.next()) {
+                same = same && actual.next() && actual.timeIndex() == expected.timeIndex() && actual.value() == expected.value();
+            }
+            CHECK(same);
+            CHECK_FALSE(actual.next());
+        }
+    }
+    std::filesystem::remove(path);
+}
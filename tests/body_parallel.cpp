@@ -0,0 +1,123 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+/// @brief A VCD text with its '\n' line ends replaced.
+std::string WithLineEnds(const std::string& text, const std::string& line_end) {
+    std::string replaced;
+    for (const char c : text) {
+        if (c == '\n') {
+            replaced += line_end;
+        } else {
+            replaced += c;
+        }
+    }
+    return replaced;
+}
+
+/// @brief Timestamps and changes of every signal, as text.
+std::string Dump(const vcdp::VCDFile& trace) {
+    std::string dump;
+    for (const uint64_t time : trace.getTimestamps()) dump += std::to_string(time) + " ";
+    for (const auto& signal : trace.getSignals()) {
+        dump += "\n" + signal.hash + ":";
+        vcdp::VCDChangeReader reader(signal);
+        while (reader.next()) dump += " " + std::to_string(reader.timeIndex()) + "=" + reader.value();
+    }
+    return dump;
+}
+
+}  // namespace
+
+TEST_CASE("Parallel body decoding matches the sequential one") {
+    vcdp::VCDParser sequential_parser;
+    vcdp::VCDFile sequential;
+    sequential_parser.parse(TEST_DATA_DIR "ghdl_counter.vcd", &sequential);
+    REQUIRE(sequential_parser.GetResult().success);
+
+    vcdp::ParseOptions options;
+    options.threads = 4;
+    options.chunk_size = 64;  // Force many small batches
+
+    vcdp::VCDParser parallel_parser;
+    vcdp::VCDFile parallel;
+    parallel_parser.parse(TEST_DATA_DIR "ghdl_counter.vcd", &parallel, options);
+    REQUIRE(parallel_parser.GetResult().success);
+
+    CHECK(parallel.getTimestamps() == sequential.getTimestamps());
+    REQUIRE(parallel.getSignals().size() == sequential.getSignals().size());
+
+    for (const auto& signal : sequential.getSignals()) {
+        const vcdp::VCDSignal* other = parallel.getSignal(signal.hash);
+        REQUIRE(other != nullptr);
+        CHECK(other->change_count == signal.change_count);
+
+        vcdp::VCDChangeReader expected(signal);
+        vcdp::VCDChangeReader actual(*other);
+        while (expected.next()) {
+            REQUIRE(actual.next());
+            CHECK(actual.timeIndex() == expected.timeIndex());
+            CHECK(actual.value() == expected.value());
+        }
+        CHECK_FALSE(actual.next());
+    }
+
+    // Spot check a decoded vector
+    vcdp::VCDChangeReader data(*parallel.getSignal("#"));
+    REQUIRE(data.next());
+    REQUIRE(data.next());
+    CHECK(parallel.getTimestamp(data.timeIndex()) == 25000000);
+    CHECK(data.value() == "0001");
+}
+
+TEST_CASE("Slices are not cut inside a $comment, whatever the line ends") {
+    // Comments holding timestamp and value lines, longer than a slice, some of them across batches
+    std::string text = "$version GHDL $end\n$scope module top $end\n$var wire 1 ! clk $end\n$var wire 4 \" data [3:0] $end\n"
+                       "$upscope $end\n$enddefinitions $end\n";
+    for (int time = 0; time < 400; time++) {
+        text += "#" + std::to_string(time * 10) + "\n" + std::to_string(time % 2) + "!\n";
+        if (time % 50 == 7) {
+            text += "$comment\n";
+            for (int line = 0; line < 30; line++) text += "#" + std::to_string(999000 + line) + "\n1!\nb1111 \"\n";
+            text += "$end\n";
+        }
+        if (time % 3 == 0) text += "b" + std::string(4, static_cast<char>('0' + time % 2)) + " \"\n";
+    }
+    text += "#oops\n";  // An error on the last line
+
+    vcdp::ParseOptions options;
+    options.threads = 4;
+    options.chunk_size = 128;
+    const std::string lf = WriteTemp("vcdp_body_parallel_comment.vcd", [&](std::ofstream& stream) { stream << text; });
+    vcdp::VCDParser serial_parser;
+    vcdp::VCDFile serial;
+    serial_parser.parse(lf, &serial);
+    std::filesystem::remove(lf);
+    REQUIRE(serial_parser.GetResult().errors.size() == 1);
+    const uint64_t error_line = serial_parser.GetResult().errors[0].line;
+    CHECK(serial.getTimestamps().size() == 400);
+
+    for (const char* line_end : {"\n", "\r\n", "\r"}) {
+        CAPTURE(std::string(line_end).size());
+        const std::string path = WriteTemp("vcdp_body_parallel_comment.vcd", [&](std::ofstream& stream) { stream << WithLineEnds(text, line_end); });
+        for (const unsigned threads : {1u, 4u}) {
+            options.threads = threads;
+            vcdp::VCDParser parser;
+            vcdp::VCDFile trace;
+            parser.parse(path, &trace, options);
+            CHECK(Dump(trace) == Dump(serial));
+            REQUIRE(parser.GetResult().errors.size() == 1);
+            CHECK(parser.GetResult().errors[0].code == vcdp::VCDDiagCode::INVALID_TIMESTAMP);
+            CHECK(parser.GetResult().errors[0].line == error_line);
+        }
+        std::filesystem::remove(path);
+    }
+}
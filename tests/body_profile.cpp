@@ -0,0 +1,58 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <sstream>
+
+#include "vcdp/VCDP.hpp"
+
+TEST_CASE("Parse profile") {
+    uint64_t changes = 0;
+    {
+        vcdp::VCDParser parser;
+        vcdp::VCDFile trace;
+        const uint64_t allocations = vcdp::vlist_allocations;
+        parser.parse(TEST_DATA_DIR "ghdl_counter.vcd", &trace);
+        REQUIRE(parser.GetResult().success);
+        CHECK(vcdp::vlist_allocations == allocations);  // Not counted either
+
+        // Disabled by default
+        const vcdp::VCDProfile& profile = parser.GetResult().profile;
+        CHECK_FALSE(profile.enabled);
+        CHECK(profile[vcdp::VCDPhase::DECODE].calls == 0);
+        CHECK(profile.memory.Total() == 0);
+
+        for (const auto& signal : trace.getSignals()) changes += signal.change_count;
+    }
+
+    for (const unsigned threads : {1u, 3u}) {
+        vcdp::VCDParser parser;
+        vcdp::VCDFile trace;
+        vcdp::ParseOptions options;
+        options.threads = threads;
+        options.chunk_size = 64;
+        options.profile = true;
+        parser.parse(TEST_DATA_DIR "ghdl_counter.vcd", &trace, options);
+        REQUIRE(parser.GetResult().success);
+
+        const vcdp::VCDProfile& profile = parser.GetResult().profile;
+        CHECK(profile.enabled);
+        CHECK(profile[vcdp::VCDPhase::HEADER_READ].calls == 1);
+        CHECK(profile[vcdp::VCDPhase::HEADER_PARSE].bytes == profile[vcdp::VCDPhase::HEADER_READ].bytes);
+        CHECK(profile[vcdp::VCDPhase::DECODE].changes == changes);
+        CHECK(profile[vcdp::VCDPhase::DECODE].bytes == profile[vcdp::VCDPhase::BODY_READ].bytes);
+        CHECK(profile[vcdp::VCDPhase::HEADER_READ].lines + profile[vcdp::VCDPhase::DECODE].lines == 177);
+
+        const vcdp::VCDPhase storing = threads == 1 ? vcdp::VCDPhase::DECODE : vcdp::VCDPhase::STORE;
+        CHECK(profile[storing].changes == changes);
+        CHECK(profile[storing].allocations == profile.memory.vlist_blocks);
+
+        CHECK(profile.memory.vlists > 0);
+        CHECK(profile.memory.time_table >= trace.getTimestamps().size() * sizeof(uint64_t));
+        CHECK(profile.memory.Total() == trace.memoryUsage().Total());
+
+        std::ostringstream json;
+        profile.WriteJson(json);
+        CHECK(json.str().find("\"decode\": {\"wall_seconds\": ") != std::string::npos);
+        CHECK(json.str().find("\"memory\": {\"vlists\": ") != std::string::npos);
+    }
+}
@@ -0,0 +1,85 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <cstdlib>
+#include <filesystem>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+TEST_CASE("Decode real value changes") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "body_real.vcd", &trace);
+
+    // A vector value for a real, a real for a wire and a real without number
+    CHECK(parser.GetResult().errors.Count(vcdp::VCDDiagCode::INVALID_VALUE) == 3);
+
+    const vcdp::VCDSignal& vout = *trace.getSignal("!");
+    CHECK(vout.isReal());
+    CHECK(vout.change_count == 41);
+    CHECK_FALSE(trace.getSignal("#")->isReal());
+
+    const auto changes = ReadChanges(trace, vout);
+    REQUIRE(changes.size() == 41);
+    CHECK(changes[0] == std::make_pair(uint64_t{0}, std::string("0")));
+    CHECK(changes[7].second == "1.5");
+    CHECK(changes[8].second == "1.5");
+    CHECK(changes[9].second == "3");
+    CHECK(changes[10].second == "-0.00225");
+    CHECK(changes[11].second == "1e+300");
+    CHECK(changes[12].second == "-0");
+    CHECK(changes[13].second == "inf");
+    CHECK(changes[40] == std::make_pair(uint64_t{400}, std::string("2.29004")));
+
+    // Values are printed in their shortest form reading back the same double
+    vcdp::VCDChangeReader reader(vout);
+    while (reader.next()) CHECK(std::strtod(reader.value().c_str(), nullptr) == reader.real());
+    CHECK(changes[1].second == "1.079742");
+
+    // Integer reads give the IEEE 754 bits
+    vcdp::VCDChangeReader bits_reader(*trace.getSignal("\""));
+    uint64_t bits = 0;
+    bool known = false;
+    REQUIRE(bits_reader.next(bits, known));
+    REQUIRE(bits_reader.next(bits, known));
+    CHECK(known);
+    CHECK(bits == 0x4044000000000000);  // 40.0
+}
+
+TEST_CASE("Real values survive a rewrite and an archive") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "body_real.vcd", &trace);
+    const vcdp::VCDSignal& vout = *trace.getSignal("!");
+
+    const std::string output = TempPath("vcdp_real.vcd");
+    REQUIRE(vcdp::VCDWriter().write(trace, output).success);
+    vcdp::VCDParser reparser;
+    vcdp::VCDFile copy;
+    reparser.parse(output, &copy);
+    REQUIRE(reparser.GetResult().success);
+    CHECK(ReadChanges(copy, *copy.getSignal("!")) == ReadChanges(trace, vout));
+    std::filesystem::remove(output);
+
+    // Blocks of an archive start on an absolute value: a window decodes on its own
+    const std::string archive = TempPath("vcdp_real.vcda");
+    vcdp::ArchiveOptions options;
+    options.block_size = 16;
+    REQUIRE(vcdp::VCDArchiveWriter(options).write(trace, archive).success);
+
+    vcdp::VCDArchiveReader reader;
+    REQUIRE(reader.open(archive));
+    const vcdp::VCDSignal& stored = *reader.getFile().getSignal("!");
+    REQUIRE(reader.getBlocks(stored).size() > 4);
+    REQUIRE(reader.loadSignal(stored, 200, 300));
+    const auto window = ReadChanges(reader.getFile(), stored);
+    const auto full = ReadChanges(trace, vout);
+    REQUIRE_FALSE(window.empty());
+    CHECK(window.size() < full.size());
+    CHECK(std::search(full.begin(), full.end(), window.begin(), window.end()) != full.end());
+
+    REQUIRE(reader.loadSignal(stored));
+    CHECK(ReadChanges(reader.getFile(), stored) == full);
+    std::filesystem::remove(archive);
+}
@@ -0,0 +1,98 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+TEST_CASE("Unknown identifiers in the body") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "body_unknown_identifier.vcd", &trace);
+
+    const auto& result = parser.GetResult();
+    CHECK(result.warnings.Count(vcdp::VCDDiagCode::UNKNOWN_IDENTIFIER) == 4);
+    CHECK(result.errors.Count(vcdp::VCDDiagCode::INVALID_TIMESTAMP) == 1);
+    CHECK_FALSE(result.success);
+
+    REQUIRE(result.warnings.size() == 4);
+    CHECK(result.warnings[0].detail == "?");
+    CHECK(result.warnings[0].line == 20);
+    CHECK(result.warnings[0].Message().find("'?'") != std::string::npos);
+
+    REQUIRE(result.errors.size() == 1);
+    CHECK(result.errors[0].detail == "#3O");
+    CHECK(result.errors[0].line == 29);
+
+    // Known signals are still decoded around the bad lines
+    CHECK(trace.getTimestamps().size() == 3);
+    CHECK(trace.getSignal("!")->change_count == 4);
+    CHECK(trace.getSignal("\"")->change_count == 2);
+}
+
+TEST_CASE("Line numbers of diagnostics with CRLF line ends") {
+    std::ifstream source(TEST_DATA_DIR "body_unknown_identifier.vcd", std::ios::binary);
+    std::stringstream text;
+    text << source.rdbuf();
+    std::string crlf;
+    for (const char c : text.str()) crlf += c == '\n' ? "\r\n" : std::string(1, c);
+    const std::string path = WriteTemp("vcdp_body_unknown_identifier_crlf.vcd", [&](std::ofstream& stream) { stream << crlf; });
+
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(path, &trace);
+    std::filesystem::remove(path);
+
+    const auto& result = parser.GetResult();
+    REQUIRE(result.warnings.size() == 4);
+    CHECK(result.warnings[0].line == 20);
+    REQUIRE(result.errors.size() == 1);
+    CHECK(result.errors[0].line == 29);
+    CHECK(trace.getSignal("!")->change_count == 4);
+}
+
+TEST_CASE("A signal idle for more than 2^32 time steps keeps the time index of its changes") {
+    vcdp::VCDFile trace;
+    trace.addScope({"top", vcdp::VCDScopeType::VCD_SCOPE_MODULE});
+    vcdp::VCDSignal declared;
+    declared.hash = "!";
+    declared.reference = "idle";
+    trace.addSignal(std::move(declared));
+    trace.endDefinitions();
+
+    // Time indices are given directly: the time table would not fit in memory
+    vcdp::VCDSignal& idle = *trace.getSignal("!");
+    const uint64_t far = (uint64_t{1} << 32) + 5;
+    trace.addValueChange(idle, 0, "0");
+    trace.addValueChange(idle, far, "1");
+    trace.addValueChange(idle, far + 1, "0");
+
+    vcdp::VCDChangeReader reader(idle);
+    REQUIRE(reader.next());
+    CHECK(reader.timeIndex() == 0);
+    REQUIRE(reader.next());
+    CHECK(reader.timeIndex() == far);
+    CHECK(reader.value() == "1");
+    REQUIRE(reader.next());
+    CHECK(reader.timeIndex() == far + 1);
+    CHECK_FALSE(reader.next());
+}
+
+TEST_CASE("Retained diagnostics are capped") {
+    vcdp::VCDDiagnosticList list;
+    list.SetLimit(2);
+    for (int i = 0; i < 1000; i++) {
+        list.Add(vcdp::VCDDiagCode::UNKNOWN_IDENTIFIER, vcdp::VCDSeverity::VCD_WARNING, i, i + 1, "?");
+    }
+
+    CHECK(list.size() == 2);
+    CHECK(list.Total() == 1000);
+    CHECK(list.Dropped() == 998);
+    CHECK(list.Count(vcdp::VCDDiagCode::UNKNOWN_IDENTIFIER) == 1000);
+    CHECK(list.Count(vcdp::VCDDiagCode::INVALID_VALUE) == 0);
+}
@@ -0,0 +1,230 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+/// @brief The noisy trace of the helpers at odd timestamps: none at 0.
+std::string WriteTrace(const std::string& name) { return WriteNoisyTrace(name, 4242, 40000, 1, 2); }
+
+/// @brief The changes of a signal read backward from its end with a cursor, in forward order.
+Changes ReadBackward(const vcdp::VCDSignal& signal) {
+    Changes changes;
+    vcdp::VCDChangeCursor cursor(signal);
+    cursor.toEnd();
+    while (cursor.prev()) changes.emplace_back(cursor.timeIndex(), cursor.value());
+    std::reverse(changes.begin(), changes.end());
+    return changes;
+}
+
+/// @brief Walk a cursor in both directions, turning around at and next to the edges of windows.
+size_t TurnAroundMismatches(const vcdp::VCDSignal& signal) {
+    const Changes changes = ReadChanges(signal);
+    size_t mismatches = 0;
+    vcdp::VCDChangeCursor cursor(signal);
+    const auto at = [&](const uint64_t change) {
+        return !cursor.valid() || cursor.index() != change || cursor.timeIndex() != changes[change].first || cursor.value() != changes[change].second;
+    };
+    for (uint64_t edge = vcdp::VCD_SKIP_INTERVAL; edge < changes.size(); edge += 3 * vcdp::VCD_SKIP_INTERVAL + 5) {
+        const uint64_t from = edge - 2;
+        cursor.toStart();
+        for (uint64_t i = 0; i <= from; i++) cursor.next();
+        mismatches += at(from);
+        for (uint64_t i = from + 1; i < std::min<uint64_t>(edge + 3, changes.size()); i++) mismatches += !cursor.next() || at(i);
+        for (uint64_t i = cursor.index(); i-- > from;) mismatches += !cursor.prev() || at(i);
+    }
+    return mismatches;
+}
+
+}  // namespace
+
+TEST_CASE("A change cursor reads backward what a reader reads forward") {
+    const std::string path = WriteTrace("vcdp_change_cursor.vcd");
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(path, &trace);
+    REQUIRE(parser.GetResult().success);
+
+    vcdp::ParseOptions options;
+    options.chunk_size = 64 * 1024;
+    options.memory_limit = 64 * 1024;
+    vcdp::VCDFile bounded;
+    parser.parse(path, &bounded, options);
+    std::filesystem::remove(path);
+    REQUIRE(parser.GetResult().success);
+    CHECK(bounded.memoryUsage().spilled > 0);
+
+    for (const vcdp::VCDFile* file : {&trace, &bounded}) {
+        for (const char* hash : {"!", "\"", "#", "$"}) {
+            const vcdp::VCDSignal& signal = *file->getSignal(hash);
+            CHECK(ReadBackward(signal) == ReadChanges(signal));
+            CHECK(TurnAroundMismatches(signal) == 0);
+        }
+    }
+
+    // At the ends
+    const vcdp::VCDSignal& noise = *trace.getSignal("!");
+    vcdp::VCDChangeCursor cursor(noise);
+    CHECK_FALSE(cursor.valid());
+    CHECK_FALSE(cursor.prev());
+    CHECK(cursor.next());
+    CHECK(cursor.index() == 0);
+    CHECK_FALSE(cursor.prev());
+    CHECK(cursor.next());
+    cursor.toEnd();
+    CHECK_FALSE(cursor.next());
+    CHECK(cursor.prev());
+    CHECK(cursor.index() == noise.change_count - 1);
+}
+
+TEST_CASE("A change cursor seeks a time index") {
+    const std::string path = WriteTrace("vcdp_change_cursor_seek.vcd");
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(path, &trace);
+    std::filesystem::remove(path);
+    REQUIRE(parser.GetResult().success);
+
+    for (const char* hash : {"!", "\"", "$"}) {
+        const vcdp::VCDSignal& signal = *trace.getSignal(hash);
+        const Changes changes = ReadChanges(signal);
+        vcdp::VCDChangeCursor cursor(signal);
+        size_t mismatches = 0;
+        for (uint64_t time_index = 0; time_index < trace.getTimestamps().size() + 2; time_index += 3) {
+            const auto after = std::lower_bound(changes.begin(), changes.end(), time_index, [](const auto& c, uint64_t t) { return c.first < t; });
+            if (after == changes.end()) {
+                mismatches += cursor.seek(time_index) || cursor.valid() || !cursor.prev() || cursor.index() != changes.size() - 1;
+            } else {
+                mismatches += !cursor.seek(time_index) || cursor.index() != static_cast<uint64_t>(after - changes.begin());
+                mismatches += cursor.timeIndex() != after->first || cursor.value() != after->second;
+            }
+
+            // The last change at or before: the one before the first change after
+            const auto next = std::upper_bound(changes.begin(), changes.end(), time_index, [](uint64_t t, const auto& c) { return t < c.first; });
+            if (next == changes.begin()) {
+                mismatches += cursor.seekBefore(time_index) || cursor.valid() || !cursor.next() || cursor.index() != 0;
+            } else {
+                mismatches += !cursor.seekBefore(time_index) || cursor.index() != static_cast<uint64_t>(next - changes.begin() - 1);
+                mismatches += cursor.value() != (next - 1)->second;
+                mismatches += cursor.next() != (next != changes.end()) || (next != changes.end() && cursor.value() != next->second);
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+}
+
+TEST_CASE("A time cursor steps over the changes of several signals both ways") {
+    const std::string path = WriteTrace("vcdp_time_cursor.vcd");
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(path, &trace);
+    std::filesystem::remove(path);
+    REQUIRE(parser.GetResult().success);
+
+    const std::vector<const vcdp::VCDSignal*> signals = {trace.getSignal("\""), trace.getSignal("#"), trace.getSignal("$")};
+    std::vector<Changes> changes;
+    std::set<uint64_t> steps;
+    for (const auto* signal : signals) {
+        changes.push_back(ReadChanges(*signal));
+        for (const auto& change : changes.back()) steps.insert(change.first);
+    }
+    const std::vector<uint64_t> expected(steps.begin(), steps.end());
+
+    // The value of each signal at a step and whether it changes there
+    size_t mismatches = 0;
+    vcdp::VCDTimeCursor cursor(trace, signals);
+    const auto check = [&](const uint64_t time_index) {
+        mismatches += cursor.timeIndex() != time_index || cursor.time() != trace.getTimestamp(time_index);
+        for (size_t i = 0; i < signals.size(); i++) {
+            const Changes& held = changes[i];
+            const auto next = std::upper_bound(held.begin(), held.end(), time_index, [](uint64_t t, const auto& c) { return t < c.first; });
+            const std::string value = next == held.begin() ? "" : (next - 1)->second;
+            mismatches += cursor.value(i) != value || cursor.changed(i) != (next != held.begin() && (next - 1)->first == time_index);
+        }
+    };
+    std::vector<uint64_t> forward;
+    while (cursor.next()) {
+        forward.push_back(cursor.timeIndex());
+        if (forward.size() % 17 == 0) check(cursor.timeIndex());
+    }
+    CHECK(forward == expected);
+    CHECK(cursor.timeIndex() == expected.back());
+
+    std::vector<uint64_t> backward = {cursor.timeIndex()};
+    while (cursor.prev()) {
+        backward.push_back(cursor.timeIndex());
+        if (backward.size() % 17 == 0) check(cursor.timeIndex());
+    }
+    std::reverse(backward.begin(), backward.end());
+    CHECK(backward == expected);
+    CHECK(mismatches == 0);
+
+    // Seeks, then a few steps around
+    for (size_t i = 0; i < expected.size(); i += 97) {
+        const uint64_t time = trace.getTimestamp(expected[i]);
+        REQUIRE(cursor.seekBefore(time + 1));
+        check(expected[i]);
+        if (i + 1 < expected.size()) {
+            REQUIRE(cursor.next());
+            check(expected[i + 1]);
+        }
+        REQUIRE(cursor.seek(time));
+        check(expected[i]);
+        if (i > 0) {
+            REQUIRE(cursor.prev());
+            check(expected[i - 1]);
+        }
+    }
+    CHECK(mismatches == 0);
+    CHECK_FALSE(cursor.seek(trace.getTimestamps().back() + 1));
+    CHECK(cursor.timeIndex() == expected.back());
+    CHECK_FALSE(cursor.seekBefore(trace.getTimestamp(expected.front()) - 1));
+    for (size_t i = 0; i < signals.size(); i++) CHECK(cursor.value(i).empty());
+    CHECK(cursor.next());
+    CHECK(cursor.timeIndex() == expected.front());
+    CHECK_FALSE(cursor.prev());
+}
+
+TEST_CASE("Backward stepping benchmark") {
+    // About a million changes of a 16 bit counter, built with the API
+    vcdp::VCDFile trace;
+    trace.addScope({"top", vcdp::VCDScopeType::VCD_SCOPE_MODULE});
+    vcdp::VCDSignal declared;
+    declared.hash = "!";
+    declared.reference = "count";
+    declared.size = 16;
+    declared.lindex = 15;
+    declared.rindex = 0;
+    trace.addSignal(std::move(declared));
+    trace.endDefinitions();
+    vcdp::VCDSignal& count = *trace.getSignal("!");
+    constexpr uint32_t STEPS = 1 << 20;
+    std::string value(16, '0');
+    for (uint32_t step = 0; step < STEPS; step++) {
+        trace.addTimestamp(step * 10);
+        for (int bit = 0; bit < 16; bit++) value[15 - bit] = static_cast<char>('0' + (step >> bit & 1));
+        trace.addValueChange(count, value);
+    }
+
+    size_t forward_bytes = 0;
+    size_t backward_bytes = 0;
+    vcdp::VCDChangeCursor cursor(count);
+    const double forward = Time([&] {
+        while (cursor.next()) forward_bytes += cursor.value().size();
+    });
+    const double backward = Time([&] {
+        while (cursor.prev()) backward_bytes += cursor.value().size();
+    });
+    CHECK(forward_bytes == backward_bytes);
+    CHECK(forward_bytes == 16ull * STEPS);
+    MESSAGE(count.change_count << " changes stepped in " << static_cast<uint64_t>(forward * 1000) << " ms forward, "
+                               << static_cast<uint64_t>(backward * 1000) << " ms backward");
+}
@@ -0,0 +1,173 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+/// @brief The noisy trace of the helpers.
+std::string WriteTrace() { return WriteNoisyTrace("vcdp_change_seek.vcd", 12345, 60000, 0, 3); }
+
+struct Change {
+    uint64_t time_index;
+    uint64_t time;
+    std::string value;
+};
+
+/// @brief Every change of a signal with both its time index and its time, read from its start.
+std::vector<Change> TimedChanges(const vcdp::VCDFile& trace, const vcdp::VCDSignal& signal) {
+    std::vector<Change> changes;
+    for (auto& [time_index, value] : ReadChanges(signal)) changes.push_back({time_index, trace.getTimestamp(time_index), std::move(value)});
+    return changes;
+}
+
+/// @brief Compare nextChange and prevChange with the changes read from the start, at every timestamp around a change.
+size_t Mismatches(const vcdp::VCDFile& trace, const vcdp::VCDSignal& signal) {
+    const std::vector<Change> changes = TimedChanges(trace, signal);
+    size_t mismatches = 0;
+    const auto check = [&](const std::optional<vcdp::VCDFoundChange>& found, const Change* expected) {
+        if (expected == nullptr) {
+            mismatches += found.has_value();
+        } else {
+            mismatches += !found || found->time_index != expected->time_index || found->time != expected->time || found->value != expected->value;
+        }
+    };
+    for (const auto& change : changes) {
+        for (const uint64_t time : {change.time - 1, change.time, change.time + 1}) {
+            if (time == UINT64_MAX) continue;
+            const auto after = std::find_if(changes.begin(), changes.end(), [&](const Change& c) { return c.time > time; });
+            check(trace.nextChange(signal, time), after == changes.end() ? nullptr : &*after);
+            const auto before = std::find_if(changes.rbegin(), changes.rend(), [&](const Change& c) { return c.time < time; });
+            check(trace.prevChange(signal, time), before == changes.rend() ? nullptr : &*before);
+        }
+    }
+    return mismatches;
+}
+
+}  // namespace
+
+TEST_CASE("Find the changes of a signal around a time") {
+    const std::string path = WriteTrace();
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(path, &trace);
+    std::filesystem::remove(path);
+    REQUIRE(parser.GetResult().success);
+
+    const vcdp::VCDSignal& noise = *trace.getSignal("!");
+    CHECK(noise.skip.size() == (noise.change_count - 1) / vcdp::VCD_SKIP_INTERVAL);
+    CHECK(trace.getSignal("\"")->skip.empty());
+    for (const char* hash : {"\"", "#", "$"}) CHECK(Mismatches(trace, *trace.getSignal(hash)) == 0);
+
+    // The noisy bit at the ends and around changes repeated at a timestamp
+    const std::vector<Change> changes = TimedChanges(trace, noise);
+    CHECK(trace.nextChange(noise, changes.back().time) == std::nullopt);
+    CHECK(trace.prevChange(noise, changes.front().time) == std::nullopt);
+    CHECK(trace.nextChange(noise, 0)->time > 0);
+    CHECK(trace.prevChange(noise, UINT64_MAX)->value == changes.back().value);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < changes.size(); i += 7) {
+        vcdp::VCDChangeReader reader(noise);
+        const auto first = std::find_if(changes.begin(), changes.end(), [&](const Change& c) { return c.time_index >= changes[i].time_index; });
+        mismatches += !reader.seek(changes[i].time_index) || reader.timeIndex() != first->time_index || reader.value() != first->value;
+        const auto last = std::find_if(changes.rbegin(), changes.rend(), [&](const Change& c) { return c.time_index <= changes[i].time_index; });
+        mismatches += !reader.seekBefore(changes[i].time_index) || reader.value() != last->value;
+        mismatches += reader.next() != (last != changes.rbegin()) || (last != changes.rbegin() && reader.value() != (last - 1)->value);
+    }
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE("Find the edges of a signal as sampleOn") {
+    const std::string path = WriteTrace();
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(path, &trace);
+    std::filesystem::remove(path);
+    REQUIRE(parser.GetResult().success);
+
+    for (const char* hash : {"!", "\"", "#"}) {
+        const vcdp::VCDSignal& signal = *trace.getSignal(hash);
+        for (const auto edge : {vcdp::VCDEdge::RISING, vcdp::VCDEdge::FALLING, vcdp::VCDEdge::BOTH}) {
+            const std::vector<uint64_t> times = trace.sampleOn(signal, edge, {}).times;
+            REQUIRE(!times.empty());
+            size_t mismatches = 0;
+            for (uint64_t time = 0; time < times.back() + 10; time += 5) {
+                const auto expected = std::upper_bound(times.begin(), times.end(), time);
+                const auto found = trace.nextEdge(signal, time, edge);
+                mismatches += expected == times.end() ? found.has_value() : !found || found->time != *expected;
+            }
+            CHECK(mismatches == 0);
+        }
+    }
+    CHECK(trace.nextEdge(*trace.getSignal("$"), 0, vcdp::VCDEdge::BOTH) == std::nullopt);
+}
+
+TEST_CASE("Find changes spilled to disk or loaded from an archive") {
+    const std::string path = WriteTrace();
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(path, &trace);
+    REQUIRE(parser.GetResult().success);
+
+    vcdp::ParseOptions options;
+    options.chunk_size = 64 * 1024;
+    options.memory_limit = 64 * 1024;
+    vcdp::VCDFile bounded;
+    parser.parse(path, &bounded, options);
+    std::filesystem::remove(path);
+    REQUIRE(parser.GetResult().success);
+    CHECK(bounded.memoryUsage().spilled > 0);
+    for (const char* hash : {"!", "$"}) CHECK(Mismatches(bounded, *bounded.getSignal(hash)) == 0);
+
+    const std::string archive = TempPath("vcdp_change_seek.vcda");
+    vcdp::ArchiveOptions archive_options;
+    archive_options.block_size = 100;
+    REQUIRE(vcdp::VCDArchiveWriter(archive_options).write(trace, archive).success);
+    vcdp::VCDArchiveReader reader;
+    REQUIRE(reader.open(archive));
+    for (const char* hash : {"!", "$"}) {
+        const vcdp::VCDSignal& signal = *reader.getFile().findSignal(hash);
+        REQUIRE(reader.loadSignal(signal));
+        CHECK(signal.skip.size() == trace.getSignal(hash)->skip.size());
+        CHECK(Mismatches(reader.getFile(), signal) == 0);
+    }
+    std::filesystem::remove(archive);
+}
+
+TEST_CASE("Change lookup benchmark") {
+    const std::string path = WriteTrace();
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(path, &trace);
+    std::filesystem::remove(path);
+    REQUIRE(parser.GetResult().success);
+
+    // The value of the noisy bit at spread times, with the skip index and by reading its changes from the start
+    const vcdp::VCDSignal& noise = *trace.getSignal("!");
+    constexpr uint64_t QUERIES = 2000;
+    const uint64_t end = trace.getTimestamps().back();
+    std::string indexed;
+    std::string replayed;
+    const double seek = Time([&] {
+        for (uint64_t query = 0; query < QUERIES; query++) indexed += trace.prevChange(noise, query * end / QUERIES + 1)->value;
+    });
+    const double replay = Time([&] {
+        for (uint64_t query = 0; query < QUERIES; query++) {
+            const uint64_t time = query * end / QUERIES + 1;
+            vcdp::VCDChangeReader reader(noise);
+            std::string value;
+            while (reader.next() && trace.getTimestamp(reader.timeIndex()) < time) value = reader.value();
+            replayed += value;
+        }
+    });
+    CHECK(indexed == replayed);
+    MESSAGE(noise.change_count << " changes; " << QUERIES << " lookups in " << static_cast<uint64_t>(seek * 1e6) << " us with the skip index, "
+                               << static_cast<uint64_t>(replay * 1e6) << " us replayed");
+}
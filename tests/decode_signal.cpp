@@ -0,0 +1,40 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "vcdp/VCDP.hpp"
+
+TEST_CASE("Decode the changes of a signal into arrays") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "clocked_bus.vcd", &trace);
+    REQUIRE(parser.GetResult().success);
+
+    const vcdp::VCDDecodedSignal nibble = trace.decode(*trace.getSignal("#"));
+    CHECK(nibble.changes() == 3);
+    CHECK(nibble.words == 1);
+    CHECK(nibble.times == std::vector<uint64_t>{0, 6, 10});
+    CHECK(nibble.time_indices == std::vector<uint64_t>{0, 3, 5});
+    CHECK(nibble.values == std::vector<uint64_t>{0, 0, 10});
+    CHECK(nibble.known == std::vector<uint8_t>{1, 0, 1});
+    CHECK(nibble.reals.empty());
+
+    // Wide values take several words, least significant first
+    const vcdp::VCDDecodedSignal bus = trace.decode(*trace.getSignal("\""));
+    CHECK(bus.words == 2);
+    CHECK(bus.times == std::vector<uint64_t>{0, 4, 8});
+    CHECK(bus.values == std::vector<uint64_t>{0, 0, 1, 0, 3, 1 << 2});
+    CHECK(bus.known == std::vector<uint8_t>{0, 1, 1});
+}
+
+TEST_CASE("Decode the changes of a real signal") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "body_real.vcd", &trace);
+
+    const vcdp::VCDDecodedSignal t_last = trace.decode(*trace.getSignal("\""));
+    CHECK(t_last.changes() == 11);
+    CHECK(t_last.times == std::vector<uint64_t>{0, 40, 80, 120, 160, 200, 240, 280, 320, 360, 400});
+    CHECK(t_last.reals == std::vector<double>{0, 40, 80, 120, 160, 200, 240, 280, 320, 360, 400});
+    CHECK(t_last.values.empty());
+    CHECK(t_last.known.empty());
+}
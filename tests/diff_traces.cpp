@@ -0,0 +1,97 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+const vcdp::VCDSignalDiff* Find(const vcdp::VCDDiffResult& result, const std::string& path) {
+    for (const auto& diff : result.signals) {
+        if (diff.path == path) return &diff;
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+TEST_CASE("A file is identical to itself") {
+    vcdp::DiffOptions options;
+    options.threads = 3;
+    options.chunk_size = 7;  // Timestamps cut across chunks
+    vcdp::VCDDiff diff(options);
+
+    const vcdp::VCDDiffResult result = diff.compare(TEST_DATA_DIR "ghdl_counter.vcd", TEST_DATA_DIR "ghdl_counter.vcd");
+    REQUIRE(result.success);
+    CHECK(result.Identical());
+    CHECK(result.signals.size() == 7);
+    CHECK(result.end_time > 0);
+}
+
+TEST_CASE("Signals are matched by path and compared in lock-step") {
+    for (const unsigned threads : {1u, 3u}) {
+        for (const size_t chunk_size : {size_t{5}, size_t{1024 * 1024}}) {
+            CAPTURE(threads);
+            CAPTURE(chunk_size);
+            vcdp::DiffOptions options;
+            options.threads = threads;
+            options.chunk_size = chunk_size;
+            vcdp::VCDDiff diff(options);
+
+            const vcdp::VCDDiffResult result = diff.compare(TEST_DATA_DIR "diff_golden.vcd", TEST_DATA_DIR "diff_failing.vcd");
+            REQUIRE(result.success);
+            CHECK_FALSE(result.Identical());
+            CHECK(result.signals.size() == 3);
+            CHECK(result.DifferingSignals() == 3);
+            CHECK(result.only_in_a == std::vector<std::string>{"tb.old"});
+            CHECK(result.only_in_b == std::vector<std::string>{"tb.new"});
+            CHECK(result.end_time == 60);
+
+            // Different encodings of the same value ("b1" and "b0001", "b11" and "B11") are equal
+            const vcdp::VCDSignalDiff* count = Find(result, "tb.count");
+            REQUIRE(count != nullptr);
+            CHECK(count->first_divergence == 20);
+            CHECK(count->mismatches == 1);
+            REQUIRE(count->windows.size() == 1);
+            CHECK(count->windows[0].begin == 20);
+            CHECK(count->windows[0].end == 25);
+
+            const vcdp::VCDSignalDiff* done = Find(result, "tb.done");
+            REQUIRE(done != nullptr);
+            CHECK(done->first_divergence == 40);
+            REQUIRE(done->windows.size() == 1);
+            CHECK(done->windows[0].end == 45);
+
+            // Still different at the end of the traces
+            const vcdp::VCDSignalDiff* clk = Find(result, "tb.clk");
+            REQUIRE(clk != nullptr);
+            CHECK(clk->first_divergence == 60);
+            REQUIRE(clk->windows.size() == 1);
+            CHECK(clk->windows[0].end == UINT64_MAX);
+        }
+    }
+}
+
+TEST_CASE("Select signals and bound the kept windows") {
+    vcdp::DiffOptions options;
+    options.signals = {"tb.c*"};
+    options.max_windows = 0;
+    vcdp::VCDDiff diff(options);
+
+    const vcdp::VCDDiffResult result = diff.compare(TEST_DATA_DIR "diff_golden.vcd", TEST_DATA_DIR "diff_failing.vcd");
+    REQUIRE(result.success);
+    CHECK(result.signals.size() == 2);
+    CHECK(result.only_in_a.empty());
+    CHECK(result.only_in_b.empty());
+    for (const auto& signal : result.signals) {
+        CHECK(signal.window_count == 1);
+        CHECK(signal.windows.empty());
+    }
+}
+
+TEST_CASE("Report a missing file") {
+    vcdp::VCDDiff diff;
+    const vcdp::VCDDiffResult result = diff.compare(TEST_DATA_DIR "diff_golden.vcd", TEST_DATA_DIR "does_not_exist.vcd");
+    CHECK_FALSE(result.success);
+    CHECK_FALSE(result.error.empty());
+    CHECK_FALSE(diff.GetParseResult(1).success);
+}
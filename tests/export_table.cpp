@@ -0,0 +1,116 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+std::string ReadAll(const std::filesystem::path& path) {
+    std::ifstream stream(path, std::ios::binary);
+    std::ostringstream text;
+    text << stream.rdbuf();
+    return text.str();
+}
+
+/// @brief Export search_handshake.vcd and read the table back.
+std::string Export(const vcdp::ExportOptions& options, const std::string& name) {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "search_handshake.vcd", &trace);
+    REQUIRE(parser.GetResult().success);
+
+    const std::string output = TempPath(name);
+    const vcdp::VCDExportResult result = vcdp::VCDExporter(options).write(trace, output);
+    REQUIRE(result.success);
+    const std::string table = ReadAll(output);
+    CHECK(result.bytes == table.size());
+    std::filesystem::remove(output);
+    return table;
+}
+
+}  // namespace
+
+TEST_CASE("Export one row per value change") {
+    vcdp::ExportOptions options;
+    options.threads = 4;
+    CHECK(Export(options, "vcdp_export_changes.csv") ==
+          "time,tb.clk,tb.valid,tb.ready,tb.data\n"
+          "0,0,0,0,\n"
+          "5,1,0,0,\n"
+          "10,0,1,0,165\n"
+          "15,1,1,0,165\n"
+          "20,0,1,0,165\n"
+          "25,1,1,0,165\n"
+          "30,0,1,1,165\n"
+          "35,1,1,1,165\n"
+          "40,0,0,0,165\n"
+          "45,1,0,0,165\n"
+          "50,0,1,1,15\n"
+          "55,1,1,1,15\n"
+          "60,0,0,1,15\n");
+
+    // Rows are the times at which a selected signal changes
+    options.signals = {"tb.data"};
+    CHECK(Export(options, "vcdp_export_data.csv") == "time,tb.data\n0,\n10,165\n50,15\n");
+}
+
+TEST_CASE("Export the values sampled on the rising edges of a clock") {
+    vcdp::ExportOptions options;
+    options.signals = {"tb.valid", "tb.ready", "tb.data"};
+    options.clock = "tb.clk";
+
+    // Values just before each edge, as a flip-flop samples them
+    CHECK(Export(options, "vcdp_export_clock.csv") ==
+          "time,tb.valid,tb.ready,tb.data\n"
+          "5,0,0,\n"
+          "15,1,0,165\n"
+          "25,1,0,165\n"
+          "35,1,1,165\n"
+          "45,0,0,165\n"
+          "55,1,1,15\n");
+
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "search_handshake.vcd", &trace);
+    const std::string output = TempPath("vcdp_export_error.csv");
+
+    options.clock = "tb.data";
+    CHECK_FALSE(vcdp::VCDExporter(options).write(trace, output).success);
+    options.clock = "tb.missing";
+    CHECK_FALSE(vcdp::VCDExporter(options).write(trace, output).success);
+    options.clock.clear();
+    options.signals = {"tb.missing"};
+    CHECK_FALSE(vcdp::VCDExporter(options).write(trace, output).success);
+    std::filesystem::remove(output);
+}
+
+TEST_CASE("Export an Arrow IPC file") {
+    vcdp::ExportOptions options;
+    options.format = vcdp::ExportFormat::ARROW;
+    options.batch_bytes = 0;  // Batches of the minimum size
+    const std::string table = Export(options, "vcdp_export.arrow");
+
+    // Magic, schema message, record batches, end of stream, footer and its size, magic
+    REQUIRE(table.size() > 32);
+    CHECK(table.compare(0, 8, std::string("ARROW1\0\0", 8)) == 0);
+    CHECK(table.compare(table.size() - 6, 6, "ARROW1") == 0);
+    CHECK(table.compare(8, 4, "\xFF\xFF\xFF\xFF") == 0);
+
+    int32_t footer_size = 0;
+    std::memcpy(&footer_size, &table[table.size() - 10], 4);
+    REQUIRE(footer_size > 0);
+    REQUIRE(static_cast<size_t>(footer_size) + 18 < table.size());
+    const size_t footer = table.size() - 10 - static_cast<size_t>(footer_size);
+    CHECK(table.compare(footer - 8, 8, std::string("\xFF\xFF\xFF\xFF\0\0\0\0", 8)) == 0);
+
+    // Field names are stored as is in the schema
+    for (const char* name : {"time", "tb.clk", "tb.valid", "tb.ready", "tb.data", "timescale", "1ns"}) {
+        CHECK(table.find(name) != std::string::npos);
+    }
+}
@@ -0,0 +1,53 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "vcdp/VCDP.hpp"
+
+TEST_CASE("Scopes and signals are stored in flat tables") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "header_flat_layout.vcd", &trace);
+    for (const auto& error : parser.GetResult().errors) {
+        std::cerr << error << std::endl;
+    }
+    REQUIRE(parser.GetResult().success);
+
+    // Breadth-first order: the top scopes come first, the children of a scope are contiguous
+    REQUIRE(trace.getScopes().size() == 5);
+    const auto top_scopes = trace.getTopScopes();
+    REQUIRE(top_scopes.size() == 2);
+    CHECK(top_scopes[0].name == "top");
+    CHECK(top_scopes[1].name == "other");
+
+    const auto children = trace.getScopeChildren(top_scopes[0]);
+    REQUIRE(children.size() == 2);
+    CHECK(children[0].name == "a");
+    CHECK(children[1].name == "b");
+    CHECK(children[0].parent == trace.indexOf(top_scopes[0]));
+    CHECK(trace.getScopeChildren(top_scopes[1]).empty());
+
+    const auto grand_children = trace.getScopeChildren(children[0]);
+    REQUIRE(grand_children.size() == 1);
+    CHECK(grand_children[0].name == "a_inner");
+
+    // An identifier declared in several scopes is a single signal listed by each scope
+    CHECK(trace.getSignals().size() == 5);
+    const vcdp::VCDSignal* clk = trace.getSignal("!");
+    REQUIRE(clk != nullptr);
+    CHECK(clk->scope == trace.indexOf(top_scopes[0]));
+    CHECK(clk->change_count == 3);
+
+    const auto top_signals = trace.getScopeSignals(top_scopes[0]);
+    const auto a_signals = trace.getScopeSignals(children[0]);
+    REQUIRE(top_signals.size() == 1);
+    REQUIRE(a_signals.size() == 2);
+    CHECK(top_signals[0] == trace.indexOf(*clk));
+    CHECK(a_signals[0] == trace.indexOf(*clk));
+    CHECK(trace.getSignals()[a_signals[1]].reference == "data");
+
+    // The identifier index finds every signal
+    for (const auto& signal : trace.getSignals()) {
+        CHECK(trace.getSignal(signal.hash) == &signal);
+    }
+    CHECK(trace.getSignal("unknown") == nullptr);
+}
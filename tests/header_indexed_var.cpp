@@ -5,22 +5,22 @@
 
 TEST_CASE("Indexed var section in the header") {
     vcdp::VCDParser parser;
-    auto trace = parser.Parse(TEST_DATA_DIR "header_indexed_var.vcd");
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "header_indexed_var.vcd", &trace);
     for (const auto& error : parser.GetResult().errors) {
         std::cerr << error << std::endl;
     }
-    REQUIRE(trace != nullptr);
+    REQUIRE(parser.GetResult().success);
 
-    const auto& top_module = trace->GetScope("tb_counter");
+    const auto* top_module = trace.getScope("tb_counter");
     REQUIRE(top_module != nullptr);
-    CHECK(top_module->signals.size() == 1);
-    const auto& signal = top_module->signals.at(0);
-    REQUIRE(signal != nullptr);
+    REQUIRE(trace.getScopeSignals(*top_module).size() == 1);
+    const auto* signal = &trace.getSignals().at(trace.getScopeSignals(*top_module).at(0));
     CHECK(signal->hash == "!");
     CHECK(signal->reference == "data");
-    CHECK(signal->scope == top_module);
+    CHECK(signal->scope == trace.indexOf(*top_module));
     CHECK(signal->size == 1);
     CHECK(signal->type == vcdp::VCDVarType::VCD_VAR_WIRE);
     CHECK(signal->lindex == -1);
     CHECK(signal->rindex == 0);
-}
\ No newline at end of file
+}
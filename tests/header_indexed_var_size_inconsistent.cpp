@@ -12,6 +12,6 @@ TEST_CASE("Indexed var size in the header is inconsistent") {
 
     REQUIRE(trace == nullptr);
     CHECK_FALSE(parser.GetResult().success);
-    auto message = parser.GetResult().errors[0];
+    auto message = parser.GetResult().errors[0].Message();
     CHECK(message.find("Size mismatch for signal") != std::string::npos);
 }
\ No newline at end of file
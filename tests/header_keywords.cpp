@@ -0,0 +1,109 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+TEST_CASE("Keywords map to their enum value and back") {
+    for (const auto& keyword : vcdp::VAR_TYPE_KEYWORDS.keywords()) {
+        CHECK(vcdp::VAR_TYPE_KEYWORDS.find(keyword.name) == keyword.value);
+        CHECK(vcdp::utils::vcdVarType2String(keyword.value) == keyword.name);
+    }
+    for (const auto& keyword : vcdp::SCOPE_TYPE_KEYWORDS.keywords()) {
+        CHECK(vcdp::SCOPE_TYPE_KEYWORDS.find(keyword.name) == keyword.value);
+        CHECK(vcdp::utils::vcdScopeType2String(keyword.value) == keyword.name);
+    }
+    for (const auto& keyword : vcdp::TIME_UNIT_KEYWORDS.keywords()) {
+        CHECK(vcdp::TIME_UNIT_KEYWORDS.find(keyword.name) == keyword.value);
+        CHECK(vcdp::utils::vcdTimeUnit2String(keyword.value) == keyword.name);
+    }
+
+    for (const char* word : {"", "w", "wires", "tri2", "Wire", "realtim", "triandx"}) {
+        CHECK(vcdp::VAR_TYPE_KEYWORDS.find(word) == vcdp::VCDVarType::VCD_VAR_UNKNOWN);
+    }
+    CHECK(vcdp::SCOPE_TYPE_KEYWORDS.find("modules") == vcdp::VCDScopeType::VCD_SCOPE_UNKNOWN);
+    CHECK(vcdp::TIME_UNIT_KEYWORDS.find("ss") == vcdp::VCDTimeUnit::TIME_UNKNOWN);
+    CHECK(vcdp::utils::vcdVarType2String(vcdp::VCDVarType::VCD_VAR_UNKNOWN) == "unknown");
+    CHECK(vcdp::utils::vcdScopeType2String(vcdp::VCDScopeType::VCD_SCOPE_ROOT) == "root");
+    CHECK(vcdp::utils::vcdTimeUnit2String(static_cast<vcdp::VCDTimeUnit>(42)) == "invalid");
+}
+
+namespace {
+
+/// @brief The former mapping of var_type, for comparison: one string comparison per keyword until a match.
+vcdp::VCDVarType ChainedVarType(const std::string& type) {
+    using vcdp::VCDVarType;
+    if (type == "event") return VCDVarType::VCD_VAR_EVENT;
+    if (type == "integer") return VCDVarType::VCD_VAR_INTEGER;
+    if (type == "parameter") return VCDVarType::VCD_VAR_PARAMETER;
+    if (type == "real") return VCDVarType::VCD_VAR_REAL;
+    if (type == "realtime") return VCDVarType::VCD_VAR_REALTIME;
+    if (type == "reg") return VCDVarType::VCD_VAR_REG;
+    if (type == "supply0") return VCDVarType::VCD_VAR_SUPPLY0;
+    if (type == "supply1") return VCDVarType::VCD_VAR_SUPPLY1;
+    if (type == "time") return VCDVarType::VCD_VAR_TIME;
+    if (type == "tri") return VCDVarType::VCD_VAR_TRI;
+    if (type == "triand") return VCDVarType::VCD_VAR_TRIAND;
+    if (type == "trior") return VCDVarType::VCD_VAR_TRIOR;
+    if (type == "trireg") return VCDVarType::VCD_VAR_TRIREG;
+    if (type == "tri0") return VCDVarType::VCD_VAR_TRI0;
+    if (type == "tri1") return VCDVarType::VCD_VAR_TRI1;
+    if (type == "wand") return VCDVarType::VCD_VAR_WAND;
+    if (type == "wire") return VCDVarType::VCD_VAR_WIRE;
+    if (type == "wor") return VCDVarType::VCD_VAR_WOR;
+    return VCDVarType::VCD_VAR_UNKNOWN;
+}
+
+}  // namespace
+
+TEST_CASE("Header parsing benchmark") {
+    // Mostly wires and regs as a netlist dump, the other types sprinkled in
+    constexpr uint32_t VARS = 200000;
+    const auto& keywords = vcdp::VAR_TYPE_KEYWORDS.keywords();
+    std::vector<std::string> types;
+    for (uint32_t i = 0; i < VARS; i++) {
+        const size_t pick = i % 4 != 0 ? 16 - i % 2 * 11 : i / 4 % keywords.size();  // wire, reg or any
+        types.emplace_back(keywords[pick].name);
+    }
+
+    const std::string path = WriteTemp("vcdp_header_keywords.vcd", [&](std::ofstream& stream) {
+        stream << "$timescale 1 ps $end\n";
+        for (uint32_t i = 0; i < VARS; i++) {
+            if (i % 1000 == 0) stream << (i == 0 ? "" : "$upscope $end\n") << "$scope module u" << i / 1000 << " $end\n";
+            stream << "$var " << types[i] << " 1 " << vcdp::utils::compactIdentifier(i) << " s" << i << " $end\n";
+        }
+        stream << "$upscope $end\n$enddefinitions $end\n";
+    });
+
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    const double parse = Time([&] { parser.parse(path, &trace); });
+    std::filesystem::remove(path);
+    REQUIRE(parser.GetResult().success);
+    REQUIRE(trace.getSignals().size() == VARS);
+    for (uint32_t i = 0; i < VARS; i += 997) CHECK(vcdp::utils::vcdVarType2String(trace.getSignals()[i].type) == types[i]);
+
+    // The keyword lookups alone, as the var_type action ran them before and now
+    uint64_t chained_sum = 0;
+    uint64_t hashed_sum = 0;
+    const double chained = Time([&] {
+        for (int round = 0; round < 10; round++) {
+            for (const auto& type : types) chained_sum += static_cast<uint64_t>(ChainedVarType(type));
+        }
+    });
+    const double hashed = Time([&] {
+        for (int round = 0; round < 10; round++) {
+            for (const auto& type : types) hashed_sum += static_cast<uint64_t>(vcdp::VAR_TYPE_KEYWORDS.find(type));
+        }
+    });
+    CHECK(chained_sum == hashed_sum);
+
+    const auto rate = [](const double seconds) { return static_cast<uint64_t>(10 * VARS / seconds / 1e6); };
+    MESSAGE("header of " << VARS << " $var parsed in " << static_cast<uint64_t>(parse * 1000) << " ms; M lookups/s: chained "
+                         << rate(chained) << ", hashed " << rate(hashed));
+}
@@ -12,6 +12,6 @@ TEST_CASE("Missing $upscope declaration in header") {
 
     REQUIRE(trace == nullptr);
     CHECK_FALSE(parser.GetResult().success);
-    auto message = parser.GetResult().errors[0];
+    auto message = parser.GetResult().errors[0].Message();
     CHECK(message.find("$upscope declaration expected") != std::string::npos);
 }
\ No newline at end of file
@@ -5,37 +5,39 @@
 
 TEST_CASE("Multi top scopes in the header") {
     vcdp::VCDParser parser;
-    auto trace = parser.Parse(TEST_DATA_DIR "header_multi_topscopes.vcd");
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "header_multi_topscopes.vcd", &trace);
     for (const auto& error : parser.GetResult().errors) {
         std::cerr << error << std::endl;
     }
-    REQUIRE(trace != nullptr);
+    REQUIRE(parser.GetResult().success);
 
-    CHECK(trace->GetScopes().size() == 3);
+    CHECK(trace.getScopes().size() == 3);
+    CHECK(trace.getTopScopes().size() == 3);
 
     // Top module 1
-    const auto& top_module = trace->GetScope("tb_counter");
+    const auto* top_module = trace.getScope("tb_counter");
     REQUIRE(top_module != nullptr);
     CHECK(top_module->name == "tb_counter");
     CHECK(top_module->type == vcdp::VCDScopeType::VCD_SCOPE_MODULE);
-    CHECK(top_module->parent == nullptr);
-    CHECK(top_module->children.size() == 0);
+    CHECK(top_module->parent == vcdp::VCD_NO_INDEX);
+    CHECK(trace.getScopeChildren(*top_module).empty());
 
     // Top module 2
-    const auto& top2_module = trace->GetScope("uut");
+    const auto* top2_module = trace.getScope("uut");
     REQUIRE(top2_module != nullptr);
     CHECK(top2_module->name == "uut");
     CHECK(top2_module->type == vcdp::VCDScopeType::VCD_SCOPE_MODULE);
-    CHECK(top2_module->parent == nullptr);
-    CHECK(top2_module->children.size() == 0);
+    CHECK(top2_module->parent == vcdp::VCD_NO_INDEX);
+    CHECK(trace.getScopeChildren(*top2_module).empty());
 
     // Top module 3
-    const auto& top3_module = trace->GetScope("and");
+    const auto* top3_module = trace.getScope("and");
     REQUIRE(top3_module != nullptr);
     CHECK(top3_module->name == "and");
     CHECK(top3_module->type == vcdp::VCDScopeType::VCD_SCOPE_MODULE);
-    CHECK(top3_module->parent == nullptr);
-    CHECK(top3_module->children.size() == 0);
+    CHECK(top3_module->parent == vcdp::VCD_NO_INDEX);
+    CHECK(trace.getScopeChildren(*top3_module).empty());
 
     // Nested module
-}
\ No newline at end of file
+}
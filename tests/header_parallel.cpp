@@ -0,0 +1,131 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+/**
+ * @brief Write a flattened netlist: two large scopes of $var, a comment and aliases inside the runs, a few changes.
+ * @param bad_var When not 0, the $var numbered so is malformed.
+ * @param bad_scope The scope between the two runs has an unknown type.
+ */
+std::string WriteNetlist(const std::string& name, const uint32_t bad_var = 0, const bool bad_scope = false) {
+    return WriteTemp(name, [&](std::ofstream& stream) {
+        stream << "$date today $end\n$version netlister $end\n$timescale 1 ps $end\n$scope module top $end\n"
+               << "$var wire 1 ! clk $end\n$scope module core $end\n";
+        for (uint32_t i = 1; i <= 150000; i++) {
+            const std::string id = vcdp::utils::compactIdentifier(i % 5000 == 0 ? 0 : i);  // Some nets alias the clock
+            if (i == bad_var) {
+                stream << "$var wire 4 " << id << " n" << i << " [7:0] $end\n";
+            } else if (i % 7 == 0) {
+                stream << "$var reg 8 " << id << " r" << i << " [7:0] $end\n";
+            } else {
+                stream << "\t$var wire 1 " << id << " n" << i << " $end\n";
+            }
+            if (i == 100000) stream << "$comment $var inside a comment $end\n";
+        }
+        stream << "$upscope $end\n$scope " << (bad_scope ? "tsk" : "task") << " io $end\n";
+        for (uint32_t i = 150001; i <= 170000; i++) stream << "$var tri 1 " << vcdp::utils::compactIdentifier(i) << " t" << i << " $end\n";
+        stream << "$upscope $end\n$upscope $end\n$enddefinitions $end\n#0\n1!\nb101 " << vcdp::utils::compactIdentifier(7) << "\n#5\n0!\n";
+    });
+}
+
+}  // namespace
+
+TEST_CASE("Long runs of $var parsed on several threads") {
+    const std::string path = WriteNetlist("vcdp_header_parallel.vcd");
+    vcdp::ParseOptions serial_options;
+    vcdp::ParseOptions parallel_options;
+    parallel_options.threads = 4;
+
+    vcdp::VCDParser serial_parser;
+    vcdp::VCDFile serial;
+    serial_parser.parse(path, &serial, serial_options);
+    vcdp::VCDParser parallel_parser;
+    vcdp::VCDFile parallel;
+    parallel_parser.parse(path, &parallel, parallel_options);
+    std::filesystem::remove(path);
+    REQUIRE(serial_parser.GetResult().success);
+    REQUIRE(parallel_parser.GetResult().success);
+
+    // The same tables as a parse on one thread
+    REQUIRE(parallel.getScopes().size() == serial.getScopes().size());
+    for (size_t i = 0; i < serial.getScopes().size(); i++) {
+        const auto& a = serial.getScopes()[i];
+        const auto& b = parallel.getScopes()[i];
+        CHECK(b.name == a.name);
+        CHECK(b.type == a.type);
+        CHECK(b.parent == a.parent);
+        CHECK(b.signals_begin == a.signals_begin);
+        CHECK(b.signals_end == a.signals_end);
+    }
+    REQUIRE(parallel.getSignals().size() == serial.getSignals().size());
+    CHECK(parallel.getSignals().size() == 170001 - 150000 / 5000);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < serial.getSignals().size(); i++) {
+        const auto& a = serial.getSignals()[i];
+        const auto& b = parallel.getSignals()[i];
+        mismatches += b.hash != a.hash || b.reference != a.reference || b.scope != a.scope || b.type != a.type || b.size != a.size ||
+                      b.lindex != a.lindex || b.rindex != a.rindex;
+    }
+    CHECK(mismatches == 0);
+    const auto& core = parallel.getScopes()[1];  // Breadth-first: top, core, io
+    CHECK(core.name == "core");
+    CHECK(parallel.getScopeSignals(core).size() == 150000);
+    CHECK(parallel.getSignal("!")->change_count == 2);
+    CHECK(parallel.getSignal(vcdp::utils::compactIdentifier(7))->size == 8);
+}
+
+TEST_CASE("A malformed $var in a run stops the header where a serial parse does") {
+    const std::string path = WriteNetlist("vcdp_header_parallel_error.vcd", 120000);
+    vcdp::ParseOptions parallel_options;
+    parallel_options.threads = 4;
+
+    vcdp::VCDParser serial_parser;
+    vcdp::VCDFile serial;
+    serial_parser.parse(path, &serial);
+    vcdp::VCDParser parallel_parser;
+    vcdp::VCDFile parallel;
+    parallel_parser.parse(path, &parallel, parallel_options);
+    std::filesystem::remove(path);
+
+    const auto& serial_result = serial_parser.GetResult();
+    const auto& parallel_result = parallel_parser.GetResult();
+    CHECK_FALSE(parallel_result.success);
+    REQUIRE(serial_result.errors.size() == 1);
+    REQUIRE(parallel_result.errors.size() == 1);
+    CHECK(parallel_result.errors[0].code == vcdp::VCDDiagCode::HEADER_SYNTAX);
+    CHECK(parallel_result.errors[0].detail == serial_result.errors[0].detail);
+    CHECK(parallel_result.errors[0].detail.find(":120007:") != std::string::npos);  // 6 lines before the run, 1 for the comment
+    CHECK(parallel.getSignals().size() == serial.getSignals().size());
+}
+
+TEST_CASE("A malformed declaration between runs stops the header where a serial parse does") {
+    const std::string path = WriteNetlist("vcdp_header_parallel_scope.vcd", 0, true);
+    vcdp::ParseOptions parallel_options;
+    parallel_options.threads = 4;
+
+    vcdp::VCDParser serial_parser;
+    vcdp::VCDFile serial;
+    serial_parser.parse(path, &serial);
+    vcdp::VCDParser parallel_parser;
+    vcdp::VCDFile parallel;
+    parallel_parser.parse(path, &parallel, parallel_options);
+    std::filesystem::remove(path);
+
+    const auto& serial_result = serial_parser.GetResult();
+    const auto& parallel_result = parallel_parser.GetResult();
+    CHECK_FALSE(parallel_result.success);
+    REQUIRE(serial_result.errors.size() == 1);
+    REQUIRE(parallel_result.errors.size() == 1);
+    CHECK(parallel_result.errors[0].code == vcdp::VCDDiagCode::HEADER_SYNTAX);
+    CHECK(parallel_result.errors[0].detail == serial_result.errors[0].detail);
+    CHECK(parallel_result.errors[0].detail.find(":150009:") != std::string::npos);  // After the run, its comment and $upscope
+    CHECK(parallel.getSignals().size() == serial.getSignals().size());
+}
@@ -12,6 +12,6 @@ TEST_CASE("Ranged var size in the header is inconsistent") {
 
     REQUIRE(trace == nullptr);
     CHECK_FALSE(parser.GetResult().success);
-    auto message = parser.GetResult().errors[0];
+    auto message = parser.GetResult().errors[0].Message();
     CHECK(message.find("Range size mismatch for signal") != std::string::npos);
 }
\ No newline at end of file
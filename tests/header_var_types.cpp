@@ -13,26 +13,27 @@ constexpr std::array<const vcdp::VCDVarType, VAR_NB> signal_types = {
     vcdp::VCDVarType::VCD_VAR_TIME,     vcdp::VCDVarType::VCD_VAR_TRI,     vcdp::VCDVarType::VCD_VAR_TRIAND,    vcdp::VCDVarType::VCD_VAR_TRIOR,
     vcdp::VCDVarType::VCD_VAR_TRIREG,   vcdp::VCDVarType::VCD_VAR_TRI0,    vcdp::VCDVarType::VCD_VAR_WAND,      vcdp::VCDVarType::VCD_VAR_WIRE,
     vcdp::VCDVarType::VCD_VAR_WOR};
-const std::array<const vcdp::VCDSignalReference, VAR_NB> signal_name = {
+const std::array<const char*, VAR_NB> signal_name = {
     "sig_event", "sig_integer", "sig_parameter", "sig_real",   "sig_realtime", "sig_reg",  "sig_supply0", "sig_supply1", "sig_time",
     "sig_tri",   "sig_triand",  "sig_trior",     "sig_trireg", "sig_tri0",     "sig_wand", "sig_wire",    "sig_wor"};
 
 TEST_CASE("Var type test in the header") {
     vcdp::VCDParser parser;
-    auto trace = parser.Parse(TEST_DATA_DIR "header_var_types.vcd");
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "header_var_types.vcd", &trace);
     for (const auto& error : parser.GetResult().errors) {
         std::cerr << error << std::endl;
     }
-    REQUIRE(trace != nullptr);
+    REQUIRE(parser.GetResult().success);
 
-    const auto& top_module = trace->GetScope("test_var_types");
+    const auto* top_module = trace.getScope("test_var_types");
     REQUIRE(top_module != nullptr);
-    CHECK(top_module->signals.size() == VAR_NB);
+    const auto signals = trace.getScopeSignals(*top_module);
+    REQUIRE(signals.size() == VAR_NB);
 
     for (size_t i = 0; i < VAR_NB; i++) {
-        auto signal = top_module->signals.at(i);
-        REQUIRE(signal != nullptr);
+        const auto* signal = &trace.getSignals().at(signals.at(i));
         CHECK(signal->type == signal_types.at(i));
         CHECK(signal->reference == signal_name.at(i));
     }
-}
\ No newline at end of file
+}
@@ -12,6 +12,6 @@ TEST_CASE("Var out of scope in the header") {
 
     REQUIRE(trace == nullptr);
     CHECK_FALSE(parser.GetResult().success);
-    auto message = parser.GetResult().errors[0];
+    auto message = parser.GetResult().errors[0].Message();
     CHECK(message.find("needs to be part of a scope") != std::string::npos);
 }
\ No newline at end of file
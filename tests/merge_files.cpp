@@ -0,0 +1,108 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <filesystem>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+TEST_CASE("Merge a rolled over dump") {
+    vcdp::MergeOptions options;
+    options.threads = 2;
+    vcdp::VCDFile merged;
+    const vcdp::VCDMergeResult result = vcdp::VCDMerger(options).merge({TEST_DATA_DIR "merge_part0.vcd", TEST_DATA_DIR "merge_part1.vcd"}, &merged);
+    REQUIRE(result.success);
+    CHECK(result.signals == 2);
+    CHECK(result.shared == 2);
+    CHECK(result.remapped == 0);
+    CHECK(result.changes == 15);
+    CHECK(merged.getTimestamps() == std::vector<uint64_t>{0, 5, 10, 15, 20, 25, 30, 35});
+    CHECK(merged.getTopScopes().size() == 1);
+
+    const vcdp::VCDSignal* clock = merged.getSignal("!");
+    const vcdp::VCDSignal* count = merged.getSignal("\"");
+    REQUIRE(clock != nullptr);
+    REQUIRE(count != nullptr);
+    CHECK(ReadChanges(merged, *clock) == Changes{{0, "0"}, {5, "1"}, {10, "0"}, {15, "1"}, {20, "0"}, {20, "0"}, {25, "1"}, {30, "0"}, {35, "1"}});
+    CHECK(ReadChanges(merged, *count) == Changes{{0, "0000"}, {5, "0001"}, {15, "0010"}, {20, "0010"}, {25, "0011"}, {35, "0100"}});
+}
+
+TEST_CASE("Merge design partitions of different timescales") {
+    vcdp::MergeOptions options;
+    options.root = "top";
+    vcdp::VCDFile merged;
+    const vcdp::VCDMergeResult result =
+        vcdp::VCDMerger(options).merge({TEST_DATA_DIR "merge_part0.vcd", TEST_DATA_DIR "merge_partition.vcd"}, &merged);
+    REQUIRE(result.success);
+    CHECK(result.signals == 4);
+    CHECK(result.shared == 1);    // tb.clk
+    CHECK(result.remapped == 2);  // tb.dut.valid took '!', then tb.dut.level the code given to it
+
+    // At the finest timescale
+    CHECK(merged.time_units == vcdp::VCDTimeUnit::TIME_PS);
+    CHECK(merged.time_resolution == 1);
+    CHECK(merged.getTimestamps() == std::vector<uint64_t>{0, 2500, 5000, 7500, 10000, 15000, 20000});
+
+    REQUIRE(merged.getScope("top") != nullptr);
+    REQUIRE(merged.getTopScopes().size() == 1);
+    const vcdp::VCDScope& tb = merged.getScopeChildren(merged.getTopScopes()[0])[0];
+    CHECK(tb.name == "tb");
+    CHECK(merged.getScopeSignals(tb).size() == 2);
+    REQUIRE(merged.getScopeChildren(tb).size() == 1);
+    const auto dut = merged.getScopeSignals(merged.getScopeChildren(tb)[0]);
+    REQUIRE(dut.size() == 2);
+    const vcdp::VCDSignal& valid = merged.getSignals()[dut[0]];
+    const vcdp::VCDSignal& level = merged.getSignals()[dut[1]];
+    CHECK(valid.reference == "valid");
+    CHECK(level.reference == "level");
+
+    // A tie keeps the file order
+    const vcdp::VCDSignal* clock = merged.getSignal("!");
+    REQUIRE(clock != nullptr);
+    CHECK(ReadChanges(merged, *clock) == Changes{{0, "0"}, {0, "0"}, {5000, "1"}, {5000, "1"}, {10000, "0"}, {15000, "1"}, {20000, "0"}});
+    CHECK(ReadChanges(merged, valid) == Changes{{0, "0"}, {2500, "1"}, {7500, "0"}});
+    CHECK(ReadChanges(merged, level) == Changes{{0, "0"}, {2500, "1.5"}, {7500, "-2.25"}});
+
+    // Same path, another size
+    vcdp::VCDFile conflict;
+    const vcdp::VCDMergeResult failed = vcdp::VCDMerger().merge({TEST_DATA_DIR "merge_part0.vcd", TEST_DATA_DIR "merge_conflict.vcd"}, &conflict);
+    CHECK_FALSE(failed.success);
+    CHECK(failed.error.find("tb.clk") != std::string::npos);
+
+    vcdp::VCDFile missing;
+    CHECK_FALSE(vcdp::VCDMerger().merge({TEST_DATA_DIR "merge_part0.vcd", TEST_DATA_DIR "missing.vcd"}, &missing).success);
+}
+
+TEST_CASE("Streamed merge writes what merge stores") {
+    const std::vector<std::string> paths = {TEST_DATA_DIR "merge_partition.vcd", TEST_DATA_DIR "merge_part0.vcd", TEST_DATA_DIR "merge_part1.vcd"};
+    vcdp::MergeOptions options;
+    options.threads = 3;
+    options.chunk_size = 16;  // Many rounds of decoding
+
+    vcdp::VCDFile stored;
+    const vcdp::VCDMergeResult merged = vcdp::VCDMerger(options).merge(paths, &stored);
+    REQUIRE(merged.success);
+
+    const std::string output = TempPath("vcdp_merged.vcd");
+    const vcdp::VCDMergeResult written = vcdp::VCDMerger(options).write(paths, output);
+    REQUIRE(written.success);
+    CHECK(written.signals == merged.signals);
+    CHECK(written.remapped == merged.remapped);
+
+    vcdp::VCDParser parser;
+    vcdp::VCDFile streamed;
+    parser.parse(output, &streamed);
+    REQUIRE(parser.GetResult().success);
+    std::filesystem::remove(output);
+
+    REQUIRE(streamed.getSignals().size() == stored.getSignals().size());
+    CHECK(streamed.getTimestamps().back() == stored.getTimestamps().back());
+    for (const auto& signal : stored.getSignals()) {
+        // The first values of the stream are dumped once, at the beginning
+        Changes expected = ReadChanges(stored, signal);
+        Changes actual = ReadChanges(streamed, *streamed.getSignal(signal.hash));
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        actual.erase(std::unique(actual.begin(), actual.end()), actual.end());
+        CHECK(actual == expected);
+    }
+}
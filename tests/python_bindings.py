@@ -0,0 +1,86 @@
+"""Tests of the vcdp Python module, run by ctest when built with VCDP_BUILD_PYTHON."""
+
+import os
+import threading
+import unittest
+
+import numpy as np
+
+import vcdp
+
+DATA_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "data")
+
+
+class BindingsTest(unittest.TestCase):
+    def test_time_table_aliases_the_file(self):
+        trace = vcdp.parse(os.path.join(DATA_DIR, "clocked_bus.vcd"))
+        self.assertTrue(trace.frozen)
+        timestamps = trace.timestamps
+        self.assertEqual(timestamps.dtype, np.uint64)
+        self.assertEqual(timestamps.tolist(), [0, 2, 4, 6, 8, 10, 12, 14, 16])
+        self.assertFalse(timestamps.flags.writeable)
+        self.assertTrue(np.shares_memory(timestamps, trace.timestamps))
+
+        del trace  # The array keeps the file alive
+        self.assertEqual(int(timestamps[-1]), 16)
+
+    def test_decode_signals(self):
+        trace = vcdp.parse(os.path.join(DATA_DIR, "clocked_bus.vcd"))
+        nibble = trace.decode(trace.find_signal("#"))
+        self.assertEqual(nibble.times.tolist(), [0, 6, 10])
+        self.assertEqual(nibble.values.tolist(), [0, 0, 10])
+        self.assertEqual(nibble.known.tolist(), [1, 0, 1])
+        self.assertFalse(nibble.values.flags.owndata)
+
+        bus = trace.decode(trace.find_signal('"'))
+        self.assertEqual(bus.values.shape, (3, 2))
+        self.assertEqual(trace.path(trace.find_signal('"')), "top.bus")
+        self.assertIsNone(trace.find_signal("?"))
+
+        real = vcdp.parse(os.path.join(DATA_DIR, "body_real.vcd"))
+        t_last = real.decode(real.find_signal('"'))
+        self.assertEqual(t_last.reals.dtype, np.float64)
+        self.assertEqual(t_last.reals[:3].tolist(), [0.0, 40.0, 80.0])
+
+    def test_parse_from_threads(self):
+        path = os.path.join(DATA_DIR, "search_handshake.vcd")
+        traces = [None] * 8
+
+        def load(index):
+            traces[index] = vcdp.Parser().parse(path)
+
+        threads = [threading.Thread(target=load, args=(index,)) for index in range(len(traces))]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        for trace in traces:
+            self.assertEqual(trace.timestamps.tolist(), traces[0].timestamps.tolist())
+
+    def test_stream_visitor(self):
+        class Counter:
+            def __init__(self):
+                self.times = []
+                self.changes = {}
+
+            def on_timestamp(self, time):
+                self.times.append(time)
+
+            def on_value_change(self, signal, value):
+                self.changes.setdefault(signal.reference, []).append(value)
+
+        parser = vcdp.Parser()
+        counter = Counter()
+        header = parser.stream(os.path.join(DATA_DIR, "clocked_bus.vcd"), counter, chunk_size=16)
+        self.assertTrue(parser.result.success)
+        self.assertEqual(len(header.timestamps), 0)
+        self.assertEqual(counter.times, [0, 2, 4, 6, 8, 10, 12, 14, 16])
+        self.assertEqual(counter.changes["nibble"], ["0", "1x", "1010"])
+
+    def test_missing_file(self):
+        with self.assertRaises(RuntimeError):
+            vcdp.parse(os.path.join(DATA_DIR, "missing.vcd"))
+
+
+if __name__ == "__main__":
+    unittest.main()
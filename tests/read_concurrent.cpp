@@ -0,0 +1,149 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+/// @brief Write a trace of 64 counters of different periods in 4 scopes.
+std::string WriteTrace() {
+    return WriteTemp("vcdp_read_concurrent.vcd", [](std::ofstream& stream) {
+        stream << "$version GHDL v0 $end\n$timescale 1 ns $end\n";
+        for (int scope = 0; scope < 4; scope++) {
+            stream << "$scope module u" << scope << " $end\n";
+            for (int signal = 0; signal < 16; signal++) {
+                stream << "$var reg 8 " << vcdp::utils::compactIdentifier(scope * 16 + signal) << " count" << signal << " [7:0] $end\n";
+            }
+            stream << "$upscope $end\n";
+        }
+        stream << "$enddefinitions $end\n";
+        for (uint32_t cycle = 0; cycle < 20000; cycle++) {
+            stream << '#' << cycle * 10 << '\n';
+            for (uint32_t signal = 0; signal < 64; signal++) {
+                if (cycle % (signal % 7 + 1) != 0) continue;
+                stream << 'b';
+                for (int bit = 7; bit >= 0; bit--) stream << (((cycle + signal) >> bit) & 1);
+                stream << ' ' << vcdp::utils::compactIdentifier(signal) << '\n';
+            }
+        }
+    });
+}
+
+/// @brief Digest of the queries a reader of the file runs: lookups, iteration and summaries.
+uint64_t Query(const vcdp::VCDFile& file, const uint32_t seed) {
+    uint64_t digest = 0;
+    for (uint32_t i = 0; i < 16; i++) {
+        const vcdp::VCDSignal* signal = file.findSignal(vcdp::utils::compactIdentifier((seed + i * 7) % 64));
+        if (signal == nullptr) return 0;
+        for (const vcdp::VCDChange& change : vcdp::VCDChanges(file, *signal)) digest = digest * 31 + change.time + change.value.back();
+        for (const auto& sample : file.summarize(*signal, 0, file.getTimestamps().back(), 64)) digest = digest * 31 + sample.changes;
+    }
+    for (const auto& scope : file.getScopes()) digest += file.getScopeSignals(scope).size();
+
+    // A slice derived before the file was frozen, and one derived again by each call
+    for (const char* text : {"{u0.count1[3:0], u1.count2[7:4]}", "u2.count5[1:0]"}) {
+        const auto sliced = file.slice(text);
+        for (const vcdp::VCDChange& change : vcdp::VCDChanges(file, *sliced)) digest = digest * 31 + change.time + change.value.back();
+    }
+    return digest;
+}
+
+}  // namespace
+
+TEST_CASE("A frozen file rejects modifications") {
+    const std::string path = WriteTrace();
+    vcdp::VCDParser parser;
+    vcdp::VCDFile file;
+    vcdp::ParseOptions options;
+    options.freeze = true;
+    parser.parse(path, &file, options);
+    REQUIRE(parser.GetResult().success);
+    CHECK(file.frozen());
+    CHECK(parser.poll() == 0);
+
+    CHECK_THROWS_AS(file.addTimestamp(1000000), std::logic_error);
+    CHECK_THROWS_AS(file.addScope(vcdp::VCDScope()), std::logic_error);
+    CHECK_THROWS_AS(file.enableSummaries(16), std::logic_error);
+    CHECK_THROWS_AS(file.limitMemory(1), std::logic_error);
+    CHECK(file.getTimestamps().size() == 20000);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Concurrent readers of a frozen file get the results of a single one") {
+    const std::string path = WriteTrace();
+    vcdp::VCDParser parser;
+    vcdp::VCDFile file;
+    vcdp::ParseOptions options;
+    options.summary_resolution = 64;
+    parser.parse(path, &file, options);
+    REQUIRE(parser.GetResult().success);
+
+    // A slice gone stale before the freeze is derived again by it, then shared by the readers
+    const char* cached = "{u0.count1[3:0], u1.count2[7:4]}";
+    const auto stale = file.slice(cached);
+    file.addTimestamp(200000);
+    file.addValueChange(*file.getSignal(vcdp::utils::compactIdentifier(1)), "00000000");
+    file.freeze();
+    const auto fresh = file.slice(cached);
+    CHECK(fresh != stale);
+    CHECK(fresh->change_count == stale->change_count + 1);
+    CHECK(file.slice(cached) == fresh);
+    CHECK(file.slice("u2.count5[1:0]") != file.slice("u2.count5[1:0]"));
+
+    std::vector<uint64_t> expected;
+    for (uint32_t seed = 0; seed < 64; seed++) expected.push_back(Query(file, seed));
+
+    for (const unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u}) {
+        std::atomic<uint64_t> mismatches{0};
+        std::vector<std::thread> readers;
+        for (unsigned thread = 0; thread < threads; thread++) {
+            readers.emplace_back([&, thread] {
+                for (uint32_t round = 0; round < 64 / threads + 1; round++) {
+                    const uint32_t seed = (thread * 13 + round) % 64;
+                    if (Query(file, seed) != expected[seed]) mismatches++;
+                }
+            });
+        }
+        for (auto& reader : readers) reader.join();
+        CHECK(mismatches == 0);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Concurrent read benchmark") {
+    const std::string path = WriteTrace();
+    vcdp::VCDParser parser;
+    vcdp::VCDFile file;
+    vcdp::ParseOptions options;
+    options.freeze = true;
+    options.summary_resolution = 64;
+    parser.parse(path, &file, options);
+    std::filesystem::remove(path);
+    REQUIRE(parser.GetResult().success);
+
+    // The same queries spread over more and more readers. The rates are reported only, they depend on the cores of the machine
+    constexpr uint32_t QUERIES = 128;
+    uint64_t expected = 0;
+    for (uint32_t query = 0; query < QUERIES; query++) expected += Query(file, query % 64);
+    for (const unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u}) {
+        std::atomic<uint64_t> digest{0};
+        const double seconds = Time([&] {
+            std::vector<std::thread> readers;
+            for (unsigned thread = 0; thread < threads; thread++) {
+                readers.emplace_back([&, thread] {
+                    for (uint32_t query = thread; query < QUERIES; query += threads) digest += Query(file, query % 64);
+                });
+            }
+            for (auto& reader : readers) reader.join();
+        });
+        CHECK(digest == expected);
+        MESSAGE(threads << " threads: " << static_cast<uint64_t>(QUERIES / seconds) << " queries/s");
+    }
+}
@@ -0,0 +1,62 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+/// @brief Sampled values of a signal, -1 when not known.
+std::vector<int64_t> Values(const vcdp::VCDSampledSignals& sampled, const size_t signal) {
+    std::vector<int64_t> values;
+    for (size_t cycle = 0; cycle < sampled.cycles(); cycle++) {
+        values.push_back(sampled.known[signal][cycle] ? static_cast<int64_t>(sampled.value(signal, cycle)) : -1);
+    }
+    return values;
+}
+
+using Expected = std::vector<int64_t>;
+
+}  // namespace
+
+TEST_CASE("Sample signals on the edges of a clock") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "search_handshake.vcd", &trace);
+    REQUIRE(parser.GetResult().success);
+
+    const vcdp::VCDSignal& clk = *trace.getSignal("!");
+    const std::vector<const vcdp::VCDSignal*> signals = {trace.getSignal("\""), trace.getSignal("#"), trace.getSignal("$")};
+
+    // Values just before each rising edge
+    const vcdp::VCDSampledSignals rising = trace.sampleOn(clk, vcdp::VCDEdge::RISING, signals, 2);
+    CHECK(rising.times == std::vector<uint64_t>{5, 15, 25, 35, 45, 55});
+    CHECK(Values(rising, 0) == Expected{0, 1, 1, 1, 0, 1});
+    CHECK(Values(rising, 1) == Expected{0, 0, 0, 1, 0, 1});
+    CHECK(Values(rising, 2) == Expected{-1, 165, 165, 165, 165, 15});
+
+    // The first value of the clock is not an edge
+    const vcdp::VCDSampledSignals falling = trace.sampleOn(clk, vcdp::VCDEdge::FALLING, signals);
+    CHECK(falling.times == std::vector<uint64_t>{10, 20, 30, 40, 50, 60});
+    CHECK(Values(falling, 0) == Expected{0, 1, 1, 1, 0, 1});
+    CHECK(Values(falling, 2) == Expected{-1, 165, 165, 165, 165, 15});
+
+    CHECK(trace.sampleOn(clk, vcdp::VCDEdge::BOTH, signals).cycles() == 12);
+    CHECK(trace.sampleOn(clk, vcdp::VCDEdge::RISING, {}).cycles() == 6);
+}
+
+TEST_CASE("Sample wide and unknown values") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "clocked_bus.vcd", &trace);
+    REQUIRE(parser.GetResult().success);
+
+    const vcdp::VCDSignal& clk = *trace.getSignal("!");
+    const vcdp::VCDSampledSignals sampled = trace.sampleOn(clk, vcdp::VCDEdge::RISING, {trace.getSignal("\""), trace.getSignal("#")}, 0);
+
+    // From x to 1 is a rising edge, from 1 to x is not
+    CHECK(sampled.times == std::vector<uint64_t>{4, 8, 12, 16});
+    CHECK(sampled.words == std::vector<uint32_t>{2, 1});
+    CHECK(Values(sampled, 0) == Expected{-1, 1, 3, 3});
+    CHECK(sampled.values[0][2 * 2 + 1] == 1 << 2);  // Bit 66 of the third cycle
+    CHECK(Values(sampled, 1) == Expected{0, -1, 10, 10});
+}
@@ -0,0 +1,102 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+/// @brief (begin, end) of every match.
+std::vector<std::pair<uint64_t, uint64_t>> Intervals(const vcdp::VCDSearchResult& result) {
+    std::vector<std::pair<uint64_t, uint64_t>> intervals;
+    for (const auto& match : result.matches) intervals.emplace_back(match.begin, match.end);
+    return intervals;
+}
+
+using Expected = std::vector<std::pair<uint64_t, uint64_t>>;
+
+}  // namespace
+
+TEST_CASE("Find the times at which a condition holds") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "search_handshake.vcd", &trace);
+    REQUIRE(parser.GetResult().success);
+
+    const auto find = [&](const std::string& expression) {
+        const vcdp::VCDSearchResult result = vcdp::VCDSearch(expression).find(trace);
+        CAPTURE(expression);
+        CHECK(result.success);
+        return Intervals(result);
+    };
+
+    CHECK(find("tb.valid && !tb.ready") == Expected{{10, 30}});
+    CHECK(find("tb.valid") == Expected{{10, 40}, {50, 60}});
+    CHECK(find("tb.valid & tb.ready") == Expected{{30, 40}, {50, 60}});
+
+    // Values, selects and precedence
+    CHECK(find("tb.data == 0b1010_0101") == Expected{{10, 50}});
+    CHECK(find("tb.data[7:4] == 0xA") == Expected{{10, 50}});
+    CHECK(find("tb.data[0]") == Expected{{10, UINT64_MAX}});
+    CHECK(find("tb.data[3:0] + 1 == 6 && tb.valid") == Expected{{10, 40}});
+    CHECK(find("~tb.data[7:4] == 0x5 || (tb.data > 200) == 0") == Expected{{10, UINT64_MAX}});
+
+    // Unknown values never match
+    CHECK(find("tb.data == tb.data").front().first == 10);
+    CHECK(find("!(tb.data == 0)") == Expected{{10, UINT64_MAX}});
+}
+
+TEST_CASE("Only match conditions held for a duration") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "search_handshake.vcd", &trace);
+    REQUIRE(parser.GetResult().success);
+
+    const auto find = [&](const std::string& expression) { return Intervals(vcdp::VCDSearch(expression).find(trace)); };
+
+    CHECK(find("tb.valid && !tb.ready for 15") == Expected{{25, 30}});
+    CHECK(find("tb.valid && !tb.ready for 25").empty());
+    CHECK(find("tb.valid && !tb.ready for 2 @ tb.clk") == Expected{{25, 30}});
+    CHECK(find("tb.valid && !tb.ready for 3 @ tb.clk").empty());
+    CHECK(find("tb.data[0] for 45") == Expected{{55, UINT64_MAX}});
+}
+
+TEST_CASE("Search a file without loading it") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "search_handshake.vcd", &trace);
+    REQUIRE(parser.GetResult().success);
+
+    const std::string expression = "tb.valid & tb.ready || tb.data[3:0] == 5 for 1 @ tb.clk";
+    vcdp::VCDSearch search(expression);
+    const vcdp::VCDSearchResult loaded = search.find(trace);
+    const vcdp::VCDSearchResult streamed = search.find(std::string(TEST_DATA_DIR "search_handshake.vcd"));
+    REQUIRE(streamed.success);
+    CHECK(search.GetParseResult().success);
+    CHECK(Intervals(streamed) == Intervals(loaded));
+    CHECK(streamed.evaluations == loaded.evaluations);
+
+    // Only the time steps changing one of the signals are evaluated
+    const vcdp::VCDSearchResult valid = vcdp::VCDSearch("tb.valid").find(trace);
+    CHECK(valid.evaluations == 5);
+    CHECK(valid.evaluations < trace.getTimestamps().size());
+
+    vcdp::SearchOptions options;
+    options.max_matches = 1;
+    CHECK(Intervals(vcdp::VCDSearch("tb.valid", options).find(std::string(TEST_DATA_DIR "search_handshake.vcd"))) == Expected{{10, 40}});
+}
+
+TEST_CASE("Report invalid expressions") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "search_handshake.vcd", &trace);
+    REQUIRE(parser.GetResult().success);
+
+    for (const std::string expression : {"tb.nope", "tb.valid &&", "tb.data[9]", "(tb.valid", "tb.valid for", "tb.valid for 2 @ tb.nope"}) {
+        const vcdp::VCDSearchResult result = vcdp::VCDSearch(expression).find(trace);
+        CAPTURE(expression);
+        CHECK_FALSE(result.success);
+        CHECK_FALSE(result.error.empty());
+    }
+
+    CHECK_FALSE(vcdp::VCDSearch("tb.valid").find(std::string("missing.vcd")).success);
+}
@@ -0,0 +1,193 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+/**
+ * @brief Write a trace with a 512 bit bus, sometimes x, changing in its upper half more often than in its lower one,
+ * an 8 bit status declared [0:7] and a 1 bit valid.
+ */
+std::string WriteTrace() {
+    return WriteTemp("vcdp_slice_signal.vcd", [](std::ofstream& stream) {
+        stream << "$timescale 1 ns $end\n$scope module tb $end\n$var wire 512 ! bus [511:0] $end\n"
+               << "$var reg 8 \" status [0:7] $end\n$var wire 1 # valid $end\n$upscope $end\n$enddefinitions $end\n";
+        Random random(777);
+        std::string bus(512, '0');
+        for (uint32_t step = 0; step < 20000; step++) {
+            stream << '#' << step * 2 << '\n';
+            const uint32_t pick = random();
+            if (pick % 3 != 0) {
+                // Mostly the upper half, at times x in a few bits or twice at a timestamp
+                const size_t bit = pick % 4 == 0 ? 511 - random() % 256 : random() % 256;
+                bus[bit] = pick % 97 == 0 ? 'x' : (bus[bit] == '1' ? '0' : '1');
+                if (pick % 89 == 0) std::replace(bus.begin(), bus.end(), 'x', '0');
+                stream << 'b' << bus << " !\n";
+                if (pick % 53 == 0) stream << 'b' << bus.substr(0, 511) << "1 !\n";
+            }
+            if (pick % 7 == 0) {
+                stream << 'b';
+                for (int bit = 0; bit < 8; bit++) stream << (random() & 1);
+                stream << " \"\n";
+            }
+            if (pick % 5 == 0) stream << (pick / 5 % 2) << "#\n";
+        }
+    });
+}
+
+/**
+ * @brief A concatenation of fields computed from the text of their signals: the value at each time index of a change,
+ * kept when it differs from the previous one.
+ * @param fields Signal and positions of the first and last character of the field in its text, most significant first.
+ */
+Changes Expected(const std::vector<std::tuple<const vcdp::VCDSignal*, size_t, size_t>>& fields) {
+    std::map<uint64_t, std::vector<std::string>> values;  // Value of each field at each time index of a change
+    std::vector<std::string> current;
+    for (const auto& [signal, begin, end] : fields) current.emplace_back(end - begin + 1, 'X');
+    for (size_t i = 0; i < fields.size(); i++) {
+        for (const auto& change : ReadChanges(*std::get<0>(fields[i]))) values[change.first];
+    }
+    std::vector<Changes> reads;
+    std::vector<size_t> next(fields.size(), 0);
+    for (const auto& field : fields) reads.push_back(ReadChanges(*std::get<0>(field)));
+
+    Changes expected;
+    for (auto& [index, unused] : values) {
+        std::string value;
+        for (size_t i = 0; i < fields.size(); i++) {
+            while (next[i] < reads[i].size() && reads[i][next[i]].first == index) {
+                current[i] = reads[i][next[i]++].second.substr(std::get<1>(fields[i]), std::get<2>(fields[i]) - std::get<1>(fields[i]) + 1);
+            }
+            value += current[i];
+        }
+        if (expected.empty() || expected.back().second != value) expected.emplace_back(index, value);
+    }
+    return expected;
+}
+
+}  // namespace
+
+TEST_CASE("Slices and concatenations of vectors") {
+    const std::string path = WriteTrace();
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(path, &trace);
+    std::filesystem::remove(path);
+    REQUIRE(parser.GetResult().success);
+    const vcdp::VCDSignal& bus = *trace.getSignal("!");
+    const vcdp::VCDSignal& status = *trace.getSignal("\"");
+    const vcdp::VCDSignal& valid = *trace.getSignal("#");
+
+    // Bits 511 down to 0 are characters 0 to 511 of the text
+    const auto high = trace.slice("tb.bus[511:256]");
+    CHECK(high->size == 256);
+    CHECK(high->reference == "bus[511:256]");
+    CHECK(ReadChanges(*high) == Expected({{&bus, 0, 255}}));
+    const auto word = trace.slice({{&bus, 63, 32}});
+    CHECK(ReadChanges(*word) == Expected({{&bus, 448, 479}}));
+    CHECK(word->change_count < bus.change_count);  // Changes elsewhere in the bus are dropped
+    CHECK(ReadChanges(*trace.slice("!")) == Expected({{&bus, 0, 511}}));
+    CHECK(ReadChanges(*trace.slice("bus[300]")) == Expected({{&bus, 211, 211}}));
+    CHECK(ReadChanges(*trace.slice("bus[32:63]")) == ReadChanges(*word));  // Either order
+
+    // Declared [0:7]: bit 0 is the most significant one
+    CHECK(ReadChanges(*trace.slice("tb.status[0:3]")) == Expected({{&status, 0, 3}}));
+    CHECK(ReadChanges(*trace.slice("tb.status[7]")) == Expected({{&status, 7, 7}}));
+
+    // Concatenations, the same signal more than once
+    const auto packed = trace.slice(" { tb.valid, tb.status[6:7], bus[260:250], bus[0] } ");
+    CHECK(packed->size == 1 + 2 + 11 + 1);
+    CHECK(packed->reference == "{valid, status[6:7], bus[260:250], bus[0]}");
+    CHECK(ReadChanges(*packed) == Expected({{&valid, 0, 0}, {&status, 6, 7}, {&bus, 251, 261}, {&bus, 511, 511}}));
+
+    // Derived once, then read as any signal
+    CHECK(trace.slice("tb.bus[63:32]") == word);
+    CHECK(trace.slice({{&bus, 32, 63}}) == word);
+    const vcdp::VCDDecodedSignal decoded = trace.decode(*word);
+    CHECK(decoded.times.size() == word->change_count);
+    const auto changes = ReadChanges(*word);
+    const auto found = trace.nextChange(*word, trace.getTimestamp(changes[changes.size() / 2].first));
+    REQUIRE(found.has_value());
+    CHECK(found->value == changes[changes.size() / 2 + 1].second);
+    CHECK(trace.memoryUsage().vlists > 0);
+
+    for (const char* text : {"tb.nothing[3:0]", "tb.bus[512]", "tb.bus[3:-1]", "{tb.bus[3:0]", "tb.bus 3]", "tb.bus[a]", "{}"}) {
+        CHECK_THROWS_AS((void)trace.slice(text), std::invalid_argument);
+    }
+    CHECK_THROWS_AS((void)trace.slice(std::vector<vcdp::VCDSliceField>{}), std::invalid_argument);
+}
+
+TEST_CASE("A slice is derived again once its signal has new changes") {
+    vcdp::VCDFile trace;
+    trace.addScope({"top", vcdp::VCDScopeType::VCD_SCOPE_MODULE});
+    vcdp::VCDSignal declared;
+    declared.hash = "!";
+    declared.reference = "data";
+    declared.size = 16;
+    declared.lindex = 15;
+    declared.rindex = 0;
+    trace.addSignal(std::move(declared));
+    trace.endDefinitions();
+    vcdp::VCDSignal& data = *trace.getSignal("!");
+
+    trace.addTimestamp(0);
+    trace.addValueChange(data, "0000000011110000");
+    trace.addTimestamp(5);
+    trace.addValueChange(data, "1111111111110000");
+    const auto before = trace.slice("data[7:4]");
+    CHECK(ReadChanges(*before) == Changes{{0, "1111"}});
+
+    trace.addTimestamp(9);
+    trace.addValueChange(data, "11111111zz110000");
+    const auto after = trace.slice("data[7:4]");
+    CHECK(after != before);
+    CHECK(ReadChanges(*after) == Changes{{0, "1111"}, {2, "ZZ11"}});
+    CHECK(ReadChanges(*before) == Changes{{0, "1111"}});  // Unchanged for its holders
+    CHECK(trace.slice("data[7:4]") == after);
+
+    // Derived on a frozen file too
+    trace.freeze();
+    CHECK(ReadChanges(*trace.slice("data[3:0]")) == Changes{{0, "0000"}});
+}
+
+TEST_CASE("Slice benchmark") {
+    const std::string path = WriteTrace();
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(path, &trace);
+    std::filesystem::remove(path);
+    REQUIRE(parser.GetResult().success);
+    const vcdp::VCDSignal& bus = *trace.getSignal("!");
+
+    // A 32 bit field of the bus queried 50 times: its text cut from every change of the bus, or derived once
+    constexpr int QUERIES = 50;
+    size_t cut_changes = 0;
+    size_t sliced_changes = 0;
+    const double cut = Time([&] {
+        for (int query = 0; query < QUERIES; query++) {
+            std::string last;
+            vcdp::VCDChangeReader reader(bus);
+            while (reader.next()) {
+                const std::string field = reader.value().substr(448, 32);
+                cut_changes += field != last;
+                last = field;
+            }
+        }
+    });
+    const double sliced = Time([&] {
+        for (int query = 0; query < QUERIES; query++) sliced_changes += trace.slice("tb.bus[63:32]")->change_count;
+    });
+    CHECK(sliced_changes <= cut_changes);
+    MESSAGE(bus.change_count << " changes of a 512 bit bus, " << QUERIES << " queries of a 32 bit field: " << static_cast<uint64_t>(cut * 1000)
+                             << " ms cut from the text, " << static_cast<uint64_t>(sliced * 1000) << " ms sliced");
+}
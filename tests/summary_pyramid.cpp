@@ -0,0 +1,114 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+bool Same(const std::vector<vcdp::VCDSummarySample>& a, const std::vector<vcdp::VCDSummarySample>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].begin != b[i].begin || a[i].end != b[i].end || a[i].changes != b[i].changes || a[i].has_x != b[i].has_x ||
+            a[i].first != b[i].first || a[i].last != b[i].last) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t Changes(const std::vector<vcdp::VCDSummarySample>& samples) {
+    uint64_t changes = 0;
+    for (const auto& sample : samples) changes += sample.changes;
+    return changes;
+}
+
+}  // namespace
+
+TEST_CASE("Summaries from the pyramid match the value changes") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile plain;
+    parser.parse(TEST_DATA_DIR "ghdl_counter.vcd", &plain);
+    REQUIRE(parser.GetResult().success);
+
+    vcdp::ParseOptions options;
+    options.summary_resolution = 1;
+    vcdp::VCDFile summarized;
+    parser.parse(TEST_DATA_DIR "ghdl_counter.vcd", &summarized, options);
+    REQUIRE(parser.GetResult().success);
+    CHECK(summarized.memoryUsage().summaries > 0);
+    CHECK(plain.memoryUsage().summaries == 0);
+
+    // Windows and buckets aligned on powers of two are summarized exactly
+    uint64_t span = 1;
+    while (span <= summarized.getTimestamps().back()) span <<= 1;
+    for (size_t i = 0; i < summarized.getSignals().size(); i++) {
+        const vcdp::VCDSignal& signal = summarized.getSignals()[i];
+        REQUIRE(signal.summary.enabled());
+        CHECK(signal.summary.levels().back().size() == 1);
+        CHECK(signal.summary.levels().back().front().count == signal.change_count);
+
+        for (const size_t count : {1, 2, 16, 1024}) {
+            const auto fast = summarized.summarize(signal, 0, span, count);
+            const auto slow = plain.summarize(plain.getSignals()[i], 0, span, count);
+            CHECK(Same(fast, slow));
+            CHECK(Changes(fast) == signal.change_count);
+        }
+        CHECK(Same(summarized.summarize(signal, span / 4, span / 2, 64), plain.summarize(plain.getSignals()[i], span / 4, span / 2, 64)));
+
+        // Other windows only have their edges rounded
+        const auto rounded = summarized.summarize(signal, 0, span + 12345, 1000);
+        CHECK(rounded.size() == 1000);
+        CHECK(rounded.back().end == span + 12345);
+        CHECK(Changes(rounded) == signal.change_count);
+    }
+
+    CHECK(summarized.summarize(summarized.getSignals()[0], 10, 10, 4).empty());
+    CHECK(summarized.summarize(summarized.getSignals()[0], 0, 10, 0).empty());
+}
+
+TEST_CASE("Summaries carry values and unknown bits") {
+    vcdp::ParseOptions options;
+    options.summary_resolution = 4;
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "search_handshake.vcd", &trace, options);
+    REQUIRE(parser.GetResult().success);
+    CHECK(trace.getSignals()[0].summary.shift() == 2);
+
+    const vcdp::VCDSignal& data = trace.getSignals()[3];
+    REQUIRE(data.reference == "data");
+    const auto samples = trace.summarize(data, 0, 64, 4);
+    REQUIRE(samples.size() == 4);
+
+    CHECK(samples[0].first.empty());
+    CHECK(samples[0].changes == 2);
+    CHECK(samples[0].has_x);
+    CHECK(samples[0].last == "10100101");
+
+    CHECK(samples[1].first == "10100101");
+    CHECK(samples[1].changes == 0);
+    CHECK_FALSE(samples[1].has_x);
+
+    CHECK(samples[3].changes == 1);
+    CHECK(samples[3].first == "10100101");
+    CHECK(samples[3].last == "00001111");  // Left-extended
+}
+
+TEST_CASE("Summaries built by the parallel parser are the same") {
+    vcdp::ParseOptions options;
+    options.summary_resolution = 1000;
+    vcdp::VCDParser parser;
+    vcdp::VCDFile single;
+    parser.parse(TEST_DATA_DIR "ghdl_counter.vcd", &single, options);
+
+    options.threads = 4;
+    options.chunk_size = 64;
+    vcdp::VCDFile parallel;
+    parser.parse(TEST_DATA_DIR "ghdl_counter.vcd", &parallel, options);
+    REQUIRE(parser.GetResult().success);
+
+    for (size_t i = 0; i < single.getSignals().size(); i++) {
+        const uint64_t end = single.getTimestamps().back() + 1;
+        CHECK(Same(single.summarize(single.getSignals()[i], 0, end, 100), parallel.summarize(parallel.getSignals()[i], 0, end, 100)));
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "vcdp/VCDP.hpp"
+
+/**
+ * @file test_helpers.hpp
+ * @brief Helpers shared by the tests: timing, trace files written on the fly and the changes of a signal.
+ */
+
+/// @brief Seconds taken by a function.
+template <typename Fn>
+double Time(Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// @brief Pseudo-random numbers of 16 bits, the same sequence for a seed on every platform.
+class Random {
+   public:
+    explicit Random(const uint32_t seed) : state_(seed) {}
+
+    uint32_t operator()() {
+        state_ = state_ * 1103515245u + 12345u;
+        return state_ >> 16;
+    }
+
+   private:
+    uint32_t state_;
+};
+
+/// @brief Path of a file of the temporary directory, for the test to remove.
+inline std::string TempPath(const std::string& name) { return (std::filesystem::temp_directory_path() / name).string(); }
+
+/**
+ * @brief Write a file of the temporary directory.
+ * @param write Called with the stream of the file.
+ * @return Path of the file, for the test to remove.
+ */
+template <typename Fn>
+std::string WriteTemp(const std::string& name, Fn&& write) {
+    const std::string path = TempPath(name);
+    std::ofstream stream(path, std::ios::binary);
+    write(stream);
+    return path;
+}
+
+/**
+ * @brief Write a trace with a noisy bit "!", sometimes changing twice at a timestamp or going x, a bit "\"" changing
+ * every few thousand steps, a 12 bit bus "#" and a real signal "$".
+ * @param seed Of the noise.
+ * @param steps Number of timestamps, from `first` and `period` apart.
+ */
+inline std::string WriteNoisyTrace(const std::string& name, const uint32_t seed, const uint32_t steps, const uint64_t first, const uint64_t period) {
+    return WriteTemp(name, [&](std::ofstream& stream) {
+        stream << "$timescale 1 ns $end\n$scope module tb $end\n$var wire 1 ! noise $end\n$var wire 1 \" slow $end\n"
+               << "$var reg 12 # bus [11:0] $end\n$var real 64 $ level $end\n$upscope $end\n$enddefinitions $end\n";
+        Random random(seed);
+        for (uint32_t step = 0; step < steps; step++) {
+            stream << '#' << first + step * period << '\n';
+            const uint32_t pick = random();
+            if (pick % 2 == 0) stream << (pick % 61 == 0 ? 'x' : static_cast<char>('0' + pick / 2 % 2)) << "!\n";
+            if (pick % 13 == 0) stream << pick / 13 % 2 << "!\n";  // Again at the same timestamp
+            if (step % 4999 == 7) stream << step / 4999 % 2 << "\"\n";
+            if (pick % 5 == 0) {
+                stream << 'b';
+                for (int bit = 11; bit >= 0; bit--) stream << (random() >> bit & 1);
+                stream << " #\n";
+            }
+            if (pick % 3 == 0) stream << 'r' << (random() % 1000) * 0.125 << " $\n";
+        }
+    });
+}
+
+/// @brief Changes of a signal as (time index, value), or (time, value) from ReadChanges(file, signal).
+using Changes = std::vector<std::pair<uint64_t, std::string>>;
+
+/// @brief (time index, value) of the changes of a signal, read from its start.
+inline Changes ReadChanges(const vcdp::VCDSignal& signal) {
+    Changes changes;
+    vcdp::VCDChangeReader reader(signal);
+    while (reader.next()) changes.emplace_back(reader.timeIndex(), reader.value());
+    return changes;
+}
+
+/// @brief (time, value) of the changes of a signal of a file, read from its start.
+inline Changes ReadChanges(const vcdp::VCDFile& file, const vcdp::VCDSignal& signal) {
+    Changes changes;
+    vcdp::VCDChangeReader reader(signal);
+    while (reader.next()) changes.emplace_back(file.getTimestamp(reader.timeIndex()), reader.value());
+    return changes;
+}
@@ -0,0 +1,210 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+/// @brief Every value of a list, in insertion order.
+std::vector<uint32_t> Values(const vcdp::VListManager& list) {
+    std::vector<uint32_t> values;
+    vcdp::VListReader reader(list);
+    uint32_t value = 0;
+    while (reader.next(value)) values.push_back(value);
+    return values;
+}
+
+}  // namespace
+
+TEST_CASE("The first values of a list are stored inline") {
+    vcdp::VListManager list;
+    std::vector<uint32_t> expected = {0, 1, 127, 128, 5};  // 1 + 1 + 1 + 2 + 1 bytes
+    for (const uint32_t value : expected) list.addData(value);
+
+    uint64_t blocks = 0;
+    CHECK(list.memoryUsage(blocks) == 0);
+    CHECK(blocks == 0);
+    CHECK(list.head() == nullptr);
+    CHECK(Values(list) == expected);
+
+    // Moved with the list
+    vcdp::VListManager moved(std::move(list));
+    CHECK(Values(moved) == expected);
+    CHECK(Values(list).empty());
+
+    // Overflowing into blocks, a varint straddling the inline bytes and the first block
+    for (uint32_t value = 1000; value < 3000; value += 7) {
+        moved.addData(value);
+        expected.push_back(value);
+    }
+    CHECK(moved.head() != nullptr);
+    CHECK(Values(moved) == expected);
+
+    vcdp::VListManager copy;
+    copy.addBytes(moved.inlineData(), moved.inlineSize());
+    CHECK(copy.head() == nullptr);
+}
+
+TEST_CASE("Quiet signals allocate no block") {
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "search_handshake.vcd", &trace);
+    REQUIRE(parser.GetResult().success);
+
+    size_t quiet = 0;
+    for (const auto& signal : trace.getSignals()) {
+        if (signal.change_count > 4 || signal.size > 1) continue;
+        quiet++;
+        uint64_t blocks = 0;
+        CHECK(signal.data.memoryUsage(blocks) == 0);
+    }
+    CHECK(quiet > 0);
+}
+
+TEST_CASE("Cleared lists reuse the blocks of their pool") {
+    vcdp::VListPool pool;
+    std::vector<vcdp::VListManager> lists;
+    for (int i = 0; i < 64; i++) lists.emplace_back(pool);
+
+    const auto fill = [&] {
+        for (uint32_t value = 0; value < 1000000; value++) lists[value % lists.size()].addData(value);
+    };
+    fill();
+    CHECK(pool.cachedBytes() == 0);
+    for (auto& list : lists) list.clear();
+    CHECK(pool.cachedBytes() > 0);
+    fill();
+    CHECK(pool.cachedBytes() == 0);  // Every large block taken again
+    CHECK(Values(lists[3]).size() == 1000000 / 64);
+
+    for (auto& list : lists) list.clear();
+    CHECK(pool.trim() > 0);
+    CHECK(pool.cachedBytes() == 0);
+}
+
+namespace {
+
+/// @brief The former VList scheme, for comparison: blocks doubling from 1 byte, each one malloc'ed and linked newest first.
+class DoublingList {
+   public:
+    DoublingList() = default;
+    DoublingList(const DoublingList&) = delete;
+    DoublingList(DoublingList&& other) noexcept : head_(std::exchange(other.head_, nullptr)) {}
+    ~DoublingList() {
+        while (head_ != nullptr) free(std::exchange(head_, head_->next));
+    }
+
+    void addData(const uint32_t data) {
+        uint8_t buffer[5];
+        const size_t size = vcdp::VListManager::encode(data, buffer);
+        for (size_t i = 0; i < size; i++) {
+            if (head_ == nullptr || head_->offset >= head_->size) {
+                const uint32_t new_size = head_ ? std::min(head_->size * 2, vcdp::VLIST_MAX_BLOCK_SIZE) : 1;
+                auto* block = static_cast<Block*>(malloc(sizeof(Block) + new_size));
+                *block = {head_, new_size, 0};
+                head_ = block;
+            }
+            reinterpret_cast<uint8_t*>(head_ + 1)[head_->offset++] = buffer[i];
+        }
+    }
+
+    /// @brief Sum of the values, read back as VListReader read them: the blocks listed and reversed, then a byte at a time.
+    [[nodiscard]] uint64_t sum() const {
+        Reader reader(head_);
+        uint64_t total = 0;
+        uint32_t value = 0;
+        while (reader.next(value)) total += value;
+        return total;
+    }
+
+   private:
+    struct Block {
+        Block* next;
+        uint32_t size;
+        uint32_t offset;
+    };
+
+    class Reader {
+       public:
+        explicit Reader(const Block* head) {
+            for (const Block* block = head; block != nullptr; block = block->next) blocks_.push_back(block);
+            std::reverse(blocks_.begin(), blocks_.end());
+        }
+
+        bool next(uint32_t& value) {
+            value = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                if (pos_ >= size_ && !nextBlock()) return false;
+                const uint8_t byte = data_[pos_++];
+                value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                if (byte & 0x80) return true;
+            }
+        }
+
+       private:
+        bool nextBlock() {
+            while (block_ < blocks_.size()) {
+                data_ = reinterpret_cast<const uint8_t*>(blocks_[block_] + 1);
+                size_ = blocks_[block_++]->offset;
+                pos_ = 0;
+                if (size_ > 0) return true;
+            }
+            return false;
+        }
+
+        std::vector<const Block*> blocks_;
+        size_t block_ = 0;
+        const uint8_t* data_ = nullptr;
+        uint32_t size_ = 0;
+        uint32_t pos_ = 0;
+    };
+
+    Block* head_ = nullptr;
+};
+
+}  // namespace
+
+TEST_CASE("Pooled lists against doubling lists") {
+    // Round robin over the signals, as a parse stores them: a few busy ones, many quiet ones
+    constexpr size_t SIGNALS = 4096;
+    constexpr uint32_t CHANGES = 4000000;
+    const auto signal_of = [](const uint32_t change) { return change % 8 != 0 ? change % 16 : 16 + (change / 8) % (SIGNALS - 16); };
+
+    // Two rounds, the first one paying for the page faults. The rates are reported only, a loaded machine may swap them
+    for (int round = 0; round < 2; round++) {
+        uint64_t pooled_sum = 0;
+        uint64_t doubling_sum = 0;
+        vcdp::VListPool pool;
+        std::vector<vcdp::VListManager> pooled;
+        for (size_t i = 0; i < SIGNALS; i++) pooled.emplace_back(pool);
+        std::vector<DoublingList> doubling(SIGNALS);
+
+        const double pooled_append = Time([&] {
+            for (uint32_t change = 0; change < CHANGES; change++) pooled[signal_of(change)].addData(change & 0x3FFF);
+        });
+        const double doubling_append = Time([&] {
+            for (uint32_t change = 0; change < CHANGES; change++) doubling[signal_of(change)].addData(change & 0x3FFF);
+        });
+        const double pooled_iterate = Time([&] {
+            for (const auto& list : pooled) {
+                vcdp::VListReader reader(list);
+                uint32_t value = 0;
+                while (reader.next(value)) pooled_sum += value;
+            }
+        });
+        const double doubling_iterate = Time([&] {
+            for (const auto& list : doubling) doubling_sum += list.sum();
+        });
+        CHECK(pooled_sum == doubling_sum);
+
+        const auto rate = [](const double seconds) { return static_cast<uint64_t>(CHANGES / seconds / 1e6); };
+        MESSAGE("append M values/s: pooled " << rate(pooled_append) << ", doubling " << rate(doubling_append) << "; iterate: pooled "
+                                             << rate(pooled_iterate) << ", doubling " << rate(doubling_iterate));
+    }
+}
@@ -0,0 +1,131 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include "test_helpers.hpp"
+#include "vcdp/VCDP.hpp"
+
+namespace {
+
+/// @brief (time, value) pairs of every signal, by hierarchical name.
+std::map<std::string, std::string> Waveforms(const vcdp::VCDFile& trace) {
+    std::map<std::string, std::string> waveforms;
+    for (const auto& scope : trace.getScopes()) {
+        for (const vcdp::VCDIndex index : trace.getScopeSignals(scope)) {
+            const vcdp::VCDSignal& signal = trace.getSignals()[index];
+            std::string& waveform = waveforms[scope.name + "." + signal.reference];
+            vcdp::VCDChangeReader reader(signal);
+            while (reader.next()) {
+                waveform += std::to_string(trace.getTimestamp(reader.timeIndex())) + "=" + reader.value() + " ";
+            }
+        }
+    }
+    return waveforms;
+}
+
+std::string ReadAll(const std::filesystem::path& path) {
+    std::ifstream stream(path, std::ios::binary);
+    std::ostringstream text;
+    text << stream.rdbuf();
+    return text.str();
+}
+
+}  // namespace
+
+TEST_CASE("Write a parsed file back to VCD") {
+    const std::string output = TempPath("vcdp_writer_full.vcd");
+
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(TEST_DATA_DIR "ghdl_counter.vcd", &trace);
+    REQUIRE(parser.GetResult().success);
+
+    vcdp::VCDWriter writer;
+    const vcdp::VCDWriteResult result = writer.write(trace, output);
+    REQUIRE(result.success);
+    CHECK(result.signals == trace.getSignals().size());
+    CHECK(result.bytes == std::filesystem::file_size(output));
+
+    vcdp::VCDParser reparser;
+    vcdp::VCDFile copy;
+    reparser.parse(output, &copy);
+    REQUIRE(reparser.GetResult().success);
+    CHECK(copy.getTimestamps() == trace.getTimestamps());
+    CHECK(copy.time_units == trace.time_units);
+    CHECK(copy.getScopes().size() == 2);  // Empty scopes are dropped
+    CHECK(Waveforms(copy) == Waveforms(trace));
+
+    // The streaming path writes the same bytes
+    const std::string streamed = TempPath("vcdp_writer_streamed.vcd");
+    REQUIRE(writer.extract(TEST_DATA_DIR "ghdl_counter.vcd", streamed).success);
+    CHECK(ReadAll(streamed) == ReadAll(output));
+
+    std::filesystem::remove(output);
+    std::filesystem::remove(streamed);
+}
+
+TEST_CASE("Extract a few signals over a time window") {
+    const std::string output = TempPath("vcdp_writer_window.vcd");
+
+    vcdp::WriteOptions options;
+    options.signals = {"tb_counter.uut.*", "#"};
+    options.begin = 22000000;
+    options.end = 40000000;
+    options.compact_ids = true;
+
+    vcdp::VCDWriter writer(options);
+    const vcdp::VCDWriteResult result = writer.extract(TEST_DATA_DIR "ghdl_counter.vcd", output);
+    REQUIRE(result.success);
+    CHECK(result.signals == 5);
+
+    vcdp::VCDParser parser;
+    vcdp::VCDFile trace;
+    parser.parse(output, &trace);
+    REQUIRE(parser.GetResult().success);
+
+    // Identifiers renumbered in declaration order
+    REQUIRE(trace.getSignals().size() == 5);
+    CHECK(trace.getSignal("!")->reference == "data");
+    CHECK(trace.getSignal("\"")->reference == "clk");
+
+    // Values at the beginning of the window, then the changes up to its end
+    CHECK(trace.getTimestamps().front() == 22000000);
+    CHECK(trace.getTimestamps().back() == 40000000);
+    const auto waveforms = Waveforms(trace);
+    CHECK(waveforms.at("tb_counter.data") == "22000000=0000 25000000=0001 35000000=0010 ");
+    CHECK(waveforms.at("uut.clk") == "22000000=0 25000000=1 30000000=0 35000000=1 40000000=0 ");
+
+    // The same selection from the parsed file
+    vcdp::VCDParser source_parser;
+    vcdp::VCDFile source;
+    source_parser.parse(TEST_DATA_DIR "ghdl_counter.vcd", &source);
+    const std::string written = TempPath("vcdp_writer_window_parsed.vcd");
+    REQUIRE(writer.write(source, written).success);
+    CHECK(ReadAll(written) == ReadAll(output));
+
+    std::filesystem::remove(output);
+    std::filesystem::remove(written);
+}
+
+TEST_CASE("Compressed output") {
+    const std::string output = TempPath("vcdp_writer.vcd.gz");
+
+    vcdp::WriteOptions options;
+    options.gzip = true;
+    vcdp::VCDWriter writer(options);
+    const vcdp::VCDWriteResult result = writer.extract(TEST_DATA_DIR "ghdl_counter.vcd", output);
+    REQUIRE(result.success);
+
+    const std::string compressed = ReadAll(output);
+    REQUIRE(compressed.size() > 2);
+    CHECK(static_cast<uint8_t>(compressed[0]) == 0x1f);
+    CHECK(static_cast<uint8_t>(compressed[1]) == 0x8b);
+    CHECK(compressed.size() == result.bytes);
+
+    CHECK_FALSE(writer.extract(TEST_DATA_DIR "missing.vcd", output).success);
+    std::filesystem::remove(output);
+}